@@ -0,0 +1,110 @@
+/***************************************************************
+ * This source files comes from the xLights project
+ * https://www.xlights.org
+ * https://github.com/smeighan/xLights
+ * See the github commit history for a record of contributing
+ * developers.
+ * Copyright claimed based on commit dates recorded in Github
+ * License: https://github.com/smeighan/xLights/blob/master/License.txt
+ **************************************************************/
+
+#include "FSEQStreamWriter.h"
+
+#include <wx/time.h>
+#include <log4cpp/Category.hh>
+
+#include <cstring>
+
+bool FSEQStreamWriter::Open(const std::string& file, uint32_t channels, int frameMS)
+{
+    static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    Close();
+
+    if (!_file.Create(file, true))
+    {
+        logger_base.error("Unable to create capture file %s.", (const char*)file.c_str());
+        return false;
+    }
+
+    _channels = channels;
+    _frameMS = frameMS;
+    _frames = 0;
+
+    wxUint8 buf[FSEQSTREAM_HEADERSIZE];
+    memset(buf, 0x00, sizeof(buf));
+
+    buf[0] = 'P';
+    buf[1] = 'S';
+    buf[2] = 'E';
+    buf[3] = 'Q';
+    // Channel data offset
+    buf[4] = (wxUint8)(FSEQSTREAM_HEADERSIZE & 0xFF);
+    buf[5] = (wxUint8)((FSEQSTREAM_HEADERSIZE >> 8) & 0xFF);
+    // Version 2.0
+    buf[6] = 0;
+    buf[7] = 2;
+    // Header length
+    buf[8] = (wxUint8)(FSEQSTREAM_HEADERSIZE & 0xFF);
+    buf[9] = (wxUint8)((FSEQSTREAM_HEADERSIZE >> 8) & 0xFF);
+    // Channel count
+    buf[10] = (wxUint8)(channels & 0xFF);
+    buf[11] = (wxUint8)((channels >> 8) & 0xFF);
+    buf[12] = (wxUint8)((channels >> 16) & 0xFF);
+    buf[13] = (wxUint8)((channels >> 24) & 0xFF);
+    // Number of frames (14-17) is filled in by Flush
+    // Step time in ms
+    buf[18] = (wxUint8)(frameMS & 0xFF);
+    // 19 flags, 20 compression type (none), 21 compression blocks, 22 sparse ranges, 23 flags all zero
+    // Unique id
+    uint64_t id = (uint64_t)wxGetUTCTimeUSec().GetValue();
+    memcpy(&buf[24], &id, sizeof(id));
+
+    if (_file.Write(buf, sizeof(buf)) != sizeof(buf))
+    {
+        logger_base.error("Error writing capture file header %s.", (const char*)file.c_str());
+        _file.Close();
+        return false;
+    }
+
+    logger_base.debug("Streaming capture to %s. Channels %u, Frame time %dms.", (const char*)file.c_str(), channels, frameMS);
+
+    return true;
+}
+
+bool FSEQStreamWriter::AddFrame(const uint8_t* data)
+{
+    if (!_file.IsOpened()) return false;
+
+    if (_file.Write(data, _channels) != _channels)
+    {
+        return false;
+    }
+    _frames++;
+    return true;
+}
+
+void FSEQStreamWriter::Flush()
+{
+    if (!_file.IsOpened()) return;
+
+    wxUint8 buf[4];
+    buf[0] = (wxUint8)(_frames & 0xFF);
+    buf[1] = (wxUint8)((_frames >> 8) & 0xFF);
+    buf[2] = (wxUint8)((_frames >> 16) & 0xFF);
+    buf[3] = (wxUint8)((_frames >> 24) & 0xFF);
+
+    wxFileOffset end = _file.Tell();
+    _file.Seek(14);
+    _file.Write(buf, sizeof(buf));
+    _file.Seek(end);
+    _file.Flush();
+}
+
+void FSEQStreamWriter::Close()
+{
+    if (!_file.IsOpened()) return;
+
+    Flush();
+    _file.Close();
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+/***************************************************************
+ * This source files comes from the xLights project
+ * https://www.xlights.org
+ * https://github.com/smeighan/xLights
+ * See the github commit history for a record of contributing
+ * developers.
+ * Copyright claimed based on commit dates recorded in Github
+ * License: https://github.com/smeighan/xLights/blob/master/License.txt
+ **************************************************************/
+
+#include <wx/file.h>
+#include <cstdint>
+#include <string>
+
+#define FSEQSTREAM_HEADERSIZE 32
+
+// Writes an uncompressed V2 FSEQ one frame at a time without knowing how many frames there
+// will be. The frame count in the header is filled in by Flush so the file is valid whenever
+// it has been flushed even though more frames may be added later.
+class FSEQStreamWriter
+{
+    wxFile _file;
+    uint32_t _channels = 0;
+    uint32_t _frames = 0;
+    int _frameMS = 0;
+
+public:
+
+    FSEQStreamWriter() {}
+    virtual ~FSEQStreamWriter() { Close(); }
+
+    bool Open(const std::string& file, uint32_t channels, int frameMS);
+    bool IsOpen() const { return _file.IsOpened(); }
+    bool AddFrame(const uint8_t* data);
+    void Flush();
+    void Close();
+
+    uint32_t GetChannels() const { return _channels; }
+    uint32_t GetFrames() const { return _frames; }
+    int GetFrameMS() const { return _frameMS; }
+};
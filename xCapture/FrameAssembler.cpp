@@ -0,0 +1,482 @@
+/***************************************************************
+ * This source files comes from the xLights project
+ * https://www.xlights.org
+ * https://github.com/smeighan/xLights
+ * See the github commit history for a record of contributing
+ * developers.
+ * Copyright claimed based on commit dates recorded in Github
+ * License: https://github.com/smeighan/xLights/blob/master/License.txt
+ **************************************************************/
+
+#include "FrameAssembler.h"
+#include "xCaptureMain.h"
+
+#include <wx/filename.h>
+#include <wx/utils.h>
+#include <log4cpp/Category.hh>
+
+#include <algorithm>
+#include <cstring>
+
+// about 0.4 seconds of 1000 universes at 40 fps
+#define FRAMEASSEMBLER_RINGSIZE 16384
+
+// the most packets processed before letting the UI look at the capture
+#define FRAMEASSEMBLER_BATCH 1000
+
+inline long RoundTo4(long i) {
+    long remainder = i % 4;
+    if (remainder == 0) {
+        return i;
+    }
+    return i + 4 - remainder;
+}
+
+FrameAssembler::FrameAssembler() :
+    wxThread(wxTHREAD_JOINABLE), _stop(false), _e131Ring(FRAMEASSEMBLER_RINGSIZE), _artNETRing(FRAMEASSEMBLER_RINGSIZE),
+    _capturing(false), _packets(0)
+{
+    static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    if (Run() != wxTHREAD_NO_ERROR)
+    {
+        logger_base.error("Failed to start frame assembler thread.");
+        _stop = true;
+    }
+}
+
+FrameAssembler::~FrameAssembler()
+{
+    Stop();
+    Clear();
+}
+
+void* FrameAssembler::Entry()
+{
+    static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+    logger_base.debug("Frame assembler thread running.");
+
+    while (!_stop)
+    {
+        int processed = 0;
+        {
+            std::unique_lock<std::mutex> lock(_lock);
+            while (processed < FRAMEASSEMBLER_BATCH)
+            {
+                // take the packets from both rings in the order they arrived
+                const PacketRing::Slot* e = _e131Ring.GetReadSlot();
+                const PacketRing::Slot* a = _artNETRing.GetReadSlot();
+                if (e == nullptr && a == nullptr) break;
+
+                if (e != nullptr && (a == nullptr || e->_timeMS <= a->_timeMS))
+                {
+                    ProcessPacket(xCaptureFrame::ID_E131SOCKET, e->_timeMS, e->_data, e->_length);
+                    _e131Ring.CommitRead();
+                }
+                else
+                {
+                    ProcessPacket(xCaptureFrame::ID_ARTNETSOCKET, a->_timeMS, a->_data, a->_length);
+                    _artNETRing.CommitRead();
+                }
+                processed++;
+            }
+        }
+
+        if (processed == 0)
+        {
+            wxMilliSleep(1);
+        }
+    }
+
+    logger_base.debug("Frame assembler thread stopped.");
+
+    return nullptr;
+}
+
+void FrameAssembler::ProcessPacket(long type, int64_t timeMS, const uint8_t* packet, int len)
+{
+    if (type == xCaptureFrame::ID_E131SOCKET)
+    {
+        // validate the packet
+        if (len < 49) return;
+        if (packet[4] != 0x41) return;
+        if (packet[5] != 0x53) return;
+        if (packet[6] != 0x43) return;
+        if (packet[7] != 0x2d) return;
+        if (packet[8] != 0x45) return;
+        if (packet[9] != 0x31) return;
+        if (packet[10] != 0x2e) return;
+        if (packet[11] != 0x31) return;
+        if (packet[12] != 0x37) return;
+
+        uint32_t rootVector = ((uint32_t)packet[18] << 24) + ((uint32_t)packet[19] << 16) + ((uint32_t)packet[20] << 8) + (uint32_t)packet[21];
+        if (rootVector == 0x08)
+        {
+            // extended packet ... we only care about synchronisation
+            uint32_t framingVector = ((uint32_t)packet[40] << 24) + ((uint32_t)packet[41] << 16) + ((uint32_t)packet[42] << 8) + (uint32_t)packet[43];
+            if (framingVector == 0x01) OnSync();
+            return;
+        }
+        if (rootVector != 0x04) return;
+        if (len < 126) return;
+
+        // only DMX data
+        if (packet[125] != 0x00) return;
+
+        if (((int)packet[109] << 8) + (int)packet[110] != 0)
+        {
+            // the sender will tell us when each frame is complete
+            _syncMode = true;
+        }
+
+        int length = (((int)packet[115] - 0x70) << 8) + (int)packet[116] - 11;
+        if (length > len - 126) length = len - 126;
+        if (length < 0) return;
+
+        ProcessData(type, timeMS, ((int)packet[113] << 8) + (int)packet[114], (int)packet[111], &packet[126], length);
+    }
+    else if (type == xCaptureFrame::ID_ARTNETSOCKET)
+    {
+        // validate the packet
+        if (len < 10) return;
+        if (packet[0] != 'A') return;
+        if (packet[1] != 'r') return;
+        if (packet[2] != 't') return;
+        if (packet[3] != '-') return;
+        if (packet[4] != 'N') return;
+        if (packet[5] != 'e') return;
+        if (packet[6] != 't') return;
+
+        if (packet[9] == 0x52)
+        {
+            // ArtSync
+            _syncMode = true;
+            OnSync();
+            return;
+        }
+
+        // we only handle artdmx packets
+        if (packet[9] != 0x50) return;
+        if (len < 18) return;
+
+        int length = ((int)packet[16] << 8) + (int)packet[17];
+        if (length > len - 18) length = len - 18;
+
+        ProcessData(type, timeMS, ((int)packet[15] << 8) + (int)packet[14], (int)packet[12], &packet[18], length);
+    }
+}
+
+void FrameAssembler::ProcessData(long type, int64_t timeMS, int universe, int seq, const uint8_t* data, int len)
+{
+    static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    if (_settings._triggerOnChannel && universe == _settings._triggerUniverse)
+    {
+        int ch = _settings._triggerChannel - 1;
+        if (ch >= 0 && ch < len)
+        {
+            if (data[ch] >= _settings._triggerStart)
+            {
+                if (!_capturing) StartCaptureLocked(true);
+            }
+            else
+            {
+                if (_capturing) StopCaptureLocked();
+            }
+        }
+    }
+
+    if (!_capturing) return;
+
+    std::pair<int, int> key(universe, type == xCaptureFrame::ID_E131SOCKET ? 0 : 1);
+    auto it = _universes.find(key);
+    if (it == _universes.end())
+    {
+        // Doing this here means we only need to check the list when it isnt already captured
+        if (!_settings._allUniverses)
+        {
+            bool found = false;
+            for (const auto& r : _settings._universes)
+            {
+                if (universe >= r.first && universe <= r.second)
+                {
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) return;
+        }
+
+        if (_layoutFixed)
+        {
+            logger_base.warn("%s universe %d started sending after the channel layout was fixed. It will not be captured.",
+                type == xCaptureFrame::ID_E131SOCKET ? "E131" : "ArtNET", universe);
+        }
+
+        it = _universes.emplace(key, UniverseState()).first;
+        it->second._protocol = type;
+        it->second._universe = universe;
+    }
+    UniverseState& u = it->second;
+
+    if (u._inFrame)
+    {
+        // we already have this universe so the sender has moved on to the next frame ... or a sync was lost
+        EmitFrame();
+    }
+
+    if (!_frameOpen)
+    {
+        _frameOpen = true;
+        _frameStartMS = timeMS;
+    }
+
+    if (u._lastSeq != -1 && seq != 0)
+    {
+        int expected = (u._lastSeq + 1) & 0xFF;
+        if (expected == 0 && type == xCaptureFrame::ID_ARTNETSOCKET) expected = 1;
+        if (seq != expected) u._missing++;
+    }
+    u._lastSeq = seq;
+    u._inFrame = true;
+    u._packets++;
+    if (u._firstFrame == -1) u._firstFrame = _assembled;
+    u._lastFrame = _assembled;
+    _packets++;
+
+    if (!_layoutFixed)
+    {
+        u._data.assign(data, data + len);
+        u._size = std::max(u._size, len);
+    }
+    else if (u._startChannel >= 0)
+    {
+        memcpy(&_frame[u._startChannel], data, std::min(len, u._size));
+    }
+}
+
+void FrameAssembler::OnSync()
+{
+    if (_capturing) EmitFrame();
+}
+
+void FrameAssembler::EmitFrame()
+{
+    if (!_frameOpen) return;
+
+    if (!_layoutFixed)
+    {
+        WarmupFrame f;
+        f._timeMS = _frameStartMS;
+        for (const auto& it : _universes)
+        {
+            if (!it.second._data.empty())
+            {
+                f._data.push_back({ it.first, it.second._data });
+            }
+        }
+        _warmup.push_back(f);
+
+        if (_warmup.size() >= FRAMEASSEMBLER_WARMUPFRAMES)
+        {
+            FixLayout();
+        }
+    }
+    else
+    {
+        WriteFrame(_frameStartMS);
+    }
+
+    for (auto& it : _universes)
+    {
+        it.second._inFrame = false;
+    }
+    _frameOpen = false;
+    _assembled++;
+}
+
+void FrameAssembler::WriteFrame(int64_t timeMS)
+{
+    static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    if (_settings._fillInMissingFrames && _lastFrameMS != -1)
+    {
+        // allow for 5ms variance
+        int timeGap = (int)(timeMS - _lastFrameMS);
+        if (timeGap > _frameMS + 5)
+        {
+            int missingFrames = (timeGap + _frameMS / 2) / _frameMS - 1;
+            for (int i = 0; i < missingFrames; i++)
+            {
+                _writer.AddFrame(_previous.data());
+            }
+        }
+    }
+
+    if (!_writer.AddFrame(_frame.data()))
+    {
+        logger_base.error("Error writing frame %u to capture file.", _writer.GetFrames());
+    }
+    _previous = _frame;
+    _lastFrameMS = timeMS;
+}
+
+void FrameAssembler::FixLayout()
+{
+    static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    if (_layoutFixed) return;
+
+    _frameMS = _settings._frameMS;
+    if (_frameMS <= 0)
+    {
+        if (_warmup.size() > 1)
+        {
+            double totalgap = (double)(_warmup.back()._timeMS - _warmup.front()._timeMS);
+            int count = (int)_warmup.size() - 1;
+            _frameMS = ((int)(totalgap / count / 5)) * 5;
+            logger_base.debug("Guessing frame time. Total time %fms. Intervals %d, Average Frame %fms, Estimate %dms",
+                totalgap, count, totalgap / count, _frameMS);
+        }
+        if (_frameMS <= 0)
+        {
+            _frameMS = 50;
+            logger_base.debug("Not enough frames to guess the frame time. Assuming %dms.", _frameMS);
+        }
+    }
+    if (_frameMS > 255) _frameMS = 255;
+
+    long size = 0;
+    for (auto& it : _universes)
+    {
+        it.second._startChannel = size;
+        size += it.second._size;
+    }
+    _channelsPerFrame = RoundTo4(size);
+    _frame.assign(_channelsPerFrame, 0);
+    _previous = _frame;
+
+    _file = wxFileName::CreateTempFileName("xCapture").ToStdString();
+    _writer.Open(_file, _channelsPerFrame, _frameMS);
+    _layoutFixed = true;
+
+    for (const auto& f : _warmup)
+    {
+        for (const auto& it : f._data)
+        {
+            const UniverseState& u = _universes[it.first];
+            memcpy(&_frame[u._startChannel], it.second.data(), it.second.size());
+        }
+        WriteFrame(f._timeMS);
+    }
+    _warmup.clear();
+    _warmup.shrink_to_fit();
+
+    for (auto& it : _universes)
+    {
+        std::vector<uint8_t>().swap(it.second._data);
+    }
+}
+
+void FrameAssembler::SetSettings(const CaptureSettings& settings)
+{
+    std::unique_lock<std::mutex> lock(_lock);
+    _settings = settings;
+}
+
+void FrameAssembler::StartCapture()
+{
+    std::unique_lock<std::mutex> lock(_lock);
+    StartCaptureLocked(false);
+}
+
+void FrameAssembler::StartCaptureLocked(bool resume)
+{
+    static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    if (!resume)
+    {
+        ClearLocked();
+    }
+
+    // dont fill in the time we were not capturing
+    _lastFrameMS = -1;
+    _capturing = true;
+
+    logger_base.debug("Capture %s.", resume && _assembled > 0 ? "resumed" : "started");
+}
+
+void FrameAssembler::StopCapture()
+{
+    std::unique_lock<std::mutex> lock(_lock);
+    StopCaptureLocked();
+}
+
+void FrameAssembler::StopCaptureLocked()
+{
+    if (!_capturing) return;
+
+    EmitFrame();
+    if (!_layoutFixed && !_warmup.empty())
+    {
+        FixLayout();
+    }
+    _writer.Flush();
+    _capturing = false;
+}
+
+void FrameAssembler::Clear()
+{
+    std::unique_lock<std::mutex> lock(_lock);
+    ClearLocked();
+}
+
+void FrameAssembler::ClearLocked()
+{
+    _writer.Close();
+    if (_file != "")
+    {
+        wxRemoveFile(_file);
+        _file = "";
+    }
+
+    _universes.clear();
+    _warmup.clear();
+    _layoutFixed = false;
+    _syncMode = false;
+    _frameOpen = false;
+    _lastFrameMS = -1;
+    _assembled = 0;
+    _frameMS = 0;
+    _channelsPerFrame = 0;
+    std::vector<uint8_t>().swap(_frame);
+    std::vector<uint8_t>().swap(_previous);
+    _packets = 0;
+}
+
+bool FrameAssembler::HasCapture()
+{
+    std::unique_lock<std::mutex> lock(_lock);
+    return _writer.GetFrames() > 0 || !_warmup.empty();
+}
+
+CaptureSummary FrameAssembler::GetSummary()
+{
+    std::unique_lock<std::mutex> lock(_lock);
+
+    CaptureSummary summary;
+    summary._file = _file;
+    summary._frameMS = _frameMS;
+    summary._channelsPerFrame = _channelsPerFrame;
+    summary._frames = _layoutFixed ? (int)_writer.GetFrames() : (int)_warmup.size();
+    summary._packets = _packets;
+    summary._dropped = _e131Ring.GetDropped() + _artNETRing.GetDropped();
+    summary._syncPackets = _syncMode;
+    for (const auto& it : _universes)
+    {
+        const UniverseState& u = it.second;
+        summary._universes.push_back({ u._protocol, u._universe, u._startChannel == -1 ? -1 : u._startChannel + 1,
+            u._size, u._packets, u._missing, u._firstFrame, u._lastFrame });
+    }
+    return summary;
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+/***************************************************************
+ * This source files comes from the xLights project
+ * https://www.xlights.org
+ * https://github.com/smeighan/xLights
+ * See the github commit history for a record of contributing
+ * developers.
+ * Copyright claimed based on commit dates recorded in Github
+ * License: https://github.com/smeighan/xLights/blob/master/License.txt
+ **************************************************************/
+
+#include <wx/thread.h>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "PacketRing.h"
+#include "FSEQStreamWriter.h"
+
+// the frame time is guessed from the first 10 intervals between frames
+#define FRAMEASSEMBLER_WARMUPFRAMES 11
+
+// what to capture ... copied from the UI
+struct CaptureSettings
+{
+    bool _triggerOnChannel = false;
+    int _triggerUniverse = 1;
+    int _triggerChannel = 1;
+    int _triggerStart = 0;
+    bool _allUniverses = true;
+    std::vector<std::pair<int, int>> _universes;
+    int _frameMS = -1; // -1 means work it out from the data
+    bool _fillInMissingFrames = false;
+};
+
+// what has been captured so far
+struct CaptureSummary
+{
+    struct Universe
+    {
+        long _protocol;
+        int _universe;
+        long _startChannel; // 1 based start channel or -1 if it is not in the file
+        int _size;
+        long _packets;
+        long _missing;      // gaps in the sequence numbers
+        int _firstFrame;
+        int _lastFrame;
+    };
+
+    std::string _file;
+    int _frameMS = 0;
+    long _channelsPerFrame = 0;
+    int _frames = 0;
+    long _packets = 0;
+    uint64_t _dropped = 0;
+    bool _syncPackets = false;
+    std::vector<Universe> _universes;
+};
+
+// Turns the packets read by the receive threads into frames and streams them to an FSEQ file.
+//
+// A frame ends when a sync packet (E1.31 or ArtSync) arrives or, when the sender does not use
+// sync, when a universe arrives for the second time as the sender has moved on to the next
+// frame. The first few frames are held in memory while the universes and frame time are worked
+// out. After that the channel layout is fixed and every frame is written straight to the file
+// so only one frame is ever held in memory no matter how long the capture runs.
+class FrameAssembler : public wxThread
+{
+    struct UniverseState
+    {
+        long _protocol = 0;
+        int _universe = 0;
+        long _startChannel = -1; // 0 based offset in the frame or -1 if not in the layout
+        int _size = 0;
+        long _packets = 0;
+        long _missing = 0;
+        int _lastSeq = -1;
+        int _firstFrame = -1;
+        int _lastFrame = -1;
+        bool _inFrame = false;
+        std::vector<uint8_t> _data; // only used until the layout is fixed
+    };
+
+    struct WarmupFrame
+    {
+        int64_t _timeMS;
+        std::vector<std::pair<std::pair<int, int>, std::vector<uint8_t>>> _data;
+    };
+
+    std::atomic<bool> _stop;
+    PacketRing _e131Ring;
+    PacketRing _artNETRing;
+
+    std::mutex _lock;
+    CaptureSettings _settings;
+    std::atomic<bool> _capturing;
+    std::atomic<long> _packets;
+
+    // ordered by universe with E1.31 before ArtNET to match the channel layout
+    std::map<std::pair<int, int>, UniverseState> _universes;
+    std::vector<WarmupFrame> _warmup;
+    bool _layoutFixed = false;
+    bool _syncMode = false;
+    bool _frameOpen = false;
+    int64_t _frameStartMS = 0;
+    int64_t _lastFrameMS = -1;
+    int _assembled = 0;
+    int _frameMS = 0;
+    long _channelsPerFrame = 0;
+    std::vector<uint8_t> _frame;
+    std::vector<uint8_t> _previous;
+    std::string _file;
+    FSEQStreamWriter _writer;
+
+    void ProcessPacket(long type, int64_t timeMS, const uint8_t* packet, int len);
+    void ProcessData(long type, int64_t timeMS, int universe, int seq, const uint8_t* data, int len);
+    void OnSync();
+    void EmitFrame();
+    void WriteFrame(int64_t timeMS);
+    void FixLayout();
+    void StartCaptureLocked(bool resume);
+    void StopCaptureLocked();
+    void ClearLocked();
+
+public:
+
+    FrameAssembler();
+    virtual ~FrameAssembler();
+
+    void Stop()
+    {
+        if (!_stop)
+        {
+            _stop = true;
+            Wait();
+        }
+    }
+
+    PacketRing& GetE131Ring() { return _e131Ring; }
+    PacketRing& GetArtNETRing() { return _artNETRing; }
+
+    void SetSettings(const CaptureSettings& settings);
+    void StartCapture();
+    void StopCapture();
+    void Clear();
+    bool IsCapturing() const { return _capturing; }
+    bool HasCapture();
+    long GetPackets() const { return _packets; }
+    CaptureSummary GetSummary();
+
+    virtual void* Entry() override;
+};
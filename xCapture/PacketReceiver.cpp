@@ -0,0 +1,67 @@
+/***************************************************************
+ * This source files comes from the xLights project
+ * https://www.xlights.org
+ * https://github.com/smeighan/xLights
+ * See the github commit history for a record of contributing
+ * developers.
+ * Copyright claimed based on commit dates recorded in Github
+ * License: https://github.com/smeighan/xLights/blob/master/License.txt
+ **************************************************************/
+
+#include "PacketReceiver.h"
+
+#include <wx/socket.h>
+#include <wx/time.h>
+#include <log4cpp/Category.hh>
+
+PacketReceiver::PacketReceiver(const std::string& name, wxDatagramSocket* socket, PacketRing& ring) :
+    wxThread(wxTHREAD_JOINABLE), _stop(false), _socket(socket), _ring(ring), _name(name)
+{
+    static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    if (Run() != wxTHREAD_NO_ERROR)
+    {
+        logger_base.error("Failed to start %s receive thread.", (const char*)_name.c_str());
+        _stop = true;
+    }
+    else
+    {
+        logger_base.debug("%s receive thread created.", (const char*)_name.c_str());
+    }
+}
+
+void* PacketReceiver::Entry()
+{
+    static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    logger_base.debug("%s receive thread running.", (const char*)_name.c_str());
+
+    wxIPV4address addr;
+    uint8_t discard[PACKETRING_PACKETSIZE];
+    while (!_stop)
+    {
+        // wake up regularly so we notice being asked to stop
+        if (!_socket->WaitForRead(0, 50)) continue;
+
+        PacketRing::Slot* slot = _ring.GetWriteSlot();
+        uint8_t* buf = slot == nullptr ? discard : slot->_data;
+
+        size_t n = _socket->RecvFrom(addr, buf, PACKETRING_PACKETSIZE).LastCount();
+        if (n == 0) continue;
+
+        if (slot == nullptr)
+        {
+            // the assembler has fallen behind ... we have to read the packet to clear it but it is lost
+            _ring.Dropped();
+            continue;
+        }
+
+        slot->_timeMS = wxGetUTCTimeMillis().GetValue();
+        slot->_length = (int)n;
+        _ring.CommitWrite();
+    }
+
+    logger_base.debug("%s receive thread stopped. Dropped %llu packets.", (const char*)_name.c_str(), (unsigned long long)_ring.GetDropped());
+
+    return nullptr;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+/***************************************************************
+ * This source files comes from the xLights project
+ * https://www.xlights.org
+ * https://github.com/smeighan/xLights
+ * See the github commit history for a record of contributing
+ * developers.
+ * Copyright claimed based on commit dates recorded in Github
+ * License: https://github.com/smeighan/xLights/blob/master/License.txt
+ **************************************************************/
+
+#include <wx/thread.h>
+#include <atomic>
+#include <string>
+
+#include "PacketRing.h"
+
+class wxDatagramSocket;
+
+// Reads packets from one socket into a ring as fast as they arrive.
+//
+// The socket must have been created with wxSOCKET_BLOCK so it can be read from this thread.
+// The thread does nothing but copy packets into the ring so it is never held up by the frame
+// assembler or the UI.
+class PacketReceiver : public wxThread
+{
+    std::atomic<bool> _stop;
+    wxDatagramSocket* _socket = nullptr;
+    PacketRing& _ring;
+    std::string _name;
+
+public:
+
+    PacketReceiver(const std::string& name, wxDatagramSocket* socket, PacketRing& ring);
+    virtual ~PacketReceiver()
+    {
+        Stop();
+    }
+
+    void Stop()
+    {
+        if (!_stop)
+        {
+            _stop = true;
+            Wait();
+        }
+    }
+
+    virtual void* Entry() override;
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+/***************************************************************
+ * This source files comes from the xLights project
+ * https://www.xlights.org
+ * https://github.com/smeighan/xLights
+ * See the github commit history for a record of contributing
+ * developers.
+ * Copyright claimed based on commit dates recorded in Github
+ * License: https://github.com/smeighan/xLights/blob/master/License.txt
+ **************************************************************/
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// big enough for an E1.31 or ArtNET packet carrying a full universe
+#define PACKETRING_PACKETSIZE 640
+
+// A fixed size queue of received packets between one receive thread and the frame assembler.
+//
+// All the slots are allocated up front and packets are copied straight into them so nothing is
+// allocated while capturing. There is exactly one writer and one reader so no locks are needed.
+// If the assembler falls behind and the ring fills the packet is dropped and counted.
+class PacketRing
+{
+public:
+
+    struct Slot
+    {
+        int64_t _timeMS;
+        int _length;
+        uint8_t _data[PACKETRING_PACKETSIZE];
+    };
+
+    // size is rounded up to a power of 2
+    PacketRing(size_t size) : _head(0), _tail(0), _dropped(0)
+    {
+        size_t s = 1;
+        while (s < size) s <<= 1;
+        _slots.resize(s);
+        _mask = s - 1;
+    }
+
+    // writer ... the slot to fill or nullptr if the ring is full
+    Slot* GetWriteSlot()
+    {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) > _mask)
+        {
+            return nullptr;
+        }
+        return &_slots[head & _mask];
+    }
+
+    // writer ... makes the slot returned by GetWriteSlot visible to the reader
+    void CommitWrite()
+    {
+        _head.store(_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    void Dropped() { ++_dropped; }
+
+    // reader ... the oldest packet or nullptr if the ring is empty
+    const Slot* GetReadSlot() const
+    {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire))
+        {
+            return nullptr;
+        }
+        return &_slots[tail & _mask];
+    }
+
+    // reader ... releases the slot returned by GetReadSlot back to the writer
+    void CommitRead()
+    {
+        _tail.store(_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    uint64_t GetDropped() const { return _dropped; }
+    size_t GetSize() const { return _slots.size(); }
+
+private:
+
+    std::vector<Slot> _slots;
+    size_t _mask;
+    // keep the writer and reader positions on separate cache lines
+    alignas(64) std::atomic<size_t> _head;
+    alignas(64) std::atomic<size_t> _tail;
+    std::atomic<uint64_t> _dropped;
+};
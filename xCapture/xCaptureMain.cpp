@@ -25,6 +25,7 @@
 #include <wx/filedlg.h>
 #include <wx/numdlg.h>
 #include "ResultDialog.h"
+#include "PacketReceiver.h"
 #include "../xLights/IPEntryDialog.h"
 
 #ifndef __WXMSW__
@@ -113,125 +114,43 @@ BEGIN_EVENT_TABLE(xCaptureFrame,wxFrame)
     //*)
 END_EVENT_TABLE()
 
-void xCaptureFrame::PurgeCollectedData()
+CaptureSettings xCaptureFrame::GetCaptureSettings()
 {
-    while (_capturedData.size() > 0)
-    {
-        auto toDelete = _capturedData.front();
-        _capturedData.pop_front();
-        delete toDelete;
-    }
-}
-
-void xCaptureFrame::StashPacket(long type, wxByte* packet, int len)
-{
-    int universe = -1;
-    if (type == ID_E131SOCKET)
-    {
-        universe = ((int)packet[113] << 8) + (int)packet[114];
-    }
-    else if (type == ID_ARTNETSOCKET)
-    {
-        // we only handle artdmx packets
-        if (packet[9] != 0x50) return;
-
-        universe = ((int)packet[15] << 8) + (int)packet[14];
-    }
+    CaptureSettings settings;
 
-    if (universe == -1) return;
+    settings._triggerOnChannel = CheckBox_TriggerOnChannel->GetValue();
+    settings._triggerUniverse = SpinCtrl_Universe->GetValue();
+    settings._triggerChannel = SpinCtrl_Channel->GetValue();
+    settings._triggerStart = SpinCtrl_TriggerStart->GetValue();
 
-    if (CheckBox_TriggerOnChannel->GetValue())
+    if (ListView_Universes->GetItemCount() == 1 &&
+        ListView_Universes->GetItemText(0) == "All")
     {
-        if (universe == SpinCtrl_Universe->GetValue())
-        {
-            wxByte c = packet[125 + SpinCtrl_Channel->GetValue()];
-
-            if (c >= SpinCtrl_TriggerStart->GetValue())
-            {
-                _capturing = true;
-                _capturedDesc = "";
-                ValidateWindow();
-            }
-            else
-            {
-                _capturing = false;
-                UpdateCaptureDesc();
-                ValidateWindow();
-            }
-        }
+        settings._allUniverses = true;
     }
-
-    if (!_capturing) return;
-
-    for (const auto& it : _capturedData)
+    else
     {
-        if (it->_protocol == type && it->_universe == universe)
+        settings._allUniverses = false;
+        for (int i = 0; i < ListView_Universes->GetItemCount(); i++)
         {
-            _capturedPackets++;
-            it->AddPacket(type, packet, len);
-            return;
+            int start = wxAtoi(ListView_Universes->GetItemText(i));
+            int end = wxAtoi(ListView_Universes->GetItemText(i, 1));
+            settings._universes.push_back({ start, end });
         }
     }
 
-    // Doing thise here means we only need to check the list when it isnt already captured
-    if (!IsUniverseToBeCaptured(universe)) return;
-
-    Collector* c = new Collector(type, universe);
-    _capturedData.push_back(c);
-    c->AddPacket(type, packet, len);
-    _capturedPackets++;
-}
-
-bool xCaptureFrame::IsUniverseToBeCaptured(int universe, bool ignoreall /*= false*/)
-{
-    if (ListView_Universes->GetItemCount() == 1 &&
-        ListView_Universes->GetItemText(0) == "All" && !ignoreall)
+    if (Choice_Timing->GetStringSelection() == "Manual")
     {
-        return true;
+        settings._frameMS = SpinCtrl_ManualTime->GetValue();
     }
-
-    for (int i = 0; i < ListView_Universes->GetItemCount(); i++)
+    else if (Choice_Timing->GetStringSelection() != "xCapture Detected (rounded to nearest 5ms)")
     {
-        int start = wxAtoi(ListView_Universes->GetItemText(i));
-        int end = wxAtoi(ListView_Universes->GetItemText(i, 1));
-
-        if (universe >= start && universe <= end) return true;
+        settings._frameMS = wxAtoi(Choice_Timing->GetStringSelection());
     }
 
-    return false;
-}
+    settings._fillInMissingFrames = CheckBox_FillInMissingFrames->GetValue();
 
-int xCaptureFrame::GuessFrameMS()
-{
-    static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
-    Collector* c = _capturedData.front();
-
-    bool first = true;
-    wxDateTime last;
-    double totalgap = 0;
-    int count = 0;
-    // look at the first 10 intervals
-    for (auto it = c->_packets.begin(); count < 10 && it != c->_packets.end(); ++it)
-    {
-        if (first)
-        {
-            first = false;
-        }
-        else
-        {
-            totalgap += ((*it)->_timeStamp - last).GetValue().ToDouble();
-            count++;
-        }
-        last = (*it)->_timeStamp;
-    }
-    logger_base.debug("Guessing frame time. Total time %fms. Intervals %d, Average Frame %fms, Estimate %dms",
-        totalgap,
-        count,
-        totalgap / count,
-        ((int)((totalgap / count)) / 5) * 5);
-    totalgap /= count;
-    //totalgap += 2.5;
-    return ((int)(totalgap / 5)) * 5;
+    return settings;
 }
 
 xCaptureFrame::xCaptureFrame(wxWindow* parent, const std::string& showdir, const std::string& playlist, wxWindowID id)
@@ -240,9 +159,11 @@ xCaptureFrame::xCaptureFrame(wxWindow* parent, const std::string& showdir, const
 
     _e131Socket = nullptr;
     _artNETSocket = nullptr;
+    _e131Receiver = nullptr;
+    _artNETReceiver = nullptr;
     _capturing = false;
-    _capturedPackets = 0;
     _capturedDesc = "";
+    _assembler = new FrameAssembler();
 
     //(*Initialize(xCaptureFrame)
     wxFlexGridSizer* FlexGridSizer1;
@@ -387,9 +308,6 @@ xCaptureFrame::xCaptureFrame(wxWindow* parent, const std::string& showdir, const
     Connect(wxEVT_SIZE,(wxObjectEventFunction)&xCaptureFrame::OnResize);
     //*)
 
-    Connect(ID_E131SOCKET, wxEVT_SOCKET, (wxObjectEventFunction)&xCaptureFrame::OnE131SocketEvent);
-    Connect(ID_ARTNETSOCKET, wxEVT_SOCKET, (wxObjectEventFunction)&xCaptureFrame::OnArtNETSocketEvent);
-
     SetTitle("xLights Capture " + GetDisplayVersionString());
 
     wxIconBundle icons;
@@ -504,7 +422,7 @@ xCaptureFrame::~xCaptureFrame()
 
     CloseSockets(true);
 
-    PurgeCollectedData();
+    delete _assembler;
 
     //(*Destroy(xCaptureFrame)
     //*)
@@ -563,18 +481,17 @@ void xCaptureFrame::SaveState()
     config->Flush();
 }
 
-void xCaptureFrame::FillInMissingFrames(int frameTime)
-{
-    for (auto& it : _capturedData)         {
-        it->FillInMissingFrames(frameTime);
-    }
-}
-
 // close not required sockets
 void xCaptureFrame::CloseSockets(bool force)
 {
     if (force || !CheckBox_E131->GetValue())
     {
+        if (_e131Receiver != nullptr)
+        {
+            _e131Receiver->Stop();
+            delete _e131Receiver;
+            _e131Receiver = nullptr;
+        }
         if (_e131Socket != nullptr)
         {
             _e131Socket->Close();
@@ -585,6 +502,12 @@ void xCaptureFrame::CloseSockets(bool force)
 
     if (force || !CheckBox_ArtNET->GetValue())
     {
+        if (_artNETReceiver != nullptr)
+        {
+            _artNETReceiver->Stop();
+            delete _artNETReceiver;
+            _artNETReceiver = nullptr;
+        }
         if (_artNETSocket != nullptr)
         {
             _artNETSocket->Close();
@@ -605,220 +528,6 @@ void xCaptureFrame::OnAbout(wxCommandEvent& event)
     wxMessageBox(about, _("Welcome to..."));
 }
 
-PacketData::PacketData(long type, wxByte* packet, int len)
-{
-    static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
-    _timeStamp = wxDateTime::UNow();
-    _frameTimeMS = -1;
-    _seq = 0;
-    _length = 0;
-    _pdata = nullptr;
-
-    if (type == xCaptureFrame::ID_E131SOCKET)
-    {
-        // validate the packet
-        if (len < 126) return;
-        if (packet[4] != 0x41) return;
-        if (packet[5] != 0x53) return;
-        if (packet[6] != 0x43) return;
-        if (packet[7] != 0x2d) return;
-        if (packet[8] != 0x45) return;
-        if (packet[9] != 0x31) return;
-        if (packet[10] != 0x2e) return;
-        if (packet[11] != 0x31) return;
-        if (packet[12] != 0x37) return;
-
-        _seq = (int)packet[111];
-        _length = (((int)packet[115] - 0x70) << 8) + (int)packet[116] - 11;
-        if (_length > len - 126)
-        {
-            logger_base.warn("E131 packet of claimed length %d truncated to actual packet length %d.", _length, len - 126);
-            logger_base.warn("    Packet looks unlikely to be valid.");
-            _length = len - 126;
-        }
-        _pdata = (wxByte*)malloc(_length);
-        memcpy(_pdata, &packet[126], _length);
-    }
-    else if (type == xCaptureFrame::ID_ARTNETSOCKET)
-    {
-        // validate the packet
-        if (len < 18) return;
-        if (packet[0] != 'A') return;
-        if (packet[1] != 'r') return;
-        if (packet[2] != 't') return;
-        if (packet[3] != '-') return;
-        if (packet[4] != 'N') return;
-        if (packet[5] != 'e') return;
-        if (packet[6] != 't') return;
-        if (packet[9] != 0x50) return;
-
-        _seq = (int)packet[12];
-        _length = ((int)packet[16] << 8) + (int)packet[17];
-        if (_length > len - 18)
-        {
-            logger_base.warn("ArtNet packet of claimed length %d truncated to actual packet length %d.", _length, len - 18);
-            logger_base.warn("    Packet looks unlikely to be valid.");
-            _length = len - 18;
-        }
-        _pdata = (wxByte*)malloc(_length);
-        memcpy(_pdata, &packet[18], _length);
-    }
-}
-
-// Duplicate a packet but update its sequence number and time
-PacketData::PacketData(PacketData& pd, int seq, int time)
-{
-    _seq = seq;
-    _length = pd._length;
-    _pdata = (wxByte*)malloc(_length);
-    memcpy(_pdata, pd._pdata, _length);
-    _frameTimeMS = time;
-}
-
-Collector::~Collector()
-{
-    while (_packets.size() > 0)
-    {
-        auto toDelete = _packets.front();
-        _packets.pop_front();
-        delete toDelete;
-    }
-}
-
-// relies on missing sequence numbers to detect missing frames
-void Collector::CalculateFrames(wxDateTime startTime, int frameMS)
-{
-    static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
-
-    bool first = true;
-    int ms = 0;
-    int lastseq = 255;
-
-    // rebase the start time to the start time in this universe if possible
-    if (_packets.size() > 0)
-    {
-        double rawFrameMS = (_packets.front()->_timeStamp - startTime).GetValue().ToDouble();
-        ms = ((int)(rawFrameMS / frameMS)) * frameMS;
-        lastseq = _packets.front()->_seq - 1;
-        if (lastseq < 0) lastseq = 255;
-    }
-
-    //logger_base.debug("Allocating frames for universe %d", _universe);
-    for (auto it = _packets.begin(); it != _packets.end(); ++it)
-    {
-        lastseq += 1;
-        if (lastseq > 255) lastseq = 0;
-
-        if (lastseq != (*it)->_seq)
-        {
-            // a frame is missing
-            // check it is only one
-            auto next = it;
-            ++next;
-
-            if (next != _packets.end() && (*next)->_seq == lastseq)
-            {
-                logger_base.warn("Universe %d missing one packet sequence lastSeq %d", _universe, lastseq);
-                // only one frame was missing so assume it was lost
-                ms += frameMS;
-                lastseq += 1;
-                if (lastseq > 255) lastseq = 0;
-            }
-            else
-            {
-                if (!first)
-                {
-                    logger_base.warn("Universe %d missing multiple packets from sequence %d", _universe, lastseq);
-                }
-                lastseq = (*it)->_seq;
-            }
-        }
-        (*it)->_frameTimeMS = ms;
-        ms += frameMS;
-        first = false;
-    }
-}
-
-PacketData* Collector::GetPacket(long ms)
-{
-    auto it = _packets.begin();
-    while (it != _packets.end() && ms > (*it)->_frameTimeMS)
-    {
-        ++it;
-    }
-
-    if (it != _packets.end() && ms == (*it)->_frameTimeMS)
-    {
-        return (*it);
-    }
-
-    return nullptr;
-}
-
-bool Collector::operator<(const Collector& c) const
-{
-    if (_universe == c._universe)
-    {
-        if (_protocol == xCaptureFrame::ID_E131SOCKET)
-        {
-            return true;
-        }
-        return false;
-    }
-
-    return _universe < c._universe;
-}
-
-void Collector::DuplicateLastPacket(std::list<PacketData*>& newPackets, int startSeq, int endSeq, int timegap)
-{
-    int frameTime = timegap / (endSeq - startSeq + 1);
-    int time = newPackets.back()->_frameTimeMS + frameTime;
-    for (int i = startSeq; i <= endSeq; i++)         {
-        newPackets.push_back(new PacketData(*newPackets.back(), i, time));
-        time += frameTime;
-    }
-}
-
-void Collector::FillInMissingFrames(int frameTime)
-{
-    std::list<PacketData*> newPackets;
-
-    int lastSeq = -1;
-
-    for (const auto& it : _packets)         {
-
-        if (lastSeq != -1) {
-            int timeGap = (int)(it->_timeStamp - newPackets.back()->_timeStamp).GetMilliseconds().ToLong();
-            if (frameTime == -1) {
-                if (it->_seq > lastSeq + 1) {
-                    DuplicateLastPacket(newPackets, lastSeq + 1, it->_seq - 1, timeGap);
-                }
-                else if (lastSeq == 255 && it->_seq > 0) {
-                    DuplicateLastPacket(newPackets, 0, it->_seq - 1, timeGap);
-                }
-                else if (it->_seq < lastSeq && !(it->_seq == 0 && lastSeq == 255)) {
-                    int timeGap1 = timeGap * (255 - (lastSeq + 1) + 1) / (255 - (lastSeq + 1) + 1 + it->_seq);
-                    int timeGap2 = timeGap * (it->_seq) / (255 - (lastSeq + 1) + 1 + it->_seq);
-                    DuplicateLastPacket(newPackets, lastSeq + 1, 255, timeGap1);
-                    DuplicateLastPacket(newPackets, 0, it->_seq - 1, timeGap2);
-                }
-            }
-            else                 {
-                // allow for 5ms variance
-                if (timeGap > frameTime + 5)                     {
-                    int missingFrames = (timeGap + frameTime / 2) / frameTime;
-                    // This wont generate sequence numbers that make sense but hey it still fills in the gap
-                    DuplicateLastPacket(newPackets, 0, missingFrames, missingFrames * frameTime);
-                }
-            }
-        }
-        newPackets.push_back(it);
-        lastSeq = it->_seq;
-    }
-
-    _packets = newPackets;
-}
-
 void xCaptureFrame::ValidateWindow()
 {
     if (Choice_Timing->GetStringSelection() == "Manual")
@@ -852,7 +561,7 @@ void xCaptureFrame::ValidateWindow()
         Button_StartStop->Enable(false);
     }
 
-    if (_capturedData.size() > 0 && !_capturing)
+    if (!_capturing && _assembler->HasCapture())
     {
         Button_Save->Enable(true);
         Button_Analyse->Enable(true);
@@ -894,7 +603,8 @@ void xCaptureFrame::CreateE131Listener()
     addr.AnyAddress();
     addr.Service(E131PORT);
     //create and bind to the address above
-    _e131Socket = new wxDatagramSocket(addr);
+    // blocking so it can be read from the receive thread
+    _e131Socket = new wxDatagramSocket(addr, wxSOCKET_BLOCK);
 
     if (_e131Socket->IsOk())
     {
@@ -921,12 +631,9 @@ void xCaptureFrame::CreateE131Listener()
             }
         }
 
-        //enable event handling
-        _e131Socket->SetEventHandler(*this, ID_E131SOCKET);
-        //Notify us about incomming data
-        _e131Socket->SetNotify(wxSOCKET_INPUT_FLAG);
-        //enable event handling
-        _e131Socket->Notify(true);
+        _e131Socket->SetTimeout(1);
+        _e131Socket->Notify(false);
+        _e131Receiver = new PacketReceiver("E131", _e131Socket, _assembler->GetE131Ring());
     }
     else
     {
@@ -947,7 +654,8 @@ void xCaptureFrame::CreateArtNETListener()
     addr.AnyAddress();
     addr.Service(ARTNETPORT);
     //create and bind to the address above
-    _artNETSocket = new wxDatagramSocket(addr);
+    // blocking so it can be read from the receive thread
+    _artNETSocket = new wxDatagramSocket(addr, wxSOCKET_BLOCK);
 
     if (_artNETSocket->IsOk())
     {
@@ -974,12 +682,9 @@ void xCaptureFrame::CreateArtNETListener()
             }
         }
 
-        //enable event handling
-        _artNETSocket->SetEventHandler(*this, ID_ARTNETSOCKET);
-        //Notify us about incomming data
-        _artNETSocket->SetNotify(wxSOCKET_INPUT_FLAG);
-        //enable event handling
-        _artNETSocket->Notify(true);
+        _artNETSocket->SetTimeout(1);
+        _artNETSocket->Notify(false);
+        _artNETReceiver = new PacketReceiver("ARTNet", _artNETSocket, _assembler->GetArtNETRing());
     }
     else
     {
@@ -1139,62 +844,61 @@ void xCaptureFrame::OnButton_StartStopClick(wxCommandEvent& event)
     if (_capturing)
     {
         _capturedDesc = "";
-        _capturedPackets = 0;
-        PurgeCollectedData();
+        _assembler->SetSettings(GetCaptureSettings());
+        _assembler->StartCapture();
         Button_StartStop->SetLabel("Stop");
-        _capturedDesc = "";
     }
     else
     {
+        _assembler->StopCapture();
         Button_StartStop->SetLabel("Start");
         UpdateCaptureDesc();
 
         logger_base.debug("Capture stopped.");
 
-        if (CheckBox_FillInMissingFrames->GetValue()) {
-            int frameTime = -1;
-            if (Choice_Timing->GetStringSelection() == "Manual") {
-                frameTime = SpinCtrl_ManualTime->GetValue();
-            }
-            else if (Choice_Timing->GetStringSelection() != "xCapture Detected (rounded to nearest 5ms)") {
-                frameTime = wxAtoi(Choice_Timing->GetStringSelection());
-            }
-            FillInMissingFrames(frameTime);
-        }
-
-        for (const auto& it : _capturedData)
+        CaptureSummary summary = _assembler->GetSummary();
+        for (const auto& it : summary._universes)
         {
-            logger_base.debug("    Protocol %s, Universe %d, Size %d, Frames %d",
-                it->_protocol == ID_E131SOCKET ? "E131" : "ArtNET",
-                it->_universe,
-                it->_packets.size() > 0 ? it->_packets.front()->_length : 0,
-                (int)it->_packets.size()
+            logger_base.debug("    Protocol %s, Universe %d, Size %d, Packets %ld",
+                it._protocol == ID_E131SOCKET ? "E131" : "ArtNET",
+                it._universe,
+                it._size,
+                it._packets
             );
         }
     }
     ValidateWindow();
 }
 
-bool cmp(const Collector *a, const Collector *b)
+wxString xCaptureFrame::GetCaptureStructure(const CaptureSummary& summary) const
 {
-    return *a < *b;
-}
+    wxString log = wxString::Format("Frame Time: %dms\n", summary._frameMS);
+    log += wxString::Format("Universes: %d\n", (int)summary._universes.size());
+    log += wxString::Format("Channels Per Frame: %ld\n", summary._channelsPerFrame);
+    log += wxString::Format("Frames: %d\n", summary._frames);
+    log += wxString::Format("Frames Aligned By: %s\n", summary._syncPackets ? "Sync Packets" : "Packet Timing");
+    if (summary._dropped > 0)
+    {
+        log += wxString::Format("WARNING: %llu packets were dropped because they could not be processed fast enough.\n", (unsigned long long)summary._dropped);
+    }
 
-inline long RoundTo4(long i) {
-    long remainder = i % 4;
-    if (remainder == 0) {
-        return i;
+    log += wxString::Format("Channel Structure Start:\n");
+    for (const auto& it : summary._universes)
+    {
+        log += wxString::Format("Channel %ld, Protocol %s, Universe %d, Size %d, Packets %ld, Missing %ld, StartFrameMS %dms, EndFrameMS %dms\n",
+            it._startChannel, it._protocol == ID_E131SOCKET ? "E131" : "ArtNET",
+            it._universe, it._size, it._packets, it._missing,
+            it._firstFrame * summary._frameMS, it._lastFrame * summary._frameMS);
     }
-    return i + 4 - remainder;
+    log += wxString::Format("Channel Structure End!\n");
+
+    return log;
 }
 
 void xCaptureFrame::OnButton_SaveClick(wxCommandEvent& event)
 {
     static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
 
-    // make sure the collectors are sorted
-    _capturedData.sort(cmp);
-
     wxFileDialog dlg(this, _("Save sequence"), "", "",
         "FSEQ (*.fseq)|*.fseq|ESEQ (*.eseq)|*.eseq", wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
     if (dlg.ShowModal() == wxID_OK)
@@ -1202,39 +906,16 @@ void xCaptureFrame::OnButton_SaveClick(wxCommandEvent& event)
         wxFileName fn(dlg.GetDirectory() + "/" + dlg.GetFilename());
         wxString log = "Saving to "+ fn.GetExt().Upper() + " file " + fn.GetFullName() + "\n";
 
-        int frameMS = GuessFrameMS();
-        log += wxString::Format("Frame Time: %dms\n", frameMS);
-
-        log += wxString::Format("Universes: %d\n", (int)_capturedData.size());
-
-        long channelsPerFrame = RoundTo4(GetChannelsPerFrame());
-        log += wxString::Format("Channels Per Frame: %ld\n", channelsPerFrame);
-
-        wxDateTime startTime = GetStartTime();
-
-        int frames = GetFrames();
-        log += wxString::Format("Frames: %d\n", frames);
-
-        log += wxString::Format("Channel Structure Start:\n");
-        for (const auto& it : _capturedData)
-        {
-            it->CalculateFrames(startTime, frameMS);
-
-            log += wxString::Format("Channel %ld, Protocol %s, Universe %d, Size %d, Frames %d, StartFrameMS %dms, EndFrameMS %dms\n",
-                it->_startChannel, it->_protocol == ID_E131SOCKET ? "E131" : "ArtNET",
-                it->_universe, it->_packets.size() > 0 ? it->_packets.front()->_length : 0,
-                (int)it->_packets.size(), it->_packets.size() > 0 ? it->_packets.front()->_frameTimeMS : -1,
-                it->_packets.size() > 0 ? it->_packets.back()->_frameTimeMS : -1);
-        }
-        log += wxString::Format("Channel Structure End!\n");
+        CaptureSummary summary = _assembler->GetSummary();
+        log += GetCaptureStructure(summary);
 
         if (fn.GetExt().Lower() == "fseq")
         {
-            SaveFSEQ(fn.GetFullPath(), frameMS, channelsPerFrame, frames ,log);
+            SaveFSEQ(fn.GetFullPath(), summary, log);
         }
         else
         {
-            SaveESEQ(fn.GetFullPath(), frameMS, channelsPerFrame, frames, log);
+            SaveESEQ(fn.GetFullPath(), summary, log);
         }
 
         logger_base.debug(log);
@@ -1244,38 +925,6 @@ void xCaptureFrame::OnButton_SaveClick(wxCommandEvent& event)
     }
 }
 
-long xCaptureFrame::GetChannelsPerFrame()
-{
-    long size = 0;
-    for (const auto& it : _capturedData)
-    {
-        it->_startChannel = size + 1;
-        if (it->_packets.size() > 0)
-        {
-            size += it->_packets.front()->_length;
-        }
-    }
-
-    return size;
-}
-
-wxDateTime xCaptureFrame::GetStartTime()
-{
-    wxDateTime startTime = wxDateTime::Now();
-    for (const auto& it : _capturedData)
-    {
-        if (it->_packets.size() > 0)
-        {
-            if (it->_packets.front()->_timeStamp < startTime)
-            {
-                startTime = it->_packets.front()->_timeStamp;
-            }
-        }
-    }
-
-    return startTime;
-}
-
 void xCaptureFrame::OnCheckBox_TriggerOnChannelClick(wxCommandEvent& event)
 {
     ValidateWindow();
@@ -1317,8 +966,7 @@ void xCaptureFrame::OnButton_AllClick(wxCommandEvent& event)
 void xCaptureFrame::OnButton_ClearClick(wxCommandEvent& event)
 {
     _capturedDesc = "";
-    _capturedPackets = 0;
-    PurgeCollectedData();
+    _assembler->Clear();
     ValidateWindow();
 }
 
@@ -1342,62 +990,6 @@ void xCaptureFrame::OnCheckBox_ArtNETClick(wxCommandEvent& event)
     ValidateWindow();
 }
 
-void xCaptureFrame::OnE131SocketEvent(wxSocketEvent& event)
-{
-    static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
-
-    wxIPV4address addr;
-    addr.Service(E131PORT);
-    wxByte buf[126+512];
-    switch (event.GetSocketEvent())
-    {
-    case wxSOCKET_INPUT:
-    {
-        _e131Socket->Notify(false);
-        size_t n = _e131Socket->RecvFrom(addr, buf, sizeof(buf)).LastCount();
-        if (!n) {
-            logger_base.error("ERROR: failed to receive E131 data");
-            return;
-        }
-        //logger_base.debug("E131 packet received.");
-        StashPacket(ID_E131SOCKET, buf, n);
-        _e131Socket->Notify(true);
-    }
-        break;
-    default:
-        logger_base.warn("OnE131SocketEvent: Unexpected event !");
-        break;
-    }
-}
-
-void xCaptureFrame::OnArtNETSocketEvent(wxSocketEvent & event)
-{
-    static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
-
-    wxIPV4address addr;
-    addr.Service(ARTNETPORT);
-    wxByte buf[18 + 512];
-    switch (event.GetSocketEvent())
-    {
-    case wxSOCKET_INPUT:
-    {
-        _artNETSocket->Notify(false);
-        size_t n = _artNETSocket->RecvFrom(addr, buf, sizeof(buf)).LastCount();
-        if (!n) {
-            logger_base.error("ERROR: failed to receive ArtNET data");
-            return;
-        }
-        //logger_base.debug("ArtNet packet received.");
-        StashPacket(ID_ARTNETSOCKET, buf, n);
-        _artNETSocket->Notify(true);
-    }
-        break;
-    default:
-        logger_base.warn("OnArtNETSocketEvent: Unexpected event !");
-        break;
-    }
-}
-
 void xCaptureFrame::OnButton_AddClick(wxCommandEvent& event)
 {
     UniverseEntryDialog dlg(this, -1, -1);
@@ -1432,111 +1024,63 @@ void xCaptureFrame::OnButton_DeleteClick(wxCommandEvent& event)
 
 void xCaptureFrame::OnUITimerTrigger(wxTimerEvent& event)
 {
-    StatusBar1->SetStatusText(wxString::Format("Universes: %d Total Packets: %ld %s", (int)_capturedData.size(), _capturedPackets, _capturedDesc));
+    // the trigger channel can start and stop the capture
+    if (_assembler->IsCapturing() != _capturing)
+    {
+        _capturing = _assembler->IsCapturing();
+        if (_capturing)
+        {
+            _capturedDesc = "";
+        }
+        else
+        {
+            UpdateCaptureDesc();
+        }
+        ValidateWindow();
+    }
+
+    // pick up any changes to the trigger or universes
+    _assembler->SetSettings(GetCaptureSettings());
+
+    CaptureSummary summary = _assembler->GetSummary();
+    StatusBar1->SetStatusText(wxString::Format("Universes: %d Total Packets: %ld %s", (int)summary._universes.size(), summary._packets, _capturedDesc));
 }
 
-void xCaptureFrame::SaveFSEQ(wxString file, int frameMS, long channelsPerFrame, int frames, wxString& log)
+int xCaptureFrame::GetOverrideFrameMS()
 {
-    static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
-
-    wxUint8 vMinor = 0;
-    wxUint8 vMajor = 1;
-    wxUint16 fixedHeaderLength = 28;
-    wxUint32 stepSize = channelsPerFrame;
-    wxUint16 stepTime = frameMS;
-    wxUint16 numUniverses = 0;
-    wxUint16 universeSize = 0;
-    wxUint8 gamma = 1;
-    wxUint8 colorEncoding = 2;
-
-    int overrideFrameMS = 0;
     if (Choice_Timing->GetStringSelection() == "Manual")
     {
-        overrideFrameMS = SpinCtrl_ManualTime->GetValue();
-    }
-    else
-    {
-        overrideFrameMS = wxAtoi(Choice_Timing->GetStringSelection());
+        return SpinCtrl_ManualTime->GetValue();
     }
+    return wxAtoi(Choice_Timing->GetStringSelection());
+}
 
-    if (overrideFrameMS != 0)
+void xCaptureFrame::SaveFSEQ(wxString file, const CaptureSummary& summary, wxString& log)
+{
+    static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    // the frames were written to an fseq file as they were captured so it just needs to be copied
+    if (summary._file == "" || !wxCopyFile(summary._file, file, true))
     {
-        logger_base.debug("Frame time overriden to %s->%d. It was %d.", (const char*)Choice_Timing->GetStringSelection().c_str(), overrideFrameMS, stepTime);
-        log += "Frame time override to " + wxString::Format("%d", overrideFrameMS) + "ms";
-        stepTime = overrideFrameMS;
+        log += "ERROR: Unable to create file.\n";
+        return;
     }
 
-    wxFile f;
-
-    if (f.Create(file, true))
+    int overrideFrameMS = GetOverrideFrameMS();
+    if (overrideFrameMS != 0 && overrideFrameMS != summary._frameMS)
     {
-        int bufsize = stepSize < 1024 ? 1024 : stepSize;
-        wxUint8* buf = (wxUint8 *)calloc(sizeof(wxUint8), bufsize);
-        memset(buf, 0x00, bufsize);
-
-        buf[0] = 'P';
-        buf[1] = 'S';
-        buf[2] = 'E';
-        buf[3] = 'Q';
-
-        buf[6] = vMinor;
-        buf[7] = vMajor;
-        // Fixed header length
-        buf[8] = (wxUint8)(fixedHeaderLength % 256);
-        buf[9] = (wxUint8)(fixedHeaderLength / 256);
-        // Step Size
-        buf[10] = (wxUint8)(stepSize & 0xFF);
-        buf[11] = (wxUint8)((stepSize >> 8) & 0xFF);
-        buf[12] = (wxUint8)((stepSize >> 16) & 0xFF);
-        buf[13] = (wxUint8)((stepSize >> 24) & 0xFF);
-        // Number of Steps
-        buf[14] = (wxUint8)(frames & 0xFF);
-        buf[15] = (wxUint8)((frames >> 8) & 0xFF);
-        buf[16] = (wxUint8)((frames >> 16) & 0xFF);
-        buf[17] = (wxUint8)((frames >> 24) & 0xFF);
-        // Step time in ms
-        buf[18] = (wxUint8)(stepTime & 0xFF);
-        buf[19] = (wxUint8)((stepTime >> 8) & 0xFF);
-        // universe count
-        buf[20] = (wxUint8)(numUniverses & 0xFF);
-        buf[21] = (wxUint8)((numUniverses >> 8) & 0xFF);
-        // universe Size
-        buf[22] = (wxUint8)(universeSize & 0xFF);
-        buf[23] = (wxUint8)((universeSize >> 8) & 0xFF);
-        // universe Size
-        buf[24] = gamma;
-        // universe Size
-        buf[25] = colorEncoding;
-        buf[26] = 0;
-        buf[27] = 0;
-
-        buf[4] = (wxUint8)(fixedHeaderLength % 256);
-        buf[5] = (wxUint8)(fixedHeaderLength / 256);
-        f.Write(buf, fixedHeaderLength);
+        logger_base.debug("Frame time overriden to %s->%d. It was %d.", (const char*)Choice_Timing->GetStringSelection().c_str(), overrideFrameMS, summary._frameMS);
+        log += "Frame time override to " + wxString::Format("%d", overrideFrameMS) + "ms";
 
-        for (int i = 0; i < frames; i++)
+        wxFile f;
+        if (f.Open(file, wxFile::read_write))
         {
-            for (const auto& it : _capturedData)
-            {
-                PacketData* p = it->GetPacket(i * frameMS);
-                if (p != nullptr)
-                {
-                    memcpy(buf + it->_startChannel - 1, p->_pdata, p->_length);
-                }
-                else
-                {
-                    logger_base.debug("   No data found uni %d ch %ld ", it->_universe, it->_startChannel);
-                }
-            }
-            f.Write(buf, stepSize);
+            // Step time in ms
+            wxUint8 stepTime = (wxUint8)(overrideFrameMS & 0xFF);
+            f.Seek(18);
+            f.Write(&stepTime, 1);
+            f.Close();
         }
-
-        f.Close();
-        free(buf);
-    }
-    else
-    {
-        log += "ERROR: Unable to create file.\n";
     }
 }
 
@@ -1556,20 +1100,19 @@ void xCaptureFrame::RestartInterfaces()
 
 void xCaptureFrame::UpdateCaptureDesc()
 {
-    if (_capturedData.size() == 0)
+    CaptureSummary summary = _assembler->GetSummary();
+    if (summary._frames == 0)
     {
         _capturedDesc = "";
     }
     else
     {
-        int frameMS = GuessFrameMS();
-        int frames = GetFrames();
         _capturedDesc = wxString::Format("Frame Interval %dms Frames %d",
-            frameMS, frames).ToStdString();
+            summary._frameMS, summary._frames).ToStdString();
     }
 }
 
-void xCaptureFrame::SaveESEQ(wxString file, int frameMS, long channelsPerFrame, int frames, wxString& log)
+void xCaptureFrame::SaveESEQ(wxString file, const CaptureSummary& summary, wxString& log)
 {
     static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
 
@@ -1579,26 +1122,32 @@ void xCaptureFrame::SaveESEQ(wxString file, int frameMS, long channelsPerFrame,
         startAddr = 1;
     }
 
-    int overrideFrameMS = 0;
-    if (Choice_Timing->GetStringSelection() == "Manual")
+    int overrideFrameMS = GetOverrideFrameMS();
+    if (overrideFrameMS != 0)
     {
-        overrideFrameMS = SpinCtrl_ManualTime->GetValue();
+        logger_base.debug("Frame time overriden to %s->%d. It was detected as %d", (const char*)Choice_Timing->GetStringSelection().c_str(), overrideFrameMS, summary._frameMS);
+        log += "Frame time override to " + wxString::Format("%d", overrideFrameMS) + "ms";
     }
-    else
+
+    // the captured frames are read back one at a time from the fseq written while capturing
+    wxFile in;
+    if (summary._file == "" || !in.Open(summary._file))
     {
-        overrideFrameMS = wxAtoi(Choice_Timing->GetStringSelection());
+        log += "ERROR: Unable to read captured data.\n";
+        return;
     }
 
-    if (overrideFrameMS != 0)
+    wxUint8 header[FSEQSTREAM_HEADERSIZE];
+    if (in.Read(header, sizeof(header)) != sizeof(header))
     {
-        logger_base.debug("Frame time overriden to %s->%d. It was detected as %d", (const char*)Choice_Timing->GetStringSelection().c_str(), overrideFrameMS, frameMS);
-        log += "Frame time override to " + wxString::Format("%d", overrideFrameMS) + "ms";
-        frameMS = overrideFrameMS;
+        log += "ERROR: Unable to read captured data.\n";
+        return;
     }
+    in.Seek((int)header[4] + ((int)header[5] << 8));
 
     wxUint16 fixedHeaderLength = 20;
-    wxUint32 modelSize = channelsPerFrame;
-    wxUint32 frameSize = RoundTo4(channelsPerFrame);
+    wxUint32 modelSize = summary._channelsPerFrame;
+    wxUint32 frameSize = summary._channelsPerFrame;
     wxFile f;
 
     if (f.Create(file, true))
@@ -1633,21 +1182,13 @@ void xCaptureFrame::SaveESEQ(wxString file, int frameMS, long channelsPerFrame,
         buf[19] = (wxUint8)((modelSize >> 24) & 0xFF);
         f.Write(buf, fixedHeaderLength);
 
-        for (int i = 0; i < frames; i++)
+        for (int i = 0; i < summary._frames; i++)
         {
-            //logger_base.debug("Writing frame %d %dms", i + 1, i * frameMS);
-            for (const auto& it : _capturedData)
+            if (in.Read(buf, frameSize) != (ssize_t)frameSize)
             {
-                PacketData* p = it->GetPacket(i * frameMS);
-                if (p != nullptr)
-                {
-                    //logger_base.debug("   Adding data uni %d ch %ld time %dms len %d seq %d time %d.%03d", (*it)->_universe, (*it)->_startChannel, p->_frameTimeMS, p->_length, p->_seq, p->_timeStamp.GetSecond(), p->_timeStamp.GetMillisecond());
-                    memcpy(buf + it->_startChannel - 1, p->_pdata, p->_length);
-                }
-                else
-                {
-                    logger_base.debug("   No data found uni %d ch %ld ", it->_universe, it->_startChannel);
-                }
+                logger_base.warn("   Captured data ended early at frame %d.", i);
+                log += wxString::Format("ERROR: Captured data ended early at frame %d.\n", i);
+                break;
             }
             f.Write(buf, frameSize);
         }
@@ -1661,43 +1202,9 @@ void xCaptureFrame::SaveESEQ(wxString file, int frameMS, long channelsPerFrame,
     }
 }
 
-int xCaptureFrame::GetFrames()
-{
-    int frames = 0;
-    for (const auto& it : _capturedData)
-    {
-        frames = std::max(frames, (int)it->_packets.size());
-    }
-    return frames;
-}
-
 void xCaptureFrame::OnButton_AnalyseClick(wxCommandEvent& event)
 {
-    int frameMS = GuessFrameMS();
-    wxString log = wxString::Format("Frame Time: %dms\n", frameMS);
-
-    log += wxString::Format("Universes: %d\n", (int)_capturedData.size());
-
-    long channelsPerFrame = RoundTo4(GetChannelsPerFrame());
-    log += wxString::Format("Channels Per Frame: %ld\n", channelsPerFrame);
-
-    wxDateTime startTime = GetStartTime();
-
-    int frames = GetFrames();
-    log += wxString::Format("Frames: %d\n", frames);
-
-    log += wxString::Format("Channel Structure Start:\n");
-    for (const auto& it : _capturedData)
-    {
-        it->CalculateFrames(startTime, frameMS);
-
-        log += wxString::Format("Channel %ld, Protocol %s, Universe %d, Size %d, Frames %d, StartFrameMS %dms, EndFrameMS %dms\n",
-            it->_startChannel, it->_protocol == ID_E131SOCKET ? "E131" : "ArtNET",
-            it->_universe, it->_packets.size() > 0 ? it->_packets.front()->_length : 0,
-            (int)it->_packets.size(), it->_packets.size() > 0 ? it->_packets.front()->_frameTimeMS : -1,
-            it->_packets.size() > 0 ? it->_packets.back()->_frameTimeMS : -1);
-    }
-    log += wxString::Format("Channel Structure End!\n");
+    wxString log = GetCaptureStructure(_assembler->GetSummary());
 
     ResultDialog dlgLog(this, log);
     dlgLog.ShowModal();
@@ -40,49 +40,22 @@
 #include <list>
 #include <wx/socket.h>
 
+#include "FrameAssembler.h"
+
 class wxDebugReportCompress;
 class wxDatagramSocket;
-
-class PacketData
-{
-public:
-    wxDateTime _timeStamp;
-    int _seq;
-    int _length;
-    wxByte* _pdata;
-    int _frameTimeMS;
-    virtual ~PacketData() { if (_pdata != nullptr) free(_pdata); }
-    PacketData(long type, wxByte* packet, int len);
-    PacketData(PacketData& pd, int seq, int time);
-};
-
-class Collector
-{
-    void DuplicateLastPacket(std::list<PacketData*>& newPackets, int startSeq, int endSeq, int timegap);
-
-public:
-    int _universe;
-    long _protocol;
-    long _startChannel; // 1 based start channel
-    std::list<PacketData*> _packets;
-    virtual ~Collector();
-    Collector(long type, int universe) { _startChannel = -1; _universe = universe; _protocol = type; }
-    void AddPacket(long type, wxByte* packet, int len) { _packets.push_back(new PacketData(type, packet, len)); }
-    void CalculateFrames(wxDateTime startTime, int frameMS);
-    PacketData* GetPacket(long ms);
-    bool operator<(const Collector& c) const;
-    void FillInMissingFrames(int frameTime);
-};
+class PacketReceiver;
 
 class xCaptureFrame : public wxFrame
 {
     void ValidateWindow();
 
-    std::list<Collector*> _capturedData;
+    FrameAssembler* _assembler;
     wxDatagramSocket* _e131Socket;
     wxDatagramSocket* _artNETSocket;
+    PacketReceiver* _e131Receiver;
+    PacketReceiver* _artNETReceiver;
     bool _capturing;
-    long _capturedPackets;
     std::string _capturedDesc;
     wxString _localIP;
     wxString _defaultIP;
@@ -92,19 +65,14 @@ class xCaptureFrame : public wxFrame
     void CreateE131Listener();
     void CreateArtNETListener();
     void AddUniverseRange(int low, int high);
-    void PurgeCollectedData();
-    void StashPacket(long type, wxByte* packet, int len);
-    bool IsUniverseToBeCaptured(int universe, bool ignoreall = false);
-    int GuessFrameMS();
-    long GetChannelsPerFrame();
-    wxDateTime GetStartTime();
-    void SaveFSEQ(wxString file, int frameMS, long channelsPerFrame, int frames, wxString& log);
-    void SaveESEQ(wxString file, int frameMS, long channelsPerFrame, int frames, wxString& log);
-    int GetFrames();
+    CaptureSettings GetCaptureSettings();
+    wxString GetCaptureStructure(const CaptureSummary& summary) const;
+    int GetOverrideFrameMS();
+    void SaveFSEQ(wxString file, const CaptureSummary& summary, wxString& log);
+    void SaveESEQ(wxString file, const CaptureSummary& summary, wxString& log);
     void UpdateCaptureDesc();
     void LoadState();
     void SaveState();
-    void FillInMissingFrames(int frameTime);
 
 public:
 
@@ -214,9 +182,6 @@ private:
         //*)
 
         DECLARE_EVENT_TABLE()
-
-        void OnE131SocketEvent(wxSocketEvent& event);
-        void OnArtNETSocketEvent(wxSocketEvent& event);
 };
 
 #endif // xCAPTUREMAIN_H
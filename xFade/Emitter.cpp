@@ -11,6 +11,9 @@
 
 #include <log4cpp/Category.hh>
 
+#include <chrono>
+#include <thread>
+
 class EmitterThread : public wxThread
 {
     Emitter* _emitter;
@@ -98,10 +101,17 @@ public:
         PacketData sendData;
         auto universes = _emitter->GetUniverses();
 
+        // Frames are scheduled against absolute deadlines so time spent sending, and any oversleep,
+        // is taken from the next wait rather than accumulating as drift. The thread sleeps until
+        // just before the deadline and then yields until it arrives as the OS sleep granularity
+        // on some platforms is far worse than a frame can tolerate.
+        const auto spinWindow = std::chrono::microseconds(2000);
+        auto deadline = std::chrono::steady_clock::now();
+
         while (!_stop)
         {
-            auto start = wxDateTime::UNow();
-            int diffMS = 0;
+            auto now = std::chrono::steady_clock::now();
+            _emitter->GetJitter().Record((int)std::chrono::duration_cast<std::chrono::microseconds>(now - deadline).count());
 
             int lb = _emitter->GetLeftBrightness();
             int rb = _emitter->GetRightBrightness();
@@ -119,13 +129,29 @@ public:
                 _emitter->IncrementSent();
             }
 
-            auto diff = wxDateTime::UNow() - start;
-            diffMS = _emitter->GetFrameMS() - diff.GetMilliseconds().ToLong();
+            auto frame = std::chrono::milliseconds(_emitter->GetFrameMS());
+            deadline += frame;
+
+            now = std::chrono::steady_clock::now();
+            if (now > deadline + frame)
+            {
+                // we have fallen more than a frame behind ... dont try to catch up with a burst of frames
+                _emitter->GetJitter().RecordMissed();
+                deadline = now;
+            }
 
-            if (diffMS > 0)
-                wxMilliSleep(diffMS);
+            if (deadline - now > spinWindow)
+            {
+                std::this_thread::sleep_until(deadline - spinWindow);
+            }
+            while (!_stop && std::chrono::steady_clock::now() < deadline)
+            {
+                std::this_thread::yield();
+            }
         }
 
+        logger_base.debug("Emitter jitter %s", (const char*)_emitter->GetJitter().AsString().c_str());
+
         if (e131SocketSend != nullptr)
         {
             e131SocketSend->Close();
@@ -179,4 +205,58 @@ void Emitter::Stop()
         delete _emitterThread;
         _emitterThread = nullptr;
     }
-}
\ No newline at end of file
+}
+const int JitterHistogram::__bucketLimitsUS[JITTER_BUCKETS - 1] = { 500, 1000, 2000, 5000, 10000, 20000 };
+
+void JitterHistogram::Reset()
+{
+    for (auto& it : _buckets)
+    {
+        it = 0;
+    }
+    _frames = 0;
+    _missed = 0;
+    _maxUS = 0;
+}
+
+void JitterHistogram::Record(int lateUS)
+{
+    if (lateUS < 0) lateUS = 0;
+
+    int b = 0;
+    while (b < JITTER_BUCKETS - 1 && lateUS >= __bucketLimitsUS[b])
+    {
+        b++;
+    }
+    _buckets[b]++;
+    _frames++;
+
+    int max = _maxUS;
+    while (lateUS > max && !_maxUS.compare_exchange_weak(max, lateUS)) {}
+}
+
+std::string JitterHistogram::GetSummary() const
+{
+    uint32_t frames = _frames;
+    if (frames == 0) return "";
+
+    uint32_t onTime = _buckets[0] + _buckets[1];
+    return wxString::Format("Jitter %.1f%% <1ms, Max %.1fms", 100.0 * onTime / frames, _maxUS / 1000.0).ToStdString();
+}
+
+std::string JitterHistogram::AsString() const
+{
+    std::string res = wxString::Format("Frames %u, Missed %u, Max %.1fms :", (uint32_t)_frames, (uint32_t)_missed, _maxUS / 1000.0).ToStdString();
+    for (int i = 0; i < JITTER_BUCKETS; i++)
+    {
+        if (i < JITTER_BUCKETS - 1)
+        {
+            res += wxString::Format(" <%gms %u", __bucketLimitsUS[i] / 1000.0, (uint32_t)_buckets[i]).ToStdString();
+        }
+        else
+        {
+            res += wxString::Format(" >=%gms %u", __bucketLimitsUS[i - 1] / 1000.0, (uint32_t)_buckets[i]).ToStdString();
+        }
+    }
+    return res;
+}
@@ -14,9 +14,34 @@ class ListenerManager;
 class Settings;
 class UniverseData;
 
+// How late each frame was sent compared to when it should have been
+#define JITTER_BUCKETS 7
+class JitterHistogram
+{
+    static const int __bucketLimitsUS[JITTER_BUCKETS - 1];
+
+    std::atomic<uint32_t> _buckets[JITTER_BUCKETS];
+    std::atomic<uint32_t> _frames;
+    std::atomic<uint32_t> _missed; // frames we were so late for we gave up on the schedule
+    std::atomic<int> _maxUS;
+
+public:
+
+    JitterHistogram() { Reset(); }
+    void Reset();
+    void Record(int lateUS);
+    void RecordMissed() { _missed++; }
+    uint32_t GetFrames() const { return _frames; }
+    uint32_t GetMissed() const { return _missed; }
+    int GetMaxUS() const { return _maxUS; }
+    std::string GetSummary() const;
+    std::string AsString() const;
+};
+
 class Emitter
 {
     std::atomic<uint32_t> _sent; // = 0;
+    JitterHistogram _jitter;
     EmitterThread* _emitterThread = nullptr;
     std::map<int, UniverseData*> _universes;
     std::atomic<int> _frameMS; // = 50;
@@ -45,7 +70,8 @@ class Emitter
     int GetRightBrightness() const { return _rightBrightness; }
     uint32_t GetSent() const { return _sent; }
     void IncrementSent() { _sent++; }
-    void ZeroSent() { _sent = 0; }
+    void ZeroSent() { _sent = 0; _jitter.Reset(); }
+    JitterHistogram& GetJitter() { return _jitter; }
     Settings* GetSettings() const { return _settings; }
 };
 
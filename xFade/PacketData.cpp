@@ -1,4 +1,5 @@
 #include "PacketData.h"
+#include "../xSchedule/BlendKernels.h"
 
 #include <wx/socket.h>
 
@@ -78,7 +79,7 @@ bool PacketData::Update(long type, uint8_t packet[], int len)
         if (packet[11] != 0x31) return false;
         if (packet[12] != 0x37) return false;
 
-        _universe = ((int)_data[113] << 8) + (int)_data[114];
+        _universe = ((int)packet[113] << 8) + (int)packet[114];
         _type = type;
         _length = len;
         wxASSERT(_length >= E131_PACKET_HEADERLEN && _length <= E131_PACKET_HEADERLEN + 512);
@@ -97,7 +98,7 @@ bool PacketData::Update(long type, uint8_t packet[], int len)
         if (packet[6] != 't') return false;
         if (packet[9] != 0x50) return true; // pretend success as otherwise I will log excessively
 
-        _universe = ((int)_data[15] << 8) + (int)_data[14];
+        _universe = ((int)packet[15] << 8) + (int)packet[14];
         _type = type;
         _length = len;
         wxASSERT(_length >= ARTNET_PACKET_HEADERLEN && _length <= ARTNET_PACKET_HEADERLEN + 512);
@@ -289,36 +290,11 @@ void PacketData::InitialiseLength(long type, int length, int universe)
     }
 }
 
-void PacketData::ApplyBrightness(int brightness, const std::list<int>& excludeChannels)
+void PacketData::ApplyBrightness(int brightness, const ChannelMask& excludeChannels)
 {
     if (brightness == 100) return;
 
-    if (excludeChannels.size() == 0)
-    {
-        if (brightness == 0)
-        {
-            memset(GetDataPtr(), 0x00, GetDataLength());
-        }
-        else
-        {
-            uint8_t* p = GetDataPtr();
-            for (int i = 0; i < GetDataLength(); i++)
-            {
-                *(p + i) = (uint8_t)((int)*(p + i) * brightness / 100);
-            }
-        }
-    }
-    else
-    {
-        uint8_t* p = GetDataPtr();
-        for (int i = 0; i < GetDataLength(); i++)
-        {
-            if (std::find(excludeChannels.begin(), excludeChannels.end(), i + 1) == excludeChannels.end())
-            {
-                *(p + i) = (uint8_t)((int)*(p + i) * brightness / 100);
-            }
-        }
-    }
+    BlendKernels::Scale(GetDataPtr(), GetDataLength(), brightness, &excludeChannels);
 }
 
 void PacketData::CopyFrom(PacketData* source, long targetType)
@@ -330,9 +306,9 @@ void PacketData::CopyFrom(PacketData* source, long targetType)
 
     if (source->_type == targetType)
     {
-        memcpy(_data, source->_data, sizeof(_data));
         _length = source->_length;
         wxASSERT(_length >= 0 && _length <= sizeof(_data));
+        memcpy(_data, source->_data, _length);
 
         if (_type == E131PORT)
         {
@@ -355,7 +331,7 @@ void PacketData::CopyFrom(PacketData* source, long targetType)
             // converting from ARTNET
             _length = E131_PACKET_HEADERLEN + source->GetDataLength();
             InitialiseE131Header();
-            memcpy(source->GetDataPtr(), GetDataPtr(), GetDataLength());
+            memcpy(GetDataPtr(), source->GetDataPtr(), GetDataLength());
             memset(&_data[44], 0x00, 64);
             strncpy((char*)&_data[44], _tag.c_str(), 64);
             _data[111] = GetNextSequenceNum(_universe);
@@ -365,7 +341,7 @@ void PacketData::CopyFrom(PacketData* source, long targetType)
             // converting from E131
             _length = ARTNET_PACKET_HEADERLEN + source->GetDataLength();
             InitialiseArtNETHeader();
-            memcpy(source->GetDataPtr(), GetDataPtr(), GetDataLength());
+            memcpy(GetDataPtr(), source->GetDataPtr(), GetDataLength());
             _data[12] = GetNextSequenceNum(_universe);
         }
     }
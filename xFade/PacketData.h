@@ -14,6 +14,7 @@
 #define E131_PACKET_LEN (E131_PACKET_HEADERLEN + 512)
 
 class wxDatagramSocket;
+class ChannelMask;
 
 class PacketData
 {
@@ -41,7 +42,7 @@ public:
     void InitialiseE131Header();
     int GetSequenceNum() const;
     void InitialiseLength(long type, int length, int universe);
-    void ApplyBrightness(int brightness, const std::list<int>& excludeChannels);
+    void ApplyBrightness(int brightness, const ChannelMask& excludeChannels);
 };
 
 #endif 
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Hands the latest value from one writer thread to one reader thread without locks.
+//
+// The writer fills its back buffer and publishes it. The reader always gets the most
+// recently published buffer. Neither side ever waits for the other or copies the value:
+// publishing and taking the latest are a single atomic exchange of buffer indexes. Three
+// buffers are used so the writer always has a free buffer even while the reader is still
+// working on the previous one ... values published between two reads are simply replaced.
+template<typename T>
+class SnapshotBuffer
+{
+    static const uint8_t FRESH = 0x04;
+
+    T _buffers[3];
+    std::atomic<uint8_t> _middle; // index of the buffer in the middle plus FRESH if it has not been read
+    uint8_t _back = 1;            // only touched by the writer
+    uint8_t _front = 0;           // only touched by the reader
+
+public:
+
+    SnapshotBuffer() : _middle(2) {}
+
+    // writer ... the buffer to fill
+    T& GetBack() { return _buffers[_back]; }
+
+    // writer ... makes the back buffer the latest value and takes a new back buffer
+    void Publish()
+    {
+        _back = _middle.exchange(_back | FRESH, std::memory_order_acq_rel) & 0x03;
+    }
+
+    // reader ... the latest published value. Only the reader may change it
+    T& GetLatest()
+    {
+        if ((_middle.load(std::memory_order_relaxed) & FRESH) != 0)
+        {
+            _front = _middle.exchange(_front, std::memory_order_acq_rel) & 0x03;
+        }
+        return _buffers[_front];
+    }
+};
@@ -3,11 +3,15 @@
 std::string UniverseData::__leftTag = "";
 std::string UniverseData::__rightTag = "";
 
-UniverseData::UniverseData(int universe, const std::string& targetIP, const std::string& targetProtocol, std::list<int> excludedChannels) :
+UniverseData::UniverseData(int universe, const std::string& targetIP, const std::string& targetProtocol, const std::list<int>& excludedChannels) :
     _universe(universe),
+    _leftSequenceNum(-1),
+    _rightSequenceNum(-1),
     _targetIP(targetIP),
-    _excludedChannels(excludedChannels)
+    _excludedChannels(ChannelMask::FromOneBasedList(excludedChannels, 512))
 {
+    memset(_blendBuffer, 0x00, sizeof(_blendBuffer));
+
     if (targetProtocol == "As per input")
     {
         _targetProtocol = 0;
@@ -26,89 +30,84 @@ UniverseData::UniverseData(int universe, const std::string& targetIP, const std:
     }
 }
 
-int UniverseData::GetLeftSequenceNum()
+bool UniverseData::Update(SnapshotBuffer<PacketData>& side, std::atomic_flag& writing, std::atomic<int>& sequenceNum, int type, uint8_t* buffer, int size)
 {
-    std::unique_lock<std::mutex> lock(_lock);
-    return _left.GetSequenceNum();
-}
+    // if the same input is arriving on both protocols just keep whichever gets here first
+    if (writing.test_and_set(std::memory_order_acquire)) return true;
 
-int UniverseData::GetRightSequenceNum()
-{
-    std::unique_lock<std::mutex> lock(_lock);
-    return _right.GetSequenceNum();
+    PacketData& pd = side.GetBack();
+    pd._length = 0;
+    bool res = pd.Update(type, buffer, size);
+
+    // only publish if the packet was data ... otherwise the back buffer holds an old packet
+    if (res && pd._length != 0)
+    {
+        sequenceNum = pd.GetSequenceNum();
+        side.Publish();
+    }
+
+    writing.clear(std::memory_order_release);
+    return res;
 }
 
 bool UniverseData::UpdateLeft(int type, uint8_t* buffer, int size)
 {
-    std::unique_lock<std::mutex> lock(_lock);
-    return _left.Update(type, buffer, size);
+    return Update(_left, _leftWriting, _leftSequenceNum, type, buffer, size);
 }
 
 bool UniverseData::UpdateRight(int type, uint8_t* buffer, int size)
 {
-    std::unique_lock<std::mutex> lock(_lock);
-    return _right.Update(type, buffer, size);
+    return Update(_right, _rightWriting, _rightSequenceNum, type, buffer, size);
 }
 
 PacketData* UniverseData::GetOutput(PacketData* output, int leftBrightness, int rightBrightness, float pos)
 {
-    std::unique_lock<std::mutex> lock(_lock);
+    PacketData& left = _left.GetLatest();
+    PacketData& right = _right.GetLatest();
 
-    if (_left._length == 0 && _right._length > 0)
+    if (left._length == 0 && right._length > 0)
     {
-        _left.InitialiseLength(_right._type, _right._length, _universe);
+        left.InitialiseLength(right._type, right._length, _universe);
     }
-    else if (_right._length == 0 && _left._length > 0)
+    else if (right._length == 0 && left._length > 0)
     {
-        _right.InitialiseLength(_left._type, _left._length, _universe);
+        right.InitialiseLength(left._type, left._length, _universe);
     }
 
     if (pos == 0.0)
     {
-        PrepareData(output, &_left, _targetProtocol);
+        PrepareData(output, &left, _targetProtocol);
         output->ApplyBrightness(leftBrightness, _excludedChannels);
     }
     else if (pos == 1.0)
     {
-        PrepareData(output, &_right, _targetProtocol);
+        PrepareData(output, &right, _targetProtocol);
         output->ApplyBrightness(rightBrightness, _excludedChannels);
     }
     else
     {
-        int sz = std::min(_left.GetDataLength(), _right.GetDataLength());
-
-        PacketData l = _left;
-        PacketData r = _right;
-        l.ApplyBrightness(leftBrightness, _excludedChannels);
-        r.ApplyBrightness(rightBrightness, _excludedChannels);
+        int sz = std::min(left.GetDataLength(), right.GetDataLength());
 
-        Blend(l.GetDataPtr(), r.GetDataPtr(), sz, pos, _excludedChannels);
-        PrepareData(output, &l, _targetProtocol);
-    }
-    return output;
-}
+        // blend straight into the output rather than copying both packets
+        PrepareData(output, &left, _targetProtocol);
+        output->ApplyBrightness(leftBrightness, _excludedChannels);
 
-void UniverseData::Blend(uint8_t* buffer, uint8_t* blendBuffer, size_t channels, float pos, std::list<int> excludeChannels)
-{
-    float inv = 1.0 - pos;
-    for (size_t i = 0; i < channels; ++i)
-    {
-        if (std::find(excludeChannels.begin(), excludeChannels.end(), i + 1) != excludeChannels.end())
+        if (sz > 0)
         {
-            if (pos < 0.5)
+            memcpy(_blendBuffer, right.GetDataPtr(), sz);
+            if (rightBrightness != 100)
             {
-                // dont change anything
-            }
-            else
-            {
-                *(buffer + i) = *(blendBuffer + i);
+                BlendKernels::Scale(_blendBuffer, sz, rightBrightness, &_excludedChannels);
             }
-        }
-        else
-        {
-            *(buffer + i) = (uint8_t)((float) * (buffer + i) * inv + (float) * (blendBuffer + i) * pos);
+            Blend(output->GetDataPtr(), _blendBuffer, sz, pos);
         }
     }
+    return output;
+}
+
+void UniverseData::Blend(uint8_t* buffer, uint8_t* blendBuffer, size_t channels, float pos)
+{
+    BlendKernels::Crossfade(buffer, blendBuffer, channels, pos, &_excludedChannels);
 }
 
 void UniverseData::PrepareData(PacketData* target, PacketData* source, int protocol)
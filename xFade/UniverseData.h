@@ -1,21 +1,30 @@
 #pragma once
 
-#include <mutex>
+#include <atomic>
 
 #include "PacketData.h"
+#include "SnapshotBuffer.h"
+#include "../xSchedule/BlendKernels.h"
 
+// The latest packets received for a universe from the left and right inputs.
+// The receivers publish packets and the emitter reads the latest without either taking a lock.
 class UniverseData
 {
     int _universe = 0;
     int _targetProtocol = 0;
-    std::mutex _lock;
-    PacketData _left;
-    PacketData _right;
+    SnapshotBuffer<PacketData> _left;
+    SnapshotBuffer<PacketData> _right;
+    std::atomic_flag _leftWriting = ATOMIC_FLAG_INIT;
+    std::atomic_flag _rightWriting = ATOMIC_FLAG_INIT;
+    std::atomic<int> _leftSequenceNum;
+    std::atomic<int> _rightSequenceNum;
     std::string _targetIP;
-    std::list<int> _excludedChannels;
+    ChannelMask _excludedChannels;
+    uint8_t _blendBuffer[512]; // only used by the emitter
 
+    bool Update(SnapshotBuffer<PacketData>& side, std::atomic_flag& writing, std::atomic<int>& sequenceNum, int type, uint8_t* buffer, int size);
     void PrepareData(PacketData* target, PacketData* source, int protocol);
-    void Blend(uint8_t* buffer, uint8_t* blendBuffer, size_t channels, float pos, std::list<int> excludeChannels);
+    void Blend(uint8_t* buffer, uint8_t* blendBuffer, size_t channels, float pos);
 
 public:
 
@@ -26,14 +35,14 @@ public:
     static void SetLeftTag(const std::string& left) { __leftTag = left; }
     static void SetRightTag(const std::string& right) { __rightTag = right; }
     int GetUniverse() const { return _universe; }
-    std::mutex& GetLock() { return _lock; }
     std::string GetTargetIP() const { return _targetIP; }
     bool UpdateLeft(int type, uint8_t* buffer, int size);
     bool UpdateRight(int type, uint8_t* buffer, int size);
-    int GetLeftSequenceNum();
-    int GetRightSequenceNum();
+    int GetLeftSequenceNum() const { return _leftSequenceNum; }
+    int GetRightSequenceNum() const { return _rightSequenceNum; }
     int GetOutputFormat() const { return _targetProtocol; }
-    UniverseData(int universe, const std::string& targetIP, const std::string& targetProtocol, std::list<int> excludedChannels);
+    UniverseData(int universe, const std::string& targetIP, const std::string& targetProtocol, const std::list<int>& excludedChannels);
     virtual ~UniverseData() {}
+    // emitter only
     PacketData* GetOutput(PacketData* output, int leftBrightness, int rightBrightness, float pos);
 };
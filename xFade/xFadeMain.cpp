@@ -1294,10 +1294,13 @@ void xFadeFrame::OnTimer_StatusTrigger(wxTimerEvent& event)
     StatusBar1->SetStatusText(wxString::Format("Right: %lu", rightReceived), 2);
     if (_emitter != nullptr)
     {
-        StatusBar1->SetStatusText(wxString::Format("Sent: %lu", _emitter->GetSent()), 1);
+        std::string jitter = _emitter->GetJitter().GetSummary();
+        StatusBar1->SetStatusText(wxString::Format("Sent: %lu", _emitter->GetSent()) + (jitter == "" ? "" : " " + jitter), 1);
+        StatusBar1->SetToolTip(_emitter->GetJitter().AsString());
         if (count % 60 == 0)
         {
             logger_base.debug("Activity - Left Received %lu, Right Received %lu, Sent %lu.", leftReceived, rightReceived, _emitter->GetSent());
+            logger_base.debug("Activity - Jitter %s.", (const char*)_emitter->GetJitter().AsString().c_str());
         }
     }
     else
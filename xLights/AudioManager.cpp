@@ -11,9 +11,13 @@
 #include <wx/wx.h>
 #include <wx/string.h>
 #include <wx/ffile.h>
+#include <wx/file.h>
+#include <wx/filename.h>
 #include <wx/log.h>
+#include <wx/dir.h>
 
 #include <algorithm>
+#include <limits>
 #include <fstream>
 #include <sstream>
 #include <vector>
@@ -26,6 +30,7 @@
 #include "../xSchedule/md5.h"
 #include "osxMacUtils.h"
 #include "Parallel.h"
+#include "SpecialOptions.h"
 
 extern "C"
 {
@@ -43,6 +48,10 @@ SDL __sdl;
 int __globalVolume = 100;
 int AudioData::__nextId = 0;
 
+// where decoded audio and the frame analysis are kept between sessions ... empty disables it
+std::string __audioCacheFolder;
+std::mutex __audioCacheFolderLock;
+
 #define SDL_INPUT_BUFFER_SIZE 8192
 
 #ifndef __WXOSX__
@@ -1429,6 +1438,13 @@ void AudioManager::DoPolyphonicTranscription(wxProgressDialog* dlg, AudioManager
 
     wxStopWatch sw;
 
+    if (LoadCachedNotes())
+    {
+        _polyphonicTranscriptionDone = true;
+        logger_base.info("DoPolyphonicTranscription: Polyphonic transcription loaded from the cache in %ld.", sw.Time());
+        return;
+    }
+
     logger_base.info("DoPolyphonicTranscription: Polyphonic transcription started on file " + _audio_file);
 
     while (!IsDataLoaded())
@@ -1569,6 +1585,7 @@ void AudioManager::DoPolyphonicTranscription(wxProgressDialog* dlg, AudioManager
 
         //done with VAMP Polyphonic Transcriber
         delete pt;
+        SaveCachedNotes();
     }
     _polyphonicTranscriptionDone = true;
     logger_base.info("DoPolyphonicTranscription: Polyphonic transcription completed in %ld.", sw.Time());
@@ -1600,6 +1617,14 @@ void AudioManager::DoPrepareFrameData()
 		return;
 	}
 
+    // if we have done it before for this song and interval we dont even need to wait for the audio to load
+    if (LoadCachedFrameData())
+    {
+        _frameDataPrepared = true;
+        logger_base.info("DoPrepareFrameData: Audio frame data loaded from the cache in %ld. Frames: %d", sw.Time(), (int)_frameData.size());
+        return;
+    }
+
     // wait for the data to load
     while (!IsDataLoaded())
     {
@@ -1783,6 +1808,8 @@ void AudioManager::DoPrepareFrameData()
 	// flag the fact that the data is all ready
 	_frameDataPrepared = true;
 
+    SaveCachedFrameData();
+
 	logger_base.info("DoPrepareFrameData: Audio frame data processing complete in %ld. Frames: %d", sw.Time(), frames);
 }
 
@@ -2102,8 +2129,20 @@ void AudioManager::SetFrameInterval(int intervalMS)
 	{
         logger_base.debug("Changing frame interval to %d", intervalMS);
 
-		// save it and regenerate the frame data for effects that rely upon it ... but do it on a background thread
-		_intervalMS = intervalMS;
+        // anything prepared for the old interval no longer lines up with the frames
+        if (_prepFrameData.valid())
+        {
+            _prepFrameData.wait();
+        }
+        {
+            std::unique_lock<std::shared_timed_mutex> locker(_mutex);
+            _intervalMS = intervalMS;
+            _frameData.clear();
+            _frameDataPrepared = false;
+            _polyphonicTranscriptionDone = false;
+        }
+
+		// regenerate the frame data for effects that rely upon it ... but do it on a background thread
 		PrepareFrameData(true);
 	}
 }
@@ -2135,6 +2174,12 @@ AudioManager::~AudioManager()
         wxMilliSleep(100);
     }
 
+    // the loading thread still uses the data for a moment after the last of it is loaded
+    if (_loadingAudio.valid())
+    {
+        _loadingAudio.wait();
+    }
+
     if (_pcmdata != nullptr)
     {
         __sdl.Stop();
@@ -2151,6 +2196,9 @@ AudioManager::~AudioManager()
         if (_filtered.back()->pcmdata) {
             free(_filtered.back()->pcmdata);
         }
+        if (_filtered.back()->pyramid) {
+            delete _filtered.back()->pyramid;
+        }
         delete _filtered.back();
         _filtered.pop_back();
     }
@@ -2446,6 +2494,25 @@ void AudioManager::DoLoadAudioData(AVFormatContext* formatContext, AVCodecContex
     #define CONVERSION_BUFFER_SIZE 192000
     uint8_t* out_buffer = (uint8_t *)av_malloc(CONVERSION_BUFFER_SIZE * out_channels * 2); // 1 second of audio
 
+    // if we have decoded this song before we can skip decoding it
+    if (LoadCachedAudio(out_channels, out_buffer, read, lastpct))
+    {
+        {
+            std::unique_lock<std::shared_timed_mutex> locker(_mutexAudioLoad);
+            _trackSize = _loadedData;
+        }
+
+        av_free(out_buffer);
+        av_packet_free(&readingPacket);
+        av_frame_free(&frame);
+        avformat_close_input(&formatContext);
+
+        BuildSummaryPyramid();
+
+        logger_base.debug("DoLoadAudioData: Song data loaded from the cache in %ld. Read: %ld", sw.Time(), read);
+        return;
+    }
+
     int64_t in_channel_layout = av_get_default_channel_layout(codecContext->channels);
 
     struct SwrContext *au_convert_ctx = swr_alloc_set_opts(nullptr, out_channel_layout, out_sample_fmt, out_sample_rate,
@@ -2518,6 +2585,9 @@ void AudioManager::DoLoadAudioData(AVFormatContext* formatContext, AVCodecContex
 
     avformat_close_input(&formatContext);
 
+    SaveCachedAudio();
+    BuildSummaryPyramid();
+
     logger_base.debug("DoLoadAudioData: Song data loaded in %ld. Read: %ld", sw.Time(), read);
 }
 
@@ -2808,6 +2878,7 @@ void AudioManager::SwitchTo(AUDIOSAMPLETYPE type, int lowNote, int highNote) {
                 fad->lowNote = 0;
                 fad->highNote = 0;
                 fad->type = type;
+                fad->pyramid = new AudioSummaryPyramid(fad->data, _trackSize);
                 _filtered.push_back(fad);
             }
         }
@@ -2891,6 +2962,7 @@ void AudioManager::SwitchTo(AUDIOSAMPLETYPE type, int lowNote, int highNote) {
             fad->lowNote = lowNote;
             fad->highNote = highNote;
             fad->type = type;
+            fad->pyramid = new AudioSummaryPyramid(fad->data, _trackSize);
             _filtered.push_back(fad);
         }
     }
@@ -2943,6 +3015,22 @@ void AudioManager::GetLeftDataMinMax(long start, long end, float& minimum, float
         return;
     }
 
+    // the pyramid answers in a few steps however long the range is
+    std::shared_ptr<AudioSummaryPyramid> rawPyramid;
+    const AudioSummaryPyramid* pyramid = fad->pyramid;
+    if (type == AUDIOSAMPLETYPE::RAW) {
+        std::unique_lock<std::shared_timed_mutex> locker(_mutexAudioLoad);
+        rawPyramid = _pyramid;
+        pyramid = rawPyramid.get();
+    }
+    if (pyramid != nullptr) {
+        float mn, mx;
+        pyramid->GetMinMax(start, std::min(end, _trackSize), mn, mx);
+        minimum = std::min(minimum, mn);
+        maximum = std::max(maximum, mx);
+        return;
+    }
+
     switch (type) {
     case AUDIOSAMPLETYPE::ALTO:
     case AUDIOSAMPLETYPE::BASS:
@@ -2965,6 +3053,107 @@ void AudioManager::GetLeftDataMinMax(long start, long end, float& minimum, float
     }
 }
 
+void AudioManager::BuildSummaryPyramid()
+{
+    static log4cpp::Category& logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    if (_data[0] == nullptr || _trackSize <= 0) return;
+
+    wxStopWatch sw;
+    std::shared_ptr<AudioSummaryPyramid> pyramid = std::make_shared<AudioSummaryPyramid>(_data[0], _trackSize);
+    {
+        std::unique_lock<std::shared_timed_mutex> locker(_mutexAudioLoad);
+        _pyramid = pyramid;
+    }
+    logger_base.debug("Audio summary pyramid built in %ld.", sw.Time());
+}
+
+// Audio summary pyramid
+
+// the smallest blocks ... anything smaller is read from the samples
+#define PYRAMID_BASE_SHIFT 6
+#define PYRAMID_BASE_SIZE (1L << PYRAMID_BASE_SHIFT)
+
+AudioSummaryPyramid::AudioSummaryPyramid(const float* data, long size) : _data(data), _size(size)
+{
+    // only whole blocks are kept ... the tail is always read from the samples
+    long count = size >> PYRAMID_BASE_SHIFT;
+    if (data == nullptr || count == 0) return;
+
+    _levels.emplace_back(count);
+    std::vector<Block>& base = _levels.back();
+    parallel_for(0, count, [&base, data](int b) {
+        const float* d = data + ((long)b << PYRAMID_BASE_SHIFT);
+        float mn = d[0];
+        float mx = d[0];
+        double sum = 0.0;
+        for (long i = 0; i < PYRAMID_BASE_SIZE; i++) {
+            mn = std::min(mn, d[i]);
+            mx = std::max(mx, d[i]);
+            sum += (double)d[i] * d[i];
+        }
+        base[b] = { mn, mx, (float)sum };
+    }, 1024);
+
+    while (_levels.back().size() > 1) {
+        const std::vector<Block>& below = _levels.back();
+        std::vector<Block> level(below.size() / 2);
+        for (size_t b = 0; b < level.size(); b++) {
+            const Block& l = below[b * 2];
+            const Block& r = below[b * 2 + 1];
+            level[b] = { std::min(l.min, r.min), std::max(l.max, r.max), l.sumSquares + r.sumSquares };
+        }
+        _levels.push_back(std::move(level));
+    }
+}
+
+AudioSummaryPyramid::Block AudioSummaryPyramid::Summarise(long start, long end) const
+{
+    Block res = { std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest(), 0.0f };
+
+    long pos = std::max(start, 0L);
+    end = std::min(end, _size);
+    while (pos < end) {
+        if ((pos & (PYRAMID_BASE_SIZE - 1)) != 0 || end - pos < PYRAMID_BASE_SIZE || _levels.empty()) {
+            float v = _data[pos++];
+            res.min = std::min(res.min, v);
+            res.max = std::max(res.max, v);
+            res.sumSquares += v * v;
+            continue;
+        }
+
+        // the largest block which starts here and does not go past the end
+        size_t level = 0;
+        while (level + 1 < _levels.size()) {
+            long size = PYRAMID_BASE_SIZE << (level + 1);
+            if ((pos & (size - 1)) != 0 || pos + size > end) break;
+            level++;
+        }
+        long shift = PYRAMID_BASE_SHIFT + level;
+        const Block& b = _levels[level][pos >> shift];
+        res.min = std::min(res.min, b.min);
+        res.max = std::max(res.max, b.max);
+        res.sumSquares += b.sumSquares;
+        pos += 1L << shift;
+    }
+    return res;
+}
+
+void AudioSummaryPyramid::GetMinMax(long start, long end, float& minimum, float& maximum) const
+{
+    Block b = Summarise(start, end);
+    minimum = b.min;
+    maximum = b.max;
+}
+
+float AudioSummaryPyramid::GetRMS(long start, long end) const
+{
+    start = std::max(start, 0L);
+    end = std::min(end, _size);
+    if (end <= start) return 0.0f;
+    return sqrtf(Summarise(start, end).sumSquares / (end - start));
+}
+
 // Access a single piece of track data
 float AudioManager::GetRightData(long offset)
 {
@@ -3048,6 +3237,398 @@ std::string AudioManager::Hash()
     return _hash;
 }
 
+// Analysis cache
+//
+// Decoded audio and the frame analysis are saved in the cache folder named for a hash of the media
+// file contents so reopening a song ... even from a different sequence ... skips the work. Each file
+// is a fixed header followed by flat arrays so it can be read straight into memory.
+//
+// Files are touched when they are used so the folder can be trimmed oldest first. It is limited to
+// the special option AudioCacheMB and anything not used for AUDIO_CACHE_MAX_AGE_DAYS is removed.
+
+#define AUDIO_CACHE_MAGIC 0x43414C58 // XLAC
+#define AUDIO_CACHE_VERSION 1
+#define AUDIO_CACHE_HASH_LIMIT (64 * 1024 * 1024)
+#define AUDIO_CACHE_MAX_AGE_DAYS 60
+#define AUDIO_CACHE_TEMP_PREFIX "xlac"
+
+namespace
+{
+    enum class AudioCacheType : uint32_t
+    {
+        PCM = 1,       // trackSize stereo 16 bit samples
+        FRAMEDATA = 2, // frames x max, min, spread ... frames x spectrum count ... count spectrum values
+        NOTES = 3      // frames x note count ... count notes
+    };
+
+    struct AudioCacheHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t type;
+        uint32_t rate;
+        uint64_t trackSize;
+        uint32_t channels;
+        uint32_t intervalMS;
+        uint32_t frames;
+        uint32_t count;
+    };
+
+    uint32_t FrameCount(long lengthMS, int intervalMS)
+    {
+        long frames = lengthMS / intervalMS;
+        while (frames * intervalMS < lengthMS)
+        {
+            frames++;
+        }
+        return frames;
+    }
+
+    bool OpenAudioCacheFile(const std::string& file, AudioCacheType type, wxFile& f, AudioCacheHeader& header)
+    {
+        if (file == "" || !wxFile::Exists(file) || !f.Open(file)) return false;
+
+        if (f.Read(&header, sizeof(header)) != (ssize_t)sizeof(header) ||
+            header.magic != AUDIO_CACHE_MAGIC ||
+            header.version != AUDIO_CACHE_VERSION ||
+            header.type != (uint32_t)type)
+        {
+            f.Close();
+            return false;
+        }
+        // mark it as recently used so it is the last to be trimmed
+        wxFileName(file).Touch();
+        return true;
+    }
+
+    // removes files not used for a long time and then the least recently used until the folder fits its limit
+    void TrimAudioCacheFolder(const wxString& folder)
+    {
+        static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+        int mb = wxAtoi(SpecialOptions::GetOption("AudioCacheMB", "2048"));
+        if (mb < 0) mb = 0;
+        wxULongLong limit = (wxULongLong)mb * 1024 * 1024;
+        wxDateTime oldest = wxDateTime::Now() - wxDateSpan::Days(AUDIO_CACHE_MAX_AGE_DAYS);
+
+        struct CacheFile
+        {
+            wxString file;
+            wxDateTime used;
+            wxULongLong size;
+        };
+        std::vector<CacheFile> files;
+        wxArrayString names;
+        wxDir::GetAllFiles(folder, &names, "", wxDIR_FILES);
+        for (const auto& it : names)
+        {
+            wxFileName fn(it);
+            files.push_back({ it, fn.GetModificationTime(), fn.GetSize() });
+        }
+        std::sort(files.begin(), files.end(), [](const CacheFile& a, const CacheFile& b) { return a.used.IsLaterThan(b.used); });
+
+        wxULongLong total = 0;
+        for (const auto& it : files)
+        {
+            // a temporary file may still be being written ... it only goes once it has been abandoned
+            bool temp = wxFileName(it.file).GetName().StartsWith(AUDIO_CACHE_TEMP_PREFIX);
+            if (it.used.IsEarlierThan(oldest) || (!temp && total + it.size > limit))
+            {
+                logger_base.debug("AudioManager: Removing audio cache file %s.", (const char*)it.file.c_str());
+                wxRemoveFile(it.file);
+            }
+            else if (!temp)
+            {
+                total += it.size;
+            }
+        }
+    }
+
+    // writes to a temporary file first so a half written file is never picked up
+    void WriteAudioCacheFile(const std::string& file, const AudioCacheHeader& header, const std::list<std::pair<const void*, size_t>>& blocks)
+    {
+        static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+        if (file == "") return;
+
+        wxFileName fn(file);
+        if (!wxDirExists(fn.GetPath()) && !wxMkdir(fn.GetPath()))
+        {
+            logger_base.warn("AudioManager: Unable to create audio cache folder %s.", (const char*)fn.GetPath().c_str());
+            return;
+        }
+
+        wxString temp = wxFileName::CreateTempFileName(fn.GetPath() + wxFileName::GetPathSeparator() + AUDIO_CACHE_TEMP_PREFIX);
+        wxFile f;
+        bool ok = temp != "" && f.Open(temp, wxFile::write);
+        if (ok)
+        {
+            ok = f.Write(&header, sizeof(header)) == sizeof(header);
+            for (const auto& it : blocks)
+            {
+                ok = ok && f.Write(it.first, it.second) == it.second;
+            }
+            f.Close();
+        }
+
+        if (!ok || !wxRenameFile(temp, file, true))
+        {
+            logger_base.warn("AudioManager: Unable to write audio cache file %s.", (const char*)file.c_str());
+            if (temp != "") wxRemoveFile(temp);
+            return;
+        }
+        TrimAudioCacheFolder(fn.GetPath());
+    }
+}
+
+void AudioManager::SetCacheFolder(const std::string& folder)
+{
+    std::unique_lock<std::mutex> lock(__audioCacheFolderLock);
+    __audioCacheFolder = folder;
+}
+
+void AudioManager::PurgeCache(const std::string& folder)
+{
+    static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    if (folder == "" || !wxDir::Exists(folder)) return;
+
+    logger_base.debug("AudioManager: Purging audio cache folder %s.", (const char*)folder.c_str());
+    // files open in a loading song may not go on some platforms ... they are trimmed later
+    wxDir::Remove(folder, wxPATH_RMDIR_RECURSIVE);
+}
+
+// a hash of the media file contents and when it was last modified ... very large files (usually video)
+// only have their start and end hashed so the time is what catches them being edited in place
+std::string AudioManager::GetCacheKey()
+{
+    std::unique_lock<std::mutex> lock(_cacheKeyMutex);
+
+    if (_cacheKey == "")
+    {
+        wxFile f;
+        if (!f.Open(_audio_file)) return "";
+
+        wxFileOffset size = f.Length();
+        int64_t modified = wxFileName(_audio_file).GetModificationTime().GetValue().GetValue();
+        MD5 md5;
+        md5.update((const char*)&size, sizeof(size));
+        md5.update((const char*)&modified, sizeof(modified));
+
+        std::vector<char> buffer(1024 * 1024);
+        auto hash = [&f, &md5, &buffer](wxFileOffset start, wxFileOffset length) {
+            f.Seek(start);
+            while (length > 0)
+            {
+                ssize_t read = f.Read(&buffer[0], std::min(length, (wxFileOffset)buffer.size()));
+                if (read <= 0) break;
+                md5.update(&buffer[0], read);
+                length -= read;
+            }
+        };
+
+        if (size <= AUDIO_CACHE_HASH_LIMIT)
+        {
+            hash(0, size);
+        }
+        else
+        {
+            hash(0, AUDIO_CACHE_HASH_LIMIT / 2);
+            hash(size - AUDIO_CACHE_HASH_LIMIT / 2, AUDIO_CACHE_HASH_LIMIT / 2);
+        }
+        md5.finalize();
+        _cacheKey = md5.hexdigest();
+    }
+
+    return _cacheKey;
+}
+
+std::string AudioManager::GetCacheFile(const std::string& type)
+{
+    std::string folder;
+    {
+        std::unique_lock<std::mutex> lock(__audioCacheFolderLock);
+        folder = __audioCacheFolder;
+    }
+    if (folder == "") return "";
+
+    std::string key = GetCacheKey();
+    if (key == "") return "";
+
+    return folder + wxFileName::GetPathSeparator() + key + type;
+}
+
+// feeds the cached samples through the same path as decoded ones so playback can start while it loads
+bool AudioManager::LoadCachedAudio(int out_channels, uint8_t* out_buffer, long& read, int& lastpct)
+{
+    static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    wxFile f;
+    AudioCacheHeader header;
+    std::string file = GetCacheFile(".pcm");
+    if (!OpenAudioCacheFile(file, AudioCacheType::PCM, f, header)) return false;
+
+    size_t sampleSize = out_channels * sizeof(int16_t);
+    if (header.rate != (uint32_t)_rate || header.channels != (uint32_t)_channels ||
+        header.trackSize * sampleSize > (uint64_t)_pcmdatasize + PCMFUDGE ||
+        header.trackSize > (uint64_t)(_trackSize + _extra) ||
+        f.Length() != (wxFileOffset)(sizeof(header) + header.trackSize * sampleSize))
+    {
+        logger_base.debug("AudioManager: Ignoring audio cache file %s as it does not match.", (const char*)file.c_str());
+        return false;
+    }
+
+    while (read < (long)header.trackSize)
+    {
+        int samples = std::min((long)CONVERSION_BUFFER_SIZE, (long)header.trackSize - read);
+        if (f.Read(out_buffer, samples * sampleSize) != (ssize_t)(samples * sampleSize))
+        {
+            logger_base.warn("AudioManager: Error reading audio cache file %s ... decoding the song instead.", (const char*)file.c_str());
+            read = 0;
+            lastpct = 0;
+            SetLoadedData(0);
+            return false;
+        }
+        LoadResampledAudio(samples, out_channels, out_buffer, read, lastpct);
+    }
+    return true;
+}
+
+void AudioManager::SaveCachedAudio()
+{
+    if (!_ok || _pcmdata == nullptr || _trackSize <= 0) return;
+
+    std::string file = GetCacheFile(".pcm");
+    if (file == "" || wxFile::Exists(file)) return;
+
+    AudioCacheHeader header = { AUDIO_CACHE_MAGIC, AUDIO_CACHE_VERSION, (uint32_t)AudioCacheType::PCM, (uint32_t)_rate, (uint64_t)_trackSize, (uint32_t)_channels, 0, 0, 0 };
+    WriteAudioCacheFile(file, header, { { _pcmdata, _trackSize * 2 * sizeof(int16_t) } });
+}
+
+// must be called with _mutex held
+bool AudioManager::LoadCachedFrameData()
+{
+    wxFile f;
+    AudioCacheHeader header;
+    if (!OpenAudioCacheFile(GetCacheFile(wxString::Format("_%d.frames", _intervalMS).ToStdString()), AudioCacheType::FRAMEDATA, f, header)) return false;
+
+    uint32_t frames = FrameCount(_lengthMS, _intervalMS);
+    if (frames == 0 || header.rate != (uint32_t)_rate || header.intervalMS != (uint32_t)_intervalMS || header.frames != frames ||
+        f.Length() != (wxFileOffset)(sizeof(header) + frames * 3 * sizeof(float) + frames + header.count * sizeof(float)))
+    {
+        return false;
+    }
+
+    std::vector<float> levels(frames * 3);
+    std::vector<uint8_t> counts(frames);
+    std::vector<float> spectrum(header.count);
+    if (f.Read(&levels[0], levels.size() * sizeof(float)) != (ssize_t)(levels.size() * sizeof(float)) ||
+        f.Read(&counts[0], counts.size()) != (ssize_t)counts.size() ||
+        (header.count > 0 && f.Read(&spectrum[0], spectrum.size() * sizeof(float)) != (ssize_t)(spectrum.size() * sizeof(float))))
+    {
+        return false;
+    }
+
+    size_t total = 0;
+    for (auto c : counts)
+    {
+        total += c;
+    }
+    if (total != header.count) return false;
+
+    _frameData.clear();
+    _frameData.resize(frames);
+    auto s = spectrum.begin();
+    for (uint32_t i = 0; i < frames; i++)
+    {
+        auto& frame = _frameData[i];
+        frame.resize(5);
+        frame[0].push_back(levels[i * 3]);
+        frame[1].push_back(levels[i * 3 + 1]);
+        frame[2].push_back(levels[i * 3 + 2]);
+        frame[3].assign(s, s + counts[i]);
+        s += counts[i];
+    }
+    return true;
+}
+
+void AudioManager::SaveCachedFrameData()
+{
+    std::string file = GetCacheFile(wxString::Format("_%d.frames", _intervalMS).ToStdString());
+    if (file == "") return;
+
+    std::vector<float> levels;
+    std::vector<uint8_t> counts;
+    std::vector<float> spectrum;
+    levels.reserve(_frameData.size() * 3);
+    counts.reserve(_frameData.size());
+    for (const auto& frame : _frameData)
+    {
+        levels.push_back(frame[0].front());
+        levels.push_back(frame[1].front());
+        levels.push_back(frame[2].front());
+        counts.push_back(frame[3].size());
+        spectrum.insert(spectrum.end(), frame[3].begin(), frame[3].end());
+    }
+
+    AudioCacheHeader header = { AUDIO_CACHE_MAGIC, AUDIO_CACHE_VERSION, (uint32_t)AudioCacheType::FRAMEDATA, (uint32_t)_rate, (uint64_t)_trackSize, (uint32_t)_channels, (uint32_t)_intervalMS, (uint32_t)_frameData.size(), (uint32_t)spectrum.size() };
+    WriteAudioCacheFile(file, header, { { levels.data(), levels.size() * sizeof(float) }, { counts.data(), counts.size() }, { spectrum.data(), spectrum.size() * sizeof(float) } });
+}
+
+bool AudioManager::LoadCachedNotes()
+{
+    wxFile f;
+    AudioCacheHeader header;
+    if (!OpenAudioCacheFile(GetCacheFile(wxString::Format("_%d.notes", _intervalMS).ToStdString()), AudioCacheType::NOTES, f, header)) return false;
+
+    if (header.rate != (uint32_t)_rate || header.intervalMS != (uint32_t)_intervalMS || header.frames != _frameData.size() ||
+        f.Length() != (wxFileOffset)(sizeof(header) + header.frames * sizeof(uint16_t) + header.count * sizeof(float)))
+    {
+        return false;
+    }
+
+    std::vector<uint16_t> counts(header.frames);
+    std::vector<float> notes(header.count);
+    if ((header.frames > 0 && f.Read(&counts[0], counts.size() * sizeof(uint16_t)) != (ssize_t)(counts.size() * sizeof(uint16_t))) ||
+        (header.count > 0 && f.Read(&notes[0], notes.size() * sizeof(float)) != (ssize_t)(notes.size() * sizeof(float))))
+    {
+        return false;
+    }
+
+    size_t total = 0;
+    for (auto c : counts)
+    {
+        total += c;
+    }
+    if (total != header.count) return false;
+
+    auto n = notes.begin();
+    for (size_t i = 0; i < _frameData.size(); i++)
+    {
+        _frameData[i][4].assign(n, n + counts[i]);
+        n += counts[i];
+    }
+    return true;
+}
+
+void AudioManager::SaveCachedNotes()
+{
+    std::string file = GetCacheFile(wxString::Format("_%d.notes", _intervalMS).ToStdString());
+    if (file == "") return;
+
+    std::vector<uint16_t> counts;
+    std::vector<float> notes;
+    counts.reserve(_frameData.size());
+    for (const auto& frame : _frameData)
+    {
+        counts.push_back(frame[4].size());
+        notes.insert(notes.end(), frame[4].begin(), frame[4].end());
+    }
+
+    AudioCacheHeader header = { AUDIO_CACHE_MAGIC, AUDIO_CACHE_VERSION, (uint32_t)AudioCacheType::NOTES, (uint32_t)_rate, (uint64_t)_trackSize, (uint32_t)_channels, (uint32_t)_intervalMS, (uint32_t)_frameData.size(), (uint32_t)notes.size() };
+    WriteAudioCacheFile(file, header, { { counts.data(), counts.size() * sizeof(uint16_t) }, { notes.data(), notes.size() * sizeof(float) } });
+}
+
 // extract the features data from a Vamp plugins output
 void xLightsVamp::ProcessFeatures(Vamp::Plugin::FeatureList &feature, std::vector<int> &starts, std::vector<int> &ends, std::vector<std::string> &labels)
 {
@@ -11,6 +11,7 @@
  **************************************************************/
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <list>
 #include <shared_mutex>
@@ -186,6 +187,33 @@ public:
     bool IsListening();
 };
 
+// The min, max and sum of squares of the samples in power of two sized blocks ... each level has
+// blocks twice the size of the level below. Any range of samples can then be summarised from a
+// handful of blocks plus a few samples at each end no matter how long it is.
+class AudioSummaryPyramid
+{
+public:
+    struct Block
+    {
+        float min;
+        float max;
+        float sumSquares;
+    };
+
+    // data must outlive the pyramid
+    AudioSummaryPyramid(const float* data, long size);
+
+    // summarises data[start, end) ... an empty range has min above max
+    Block Summarise(long start, long end) const;
+    void GetMinMax(long start, long end, float& minimum, float& maximum) const;
+    float GetRMS(long start, long end) const;
+
+private:
+    const float* _data;
+    long _size;
+    std::vector<std::vector<Block>> _levels;
+};
+
 struct FilteredAudioData
 {
     AUDIOSAMPLETYPE type;
@@ -193,6 +221,7 @@ struct FilteredAudioData
     int highNote = 127;
     float* data = nullptr;
     int16_t *pcmdata = nullptr;
+    AudioSummaryPyramid* pyramid = nullptr;
 };
 
 class AudioManager
@@ -229,8 +258,11 @@ class AudioManager
     int _sdlid = 0;
     bool _ok = false;
     std::string _hash;
+    std::string _cacheKey;
+    std::mutex _cacheKeyMutex;
     std::future<void> _prepFrameData;
     std::future<void> _loadingAudio;
+    std::shared_ptr<AudioSummaryPyramid> _pyramid; // of the left channel ... guarded by _mutexAudioLoad
 
 	void GetTrackMetrics(AVFormatContext* formatContext, AVCodecContext* codecContext, AVStream* audioStream);
 	void LoadTrackData(AVFormatContext* formatContext, AVCodecContext* codecContext, AVStream* audioStream);
@@ -251,6 +283,17 @@ class AudioManager
                                     int out_channels, uint8_t* out_buffer, long& read, int& lastpct );
     void LoadResampledAudio( int sampleCount, int out_channels, uint8_t* out_buffer, long& read, int& lastpct );
     void SetLoadedData(long pos);
+    void BuildSummaryPyramid();
+
+    // persistent analysis cache ... see SetCacheFolder
+    std::string GetCacheKey();
+    std::string GetCacheFile(const std::string& type);
+    bool LoadCachedAudio(int out_channels, uint8_t* out_buffer, long& read, int& lastpct);
+    void SaveCachedAudio();
+    bool LoadCachedFrameData();
+    void SaveCachedFrameData();
+    bool LoadCachedNotes();
+    void SaveCachedNotes();
 
     static bool WriteAudioFrame( AVFormatContext *oc, AVCodecContext* codecContext, AVStream *st, float *sampleBuff, int sampleCount, bool clearQueue = false );
 
@@ -281,6 +324,9 @@ public:
     static void SetAudioDevice(const std::string& device);
     static std::list<std::string> GetAudioDevices();
     static void SetInputAudioDevice(const std::string& device);
+    // where the decoded audio and analysis are cached ... blank turns the cache off
+    static void SetCacheFolder(const std::string& folder);
+    static void PurgeCache(const std::string& folder);
     static std::list<std::string> GetInputAudioDevices();
     long GetTrackSize() const { return _trackSize; };
 	long GetRate() const { return _rate; };
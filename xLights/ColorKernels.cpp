@@ -0,0 +1,372 @@
+/***************************************************************
+ * This source files comes from the xLights project
+ * https://www.xlights.org
+ * https://github.com/smeighan/xLights
+ * See the github commit history for a record of contributing
+ * developers.
+ * Copyright claimed based on commit dates recorded in Github
+ * License: https://github.com/smeighan/xLights/blob/master/License.txt
+ **************************************************************/
+
+#include "ColorKernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__)
+#define COLOR_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define COLOR_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define COLOR_NEON
+#include <arm_neon.h>
+#endif
+
+#pragma region Vector primitives
+
+namespace
+{
+    // The primitives below are the only place the instruction set matters. The conversions further
+    // down are written once against them. Without SIMD a vector is just a double.
+
+#if defined(COLOR_AVX2)
+    typedef __m256d vd;
+    typedef __m256d vm;
+    constexpr size_t VW = 4;
+    inline vd Set1(double d) { return _mm256_set1_pd(d); }
+    inline vd Load(const double* p) { return _mm256_loadu_pd(p); }
+    inline void Store(double* p, vd v) { _mm256_storeu_pd(p, v); }
+    inline vd Add(vd a, vd b) { return _mm256_add_pd(a, b); }
+    inline vd Sub(vd a, vd b) { return _mm256_sub_pd(a, b); }
+    inline vd Mul(vd a, vd b) { return _mm256_mul_pd(a, b); }
+    inline vd Div(vd a, vd b) { return _mm256_div_pd(a, b); }
+    inline vd Min(vd a, vd b) { return _mm256_min_pd(a, b); }
+    inline vd Max(vd a, vd b) { return _mm256_max_pd(a, b); }
+    inline vd Abs(vd a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+    inline vd Floor(vd a) { return _mm256_floor_pd(a); }
+    inline vm Less(vd a, vd b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+    inline vm Equal(vd a, vd b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+    inline vm Or(vm a, vm b) { return _mm256_or_pd(a, b); }
+    inline vd Select(vm mask, vd ifSet, vd ifClear) { return _mm256_blendv_pd(ifClear, ifSet, mask); }
+#elif defined(COLOR_SSE2)
+    typedef __m128d vd;
+    typedef __m128d vm;
+    constexpr size_t VW = 2;
+    inline vd Set1(double d) { return _mm_set1_pd(d); }
+    inline vd Load(const double* p) { return _mm_loadu_pd(p); }
+    inline void Store(double* p, vd v) { _mm_storeu_pd(p, v); }
+    inline vd Add(vd a, vd b) { return _mm_add_pd(a, b); }
+    inline vd Sub(vd a, vd b) { return _mm_sub_pd(a, b); }
+    inline vd Mul(vd a, vd b) { return _mm_mul_pd(a, b); }
+    inline vd Div(vd a, vd b) { return _mm_div_pd(a, b); }
+    inline vd Min(vd a, vd b) { return _mm_min_pd(a, b); }
+    inline vd Max(vd a, vd b) { return _mm_max_pd(a, b); }
+    inline vd Abs(vd a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+    inline vm Less(vd a, vd b) { return _mm_cmplt_pd(a, b); }
+    inline vm Equal(vd a, vd b) { return _mm_cmpeq_pd(a, b); }
+    inline vm Or(vm a, vm b) { return _mm_or_pd(a, b); }
+    inline vd Select(vm mask, vd ifSet, vd ifClear) { return _mm_or_pd(_mm_and_pd(mask, ifSet), _mm_andnot_pd(mask, ifClear)); }
+    // SSE2 has no floor ... truncate then step down where truncation rounded a negative number up
+    inline vd Floor(vd a)
+    {
+        vd t = _mm_cvtepi32_pd(_mm_cvttpd_epi32(a));
+        return _mm_sub_pd(t, _mm_and_pd(_mm_cmplt_pd(a, t), Set1(1.0)));
+    }
+#elif defined(COLOR_NEON)
+    typedef float64x2_t vd;
+    typedef uint64x2_t vm;
+    constexpr size_t VW = 2;
+    inline vd Set1(double d) { return vdupq_n_f64(d); }
+    inline vd Load(const double* p) { return vld1q_f64(p); }
+    inline void Store(double* p, vd v) { vst1q_f64(p, v); }
+    inline vd Add(vd a, vd b) { return vaddq_f64(a, b); }
+    inline vd Sub(vd a, vd b) { return vsubq_f64(a, b); }
+    inline vd Mul(vd a, vd b) { return vmulq_f64(a, b); }
+    inline vd Div(vd a, vd b) { return vdivq_f64(a, b); }
+    inline vd Min(vd a, vd b) { return vminq_f64(a, b); }
+    inline vd Max(vd a, vd b) { return vmaxq_f64(a, b); }
+    inline vd Abs(vd a) { return vabsq_f64(a); }
+    inline vd Floor(vd a) { return vrndmq_f64(a); }
+    inline vm Less(vd a, vd b) { return vcltq_f64(a, b); }
+    inline vm Equal(vd a, vd b) { return vceqq_f64(a, b); }
+    inline vm Or(vm a, vm b) { return vorrq_u64(a, b); }
+    inline vd Select(vm mask, vd ifSet, vd ifClear) { return vbslq_f64(mask, ifSet, ifClear); }
+#else
+    typedef double vd;
+    typedef bool vm;
+    constexpr size_t VW = 1;
+    inline vd Set1(double d) { return d; }
+    inline vd Load(const double* p) { return *p; }
+    inline void Store(double* p, vd v) { *p = v; }
+    inline vd Add(vd a, vd b) { return a + b; }
+    inline vd Sub(vd a, vd b) { return a - b; }
+    inline vd Mul(vd a, vd b) { return a * b; }
+    inline vd Div(vd a, vd b) { return a / b; }
+    inline vd Min(vd a, vd b) { return std::min(a, b); }
+    inline vd Max(vd a, vd b) { return std::max(a, b); }
+    inline vd Abs(vd a) { return std::abs(a); }
+    inline vd Floor(vd a) { return std::floor(a); }
+    inline vm Less(vd a, vd b) { return a < b; }
+    inline vm Equal(vd a, vd b) { return a == b; }
+    inline vm Or(vm a, vm b) { return a || b; }
+    inline vd Select(vm mask, vd ifSet, vd ifClear) { return mask ? ifSet : ifClear; }
+#endif
+
+    inline vd Clamp01(vd a) { return Min(Max(a, Set1(0.0)), Set1(1.0)); }
+
+    // pixels are converted in blocks so the colour planes stay in the cache between the steps
+    constexpr size_t BLOCK = 64;
+    static_assert(BLOCK % VW == 0, "Block must be a whole number of vectors");
+
+    struct Planes
+    {
+        double r[BLOCK];
+        double g[BLOCK];
+        double b[BLOCK];
+        double h[BLOCK];
+        double s[BLOCK];
+        double v[BLOCK];
+    };
+
+    // c / 255.0 for every byte ... the same values toHSV calculates without the divides
+    struct ByteToUnit
+    {
+        double values[256];
+        ByteToUnit()
+        {
+            for (int i = 0; i < 256; i++) {
+                values[i] = i / 255.0;
+            }
+        }
+    };
+    const ByteToUnit byteToUnit;
+
+    // rgba to 0-1 planes ... the unused end of a short block is zeroed so it converts harmlessly
+    void Unpack(const uint8_t* rgba, size_t n, Planes& planes)
+    {
+        for (size_t i = 0; i < n; i++) {
+            planes.r[i] = byteToUnit.values[rgba[i * 4]];
+            planes.g[i] = byteToUnit.values[rgba[i * 4 + 1]];
+            planes.b[i] = byteToUnit.values[rgba[i * 4 + 2]];
+        }
+        for (size_t i = n; i < BLOCK; i++) {
+            planes.r[i] = planes.g[i] = planes.b[i] = 0.0;
+        }
+    }
+
+    inline uint8_t ToByte(double d)
+    {
+        return (uint8_t)std::min(std::max(d * 255.0, 0.0), 255.0);
+    }
+
+    // 0-1 planes to rgba truncating like fromHSV does ... alpha is taken from alphaFrom or is 255 if there is none
+    void Pack(const Planes& planes, size_t n, uint8_t* rgba, const uint8_t* alphaFrom)
+    {
+        for (size_t i = 0; i < n; i++) {
+            rgba[i * 4] = ToByte(planes.r[i]);
+            rgba[i * 4 + 1] = ToByte(planes.g[i]);
+            rgba[i * 4 + 2] = ToByte(planes.b[i]);
+            rgba[i * 4 + 3] = alphaFrom == nullptr ? 255 : alphaFrom[i * 4 + 3];
+        }
+    }
+
+    // xlColor::toHSV with its swaps turned into selects
+    void ToHSV(Planes& planes)
+    {
+        const vd zero = Set1(0.0);
+        const vd tiny = Set1(1e-20);
+        for (size_t i = 0; i < BLOCK; i += VW) {
+            vd r = Load(planes.r + i);
+            vd g = Load(planes.g + i);
+            vd b = Load(planes.b + i);
+
+            vm swap = Less(g, b);
+            vd K = Select(swap, Set1(-1.0), zero);
+            vd t = g;
+            g = Select(swap, b, g);
+            b = Select(swap, t, b);
+            vd minGB = b;
+
+            swap = Less(r, g);
+            K = Select(swap, Sub(Set1(-2.0 / 6.0), K), K);
+            minGB = Select(swap, Min(r, b), minGB);
+            t = r;
+            r = Select(swap, g, r);
+            g = Select(swap, t, g);
+
+            vd chroma = Sub(r, minGB);
+            Store(planes.h + i, Abs(Add(K, Div(Sub(g, b), Add(Mul(Set1(6.0), chroma), tiny)))));
+            Store(planes.s + i, Div(chroma, Add(r, tiny)));
+            Store(planes.v + i, r);
+        }
+    }
+
+    // xlColor::fromHSV with its switch turned into selects ... every channel is one of v, p,
+    // v(1 - s(1 - f)) or v(1 - sf) depending on the sector. Hues outside 0-1 fall into the default
+    // case just as they do in fromHSV, some effects rely on that
+    void FromHSV(Planes& planes)
+    {
+        const vd one = Set1(1.0);
+        for (size_t i = 0; i < BLOCK; i += VW) {
+            vd hue = Mul(Load(planes.h + i), Set1(6.0));
+            vd s = Load(planes.s + i);
+            vd v = Load(planes.v + i);
+            vd sector = Floor(hue);
+            vd f = Sub(hue, sector);
+            vd p = Mul(v, Sub(one, s));
+            vd rising = Mul(v, Sub(one, Mul(s, Sub(one, f))));
+            vd falling = Mul(v, Sub(one, Mul(s, f)));
+
+            vm s0 = Equal(sector, Set1(0.0));
+            vm s1 = Equal(sector, one);
+            vm s2 = Equal(sector, Set1(2.0));
+            vm s3 = Equal(sector, Set1(3.0));
+            vm s4 = Equal(sector, Set1(4.0));
+
+            Store(planes.r + i, Select(s1, falling, Select(Or(s2, s3), p, Select(s4, rising, v))));
+            Store(planes.g + i, Select(s0, rising, Select(Or(s1, s2), v, Select(s3, falling, p))));
+            Store(planes.b + i, Select(Or(s0, s1), p, Select(s2, rising, Select(Or(s3, s4), v, falling))));
+        }
+    }
+
+    // converts each block of pixels to HSV, lets adjust change the planes and converts back into dst
+    // ... src and dst can be the same as a block is read in full before any of it is written
+    template<typename ADJUST>
+    void AdjustBlocks(const uint8_t* src, uint8_t* dst, size_t count, ADJUST adjust)
+    {
+        Planes planes;
+        for (size_t start = 0; start < count; start += BLOCK) {
+            size_t n = std::min(BLOCK, count - start);
+            const uint8_t* s = src + start * 4;
+            Unpack(s, n, planes);
+            ToHSV(planes);
+            for (size_t i = 0; i < BLOCK; i += VW) {
+                adjust(planes, i);
+            }
+            FromHSV(planes);
+            Pack(planes, n, dst + start * 4, s);
+        }
+    }
+
+    void Copy(const uint8_t* src, uint8_t* dst, size_t count)
+    {
+        if (src != dst) std::copy(src, src + count * 4, dst);
+    }
+}
+
+#pragma endregion
+
+const char* ColorKernels::GetImplementation()
+{
+#if defined(COLOR_AVX2)
+    return "AVX2";
+#elif defined(COLOR_SSE2)
+    return "SSE2";
+#elif defined(COLOR_NEON)
+    return "NEON";
+#else
+    return "Scalar";
+#endif
+}
+
+void ColorKernels::RGBToHSV(const uint8_t* rgba, double* hue, double* saturation, double* value, size_t count)
+{
+    Planes planes;
+    for (size_t start = 0; start < count; start += BLOCK) {
+        size_t n = std::min(BLOCK, count - start);
+        Unpack(rgba + start * 4, n, planes);
+        ToHSV(planes);
+        std::copy(planes.h, planes.h + n, hue + start);
+        std::copy(planes.s, planes.s + n, saturation + start);
+        std::copy(planes.v, planes.v + n, value + start);
+    }
+}
+
+void ColorKernels::HSVToRGB(const double* hue, const double* saturation, const double* value, uint8_t* rgba, size_t count)
+{
+    Planes planes;
+    for (size_t start = 0; start < count; start += BLOCK) {
+        size_t n = std::min(BLOCK, count - start);
+        std::copy(hue + start, hue + start + n, planes.h);
+        std::copy(saturation + start, saturation + start + n, planes.s);
+        std::copy(value + start, value + start + n, planes.v);
+        std::fill(planes.h + n, planes.h + BLOCK, 0.0);
+        std::fill(planes.s + n, planes.s + BLOCK, 0.0);
+        std::fill(planes.v + n, planes.v + BLOCK, 0.0);
+        FromHSV(planes);
+        Pack(planes, n, rgba + start * 4, nullptr);
+    }
+}
+
+void ColorKernels::AdjustHSV(uint8_t* rgba, size_t count, double hueAdjust, double saturationAdjust, double valueAdjust)
+{
+    AdjustHSV(rgba, rgba, count, hueAdjust, saturationAdjust, valueAdjust);
+}
+
+void ColorKernels::AdjustHSV(const uint8_t* src, uint8_t* dst, size_t count, double hueAdjust, double saturationAdjust, double valueAdjust)
+{
+    if (hueAdjust == 0.0 && saturationAdjust == 0.0 && valueAdjust == 0.0) {
+        Copy(src, dst, count);
+        return;
+    }
+
+    const vd zero = Set1(0.0);
+    const vd one = Set1(1.0);
+    AdjustBlocks(src, dst, count, [&](Planes& planes, size_t i) {
+        // as in the render code the hue only wraps once and only when it was actually adjusted
+        if (hueAdjust != 0.0) {
+            vd h = Add(Load(planes.h + i), Set1(hueAdjust));
+            Store(planes.h + i, Select(Less(h, zero), Add(h, one), Select(Less(one, h), Sub(h, one), h)));
+        }
+        if (saturationAdjust != 0.0) {
+            Store(planes.s + i, Clamp01(Add(Load(planes.s + i), Set1(saturationAdjust))));
+        }
+        if (valueAdjust != 0.0) {
+            Store(planes.v + i, Clamp01(Add(Load(planes.v + i), Set1(valueAdjust))));
+        }
+    });
+}
+
+void ColorKernels::ApplyBrightnessContrast(uint8_t* rgba, size_t count, int brightness, int contrast)
+{
+    ApplyBrightnessContrast(rgba, rgba, count, brightness, contrast);
+}
+
+void ColorKernels::ApplyBrightnessContrast(const uint8_t* src, uint8_t* dst, size_t count, int brightness, int contrast)
+{
+    if (contrast != 0) {
+        // contrast pushes the value away from the middle so it has to go through HSV
+        const vd scale = Set1((double)brightness / 100.0);
+        const vd c = Set1((double)contrast / 100.0);
+        const vd half = Set1(0.5);
+        AdjustBlocks(src, dst, count, [&](Planes& planes, size_t i) {
+            vd v = Mul(Load(planes.v + i), scale);
+            vd change = Mul(v, c);
+            Store(planes.v + i, Clamp01(Select(Less(v, half), Sub(v, change), Add(v, change))));
+        });
+    } else if (brightness != 100) {
+        // brightness alone scales the channels directly ... simple enough for the compiler to vectorise
+        float ba = brightness;
+        ba /= 100.0f;
+        for (size_t i = 0; i < count; i++) {
+            const uint8_t* s = src + i * 4;
+            uint8_t* d = dst + i * 4;
+            for (int ch = 0; ch < 3; ch++) {
+                d[ch] = (uint8_t)std::max(std::min((int)(s[ch] * ba), 255), 0);
+            }
+            d[3] = s[3];
+        }
+    } else {
+        Copy(src, dst, count);
+    }
+}
+
+void ColorKernels::ScaleValue(uint8_t* rgba, size_t count, double factor)
+{
+    const vd scale = Set1(factor);
+    AdjustBlocks(rgba, rgba, count, [&](Planes& planes, size_t i) {
+        Store(planes.v + i, Mul(Load(planes.v + i), scale));
+    });
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+/***************************************************************
+ * This source files comes from the xLights project
+ * https://www.xlights.org
+ * https://github.com/smeighan/xLights
+ * See the github commit history for a record of contributing
+ * developers.
+ * Copyright claimed based on commit dates recorded in Github
+ * License: https://github.com/smeighan/xLights/blob/master/License.txt
+ **************************************************************/
+
+// Batch HSV colour kernels for the render path.
+// This file must not depend on wxWidgets.
+//
+// Pixels are 4 bytes each in xlColor order (red, green, blue, alpha) so an xlColorVector can be
+// passed straight in. The kernels use the widest instruction set the compiler is targeting (AVX2,
+// SSE2 or NEON, otherwise plain C++). They work in double precision and do the same arithmetic as
+// xlColor::toHSV/fromHSV so they produce the same bytes. Single precision is not good enough as
+// fromHSV jumps between colours at the sector boundaries (and treats hues outside 0-1 as its last
+// sector) so a rounding difference there is a different colour, not an off by one.
+
+#include <cstdint>
+#include <cstddef>
+
+namespace ColorKernels
+{
+    // name of the instruction set the kernels were compiled for ... for logging
+    const char* GetImplementation();
+
+    // hue, saturation and value are 0-1 like HSVValue
+    void RGBToHSV(const uint8_t* rgba, double* hue, double* saturation, double* value, size_t count);
+    // alpha is set to 255 as assigning an HSVValue to an xlColor does
+    void HSVToRGB(const double* hue, const double* saturation, const double* value, uint8_t* rgba, size_t count);
+
+    // the following keep alpha ... they work in place or from src into dst (which may be the same buffer)
+
+    // the layer hue/saturation/value adjustment ... the hue wraps, saturation and value are clamped to 0-1
+    void AdjustHSV(uint8_t* rgba, size_t count, double hueAdjust, double saturationAdjust, double valueAdjust);
+    void AdjustHSV(const uint8_t* src, uint8_t* dst, size_t count, double hueAdjust, double saturationAdjust, double valueAdjust);
+    // the layer brightness (percent, 100 is unchanged) and contrast (-100 to 100)
+    void ApplyBrightnessContrast(uint8_t* rgba, size_t count, int brightness, int contrast);
+    void ApplyBrightnessContrast(const uint8_t* src, uint8_t* dst, size_t count, int brightness, int contrast);
+    // multiplies the HSV value by factor
+    void ScaleValue(uint8_t* rgba, size_t count, double factor);
+}
@@ -85,3 +85,28 @@ void DataLayerSet::MoveLayerDown(int index)
         mDataLayers[index] = tmp;
     }
 }
+
+SequenceData* DataLayerSet::GetMergedLayers(bool bottom, const std::string& key)
+{
+    int i = bottom ? 0 : 1;
+    if (mMerged[i] == nullptr || mMergedKey[i] != key) {
+        return nullptr;
+    }
+    return mMerged[i].get();
+}
+
+SequenceData* DataLayerSet::SetMergedLayers(bool bottom, const std::string& key, std::unique_ptr<SequenceData> data)
+{
+    int i = bottom ? 0 : 1;
+    mMergedKey[i] = key;
+    mMerged[i] = std::move(data);
+    return mMerged[i].get();
+}
+
+void DataLayerSet::ClearMergedLayers()
+{
+    for (int i = 0; i < 2; i++) {
+        mMergedKey[i] = "";
+        mMerged[i].reset();
+    }
+}
@@ -11,6 +11,8 @@
  **************************************************************/
 
 #include <wx/string.h>
+#include <memory>
+#include <string>
 #include <vector>
 #include "SequenceData.h"
 
@@ -70,7 +72,16 @@ class DataLayerSet
         void MoveLayerUp( int index );
         void MoveLayerDown( int index );
 
+        // the layers below (bottom) or above the Nutcracker layer already merged so render all does not
+        // have to read them again. The key describes the layers and files the merge was built from ...
+        // nullptr if there is nothing cached for that key
+        SequenceData* GetMergedLayers(bool bottom, const std::string& key);
+        SequenceData* SetMergedLayers(bool bottom, const std::string& key, std::unique_ptr<SequenceData> data);
+        void ClearMergedLayers();
+
     private:
         std::vector<DataLayer*> mDataLayers;
+        std::string mMergedKey[2];
+        std::unique_ptr<SequenceData> mMerged[2];
 };
 
@@ -9,6 +9,8 @@
  **************************************************************/
 
 #include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <map>
 
 #include <wx/app.h>
@@ -23,6 +25,7 @@
 #include "FSEQFile.h"
 #include "FileConverter.h"
 #include "UtilFunctions.h"
+#include "Parallel.h"
 #include "outputs/OutputManager.h"
 #include "outputs/Controller.h"
 #ifndef FPP
@@ -36,6 +39,8 @@
 #include <log4cpp/Category.hh>
 
 static const int MAX_READ_BLOCK_SIZE = 4096 * 1024;
+// fewest frames worth handing to a job when merging data layers
+static const uint32_t MERGE_MIN_FRAMES = 100;
 
 void ConvertParameters::AppendConvertStatus(const wxString& msg, bool flushbuffer)
 {
@@ -1618,11 +1623,148 @@ void FileConverter::ReadFalconFile(ConvertParameters& params)
     delete file;
 }
 
+void FileConverter::MergeIgnoreBlack(FrameData& dst, uint32_t dstStart, const uint8_t* src, uint32_t count)
+{
+    // skip the leading black a word at a time so layers which are black for the frame cost next to nothing
+    uint32_t i = 0;
+    while (i + sizeof(uint64_t) <= count) {
+        uint64_t v;
+        memcpy(&v, &src[i], sizeof(v));
+        if (v != 0) break;
+        i += sizeof(uint64_t);
+    }
+    while (i < count && src[i] == 0) {
+        i++;
+    }
+    if (i == count) return;
+
+    uint8_t* d = &dst[dstStart + i];
+    const uint8_t* s = &src[i];
+    count -= i;
+    // kept branch free so the compiler turns it into vector compares and blends
+    for (uint32_t j = 0; j < count; j++) {
+        d[j] = s[j] != 0 ? s[j] : d[j];
+    }
+}
+
+bool FileConverter::MergeDataLayers(const std::vector<DataLayer*>& layers, SequenceData& seq_data, xLightsFrame* xLightsFrm, ConvertLogDialog* plog)
+{
+    static log4cpp::Category &logger_conversion = log4cpp::Category::getInstance(std::string("log_conversion"));
+
+    struct LayerWindow
+    {
+        std::string file;
+        uint32_t channels; // in the file
+        uint32_t frames;   // which fit in the sequence
+        uint32_t first;    // first file channel which lands in the sequence
+        uint32_t count;
+        int offset;
+    };
+
+    // read the headers up front so every job knows which channels of each layer it needs
+    bool ok = true;
+    uint32_t frames = 0;
+    std::vector<LayerWindow> windows;
+    for (auto layer : layers) {
+        FSEQFile *file = FSEQFile::openFSEQFile(layer->GetDataSource().ToStdString());
+        if (!file) {
+            logger_conversion.debug("Unable to load sequence: %s.", (const char *)layer->GetDataSource().c_str());
+            ConvertParameters params(layer->GetDataSource(), seq_data, nullptr, ConvertParameters::READ_MODE_IGNORE_BLACK, xLightsFrm, nullptr, plog);
+            params.PlayerError(wxString("Unable to load sequence:\n") + layer->GetDataSource());
+            ok = false;
+            continue;
+        }
+        int numChannels = file->getMaxChannel();
+        int layerFrames = 0;
+        if (numChannels > 0) layerFrames = file->getNumFrames();
+        layer->SetNumFrames(layerFrames);
+        layer->SetNumChannels(numChannels);
+        delete file;
+
+        int offset = layer->GetChannelOffset();
+        int64_t first = std::max(0, -offset);
+        int64_t last = std::min((int64_t)numChannels, (int64_t)seq_data.NumChannels() - offset);
+        if (last <= first || layerFrames <= 0) continue;
+
+        LayerWindow w;
+        w.file = layer->GetDataSource().ToStdString();
+        w.channels = numChannels;
+        w.frames = std::min((uint32_t)layerFrames, seq_data.NumFrames());
+        w.first = first;
+        w.count = last - first;
+        w.offset = offset;
+        windows.push_back(w);
+        frames = std::max(frames, w.frames);
+    }
+    if (windows.empty()) return ok;
+
+    // each job works through its own range of frames holding its own handle on every layer. Within the
+    // range the layers are still applied bottom up and reads stay sequential so compressed blocks are
+    // mostly only decompressed once
+    int jobs = std::max(1, std::min(ParallelJobPool::POOL.maxSize() * 2, (int)(frames / MERGE_MIN_FRAMES)));
+    uint32_t perJob = (frames + jobs - 1) / jobs;
+    std::atomic<bool> corrupt(false);
+    parallel_for(0, jobs, [&](int job) {
+        uint32_t start = job * perJob;
+        uint32_t end = std::min(frames, start + perJob);
+        std::vector<uint8_t> buf;
+        for (auto& w : windows) {
+            uint32_t wend = std::min(end, w.frames);
+            if (start >= wend) continue;
+
+            FSEQFile *file = FSEQFile::openFSEQFile(w.file);
+            if (!file) {
+                corrupt = true;
+                continue;
+            }
+            std::vector<std::pair<uint32_t, uint32_t>> rng;
+            rng.push_back(std::pair<uint32_t, uint32_t>(w.first, w.count));
+            file->prepareRead(rng, start);
+            // sparse files only fill their own ranges so nothing may be left over from the last layer
+            buf.assign(w.channels, 0);
+
+            for (uint32_t f = start; f < wend; f++) {
+                FSEQFile::FrameData *data = file->getFrame(f);
+                if (data == nullptr) break;
+                if (data->readFrame(&buf[0], w.channels)) {
+                    MergeIgnoreBlack(seq_data[f], w.first + w.offset, &buf[w.first], w.count);
+                } else {
+                    corrupt = true;
+                }
+                delete data;
+            }
+            delete file;
+        }
+    }, 1);
+
+    if (corrupt) {
+        // fseq file corrupt
+        logger_conversion.error("FSEQ file seems to be corrupt.");
+    }
+    return ok && !corrupt;
+}
+
 void FileConverter::WriteFalconPiFile(ConvertParameters& params)
 {
     static log4cpp::Category &logger_conversion = log4cpp::Category::getInstance(std::string("log_conversion"));
     logger_conversion.debug("Start fseq write");
-       
+
+    FSEQFile* file = CreateFalconPiFile(params);
+    if (file == nullptr) {
+        return;
+    }
+    size_t size = params.seq_data.NumFrames();
+    for (int x = 0; x < size; x++) {
+        const FrameData& frame(params.seq_data[x]);
+        file->addFrame(x, frame[0]);
+    }
+    file->finalize();
+    delete file;
+    logger_conversion.debug("End fseq write");
+}
+
+FSEQFile* FileConverter::CreateFalconPiFile(ConvertParameters& params)
+{
     const wxUint8 fType = params.xLightsFrm->_fseqVersion;
     int vMajor = 2;
     int clevel = 2;
@@ -1645,7 +1787,7 @@ void FileConverter::WriteFalconPiFile(ConvertParameters& params)
     FSEQFile *file = FSEQFile::createFSEQFile(params.out_filename, vMajor, ctype, clevel);
     if (!file) {
         params.ConversionError(wxString("Unable to create file: ") + params.out_filename + ". Check directory and file permissions.");
-        return;
+        return nullptr;
     }
     size_t stepSize = roundTo4(params.seq_data.NumChannels());
     wxUint16 stepTime = params.seq_data.FrameTime();
@@ -1675,11 +1817,5 @@ void FileConverter::WriteFalconPiFile(ConvertParameters& params)
     file->addVariableHeader(header);
 
     file->writeHeader();
-    size_t size = params.seq_data.NumFrames();
-    for (int x = 0; x < size; x++) {
-        file->addFrame(x, &params.seq_data[x][0]);
-    }
-    file->finalize();
-    delete file;
-    logger_conversion.debug("End fseq write");
+    return file;
 }
@@ -20,6 +20,7 @@
 #include "Color.h"
 
 class xLightsFrame; // forward declare to prevent including the world
+class FSEQFile;
 class ConvertDialog;
 class ConvertLogDialog;
 class OutputManager;
@@ -86,7 +87,15 @@ class FileConverter
         static void ReadGlediatorFile(ConvertParameters& params);
         static void ReadConductorFile(ConvertParameters& params);
         static void ReadFalconFile(ConvertParameters& params);
+        // reads the data layers, listed bottom up, into seq_data. Black channels in a layer leave the
+        // channels under them alone. Ranges of frames are read in parallel with each job holding its own
+        // handle on every layer. Returns false if any layer could not be read
+        static bool MergeDataLayers(const std::vector<DataLayer*>& layers, SequenceData& seq_data, xLightsFrame* xLightsFrm, ConvertLogDialog* plog);
+        // copies the non zero channels in src over dst starting at dstStart. A frame that is all black in src is not touched
+        static void MergeIgnoreBlack(FrameData& dst, uint32_t dstStart, const uint8_t* src, uint32_t count);
         static void WriteFalconPiFile(ConvertParameters& params);
+        // creates the fseq and writes its header ready for the frames to be added ... nullptr on failure
+        static FSEQFile* CreateFalconPiFile(ConvertParameters& params);
 
     
         static bool LoadVixenProfile(ConvertParameters& params, const wxString& ProfileName,
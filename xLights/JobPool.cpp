@@ -263,14 +263,17 @@ void JobPoolWorker::ProcessJob(Job *job)
 		logger_jobpool.debug("Starting job on background thread.");
 		currentJob = job;
         
+        // a job can requeue itself from inside Process and be finished and deleted by another
+        // thread before Process returns here so job must not be touched once it has been called
         std::string origName;
-        if (job->SetThreadName()) {
+        bool setThreadName = job->SetThreadName();
+        if (setThreadName) {
             origName = OriginalThreadName();
             SetThreadName(job->GetName());
         }
         bool deleteWhenComplete = job->DeleteWhenComplete();
         job->Process();
-        if (job->SetThreadName()) {
+        if (setThreadName) {
             SetThreadName(origName);
         }
         currentJob = nullptr;
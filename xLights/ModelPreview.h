@@ -76,9 +76,8 @@ public:
 	void SetbackgroundImage(wxString image);
     const wxString &GetBackgroundImage() const { return mBackgroundImage;}
 	void SetBackgroundBrightness(int brightness, int alpha);
-/*
     int GetBackgroundBrightness() const { return mBackgroundBrightness;}
-     */
+    int GetBackgroundAlpha() const { return mBackgroundAlpha;}
     void SetScaleBackgroundImage(bool b);
     bool GetScaleBackgroundImage() const { return scaleImage; }
 
@@ -131,6 +130,8 @@ public:
     void SetCamera3D(int i);
     void SetDisplay2DBoundingBox(bool bb) { _display2DBox = bb; }
     void SetDisplay2DCenter0(bool bb) { _center2D0 = bb; }
+    bool GetDisplay2DCenter0() const { return _center2D0; }
+    const PreviewCamera& GetActiveCamera() const { return is_3d ? *camera3d : *camera2d; }
 
     bool IsNoCurrentModel() { return currentModel == "&---none---&"; }
     void SetRenderOrder(int i) { renderOrder = i; Refresh(); }
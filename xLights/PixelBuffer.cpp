@@ -24,6 +24,7 @@
 #include "Parallel.h"
 #include "UtilFunctions.h"
 #include "DissolveTransitionPattern.h"
+#include "ColorKernels.h"
 
 // This is needed for visual studio
 #ifdef _MSC_VER
@@ -1160,6 +1161,7 @@ void PixelBufferClass::GetMixedColor(int node, const std::vector<bool> & validLa
                 auto &coord = thelayer->buffer.Nodes[node]->Coords[0];
                 int x = coord.bufX;
                 int y = coord.bufY;
+                bool adjusted = false;
 
                 if (thelayer->isMasked(x, y)
                     || x < 0
@@ -1168,12 +1170,14 @@ void PixelBufferClass::GetMixedColor(int node, const std::vector<bool> & validLa
                     || y >= thelayer->BufferHt
                     ) {
                     color.Set(0, 0, 0, 0);
+                } else if (thelayer->getAdjustedPixel(x, y, color)) {
+                    adjusted = true;
                 } else {
                     thelayer->buffer.GetPixel(x, y, color);
                 }
 
                 // adjust for HSV adjustments
-                if (thelayer->needsHSVAdjust) {
+                if (thelayer->needsHSVAdjust && !(adjusted && thelayer->adjustedHSV)) {
                     HSVValue hsv = color.asHSV();
 
                     if (thelayer->outputHueAdjust != 0) {
@@ -1239,7 +1243,9 @@ void PixelBufferClass::GetMixedColor(int node, const std::vector<bool> & validLa
                     sparkle++;
                 }
                 int b = thelayer->outputBrightnessAdjust;
-                if (thelayer->contrast != 0) {
+                if (adjusted && thelayer->adjustedBrightness) {
+                    // already applied
+                } else if (thelayer->contrast != 0) {
                     //contrast is not 0, can handle brightness change at same time
                     HSVValue hsv = color.asHSV();
                     hsv.value = hsv.value * ((double)b / 100.0);
@@ -2834,6 +2840,11 @@ void PixelBufferClass::CalcOutput(int EffectPeriod, const std::vector<bool> & va
 
     // layer calculation and map to output
     size_t NodeCount = layers[0]->buffer.Nodes.size();
+    for (int ii = 0; ii < numLayers; ii++) {
+        if (validLayers[ii]) {
+            layers[ii]->calculateAdjustedPixels(NodeCount);
+        }
+    }
     int countValid = 0;
     for (auto x : validLayers) {
         if (x) {
@@ -3612,6 +3623,58 @@ void PixelBufferClass::LayerInfo::calculateNodeOutputParams(int EffectPeriod) {
 }
 
 
+static_assert(sizeof(xlColor) == 4, "The colour kernels treat an xlColorVector as packed rgba bytes");
+
+// The per node HSV adjustment was a full RGB -> HSV -> RGB round trip per node per layer. Doing the
+// whole buffer in one pass lets the colour kernels convert several pixels at once.
+void PixelBufferClass::LayerInfo::calculateAdjustedPixels(size_t nodeCount) {
+    // sparkles are added between the HSV adjustment and the brightness so only then can both be done here
+    bool sparkles = use_music_sparkle_count || sparkle_count > 0 || outputSparkleCount > 0;
+    adjustedHSV = needsHSVAdjust;
+    adjustedBrightness = !sparkles && (contrast != 0 || outputBrightnessAdjust != 100);
+
+    // not worth it when most of the buffer is never mapped to a node
+    if ((!adjustedHSV && !adjustedBrightness) || buffer.pixels.size() > nodeCount * 2) {
+        adjustedHSV = false;
+        adjustedBrightness = false;
+        return;
+    }
+
+    // the buffer itself cannot be changed as persistent effects draw over the last frame so the kernels
+    // read it and write into adjustedPixels which is kept from frame to frame
+    size_t count = buffer.pixels.size();
+    if (adjustedPixels.size() != count) {
+        adjustedPixels.resize(count);
+    }
+    static const int CHUNK = 4096;
+    parallel_for(0, (count + CHUNK - 1) / CHUNK, [this, count](int c) {
+        size_t start = (size_t)c * CHUNK;
+        size_t n = std::min((size_t)CHUNK, count - start);
+        const uint8_t* src = &buffer.pixels[start].red;
+        uint8_t* dst = &adjustedPixels[start].red;
+        if (adjustedHSV) {
+            ColorKernels::AdjustHSV(src, dst, n, outputHueAdjust, outputSaturationAdjust, outputValueAdjust);
+            src = dst;
+        }
+        if (adjustedBrightness) {
+            ColorKernels::ApplyBrightnessContrast(src, dst, n, outputBrightnessAdjust, contrast);
+        }
+    });
+}
+
+bool PixelBufferClass::LayerInfo::getAdjustedPixel(int x, int y, xlColor& color) const {
+    if (!adjustedHSV && !adjustedBrightness) {
+        return false;
+    }
+    // same checks as RenderBuffer::GetPixel ... anything it would turn black goes the slow way
+    size_t pidx = (size_t)y * buffer.BufferWi + x;
+    if (x >= 0 && x < buffer.BufferWi && y >= 0 && y < buffer.BufferHt && pidx < adjustedPixels.size()) {
+        color = adjustedPixels[pidx];
+        return true;
+    }
+    return false;
+}
+
 bool PixelBufferClass::LayerInfo::isMasked(int x, int y) {
     int idx = x*BufferHt + y;
     if (idx < mask.size()) {
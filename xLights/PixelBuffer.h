@@ -226,7 +226,16 @@ private:
         int   outputBrightnessAdjust = 0;
         float outputEffectMixThreshold;
         
+        // the buffer with the HSV adjustment and, when no sparkles sit between them, the brightness
+        // and contrast already applied ... worked out once per frame by calculateAdjustedPixels. It is kept
+        // between frames to save reallocating it and only holds this frame when one of the flags is set
+        xlColorVector adjustedPixels;
+        bool adjustedHSV = false;
+        bool adjustedBrightness = false;
+
         void calculateNodeOutputParams(int effectPeriod);
+        void calculateAdjustedPixels(size_t nodeCount);
+        bool getAdjustedPixel(int x, int y, xlColor& color) const;
 
     private:
         void createSquareExplodeMask(bool end);
@@ -12,6 +12,8 @@
 #include <condition_variable>
 #include <map>
 #include <memory>
+#include <algorithm>
+#include <list>
 
 #include "xLightsMain.h"
 #include "xLightsXmlFile.h"
@@ -25,11 +27,19 @@
 #include "UtilFunctions.h"
 #include "PixelBuffer.h"
 #include "Parallel.h"
+#include "SharedRenderFrames.h"
+#include "SpecialOptions.h"
 
 #include <log4cpp/Category.hh>
 
 #define END_OF_RENDER_FRAME INT_MAX
 
+// stateful effects save their render state no more than this many times and no more often than
+// every MIN_CHECKPOINT_FRAMES frames so the memory used by an effect's checkpoints is bounded ...
+// the checkpoints of all effects together are also limited by the special option EffectCheckpointMB
+#define MAX_EFFECT_CHECKPOINTS 16
+#define MIN_CHECKPOINT_FRAMES 20
+
 //other common strings
 static const std::string STR_EMPTY("");
 
@@ -53,6 +63,7 @@ public:
         currentEffects.resize(l);
         currentEffectIdxs.resize(l);
         settingsMaps.resize(l);
+        checkpointGenerations.resize(l);
         effectStates.resize(l);
         validLayers.resize(l + 1); //extra one for the blending layer
     }
@@ -64,6 +75,7 @@ public:
     std::vector<Effect*> currentEffects;
     std::vector<int> currentEffectIdxs;
     std::vector<SettingsMap> settingsMaps;
+    std::vector<int> checkpointGenerations; // of the effect when its settings were loaded
     std::vector<bool> effectStates;
     std::vector<bool> validLayers;
 };
@@ -82,6 +94,7 @@ public:
     bool *ResetEffectState;
     bool returnVal = true;
     bool suppress = false;
+    SharedRenderFrames* sharedFrames = nullptr;
 };
 
 class NextRenderer {
@@ -220,6 +233,36 @@ public:
 };
 
 
+class RenderJob;
+
+// The frames a windowed render may get ahead to. A job which reaches the end of the window, or a frame
+// the model it depends on has not rendered yet, is suspended here and gives its pool thread back. The
+// pool is capped so jobs sleeping on their threads could stop the jobs they are waiting on from ever
+// starting. Suspended jobs are pushed back onto the pool as soon as they can carry on.
+class RenderWindow {
+public:
+    RenderWindow(JobPool& p, int end) : pool(p), windowEnd(end), suspensions(0) {}
+
+    int GetEnd() const { return windowEnd; }
+    void SetEnd(int end) {
+        windowEnd = end;
+        Wake();
+    }
+    int GetSuspensions() const { return suspensions; }
+
+    // returns false if the job can carry on after all
+    bool Suspend(RenderJob* job);
+    // requeues the suspended jobs which can now carry on
+    void Wake();
+
+private:
+    JobPool& pool;
+    std::atomic_int windowEnd;
+    std::atomic_int suspensions;
+    std::mutex lock;
+    std::list<RenderJob*> suspended;
+};
+
 class RenderJob: public Job, public NextRenderer {
 public:
     RenderJob(ModelElement *row, SequenceData &data, xLightsFrame *xframe, bool zeroBased = false)
@@ -244,7 +287,9 @@ public:
                             static const std::string CHOICE_BufferStyle("B_CHOICE_BufferStyle");
                             static const std::string DEFAULT("Default");
                             static const std::string PER_MODEL("Per Model");
-                            const std::string &bt = layer->GetEffect(e)->GetSettings().Get(CHOICE_BufferStyle, DEFAULT);
+                            const Effect* ef = layer->GetEffect(e);
+                            auto settings = ef->GetSettingsPtr();
+                            const std::string &bt = settings->Get(CHOICE_BufferStyle, DEFAULT);
                             if (bt.compare(0, 9, PER_MODEL) == 0) {
                                 perModelEffects = true;
                             }
@@ -318,6 +363,9 @@ public:
     int GetCurrentFrame() const { return currentFrame;}
     int GetEndFrame() const { return endFrame;}
     int GetStartFrame() const { return startFrame;}
+    // in a windowed render the job suspends rather than render frames past the end of the window
+    void SetRenderWindow(RenderWindow* window) { renderWindow = window; }
+    void SetSharedFrames(SharedRenderFrames* frames) { renderEvent.sharedFrames = frames; }
 
     const std::string GetName() const override {
         return name;
@@ -543,6 +591,7 @@ public:
             if (ef != info.currentEffects[layer]) {
                 info.currentEffects[layer] = ef;
                 SetInializingStatus(frame, layer, strand);
+                info.checkpointGenerations[layer] = ef == nullptr ? 0 : ef->GetCheckpointGeneration();
                 initialize(layer, frame, ef, info.settingsMaps[layer], buffer);
                 info.effectStates[layer] = true;
             }
@@ -571,6 +620,7 @@ public:
 
             SetRenderingStatus(frame, &info.settingsMaps[layer], layer, strand, -1, true);
             bool b = info.effectStates[layer];
+            bool reset = b;
 
             if (!freeze)
             {
@@ -625,6 +675,10 @@ public:
                 effectsToUpdate |= info.validLayers[layer];
                 info.effectStates[layer] = b;
 
+                if (buffer == mainBuffer && !suppress) {
+                    SaveCheckpoint(frame, layer, ef, info, reset);
+                }
+
                 if (suppress)
                 {
                     info.validLayers[layer] = false;
@@ -658,25 +712,64 @@ public:
     }
 
     virtual void Process() override {
-        static log4cpp::Category& logger_base = log4cpp::Category::getInstance(std::string("log_base"));
         static log4cpp::Category& logger_jobpool = log4cpp::Category::getInstance(std::string("log_jobpool"));
         logger_jobpool.debug("Render job thread id 0x%x or %d", wxThread::GetCurrentId(), wxThread::GetCurrentId());
 
-        SetGenericStatus("Initializing rendering thread for %s", 0);
-        int maxFrameBeforeCheck = -1;
-        int origChangeCount;
-        int ss, es;
+        std::unique_lock<std::recursive_timed_mutex> lock(rowToRender->GetRenderLock(), std::defer_lock);
+        if (!started) {
+            SetGenericStatus("Initializing rendering thread for %s", 0);
 
-        rowToRender->IncWaitCount();
-        std::unique_lock<std::recursive_timed_mutex> lock(rowToRender->GetRenderLock());
-        if (rowToRender->DecWaitCount() && !HasNext()) {
-            // other threads for this model waiting, we'll bail fast and let them handle this
-            renderLog.debug("Rendering thread exiting early.");
-            currentFrame = END_OF_RENDER_FRAME; // this is needed otherwise the job does not look done
-            return;
+            rowToRender->IncWaitCount();
+            lock.lock();
+            if (rowToRender->DecWaitCount() && !HasNext()) {
+                // other threads for this model waiting, we'll bail fast and let them handle this
+                renderLog.debug("Rendering thread exiting early.");
+                currentFrame = END_OF_RENDER_FRAME; // this is needed otherwise the job does not look done
+                return;
+            }
+            SetGenericStatus("Got lock on rendering thread for %s", 0);
+            StartRender();
+            started = true;
+        } else {
+            lock.lock();
+            rowToRender->DecWaitCount();
+        }
+
+        // in a windowed render the job gives its pool thread back rather than wait
+        while (RenderFrames()) {
+            // the wait count stays up while suspended so another render of this model backs off rather
+            // than take the lock from under us
+            rowToRender->IncWaitCount();
+            lock.unlock();
+            if (renderWindow->Suspend(this)) {
+                // it is pushed back onto the pool when it can carry on
+                return;
+            }
+            lock.lock();
+            rowToRender->DecWaitCount();
         }
-        SetGenericStatus("Got lock on rendering thread for %s", 0);
 
+        FinishRender();
+    }
+
+    // in a windowed render a suspended job is pushed back onto the pool once this is true
+    bool CanResume() {
+        return CanRenderFrame(nextFrame);
+    }
+
+    void AbortRender() {
+        abort = true;
+        if (renderWindow != nullptr) {
+            renderWindow->Wake();
+        }
+    }
+
+    ModelElement* GetModelElement() const { return rowToRender; }
+
+private:
+
+    void StartRender() {
+        int ss, es;
         rowToRender->GetAndResetDirtyRange(origChangeCount, ss, es);
         if (ss != -1) {
             //expand to cover the whole dirty range
@@ -698,25 +791,49 @@ public:
         if (startFrame < 0) startFrame = 0;
         if (endFrame > seqData->NumFrames()) endFrame = seqData->NumFrames() - 1;
 
-        EffectLayerInfo mainModelInfo(numLayers);
-        std::map<SNPair, Effect*> nodeEffects;
-        std::map<SNPair, SettingsMap> nodeSettingsMaps;
-        std::map<SNPair, bool> nodeEffectStates;
-        std::map<SNPair, int> nodeEffectIdxs;
+        mainModelInfo.resize(numLayers);
+        nextFrame = startFrame;
+        maxFrameBeforeCheck = -1;
+    }
+
+    // the frame can be rendered without waiting for the render window or the models this one depends on
+    bool CanRenderFrame(int frame) {
+        if (abort) {
+            return true;
+        }
+        if (frame > endFrame) {
+            return !HasNext() || checkIfDone(END_OF_RENDER_FRAME);
+        }
+        return frame <= renderWindow->GetEnd() && (frame < maxFrameBeforeCheck || checkIfDone(frame));
+    }
+
+    // renders from nextFrame on ... returns true if it stopped where a windowed render would have to wait
+    bool RenderFrames() {
+        static log4cpp::Category& logger_base = log4cpp::Category::getInstance(std::string("log_base"));
 
         try {
-            //for (int layer = 0; layer < numLayers; ++layer) {
-            for (int layer = numLayers - 1; layer >= 0; --layer) {
-                SetGenericStatus("Finding starting effect for %s, startFrame %d, and layer %d ", (int)startFrame, layer, false, true);
-                EffectLayer *elayer = rowToRender->GetEffectLayer(layer);
-                std::unique_lock<std::recursive_mutex> elock(elayer->GetLock());
-                mainModelInfo.currentEffects[layer] = findEffectForFrame(elayer, startFrame, mainModelInfo.currentEffectIdxs[layer]);
-                SetGenericStatus("Initializing starting effect for %s, startFrame %d, and layer %d ", (int)startFrame, layer, false, true);
-                initialize(layer, startFrame, mainModelInfo.currentEffects[layer], mainModelInfo.settingsMaps[layer], mainBuffer);
-                mainModelInfo.effectStates[layer] = true;
-            }
-
-            for (int frame = startFrame; frame <= endFrame; ++frame) {
+            if (!layersInitialised) {
+                layersInitialised = true;
+                //for (int layer = 0; layer < numLayers; ++layer) {
+                for (int layer = numLayers - 1; layer >= 0; --layer) {
+                    SetGenericStatus("Finding starting effect for %s, startFrame %d, and layer %d ", (int)startFrame, layer, false, true);
+                    EffectLayer *elayer = rowToRender->GetEffectLayer(layer);
+                    std::unique_lock<std::recursive_mutex> elock(elayer->GetLock());
+                    mainModelInfo.currentEffects[layer] = findEffectForFrame(elayer, startFrame, mainModelInfo.currentEffectIdxs[layer]);
+                    SetGenericStatus("Initializing starting effect for %s, startFrame %d, and layer %d ", (int)startFrame, layer, false, true);
+                    Effect* ef = mainModelInfo.currentEffects[layer];
+                    mainModelInfo.checkpointGenerations[layer] = ef == nullptr ? 0 : ef->GetCheckpointGeneration();
+                    initialize(layer, startFrame, ef, mainModelInfo.settingsMaps[layer], mainBuffer);
+                    mainModelInfo.effectStates[layer] = true;
+
+                    // if we are starting part way through an effect try to pick up where a previous render left off
+                    if (ResumeFromCheckpoint(layer, mainModelInfo.currentEffects[layer], mainModelInfo)) {
+                        mainModelInfo.effectStates[layer] = false;
+                    }
+                }
+            }
+
+            for (int frame = nextFrame; frame <= endFrame; ++frame) {
                 currentFrame = frame;
                 SetGenericStatus("%s: Starting frame %d ", frame, true, true);
 
@@ -724,6 +841,12 @@ public:
                     break;
                 }
 
+                if (renderWindow != nullptr && !CanRenderFrame(frame)) {
+                    SetGenericStatus("%s: Waiting to render frame %d ", frame, true);
+                    nextFrame = frame;
+                    return true;
+                }
+
                 if (!HasNext() &&
                         (origChangeCount != rowToRender->getChangeCount()
                          || rowToRender->GetWaitCount())) {
@@ -798,6 +921,9 @@ public:
                 if (HasNext()) {
                     SetGenericStatus("%s: Notifying next renderer of frame %d done", frame);
                     FrameDone(frame);
+                    if (renderWindow != nullptr) {
+                        renderWindow->Wake();
+                    }
                 }
             }
             SetGenericStatus("%s: All done - Completed frame %d ", endFrame, true, true);
@@ -812,6 +938,16 @@ public:
 			renderLog.error("Caught an unknown exception on rendering thread.");
             logger_base.error("Caught an unknown exception on rendering thread.");
         }
+
+        if (renderWindow != nullptr && !CanRenderFrame(endFrame + 1)) {
+            // the model this one depends on has not finished yet
+            nextFrame = endFrame + 1;
+            return true;
+        }
+        return false;
+    }
+
+    void FinishRender() {
         if (HasNext()) {
             //make sure the previous has told us we're at the end.  If we return before waiting, the previous
             //may try sending the END_OF_RENDER_FRAME to us and we'll have been deleted
@@ -821,6 +957,9 @@ public:
             //let the next know we're done
             SetGenericStatus("%s: Notifying next renderer of final frame", 0);
             FrameDone(END_OF_RENDER_FRAME);
+            if (renderWindow != nullptr) {
+                renderWindow->Wake();
+            }
             xLights->CallAfter(&xLightsFrame::SetStatusText, wxString("Done Rendering \"" + rowToRender->GetModelName() + "\""), 0);
         } else {
             xLights->CallAfter(&xLightsFrame::RenderDone);
@@ -829,16 +968,8 @@ public:
         currentFrame = END_OF_RENDER_FRAME;
         //printf("Done rendering %lx (next %lx)\n", (unsigned long)this, (unsigned long)next);
 		renderLog.debug("Rendering thread exiting.");
-	}
-
-    void AbortRender() {
-        abort = true;
     }
 
-    ModelElement* GetModelElement() const { return rowToRender; }
-
-private:
-
     void initialize(int layer, int frame, Effect *el, SettingsMap &settingsMap, PixelBufferClass *buffer) {
         if (el == nullptr || el->GetEffectIndex() == -1) {
             settingsMap.clear();
@@ -877,6 +1008,110 @@ private:
         return findEffectForFrame(rowToRender->GetEffectLayer(layer), frame, lastIdx);
     }
 
+    // the effect if its render state can be checkpointed on this layer
+    RenderableEffect* GetCheckpointEffect(int layer, Effect* ef, const SettingsMap& settings) const {
+        if (ef == nullptr || ef->GetEffectIndex() == -1 || mainBuffer->IsCanvasMix(layer)) {
+            // canvas layers depend on the layers below them as well as their own state
+            return nullptr;
+        }
+        RenderableEffect* reff = xLights->GetEffectManager().GetEffect(ef->GetEffectIndex());
+        if (reff == nullptr || (xLights->_renderCache.IsEnabled() && reff->SupportsRenderCache(settings))) {
+            // frames which come out of the render cache don't move the effect state on
+            return nullptr;
+        }
+        return reff;
+    }
+
+    void SaveCheckpoint(int frame, int layer, Effect* ef, EffectLayerInfo& info, bool reset) {
+        if (ef == nullptr) {
+            return;
+        }
+
+        int effectStart = ef->GetStartTimeMS() / seqData->FrameTime();
+        int effectEnd = ef->GetEndTimeMS() / seqData->FrameTime();
+        if (reset && frame == effectStart) {
+            // the effect is being rendered from the start so the old checkpoints no longer lead on from it
+            ef->ClearCheckpoints(info.checkpointGenerations[layer]);
+        }
+
+        int interval = std::max(MIN_CHECKPOINT_FRAMES, (effectEnd - effectStart) / MAX_EFFECT_CHECKPOINTS);
+        if ((frame - effectStart + 1) % interval != 0 || frame + interval >= effectEnd || !Effect::IsCheckpointingEnabled()) {
+            return;
+        }
+
+        RenderableEffect* reff = GetCheckpointEffect(layer, ef, info.settingsMaps[layer]);
+        if (reff == nullptr) {
+            return;
+        }
+
+        auto checkpoint = std::make_shared<EffectCheckpoint>();
+        checkpoint->frame = frame;
+        checkpoint->generation = info.checkpointGenerations[layer];
+        checkpoint->effectStartPer = effectStart;
+        checkpoint->effectEndPer = effectEnd;
+        checkpoint->buffers.resize(mainBuffer->BufferCountForLayer(layer));
+        bool persist = mainBuffer->IsPersistent(layer);
+        for (size_t i = 0; i < checkpoint->buffers.size(); ++i) {
+            if (!mainBuffer->BufferForLayer(layer, i).SaveCheckpoint(reff->GetId(), checkpoint->buffers[i], persist)) {
+                return;
+            }
+        }
+        ef->AddCheckpoint(checkpoint);
+    }
+
+    // Restores the nearest checkpoint before startFrame and then renders the frames between it and
+    // startFrame without writing them out so the effect carries on as if it had been rendered from
+    // its start. Returns false if there is no usable checkpoint.
+    bool ResumeFromCheckpoint(int layer, Effect* ef, EffectLayerInfo& info) {
+        if (ef == nullptr) {
+            return false;
+        }
+
+        int effectStart = ef->GetStartTimeMS() / seqData->FrameTime();
+        int effectEnd = ef->GetEndTimeMS() / seqData->FrameTime();
+        if (startFrame <= effectStart) {
+            return false;
+        }
+
+        RenderableEffect* reff = GetCheckpointEffect(layer, ef, info.settingsMaps[layer]);
+        if (reff == nullptr) {
+            return false;
+        }
+
+        auto checkpoint = ef->GetCheckpoint(startFrame, info.checkpointGenerations[layer]);
+        if (checkpoint == nullptr || checkpoint->effectStartPer != effectStart || checkpoint->effectEndPer != effectEnd ||
+            checkpoint->buffers.size() != (size_t)mainBuffer->BufferCountForLayer(layer)) {
+            return false;
+        }
+
+        for (size_t i = 0; i < checkpoint->buffers.size(); ++i) {
+            if (!mainBuffer->BufferForLayer(layer, i).RestoreCheckpoint(reff->GetId(), checkpoint->buffers[i], reff->CreateRenderCache())) {
+                return false;
+            }
+        }
+
+        SetGenericStatus("%s: Resuming effect from checkpoint at frame %d ", checkpoint->frame, true);
+        bool reset = false;
+        for (int frame = checkpoint->frame + 1; frame < startFrame && !abort; ++frame) {
+            if (mainBuffer->IsVariableSubBuffer(layer)) {
+                mainBuffer->PrepareVariableSubBuffer(frame, layer);
+            }
+            int effectFrame = GetEffectFrame(ef, frame, mainBuffer->GetFrameTimeInMS());
+            if (mainBuffer->GetFreezeFrame(layer) <= effectFrame) {
+                // the effect is frozen from here on so its state no longer changes
+                break;
+            }
+            if (!mainBuffer->IsPersistent(layer)) {
+                mainBuffer->Clear(layer);
+            }
+            bool suppress = mainBuffer->GetSuppressUntil(layer) > effectFrame;
+            xLights->RenderEffectFromMap(suppress, ef, layer, frame, info.settingsMaps[layer], *mainBuffer, reset, true, &renderEvent);
+        }
+        renderLog.debug("Model %s layer %d resumed effect %s from checkpoint at frame %d to start at frame %d.",
+            (const char*)name.c_str(), layer, (const char*)ef->GetEffectName().c_str(), checkpoint->frame, (int)startFrame);
+        return true;
+    }
+
     void loadSettingsMap(const std::string &effectName,
                          Effect *effect,
                          SettingsMap& settingsMap) {
@@ -910,6 +1145,19 @@ private:
     wxGauge *gauge;
     std::atomic_int currentFrame;
     std::atomic_bool abort;
+    RenderWindow* renderWindow = nullptr;
+
+    // render state kept between runs of a job suspended in a windowed render
+    bool started = false;
+    bool layersInitialised = false;
+    int nextFrame = 0;
+    int maxFrameBeforeCheck = -1;
+    int origChangeCount = 0;
+    EffectLayerInfo mainModelInfo;
+    std::map<SNPair, Effect*> nodeEffects;
+    std::map<SNPair, SettingsMap> nodeSettingsMaps;
+    std::map<SNPair, bool> nodeEffectStates;
+    std::map<SNPair, int> nodeEffectIdxs;
 
     std::vector<EffectLayerInfo *> subModelInfos;
 
@@ -917,6 +1165,29 @@ private:
 };
 
 
+bool RenderWindow::Suspend(RenderJob* job) {
+    std::unique_lock<std::mutex> l(lock);
+    // checked again under the lock as whatever the job is waiting on may have happened since
+    if (job->CanResume()) {
+        return false;
+    }
+    suspended.push_back(job);
+    ++suspensions;
+    return true;
+}
+
+void RenderWindow::Wake() {
+    std::unique_lock<std::mutex> l(lock);
+    for (auto it = suspended.begin(); it != suspended.end();) {
+        if ((*it)->CanResume()) {
+            pool.PushJob(*it);
+            it = suspended.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
 IMPLEMENT_DYNAMIC_CLASS(RenderCommandEvent, wxCommandEvent)
 IMPLEMENT_DYNAMIC_CLASS(SelectedEffectChangedEvent, wxCommandEvent)
 
@@ -979,6 +1250,10 @@ public:
         jobs = nullptr;
         aggregators = nullptr;
         renderProgressDialog = nullptr;
+        windowFrames = 0;
+        window = nullptr;
+        windowNext = 0;
+        sharedFrames = nullptr;
     };
     std::function<void()> callback;
     int numRows;
@@ -988,6 +1263,15 @@ public:
     AggregatorRenderer **aggregators;
     RenderProgressDialog *renderProgressDialog;
     std::list<Model *> restriction;
+
+    // windowed renders hand each window of frames on as soon as every job is past it
+    int windowFrames;
+    RenderWindow *window;
+    int windowNext;
+    std::function<void(int, int)> windowCallback;
+
+    // frames of identical effects rendered once and shared between models
+    SharedRenderFrames* sharedFrames;
 };
 
 void xLightsFrame::LogRenderStatus()
@@ -1058,6 +1342,8 @@ void xLightsFrame::OnProgressBarDoubleClick(wxMouseEvent &evt) {
 }
 
 void xLightsFrame::UpdateRenderStatus() {
+    static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
     if (renderProgressInfo.empty()) {
         return;
     }
@@ -1124,6 +1410,10 @@ void xLightsFrame::UpdateRenderStatus() {
             }
         }
 
+        if (rpi->windowFrames > 0) {
+            UpdateRenderWindow(rpi, done);
+        }
+
         if (done) {
             for (size_t row = 0; row < rpi->numRows; ++row) {
                 if (rpi->jobs[row]) {
@@ -1131,6 +1421,16 @@ void xLightsFrame::UpdateRenderStatus() {
                 }
                 delete rpi->aggregators[row];
             }
+            if (rpi->window != nullptr) {
+                logger_base.debug("Render jobs gave their thread back %d times waiting on the render window or other models.", rpi->window->GetSuspensions());
+                delete rpi->window;
+                rpi->window = nullptr;
+            }
+            if (rpi->sharedFrames != nullptr) {
+                LogSharedFrames(rpi->sharedFrames);
+                delete rpi->sharedFrames;
+                rpi->sharedFrames = nullptr;
+            }
             if (rpi->renderProgressDialog) {
                 delete rpi->renderProgressDialog;
                 rpi->renderProgressDialog = nullptr;
@@ -1142,6 +1442,11 @@ void xLightsFrame::UpdateRenderStatus() {
             delete rpi;
             rpi = nullptr;
             it = renderProgressInfo.erase(it);
+            if (_seqData.IsSparse()) {
+                // give back any frames the render left black ... but not from here as playback or
+                // render ahead may still be reading them
+                _compactSeqDataPending = true;
+            }
         } else {
             ++it;
         }
@@ -1149,6 +1454,62 @@ void xLightsFrame::UpdateRenderStatus() {
 }
 
 
+bool xLightsFrame::CanCompactSeqData() const
+{
+    // compacting frees frames so nothing may be rendering into them, playing them or about to render ahead
+    return renderProgressInfo.empty() && _renderAheadQueue.empty() && !IsRenderingAhead() && playType == PLAY_TYPE_STOPPED;
+}
+
+void xLightsFrame::OnIdleCompactSeqData(wxIdleEvent& event)
+{
+    event.Skip();
+    if (_compactSeqDataPending && CanCompactSeqData()) {
+        _compactSeqDataPending = false;
+        _seqData.Compact();
+    }
+}
+
+void xLightsFrame::LogSharedFrames(SharedRenderFrames* sharedFrames)
+{
+    static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+    static log4cpp::Category &logger_render = log4cpp::Category::getInstance(std::string("log_render"));
+
+    uint64_t hits = sharedFrames->GetHits();
+    uint64_t lookups = hits + sharedFrames->GetMisses();
+    std::string msg = wxString::Format("Shared effect frames: %d effects in %d groups, %llu of %llu frames reused (%.1f%%), %llu dropped to stay under the memory cap.",
+        (int)sharedFrames->GetSharedEffectCount(), (int)sharedFrames->GetGroupCount(),
+        (unsigned long long)hits, (unsigned long long)lookups, lookups == 0 ? 0.0 : hits * 100.0 / lookups,
+        (unsigned long long)sharedFrames->GetDropped()).ToStdString();
+    logger_base.debug(msg);
+    logger_render.info(msg);
+}
+
+void xLightsFrame::UpdateRenderWindow(RenderProgressInfo* rpi, bool done)
+{
+    // every frame before the slowest job is complete ... one is held back in case it is still being read.
+    // A job which has not started yet holds everything back but it will get a thread as every job is
+    // queued up front and jobs waiting on the window are suspended rather than sit on a pool thread.
+    int complete = rpi->endFrame + 1;
+    if (!done) {
+        for (size_t row = 0; row < rpi->numRows; ++row) {
+            RenderJob* job = rpi->jobs[row];
+            if (job == nullptr) continue;
+            int cur = job->GetCurrentFrame();
+            if (cur == END_OF_RENDER_FRAME || cur > job->GetEndFrame()) continue;
+            complete = std::min(complete, std::max(cur, job->GetStartFrame()) - 1);
+        }
+    }
+
+    while (rpi->windowNext < complete && (done || complete - rpi->windowNext >= rpi->windowFrames)) {
+        int end = std::min(complete, rpi->windowNext + rpi->windowFrames) - 1;
+        rpi->windowCallback(rpi->windowNext, end);
+        rpi->windowNext = end + 1;
+    }
+
+    // let the jobs get up to two windows ahead of what has been handed on
+    rpi->window->SetEnd(rpi->windowNext + rpi->windowFrames * 2);
+}
+
 void xLightsFrame::RenderDone()
 {
     mainSequencer->PanelEffectGrid->Refresh();
@@ -1311,10 +1672,33 @@ void xLightsFrame::Render(SequenceElements& seqElements,
         RenderTreeData::sortRanges(ranges);
     }
     int numRows = models.size();
+    RenderWindow* window = nullptr;
+    if (_renderWindowFrames > 0) {
+        window = new RenderWindow(jobPool, startFrame + _renderWindowFrames * 2);
+        if (numRows > jobPool.maxSize()) {
+            logger_base.debug("Windowed render of %d models on at most %d pool threads, jobs waiting on the window give their thread back.", numRows, jobPool.maxSize());
+        }
+    }
     RenderJob **jobs = new RenderJob*[numRows];
     AggregatorRenderer **aggregators = new AggregatorRenderer*[numRows];
     std::vector<std::set<int>> channelMaps(seqData.NumChannels());
 
+    SharedRenderFrames* sharedFrames = nullptr;
+    if (numRows > 1 && SpecialOptions::GetOption("ShareEffectRenders", "true") == "true") {
+        std::list<Element*> elements;
+        for (const auto& it : models) {
+            Element* el = seqElements.GetElement(it->GetName());
+            if (el != nullptr && el->GetType() == ElementType::ELEMENT_TYPE_MODEL) {
+                elements.push_back(el);
+            }
+        }
+        sharedFrames = new SharedRenderFrames(elements, effectManager);
+        if (!sharedFrames->HasSharedEffects()) {
+            delete sharedFrames;
+            sharedFrames = nullptr;
+        }
+    }
+
     size_t row = 0;
     for (auto it = models.begin(); it != models.end(); ++it, ++row) {
         jobs[row] = nullptr;
@@ -1343,6 +1727,8 @@ void xLightsFrame::Render(SequenceElements& seqElements,
 
                     job->setRenderRange(startFrame, endFrame);
                     job->SetRangeRestriction(ranges);
+                    job->SetRenderWindow(window);
+                    job->SetSharedFrames(sharedFrames);
                     if (seqElements.SupportsModelBlending()) {
                         job->SetModelBlending();
                     }
@@ -1442,9 +1828,26 @@ void xLightsFrame::Render(SequenceElements& seqElements,
         pi->renderProgressDialog = renderProgressDialog;
         pi->restriction = restrictToModels;
         pi->aggregators = aggregators;
+        if (window != nullptr) {
+            pi->windowFrames = _renderWindowFrames;
+            pi->window = window;
+            pi->windowNext = startFrame;
+            pi->windowCallback = _renderWindowCallback;
+        }
+        pi->sharedFrames = sharedFrames;
 
         renderProgressInfo.push_back(pi);
     } else {
+        if (window != nullptr) {
+            // nothing to render but the frames still need handing on
+            for (int f = startFrame; f <= endFrame; f += _renderWindowFrames) {
+                _renderWindowCallback(f, std::min(endFrame, f + _renderWindowFrames - 1));
+            }
+            delete window;
+        }
+        if (sharedFrames != nullptr) {
+            delete sharedFrames;
+        }
         callback();
         if (progressDialog) {
             delete renderProgressDialog;
@@ -1488,6 +1891,28 @@ static void addModelsFrom(std::list<Model*> &models, const std::list<Model *> &t
     }
 }
 
+// the channels the models cover as sorted, merged, 0 based (start, count) ranges
+static RenderedDataSnapshot::ChannelRanges GetModelChannelRanges(const std::list<Model*> &models) {
+    RenderedDataSnapshot::ChannelRanges ranges;
+    for (const auto& m : models) {
+        uint32_t first = m->GetFirstChannel();
+        uint32_t last = m->GetLastChannel();
+        if (first <= last) {
+            ranges.push_back({ first, last - first + 1 });
+        }
+    }
+    std::sort(ranges.begin(), ranges.end());
+    RenderedDataSnapshot::ChannelRanges merged;
+    for (const auto& it : ranges) {
+        if (!merged.empty() && it.first <= merged.back().first + merged.back().second) {
+            merged.back().second = std::max(merged.back().second, it.first + it.second - merged.back().first);
+        } else {
+            merged.push_back(it);
+        }
+    }
+    return merged;
+}
+
 void xLightsFrame::RenderDirtyModels() {
 
     if (_suspendRender) return; // dont render if suspended
@@ -1549,6 +1974,7 @@ void xLightsFrame::RenderDirtyModels() {
     if (endframe < startframe) {
         return;
     }
+    _sequenceElements.get_undo_mgr().CaptureRenderedData(GetModelChannelRanges(models), startframe, endframe);
     Render(_sequenceElements, _seqData, models, restricts, startframe, endframe, false, true, [] {});
 }
 
@@ -1556,6 +1982,7 @@ bool xLightsFrame::AbortRender(int maxTimeMS)
 {
     static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
     logger_base.info("Aborting rendering ...");
+    _renderAheadQueue.clear();
     int abortCount = 0;
     for (auto rpi : renderProgressInfo) {
         //abort whatever is rendering
@@ -1639,6 +2066,43 @@ void xLightsFrame::RenderGridToSeqData(std::function<void()>&& callback) {
 #endif
 }
 
+void xLightsFrame::RenderGridToSeqDataWindowed(int windowFrames, std::function<void(int, int)>&& windowDone, std::function<void()>&& callback) {
+
+    static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    BuildRenderTree();
+    if (renderTree.data.empty() || _sequenceElements.GetElementCount() == 0) {
+        //nothing to do.... but the frames still need handing on
+        for (int f = 0; f < (int)_seqData.NumFrames(); f += windowFrames) {
+            windowDone(f, std::min((int)_seqData.NumFrames() - 1, f + windowFrames - 1));
+        }
+        callback();
+        return;
+    }
+
+    std::list<Model *> models;
+    for (const auto& it : renderTree.data) {
+        models.push_back(it->model);
+    }
+    for (auto it : renderProgressInfo) {
+        //we're going to render EVERYTHING, abort whatever is rendering
+        for (size_t row = 0; row < it->numRows; ++row) {
+            if (it->jobs[row]) {
+               it->jobs[row]->AbortRender();
+            }
+        }
+    }
+    std::list<Model*> restricts;
+
+    logger_base.debug("Rendering %d models %d frames in windows of %d frames.", models.size(), _seqData.NumFrames(), windowFrames);
+
+    _renderWindowFrames = windowFrames;
+    _renderWindowCallback = std::move(windowDone);
+    Render(_sequenceElements, _seqData, models, restricts, 0, _seqData.NumFrames() - 1, true, false, std::move(callback));
+    _renderWindowFrames = 0;
+    _renderWindowCallback = nullptr;
+}
+
 void xLightsFrame::RenderEffectForModel(const std::string &model, int startms, int endms, bool clear) {
 
     static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
@@ -1698,16 +2162,126 @@ void xLightsFrame::RenderEffectForModel(const std::string &model, int startms, i
                     }
                 }
             }
+            if (IsRenderingAhead()) {
+                // fold in anything already waiting for this model so it is all weighed against the play marker
+                for (auto q = _renderAheadQueue.begin(); q != _renderAheadQueue.end();) {
+                    if (q->model == model) {
+                        startframe = std::min(startframe, q->startFrame);
+                        endframe = std::max(endframe, q->endFrame);
+                        q = _renderAheadQueue.erase(q);
+                    } else {
+                        ++q;
+                    }
+                }
+
+                // the render job widens itself to the model's dirty range so that is taken here instead
+                Element* el = _sequenceElements.GetElement(model);
+                if (el != nullptr) {
+                    int changes, ss, es;
+                    el->GetAndResetDirtyRange(changes, ss, es);
+                    if (ss != -1) {
+                        startframe = std::min(startframe, std::max(0, ss / _seqData.FrameTime()));
+                        endframe = std::max(endframe, std::min(es / _seqData.FrameTime(), (int)_seqData.NumFrames() - 1));
+                    }
+                }
+
+                // render from the play marker on first ... the frames behind it wait until this is done
+                int playFrame = _renderAheadPlayMS / _seqData.FrameTime();
+                if (playFrame > startframe && playFrame <= endframe) {
+                    logger_base.debug("Rendering ahead of play marker, frames %d-%d deferred.", startframe, playFrame - 1);
+                    _renderAheadQueue.push_back({ model, startframe, playFrame - 1 });
+                    startframe = playFrame;
+                }
+            }
+
             std::list<Model *> m;
             m.push_back((*it)->model);
 
             logger_base.debug("Rendering %d models %d frames.", m.size(), endframe - startframe + 1);
+            _sequenceElements.get_undo_mgr().CaptureRenderedData(GetModelChannelRanges((*it)->renderOrder), startframe, endframe);
 
             Render(_sequenceElements, _seqData, (*it)->renderOrder, m, startframe, endframe, false, true, [] {});
         }
     }
 }
 
+bool xLightsFrame::IsRenderingAhead() const {
+    return _renderAhead && playType == PLAY_TYPE_MODEL && _renderAheadPlayMS >= 0;
+}
+
+void xLightsFrame::DispatchRenderAhead() {
+
+    if (_renderAheadQueue.empty() || _suspendRender) return;
+
+    // anything for a model which is still rendering has to wait for that to finish
+    std::vector<RenderAheadRange> ready;
+    for (auto q = _renderAheadQueue.begin(); q != _renderAheadQueue.end();) {
+        bool busy = false;
+        for (const auto& rpi : renderProgressInfo) {
+            if (rpi->restriction.empty()) {
+                busy = true;
+            }
+            for (const auto& m : rpi->restriction) {
+                if (m->GetName() == q->model) {
+                    busy = true;
+                }
+            }
+        }
+        if (busy) {
+            ++q;
+        } else {
+            ready.push_back(*q);
+            q = _renderAheadQueue.erase(q);
+        }
+    }
+    if (ready.empty()) return;
+
+    // nearest the play marker first with frames still to be played ahead of those already played
+    int playFrame = IsRenderingAhead() ? _renderAheadPlayMS / _seqData.FrameTime() : 0;
+    auto distance = [playFrame](const RenderAheadRange& r) {
+        if (r.endFrame < playFrame) {
+            return (INT_MAX / 2) + (playFrame - r.endFrame);
+        }
+        return std::max(0, r.startFrame - playFrame);
+    };
+    std::stable_sort(ready.begin(), ready.end(), [&distance](const RenderAheadRange& a, const RenderAheadRange& b) {
+        return distance(a) < distance(b);
+    });
+
+    for (const auto& r : ready) {
+        RenderEffectForModel(r.model, r.startFrame * _seqData.FrameTime(), r.endFrame * _seqData.FrameTime());
+    }
+}
+
+// the first frame from this one on that the render has not written yet, -1 if there are none
+int xLightsFrame::GetRenderFrontierFrame(int frame) const {
+
+    int frontier = -1;
+    for (const auto& rpi : renderProgressInfo) {
+        for (size_t row = 0; row < rpi->numRows; ++row) {
+            RenderJob* job = rpi->jobs[row];
+            if (job == nullptr) continue;
+
+            int cur = job->GetCurrentFrame();
+            if (cur == END_OF_RENDER_FRAME || cur > job->GetEndFrame() || job->GetEndFrame() < frame) continue;
+
+            int f = std::max(frame, std::max(cur, job->GetStartFrame()));
+            if (frontier == -1 || f < frontier) {
+                frontier = f;
+            }
+        }
+    }
+    for (const auto& r : _renderAheadQueue) {
+        if (r.endFrame >= frame) {
+            int f = std::max(frame, r.startFrame);
+            if (frontier == -1 || f < frontier) {
+                frontier = f;
+            }
+        }
+    }
+    return frontier;
+}
+
 void xLightsFrame::RenderTimeSlice(int startms, int endms, bool clear) {
 
     static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
@@ -1988,13 +2562,20 @@ bool xLightsFrame::RenderEffectFromMap(bool suppress, Effect *effectObj, int lay
             } else if (!bgThread || reff->CanRenderOnBackgroundThread(effectObj, SettingsMap, *b)) {
                 wxStopWatch sw;
 
-                if (effectObj != nullptr && reff->SupportsRenderCache(SettingsMap)) {
-                    if (!effectObj->GetFrame(*b, _renderCache)) {
+                // identical effects on other models in this render may have already done the work
+                SharedRenderFrames* shared = (event != nullptr && buffer.BufferCountForLayer(layer) == 1) ? event->sharedFrames : nullptr;
+                if (shared == nullptr || !shared->GetFrame(effectObj, *b)) {
+                    if (effectObj != nullptr && reff->SupportsRenderCache(SettingsMap)) {
+                        if (!effectObj->GetFrame(*b, _renderCache)) {
+                            reff->Render(effectObj, SettingsMap, *b);
+                            effectObj->AddFrame(*b, _renderCache);
+                        }
+                    } else {
                         reff->Render(effectObj, SettingsMap, *b);
-                        effectObj->AddFrame(*b, _renderCache);
                     }
-                } else {
-                    reff->Render(effectObj, SettingsMap, *b);
+                    if (shared != nullptr) {
+                        shared->AddFrame(effectObj, *b);
+                    }
                 }
                 // Log slow render frames ... this takes time but at this point it is already slow
                 if (sw.Time() > 150) {
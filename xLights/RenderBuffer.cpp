@@ -1252,6 +1252,57 @@ void RenderBuffer::SetState(int period, bool ResetState, const std::string& mode
     }
 }
 
+bool RenderBuffer::SaveCheckpoint(int id, EffectCheckpoint::BufferState& state, bool keepPixels) const
+{
+    auto it = infoCache.find(id);
+    if (it == infoCache.end() || it->second == nullptr) {
+        // nothing has been rendered yet
+        return false;
+    }
+
+    state.cache.clear();
+    if (!it->second->Serialise(state.cache)) {
+        return false;
+    }
+    state.bufferWi = BufferWi;
+    state.bufferHt = BufferHt;
+    state.needToInit = needToInit;
+    state.tempInt = tempInt;
+    state.tempInt2 = tempInt2;
+    if (keepPixels) {
+        state.pixels = pixels;
+    } else {
+        state.pixels.clear();
+    }
+    state.tempbuf = tempbuf;
+    return true;
+}
+
+bool RenderBuffer::RestoreCheckpoint(int id, const EffectCheckpoint::BufferState& state, EffectRenderCache* cache)
+{
+    // the model may have changed size since the checkpoint was saved
+    if (cache == nullptr || state.bufferWi != BufferWi || state.bufferHt != BufferHt ||
+        (!state.pixels.empty() && state.pixels.size() != pixels.size()) ||
+        state.tempbuf.size() != tempbuf.size() || !cache->Restore(state.cache)) {
+        delete cache;
+        return false;
+    }
+
+    auto it = infoCache.find(id);
+    if (it != infoCache.end()) {
+        delete it->second;
+    }
+    infoCache[id] = cache;
+    needToInit = state.needToInit;
+    tempInt = state.tempInt;
+    tempInt2 = state.tempInt2;
+    if (!state.pixels.empty()) {
+        pixels = state.pixels;
+    }
+    tempbuf = state.tempbuf;
+    return true;
+}
+
 void RenderBuffer::ClearTempBuf()
 {
     for (size_t i = 0; i < tempbuf.size(); i++) {
@@ -11,10 +11,12 @@
  **************************************************************/
 
 #include <stdint.h>
+#include <cstring>
 #include <map>
 #include <list>
 #include <vector>
 #include <atomic>
+#include <type_traits>
 #include <wx/colour.h>
 #include <wx/dcclient.h>
 #include <wx/dcmemory.h>
@@ -388,6 +390,82 @@ class /*NCCDLLEXPORT*/ EffectRenderCache {
 public:
 	EffectRenderCache();
 	virtual ~EffectRenderCache();
+
+    // Effects which keep state from one frame to the next can save it so a later render can
+    // resume part way through the effect. The data is only ever read back by the same build
+    // so plain copies of the members are fine. Return false if the state can't be saved.
+    virtual bool Serialise(std::vector<uint8_t>& data) const { return false; }
+    virtual bool Restore(const std::vector<uint8_t>& data) { return false; }
+
+protected:
+    template<typename T> static void Write(std::vector<uint8_t>& data, const T& value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be written");
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(&value);
+        data.insert(data.end(), p, p + sizeof(T));
+    }
+    template<typename T> static bool Read(const std::vector<uint8_t>& data, size_t& pos, T& value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be read");
+        if (pos + sizeof(T) > data.size()) return false;
+        memcpy(&value, &data[pos], sizeof(T));
+        pos += sizeof(T);
+        return true;
+    }
+    // containers are written as a count followed by the elements
+    template<typename C> static void WriteAll(std::vector<uint8_t>& data, const C& values)
+    {
+        Write(data, (uint32_t)values.size());
+        for (const auto& it : values) {
+            Write(data, it);
+        }
+    }
+    template<typename C> static bool ReadAll(const std::vector<uint8_t>& data, size_t& pos, C& values)
+    {
+        uint32_t count = 0;
+        if (!Read(data, pos, count)) return false;
+        values.clear();
+        for (uint32_t i = 0; i < count; i++) {
+            typename C::value_type v;
+            if (!Read(data, pos, v)) return false;
+            values.insert(values.end(), v);
+        }
+        return true;
+    }
+};
+
+// The state a render buffer carries from one frame of an effect to the next, captured every
+// so often while a stateful effect renders so re-rendering from the middle of the effect can
+// pick up from the nearest earlier checkpoint rather than starting the effect again.
+struct EffectCheckpoint
+{
+    struct BufferState
+    {
+        int bufferWi = 0;
+        int bufferHt = 0;
+        bool needToInit = false;
+        int tempInt = 0;
+        int tempInt2 = 0;
+        xlColorVector pixels;
+        xlColorVector tempbuf;
+        std::vector<uint8_t> cache; // the serialised EffectRenderCache
+    };
+
+    int frame = 0;          // the last frame rendered before the state was saved
+    int generation = 0;     // Effect::GetCheckpointGeneration() when the settings rendered were read
+    int effectStartPer = 0;
+    int effectEndPer = 0;
+    std::vector<BufferState> buffers;
+
+    // roughly the memory held ... what the checkpoint memory limit is measured against
+    size_t GetSize() const
+    {
+        size_t size = sizeof(EffectCheckpoint);
+        for (const auto& it : buffers) {
+            size += sizeof(BufferState) + (it.pixels.size() + it.tempbuf.size()) * sizeof(xlColor) + it.cache.size();
+        }
+        return size;
+    }
 };
 
 class /*NCCDLLEXPORT*/ RenderBuffer {
@@ -411,6 +489,12 @@ public:
 
     void SetState(int period, bool reset, const std::string& model_name);
 
+    // saves or restores the state carried between frames by the effect whose render cache is
+    // stored under 'id'. The pixels only need saving when the layer is persistent as otherwise
+    // they are cleared before every frame. Restore takes ownership of the cache
+    bool SaveCheckpoint(int id, EffectCheckpoint::BufferState& state, bool keepPixels) const;
+    bool RestoreCheckpoint(int id, const EffectCheckpoint::BufferState& state, EffectRenderCache* cache);
+
     void SetEffectDuration(int startMsec, int endMsec);
     void GetEffectPeriods(int& curEffStartPer, int& curEffEndPer) const;  // nobody wants endPer?
     void SetFrameTimeInMs(int i);
@@ -170,14 +170,16 @@ void RenderCache::RemoveItem(RenderCacheItem *item) {
     delete item;
 }
 
-bool RenderCache::IsEffectOkForCaching(Effect* effect) const
+bool RenderCache::IsEffectOkForCaching(const Effect* effect) const
 {
     static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
     if (!IsEnabled()) return false;
 
     bool locked = false;
 
-    for (const auto& it : effect->GetSettings()) {
+    // this runs on the render threads so hold on to the settings while they are read
+    auto settings = effect->GetSettingsPtr();
+    for (const auto& it : *settings) {
         // we cant cache effects with canvas turned on
         if (it.first == "T_CHECKBOX_Canvas" && it.second == "1") {
             return false;
@@ -434,7 +436,7 @@ std::string RenderCacheItem::GetModelName(RenderBuffer* buffer)
     }
 }
 
-RenderCacheItem::RenderCacheItem(RenderCache* renderCache, Effect* effect, RenderBuffer* buffer) : _renderCache(renderCache)
+RenderCacheItem::RenderCacheItem(RenderCache* renderCache, const Effect* effect, RenderBuffer* buffer) : _renderCache(renderCache)
 {
     _purged = false;
     _dirty = true;
@@ -461,17 +463,19 @@ RenderCacheItem::RenderCacheItem(RenderCache* renderCache, Effect* effect, Rende
     _properties["EndMS"] = wxString::Format("%d", effect->GetEndTimeMS());
     _properties["Frames"] = wxString::Format("%d", buffer->curEffEndPer - buffer->curEffStartPer + 1);
     _properties["Models"] = "-1";
-    for (const auto& it : effect->GetSettings())
+    auto settings = effect->GetSettingsPtr();
+    auto palette = effect->GetPaletteMapPtr();
+    for (const auto& it : *settings)
     {
         _properties[it.first] = it.second;
     }
-    for (const auto& it : effect->GetPaletteMap())
+    for (const auto& it : *palette)
     {
         _properties[it.first] = it.second;
     }
 }
 
-bool RenderCacheItem::IsMatch(Effect* effect, RenderBuffer* buffer)
+bool RenderCacheItem::IsMatch(const Effect* effect, RenderBuffer* buffer)
 {
     static log4cpp::Category& logger_rcache = log4cpp::Category::getInstance(std::string("log_rendercache"));
     if (_purged) return false;
@@ -496,14 +500,17 @@ bool RenderCacheItem::IsMatch(Effect* effect, RenderBuffer* buffer)
 
     // We only log failures from here on because they should be relatively rare
 
+    auto settings = effect->GetSettingsPtr();
+    auto palette = effect->GetPaletteMapPtr();
+
     // 8 is the number of predefined tags
-    if (_properties.size() - 7 != effect->GetSettings().size() + effect->GetPaletteMap().size())
+    if (_properties.size() - 7 != settings->size() + palette->size())
     {
         logger_rcache.debug("RenderCache no mantch because number of proprerties different.");
         return false;
     }
 
-    for (const auto& it : effect->GetSettings())
+    for (const auto& it : *settings)
     {
         if (_properties.find(it.first) == _properties.end()) {
             logger_rcache.debug("RenderCache no match because proprerty not present: " + it.first);
@@ -519,7 +526,7 @@ bool RenderCacheItem::IsMatch(Effect* effect, RenderBuffer* buffer)
         }
     }
 
-    for (const auto& it : effect->GetPaletteMap())
+    for (const auto& it : *palette)
     {
         if (_properties.find(it.first) == _properties.end()) {
             logger_rcache.debug("RenderCache no match because pallette map not present: " + it.first);
@@ -35,13 +35,13 @@ class RenderCacheItem
 
 public:
     RenderCacheItem(RenderCache* renderCache, const std::string& file);
-    RenderCacheItem(RenderCache* renderCache, Effect* effect, RenderBuffer* buffer);
+    RenderCacheItem(RenderCache* renderCache, const Effect* effect, RenderBuffer* buffer);
     virtual ~RenderCacheItem();
     bool GetFrame(RenderBuffer* buffer);
     void AddFrame(RenderBuffer* buffer);
     void PurgeFrames();
     bool IsPurged() const { return _purged; }
-    bool IsMatch(Effect* effect, RenderBuffer* buffer);
+    bool IsMatch(const Effect* effect, RenderBuffer* buffer);
     void Delete();
     void Save();
     bool IsDone(RenderBuffer* buffer) const;
@@ -72,5 +72,5 @@ class RenderCache
         void Enable(std::string enabled) { _enabled = enabled; }
         std::mutex& GetLoadMutex() { return _loadMutex; }
         void AddCacheItem(RenderCacheItem* rci);
-        bool IsEffectOkForCaching(Effect* effect) const;
+        bool IsEffectOkForCaching(const Effect* effect) const;
 };
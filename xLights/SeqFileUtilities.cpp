@@ -30,6 +30,9 @@
 #include "ConvertLogDialog.h"
 #include "xLightsVersion.h"
 #include "UtilFunctions.h"
+#include "Parallel.h"
+#include "SpecialOptions.h"
+#include "XmlStreamReader.h"
 #include "models/ModelGroup.h"
 #include "HousePreviewPanel.h"
 #include "FontManager.h"
@@ -51,6 +54,9 @@
 #include "Vixen3.h"
 #include "osxMacUtils.h"
 
+#include <unordered_map>
+#include <unordered_set>
+
 #include <log4cpp/Category.hh>
 
 void xLightsFrame::AddAllModelsToSequence()
@@ -702,13 +708,27 @@ void xLightsFrame::ClearSequenceData()
         _seqData[i].Zero();
 }
 
+// describes the layers and the files they come from so a cached merge is thrown away when any of them change
+static std::string DataLayerMergeKey(const std::vector<DataLayer*>& layers, const SequenceData& seqData)
+{
+    wxString key = wxString::Format("%u,%u,%u", seqData.NumChannels(), seqData.NumFrames(), seqData.FrameTime());
+    for (auto layer : layers) {
+        wxString file = layer->GetDataSource();
+        wxULongLong size = wxFileName::GetSize(file);
+        key += "|" + file + wxString::Format(",%d,%llu,%lld",
+                                             layer->GetChannelOffset(),
+                                             (unsigned long long)(size == wxInvalidSize ? 0 : size.GetValue()),
+                                             (long long)wxFileModificationTime(file));
+    }
+    return key.ToStdString();
+}
+
 void xLightsFrame::RenderIseqData(bool bottom_layers, ConvertLogDialog* plog)
 {
     static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
     logger_base.debug("xLightsFrame::RenderIseqData bottom_layers %d", bottom_layers);
 
     DataLayerSet& data_layers = CurrentSeqXmlFile->GetDataLayers();
-    ConvertParameters::ReadMode read_mode;
     if (bottom_layers && data_layers.GetNumLayers() == 1 &&
         data_layers.GetDataLayer(0)->GetName() == "Nutcracker") {
         DataLayer* nut_layer = data_layers.GetDataLayer(0);
@@ -722,14 +742,9 @@ void xLightsFrame::RenderIseqData(bool bottom_layers, ConvertLogDialog* plog)
     {
         logger_base.debug("xLightsFrame::RenderIseqData clearing sequence data.");
         ClearSequenceData();
-        read_mode = ConvertParameters::READ_MODE_NORMAL;
-    }
-    else
-    {
-        read_mode = ConvertParameters::READ_MODE_IGNORE_BLACK;
     }
 
-    int layers_rendered = 0;
+    std::vector<DataLayer*> layers;
     bool start_rendering = bottom_layers;
     for( int i = data_layers.GetNumLayers() - 1; i >= 0; --i )  // build layers bottom up
     {
@@ -739,23 +754,7 @@ void xLightsFrame::RenderIseqData(bool bottom_layers, ConvertLogDialog* plog)
             if( start_rendering )
             {
                 logger_base.debug("xLightsFrame::RenderIseqData rendering %s.", (const char *)data_layer->GetDataSource().c_str());
-                if (plog != nullptr)
-                {
-                    plog->Show(true);
-                }
-                ConvertParameters read_params(data_layer->GetDataSource(),                // input filename
-                                              _seqData,                                    // sequence data object
-                                              &_outputManager,                               // global network info
-                                              read_mode,                                  // file read mode
-                                              this,                                       // xLights main frame
-                                              nullptr,
-                                              plog,
-                                              nullptr,                                    // filename not needed
-                                              data_layer );                               // provide data layer for channel offsets
-
-                FileConverter::ReadFalconFile(read_params);
-                read_mode = ConvertParameters::READ_MODE_IGNORE_BLACK;
-                layers_rendered++;
+                layers.push_back(data_layer);
             }
         }
         else
@@ -764,6 +763,53 @@ void xLightsFrame::RenderIseqData(bool bottom_layers, ConvertLogDialog* plog)
             start_rendering = true;
         }
     }
+    if (layers.empty()) return;
+
+    if (plog != nullptr)
+    {
+        plog->Show(true);
+    }
+
+    // The bottom layers go onto cleared data so both sides are just each layer's non black channels
+    // applied bottom up. That result is kept so the next render only has to lay it over the sequence
+    std::string key = DataLayerMergeKey(layers, _seqData);
+    std::unique_ptr<SequenceData> uncached;
+    SequenceData* merged = data_layers.GetMergedLayers(bottom_layers, key);
+    if (merged == nullptr)
+    {
+        size_t maxBytes = (size_t)wxAtoi(SpecialOptions::GetOption("DataLayerCacheMB", "512")) * 1024 * 1024;
+        if ((size_t)_seqData.NumChannels() * _seqData.NumFrames() > maxBytes)
+        {
+            logger_base.debug("xLightsFrame::RenderIseqData sequence is too big to cache the merged layers.");
+            data_layers.ClearMergedLayers();
+            FileConverter::MergeDataLayers(layers, _seqData, this, plog);
+            return;
+        }
+
+        std::unique_ptr<SequenceData> data = std::make_unique<SequenceData>();
+        data->init(_seqData.NumChannels(), _seqData.NumFrames(), _seqData.FrameTime());
+        if (FileConverter::MergeDataLayers(layers, *data, this, plog))
+        {
+            merged = data_layers.SetMergedLayers(bottom_layers, key, std::move(data));
+        }
+        else
+        {
+            // dont keep a merge with missing layers ... the next render will try them again
+            uncached = std::move(data);
+            merged = uncached.get();
+        }
+    }
+    else
+    {
+        logger_base.debug("xLightsFrame::RenderIseqData using the cached merge of %d layers.", (int)layers.size());
+    }
+
+    const SequenceData& m = *merged;
+    unsigned int channels = _seqData.NumChannels();
+    parallel_for(0, _seqData.NumFrames(), [this, &m, channels](int f) {
+        if (!m[f].IsAllocated()) return;
+        FileConverter::MergeIgnoreBlack(_seqData[f], 0, m[f][0], channels);
+    }, 500);
 }
 
 void xLightsFrame::SetSequenceEnd(int ms)
@@ -1496,16 +1542,11 @@ void ReadHLSData(wxXmlNode *chand, std::vector<unsigned char> & data) {
     }
 }
 
-void MapHLSChannelInformation(xLightsFrame *xlights, EffectLayer *layer, wxXmlNode* tuniv, int frames, int frameTime,
-                              const wxString &cn, wxColor color, Model &mc, bool byStrand, bool eraseExisting) {
-    if (cn == "") {
-        return;
-    }
-    static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
-    wxXmlNode *redNode = nullptr;
-    wxXmlNode *greenNode = nullptr;
-    wxXmlNode *blueNode = nullptr;
+// the ChannelData elements of an hls sequence by their ChanInfo eg "Name, Normal" or "Name, RGB-R"
+typedef std::unordered_map<std::string, wxXmlNode*> HLSChannelIndex;
 
+static HLSChannelIndex IndexHLSChannels(wxXmlNode* tuniv) {
+    HLSChannelIndex index;
     for (wxXmlNode* univ=tuniv->GetChildren(); univ!=nullptr; univ=univ->GetNext()) {
         if (univ->GetName() == "Universe") {
             for (wxXmlNode* channels=univ->GetChildren(); channels!=nullptr; channels=channels->GetNext()) {
@@ -1514,17 +1555,7 @@ void MapHLSChannelInformation(xLightsFrame *xlights, EffectLayer *layer, wxXmlNo
                         if (chand->GetName() == "ChannelData") {
                             for (wxXmlNode* chani=chand->GetChildren(); chani!=nullptr; chani=chani->GetNext()) {
                                 if (chani->GetName() == "ChanInfo") {
-                                    wxString info = chani->GetChildren()->GetContent();
-                                    if (info == cn + ", Normal") {
-                                        //single channel, easy
-                                        redNode = chand;
-                                    } else if (info == cn + ", RGB-R") {
-                                        redNode = chand;
-                                    } else if (info == cn + ", RGB-G") {
-                                        greenNode = chand;
-                                    } else if (info == cn + ", RGB-B") {
-                                        blueNode = chand;
-                                    }
+                                    index[chani->GetChildren()->GetContent().ToStdString()] = chand;
                                 }
                             }
                         }
@@ -1533,6 +1564,26 @@ void MapHLSChannelInformation(xLightsFrame *xlights, EffectLayer *layer, wxXmlNo
             }
         }
     }
+    return index;
+}
+
+void MapHLSChannelInformation(xLightsFrame *xlights, EffectLayer *layer, const HLSChannelIndex &index, int frames, int frameTime,
+                              const wxString &cn, wxColor color, Model &mc, bool byStrand, bool eraseExisting) {
+    if (cn == "") {
+        return;
+    }
+    static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+    auto find = [&index, &cn](const char *type) {
+        auto it = index.find((cn + type).ToStdString());
+        return it == index.end() ? nullptr : it->second;
+    };
+    wxXmlNode *redNode = find(", RGB-R");
+    wxXmlNode *greenNode = find(", RGB-G");
+    wxXmlNode *blueNode = find(", RGB-B");
+    if (redNode == nullptr) {
+        //single channel, easy
+        redNode = find(", Normal");
+    }
     if (redNode == nullptr) {
         printf("Did not map %s\n", (const char *)cn.c_str());
 		logger_base.info("Did not map " + cn);
@@ -1576,34 +1627,52 @@ void MapHLSChannelInformation(xLightsFrame *xlights, EffectLayer *layer, wxXmlNo
     xlights->DoConvertDataRowToEffects(layer, colors, frameTime, eraseExisting);
 }
 
-std::string FindHLSStrandName(const std::string &ccrName, int node, const std::vector<std::string> &channelNames) {
+std::string FindHLSStrandName(const std::string &ccrName, int node, const std::unordered_set<std::string> &channelNames) {
     std::string r = ccrName + wxString::Format("P%03d", node).ToStdString();
-    if (std::find(channelNames.begin(), channelNames.end(), r) == channelNames.end()) {
+    if (channelNames.find(r) == channelNames.end()) {
         r = ccrName + wxString::Format("P%04d", node);
     } else {
         return r;
     }
-    if (std::find(channelNames.begin(), channelNames.end(), r) == channelNames.end()) {
+    if (channelNames.find(r) == channelNames.end()) {
         r = ccrName + wxString::Format("P%02d", node);
     } else {
         return r;
     }
-    if (std::find(channelNames.begin(), channelNames.end(), r) == channelNames.end()) {
+    if (channelNames.find(r) == channelNames.end()) {
         r = ccrName + wxString::Format("_%04d", node);
     } else {
         return r;
     }
-    if (std::find(channelNames.begin(), channelNames.end(), r) == channelNames.end()) {
+    if (channelNames.find(r) == channelNames.end()) {
         r = ccrName + wxString::Format("_%03d", node);
     } else {
         return r;
     }
-    if (std::find(channelNames.begin(), channelNames.end(), r) == channelNames.end()) {
+    if (channelNames.find(r) == channelNames.end()) {
         return r;
     }
     return "";
 }
 
+// the strand name a pixel channel from FindHLSStrandName belongs to
+static std::string HLSStrandName(const std::string &name) {
+    size_t end = name.find_last_not_of("0123456789");
+    if (end == std::string::npos || end == name.size() - 1) return "";
+    if (name[end] != 'P' && name[end] != '_') return "";
+    return name.substr(0, end);
+}
+
+// the channel name part of a ChanInfo
+static std::string HLSChannelName(const std::string &info) {
+    if (info.find(", Normal") != info.npos) {
+        return info.substr(0, info.find(", Normal"));
+    } else if (info.find(", RGB-") != info.npos) {
+        return info.substr(0, info.find(", RGB-"));
+    }
+    return "";
+}
+
 bool Contains(const std::vector<std::string> &array, const std::string &str) {
     return std::find(array.begin(), array.end(), str) != array.end();
 }
@@ -1987,16 +2056,108 @@ void xLightsFrame::ImportVix(const wxFileName &filename) {
     SetStatusText(wxString::Format("'%s' imported in %4.3f sec.", filename.GetPath(), elapsedTime));
 }
 
+// shows how far through the file a streamed import has read
+static XmlStreamReader::ProgressCallback MakeImportProgress(xLightsFrame *frame, const wxFileName &filename)
+{
+    auto last = std::make_shared<int>(-1);
+    wxString name = filename.GetFullName();
+    return [frame, name, last](wxFileOffset done, wxFileOffset size) {
+        int pct = size > 0 ? (int)(done * 100 / size) : 0;
+        if (pct != *last) {
+            *last = pct;
+            frame->SetStatusText(wxString::Format("Reading %s ... %d%%", name, pct));
+            wxYield();
+        }
+    };
+}
+
+// LOR S5 and Pixel Editor props are named either by an attribute or by their prop class
+static std::string GetLORPropName(wxXmlNode* prop)
+{
+    std::string name = prop->GetAttribute("name").ToStdString();
+    if (name == "") {
+        for (wxXmlNode* ap = prop->GetChildren(); ap != nullptr; ap = ap->GetNext()) {
+            if (ap->GetName() == "PropClass") {
+                name = ap->GetAttribute("Name").ToStdString();
+            }
+        }
+    }
+    return name;
+}
+
+// reads the props of a LOR S5 or Pixel Editor file for the mapping dialog ... it only needs to know which
+// tracks and channels have effects so all but the first effect of each is dropped as the props are read
+static bool ReadLORProps(xLightsFrame *frame, const wxFileName &filename, wxXmlDocument &doc)
+{
+    XmlStreamReader reader(filename.GetFullPath());
+    reader.Watch("SequenceProps/SeqProp");
+    reader.Watch("ArchivedProps/ArchiveProp");
+    reader.Watch("TimingGrids");
+    reader.Watch("PreviewClass");
+    return reader.Read([](const std::string& path, wxXmlNode* node) {
+        if (path == "TimingGrids" || path == "PreviewClass") return true;
+        for (wxXmlNode* tc = node->GetChildren(); tc != nullptr; tc = tc->GetNext()) {
+            if ((tc->GetName() == "track" || tc->GetName() == "channel") && tc->GetChildren() != nullptr) {
+                while (tc->GetChildren()->GetNext() != nullptr) {
+                    wxXmlNode* ef = tc->GetChildren()->GetNext();
+                    tc->RemoveChild(ef);
+                    delete ef;
+                }
+            }
+        }
+        return true;
+    }, MakeImportProgress(frame, filename), &doc) && doc.GetRoot() != nullptr;
+}
+
+// rereads a LOR S5 or Pixel Editor file keeping the effects of just the props which were mapped ... mappings
+// can carry node and strand details after the prop name so a prop is kept if any mapping starts with its name
+static bool ReadMappedLORProps(xLightsFrame *frame, const wxFileName &filename, xLightsImportTreeModel *dataModel, wxXmlDocument &doc)
+{
+    std::vector<std::string> mappings;
+    for (size_t i = 0; i < dataModel->GetChildCount(); ++i) {
+        xLightsImportModelNode* m = dataModel->GetNthChild(i);
+        std::list<xLightsImportModelNode*> nodes = { m };
+        for (size_t j = 0; j < m->GetChildCount(); j++) {
+            xLightsImportModelNode* s = m->GetNthChild(j);
+            nodes.push_back(s);
+            for (size_t n = 0; n < s->GetChildCount(); n++) {
+                nodes.push_back(s->GetNthChild(n));
+            }
+        }
+        for (auto node : nodes) {
+            if (node->_mapping != "") mappings.push_back(node->_mapping.ToStdString());
+        }
+    }
+
+    XmlStreamReader reader(filename.GetFullPath());
+    reader.Watch("SequenceProps/SeqProp");
+    reader.Watch("ArchivedProps/ArchiveProp");
+    reader.Watch("TimingGrids");
+    reader.Watch("PreviewClass");
+    return reader.Read([&mappings](const std::string& path, wxXmlNode* node) {
+        if (path == "TimingGrids" || path == "PreviewClass") return true;
+        std::string name = GetLORPropName(node);
+        if (name == "") return false;
+        for (const auto& it : mappings) {
+            if (StartsWith(it, name)) return true;
+        }
+        return false;
+    }, MakeImportProgress(frame, filename), &doc) && doc.GetRoot() != nullptr;
+}
+
 void xLightsFrame::ImportHLS(const wxFileName &filename)
 {
     wxStopWatch sw; // start a stopwatch timer
 
-    wxFileName xml_file(filename);
+    // the illumination data is most of the file so only the channel list is read for now and the data
+    // for just the mapped channels is read once the mapping is known
+    XmlStreamReader reader(filename.GetFullPath());
+    reader.Watch("NumberOfTimeCells");
+    reader.Watch("MilliSecPerTimeUnit");
+    reader.Watch("TotalUniverses/Universe/Channels/ChannelData");
+    reader.Ignore("TotalUniverses/Universe/Channels/ChannelData/IlluminationData");
     wxXmlDocument input_xml;
-    wxString xml_doc = xml_file.GetFullPath();
-    wxFileInputStream fin(xml_doc);
-
-    if( !input_xml.Load(fin) )  return;
+    if (!reader.Read([](const std::string&, wxXmlNode*) { return true; }, MakeImportProgress(this, filename), &input_xml) || input_xml.GetRoot() == nullptr) return;
 
     LMSImportChannelMapDialog dlg(this, filename);
     dlg.mSequenceElements = &_sequenceElements;
@@ -2072,6 +2233,37 @@ void xLightsFrame::ImportHLS(const wxFileName &filename)
         return;
     }
 
+    std::unordered_set<std::string> mapped;
+    for (int row = 0; row < dlg.ChannelMapGrid->GetNumberRows(); row++) {
+        std::string name = dlg.ChannelMapGrid->GetCellValue(row, 3).ToStdString();
+        if (name != "") mapped.insert(name);
+    }
+    bool byStrand = dlg.MapByStrand->GetValue();
+    XmlStreamReader dataReader(filename.GetFullPath());
+    dataReader.Watch("TotalUniverses/Universe/Channels/ChannelData");
+    wxXmlDocument data_xml;
+    bool ok = dataReader.Read([&mapped, byStrand](const std::string&, wxXmlNode* node) {
+        for (wxXmlNode* chani = node->GetChildren(); chani != nullptr; chani = chani->GetNext()) {
+            if (chani->GetName() == "ChanInfo" && chani->GetChildren() != nullptr) {
+                std::string name = HLSChannelName(chani->GetChildren()->GetContent().ToStdString());
+                if (name == "") return false;
+                return mapped.find(name) != mapped.end() || (byStrand && mapped.find(HLSStrandName(name)) != mapped.end());
+            }
+        }
+        return false;
+    }, MakeImportProgress(this, filename), &data_xml);
+    if (!ok || data_xml.GetRoot() == nullptr) return;
+
+    totalUniverses = nullptr;
+    for (wxXmlNode* tuniv = data_xml.GetRoot()->GetChildren(); tuniv != nullptr; tuniv = tuniv->GetNext()) {
+        if (tuniv->GetName() == "TotalUniverses") {
+            totalUniverses = tuniv;
+        }
+    }
+    if (totalUniverses == nullptr) return;
+    HLSChannelIndex channels = IndexHLSChannels(totalUniverses);
+    std::unordered_set<std::string> channelNames(dlg.channelNames.begin(), dlg.channelNames.end());
+
     int row = 0;
     for (size_t m = 0; m < dlg.modelNames.size(); m++) {
         std::string modelName = dlg.modelNames[m];
@@ -2084,7 +2276,7 @@ void xLightsFrame::ImportHLS(const wxFileName &filename)
             }
         }
         MapHLSChannelInformation(this, model->GetEffectLayer(0),
-                                 totalUniverses, frames, frameTime,
+                                 channels, frames, frameTime,
                                  dlg.ChannelMapGrid->GetCellValue(row, 3),
                                  dlg.ChannelMapGrid->GetCellBackgroundColour(row, 4),
                                  *mc, dlg.MapByStrand->GetValue(), false /*dlg.CheckBox_EraseExisting()->GetValue()*/);
@@ -2096,7 +2288,7 @@ void xLightsFrame::ImportHLS(const wxFileName &filename)
                 EffectLayer *sl = se->GetEffectLayer(0);
 
                 MapHLSChannelInformation(this, sl,
-                                         totalUniverses, frames, frameTime,
+                                         channels, frames, frameTime,
                                          dlg.ChannelMapGrid->GetCellValue(row, 3),
                                          dlg.ChannelMapGrid->GetCellBackgroundColour(row, 4),
                                          *mc, false, false /*dlg.CheckBox_EraseExisting()->GetValue()*/);
@@ -2110,7 +2302,7 @@ void xLightsFrame::ImportHLS(const wxFileName &filename)
             if ("" != dlg.ChannelMapGrid->GetCellValue(row, 3)) {
                 if (!dlg.MapByStrand->GetValue()) {
                     MapHLSChannelInformation(this, sl,
-                                             totalUniverses, frames, frameTime,
+                                             channels, frames, frameTime,
                                              dlg.ChannelMapGrid->GetCellValue(row, 3),
                                              dlg.ChannelMapGrid->GetCellBackgroundColour(row, 4),
                                              *mc, false, false /*dlg.CheckBox_EraseExisting()->GetValue()*/);
@@ -2119,10 +2311,10 @@ void xLightsFrame::ImportHLS(const wxFileName &filename)
                     for (int n = 0; n < se->GetNodeLayerCount(); n++) {
                         EffectLayer *layer = se->GetNodeLayer(n, true);
 
-                        wxString nm = FindHLSStrandName(ccrName, n+1, dlg.channelNames);
+                        wxString nm = FindHLSStrandName(ccrName, n+1, channelNames);
 
                         MapHLSChannelInformation(this, layer,
-                                                 totalUniverses, frames, frameTime,
+                                                 channels, frames, frameTime,
                                                  nm,
                                                  dlg.ChannelMapGrid->GetCellBackgroundColour(row, 4),
                                                  *mc, true, false /*dlg.CheckBox_EraseExisting()->GetValue()*/);
@@ -2137,7 +2329,7 @@ void xLightsFrame::ImportHLS(const wxFileName &filename)
                 for (int n = 0; n < mc->GetStrandLength(str); n++) {
                     if ("" != dlg.ChannelMapGrid->GetCellValue(row, 3)) {
                         MapHLSChannelInformation(this, se->GetNodeLayer(n, true),
-                                                 totalUniverses, frames, frameTime,
+                                                 channels, frames, frameTime,
                                                  dlg.ChannelMapGrid->GetCellValue(row, 3),
                                                  dlg.ChannelMapGrid->GetCellBackgroundColour(row, 4),
                                                  *mc, false, false /*dlg.CheckBox_EraseExisting()->GetValue()*/);
@@ -2156,13 +2348,16 @@ void xLightsFrame::ImportHLS(const wxFileName &filename)
 void xLightsFrame::ImportLMS(const wxFileName &filename) {
     wxStopWatch sw; // start a stopwatch timer
 
-    wxFileName xml_file(filename);
+    // the effects are most of the file so only the channel list is read for now ... ImportLMS reads
+    // the effects of just the channels which end up mapped
+    XmlStreamReader reader(filename.GetFullPath());
+    reader.Watch("channels/channel");
+    reader.Watch("channels/rgbChannel");
+    reader.Watch("timingGrids/timingGrid");
+    reader.Ignore("channels/channel/effect");
     wxXmlDocument input_xml;
-    wxString xml_doc = xml_file.GetFullPath();
-    wxFileInputStream fin(xml_doc);
-
-    if( !input_xml.Load(fin) )  return;
-    ImportLMS(input_xml, filename);
+    if (!reader.Read([](const std::string&, wxXmlNode*) { return true; }, MakeImportProgress(this, filename), &input_xml) || input_xml.GetRoot() == nullptr) return;
+    ImportLMS(input_xml, filename, true);
     float elapsedTime = sw.Time()/1000.0; //msec => sec
     SetStatusText(wxString::Format("'%s' imported in %4.3f sec.", filename.GetPath(), elapsedTime));
 }
@@ -2170,13 +2365,10 @@ void xLightsFrame::ImportLMS(const wxFileName &filename) {
 void xLightsFrame::ImportLPE(const wxFileName &filename) {
     wxStopWatch sw; // start a stopwatch timer
 
-    wxFileName xml_file(filename);
+    // the effects are only read for the props which end up mapped
     wxXmlDocument input_xml;
-    wxString xml_doc = xml_file.GetFullPath();
-    wxFileInputStream fin(xml_doc);
-
-    if (!input_xml.Load(fin))  return;
-    ImportLPE(input_xml, filename);
+    if (!ReadLORProps(this, filename, input_xml)) return;
+    ImportLPE(input_xml, filename, true);
     float elapsedTime = sw.Time() / 1000.0; //msec => sec
     SetStatusText(wxString::Format("'%s' imported in %4.3f sec.", filename.GetPath(), elapsedTime));
 }
@@ -2184,13 +2376,10 @@ void xLightsFrame::ImportLPE(const wxFileName &filename) {
 void xLightsFrame::ImportS5(const wxFileName &filename) {
     wxStopWatch sw; // start a stopwatch timer
 
-    wxFileName xml_file(filename);
+    // the effects are only read for the props which end up mapped
     wxXmlDocument input_xml;
-    wxString xml_doc = xml_file.GetFullPath();
-    wxFileInputStream fin(xml_doc);
-
-    if (!input_xml.Load(fin))  return;
-    ImportS5(input_xml, filename);
+    if (!ReadLORProps(this, filename, input_xml)) return;
+    ImportS5(input_xml, filename, true);
     float elapsedTime = sw.Time() / 1000.0; //msec => sec
     SetStatusText(wxString::Format("'%s' imported in %4.3f sec.", filename.GetPath(), elapsedTime));
 }
@@ -2318,34 +2507,68 @@ void xLightsFrame::ImportSuperStar(const wxFileName &filename)
     SetStatusText(wxString::Format("'%s' imported in %4.3f sec.", filename.GetPath(), elapsedTime));
 }
 
-bool findRGB(wxXmlNode *e, wxXmlNode *chan, wxXmlNode *&rchannel, wxXmlNode *&gchannel, wxXmlNode *&bchannel) {
-    wxString idxs[3];
+// finds the lms channels by name and saved index without walking every channel for every mapping
+struct LMSChannelIndex
+{
+    std::unordered_map<std::string, wxXmlNode*> byName; // name and name_Unit_x_Circuit_y ... the first one wins
+    std::unordered_map<std::string, wxXmlNode*> bySavedIndex;
+
+    LMSChannelIndex(wxXmlDocument &input_xml) {
+        for (wxXmlNode* e = input_xml.GetRoot()->GetChildren(); e != nullptr; e = e->GetNext()) {
+            if (e->GetName() != "channels") continue;
+            for (wxXmlNode* chan = e->GetChildren(); chan != nullptr; chan = chan->GetNext()) {
+                if (chan->GetName() == "channel" || chan->GetName() == "rgbChannel") {
+                    std::string name = chan->GetAttribute("name").ToStdString();
+                    std::string dedupname = name + "_Unit_" + chan->GetAttribute("unit").ToStdString() + "_Circuit_" + chan->GetAttribute("circuit").ToStdString();
+                    byName.emplace(name, chan);
+                    byName.emplace(dedupname, chan);
+                    if (chan->GetName() == "channel") {
+                        bySavedIndex[chan->GetAttribute("savedIndex").ToStdString()] = chan;
+                    }
+                }
+            }
+        }
+    }
+};
+
+bool findRGB(const LMSChannelIndex &index, wxXmlNode *chan, wxXmlNode *&rchannel, wxXmlNode *&gchannel, wxXmlNode *&bchannel) {
+    wxXmlNode **rgb[3] = { &rchannel, &gchannel, &bchannel };
     int cnt = 0;
     for (wxXmlNode *n = chan->GetChildren(); n != nullptr; n = n->GetNext()) {
         if (n->GetName() == "channels") {
             for (wxXmlNode *n2 = n->GetChildren(); n2 != nullptr; n2 = n2->GetNext()) {
                 if (n2->GetName() == "channel" && cnt < 3) {
-                    idxs[cnt] = n2->GetAttribute("savedIndex");
+                    auto it = index.bySavedIndex.find(n2->GetAttribute("savedIndex").ToStdString());
+                    if (it != index.bySavedIndex.end()) {
+                        *rgb[cnt] = it->second;
+                    }
                     cnt++;
                 }
             }
         }
     }
-    for (wxXmlNode* ch=e->GetChildren(); ch!=nullptr; ch=ch->GetNext()) {
-        if (ch->GetName() == "channel") {
-            wxString idx = ch->GetAttribute("savedIndex");
-            if (idx == idxs[0]) {
-                rchannel = ch;
-            }
-            if (idx == idxs[1]) {
-                gchannel = ch;
-            }
-            if (idx == idxs[2]) {
-                bchannel = ch;
-            }
+    return rchannel != nullptr && gchannel != nullptr && bchannel != nullptr;
+}
+
+// true if an lms rgb channel name looks like one pixel of a CCR ... ccrName is the part before the pixel number
+static bool IsLMSCCRChannel(const std::string &name, std::string &ccrName) {
+    int idxDP = name.find("-P");
+    int idxUP = name.find(" P");
+    int idxSP = name.find(" p");
+    if (idxUP > idxSP) {
+        idxSP = idxUP;
+    }
+    if (idxDP > idxSP) {
+        idxSP = idxDP;
+    }
+    if (idxSP != wxNOT_FOUND) {
+        int i = wxAtoi(name.substr(idxSP + 2, name.size()));
+        if (i > 0 && name != "") {
+            ccrName = name.substr(0, idxSP);
+            return true;
         }
     }
-    return true;
+    return false;
 }
 
 void GetRGBTimes(wxXmlNode *re, int &startms, int &endms) {
@@ -2626,39 +2849,25 @@ void MapOnEffects(EffectManager &effectManager, EffectLayer *layer, wxXmlNode *c
     }
 }
 
-bool MapChannelInformation(EffectManager &effectManager, EffectLayer *layer, wxXmlDocument &input_xml, const wxString &nm, const wxColor &color, const Model &mc, bool eraseExisting) {
+bool MapChannelInformation(EffectManager &effectManager, EffectLayer *layer, const LMSChannelIndex &index, const wxString &nm, const wxColor &color, const Model &mc, bool eraseExisting) {
     if ("" == nm) {
         return false;
     }
 
     if (eraseExisting) layer->DeleteAllEffects();
 
-    wxXmlNode *channel = nullptr;
-    wxXmlNode *rchannel = nullptr;
-    wxXmlNode *gchannel = nullptr;
-    wxXmlNode *bchannel = nullptr;
-    for (wxXmlNode* e = input_xml.GetRoot()->GetChildren(); channel == nullptr && e != nullptr; e = e->GetNext()) {
-        if (e->GetName() == "channels") {
-            for (wxXmlNode* chan = e->GetChildren(); channel == nullptr && chan != nullptr; chan = chan->GetNext()) {
-                std::string unit = chan->GetAttribute("unit");
-                std::string circuit = chan->GetAttribute("circuit");
-                std::string dedupname = chan->GetAttribute("name") + "_Unit_" + unit + "_Circuit_" + circuit;
-                if ((chan->GetName() == "channel" || chan->GetName() == "rgbChannel")
-                    && (nm == chan->GetAttribute("name") || nm == dedupname)) {
-                    channel = chan;
-                    if (chan->GetName() == "rgbChannel"
-                        && !findRGB(e, chan, rchannel, gchannel, bchannel)) {
-                        return false;
-                    }
-                    break;
-                }
-            }
-        }
-    }
-    if (channel == nullptr) {
+    auto it = index.byName.find(nm.ToStdString());
+    if (it == index.byName.end()) {
         return false;
     }
+    wxXmlNode *channel = it->second;
     if (channel->GetName() == "rgbChannel") {
+        wxXmlNode *rchannel = nullptr;
+        wxXmlNode *gchannel = nullptr;
+        wxXmlNode *bchannel = nullptr;
+        if (!findRGB(index, channel, rchannel, gchannel, bchannel)) {
+            return false;
+        }
         MapRGBEffects(effectManager, layer, rchannel, gchannel, bchannel);
     }
     else {
@@ -2667,7 +2876,7 @@ bool MapChannelInformation(EffectManager &effectManager, EffectLayer *layer, wxX
     return true;
 }
 
-void MapCCRModel(int& node, const std::vector<std::string>& channelNames, ModelElement* model, xLightsImportModelNode* m, Model* mc, wxXmlDocument &input_xml, EffectManager& effectManager, bool eraseExisting)
+void MapCCRModel(int& node, const std::unordered_set<std::string>& channelNames, ModelElement* model, xLightsImportModelNode* m, Model* mc, const LMSChannelIndex &index, EffectManager& effectManager, bool eraseExisting)
 {
     wxString ccrName = m->_mapping;
 
@@ -2679,20 +2888,20 @@ void MapCCRModel(int& node, const std::vector<std::string>& channelNames, ModelE
 
             EffectLayer *layer = se->GetNodeLayer(n, true);
             wxString nm = ccrName + wxString::Format("-P%02d", (node + 1));
-            if (std::find(channelNames.begin(), channelNames.end(), nm) == channelNames.end()) {
+            if (channelNames.find(nm.ToStdString()) == channelNames.end()) {
                 nm = ccrName + wxString::Format(" p%02d", (node + 1));
             }
-            if (std::find(channelNames.begin(), channelNames.end(), nm) == channelNames.end()) {
+            if (channelNames.find(nm.ToStdString()) == channelNames.end()) {
                 nm = ccrName + wxString::Format("-P%d", (node + 1));
             }
-            if (std::find(channelNames.begin(), channelNames.end(), nm) == channelNames.end()) {
+            if (channelNames.find(nm.ToStdString()) == channelNames.end()) {
                 nm = ccrName + wxString::Format(" p%d", (node + 1));
             }
-            if (std::find(channelNames.begin(), channelNames.end(), nm) == channelNames.end()) {
+            if (channelNames.find(nm.ToStdString()) == channelNames.end()) {
                 nm = ccrName + wxString::Format(" P %02d", (node + 1));
             }
             MapChannelInformation(effectManager,
-                layer, input_xml,
+                layer, index,
                 nm, m->_color,
                 *mc, eraseExisting);
             node++;
@@ -2700,7 +2909,7 @@ void MapCCRModel(int& node, const std::vector<std::string>& channelNames, ModelE
     }
 }
 
-void MapCCRStrand(const std::vector<std::string>& channelNames, StrandElement* se, xLightsImportModelNode* s, Model* mc, wxXmlDocument &input_xml, EffectManager& effectManager, bool eraseExisting)
+void MapCCRStrand(const std::unordered_set<std::string>& channelNames, StrandElement* se, xLightsImportModelNode* s, Model* mc, const LMSChannelIndex &index, EffectManager& effectManager, bool eraseExisting)
 {
     int node = 0;
     wxString ccrName = s->_mapping;
@@ -2708,27 +2917,27 @@ void MapCCRStrand(const std::vector<std::string>& channelNames, StrandElement* s
     for (int n = 0; n < se->GetNodeLayerCount(); n++) {
         EffectLayer *layer = se->GetNodeLayer(n, true);
         wxString nm = ccrName + wxString::Format("-P%02d", (node + 1));
-        if (std::find(channelNames.begin(), channelNames.end(), nm) == channelNames.end()) {
+        if (channelNames.find(nm.ToStdString()) == channelNames.end()) {
             nm = ccrName + wxString::Format(" p%02d", (node + 1));
         }
-        if (std::find(channelNames.begin(), channelNames.end(), nm) == channelNames.end()) {
+        if (channelNames.find(nm.ToStdString()) == channelNames.end()) {
             nm = ccrName + wxString::Format("-P%d", (node + 1));
         }
-        if (std::find(channelNames.begin(), channelNames.end(), nm) == channelNames.end()) {
+        if (channelNames.find(nm.ToStdString()) == channelNames.end()) {
             nm = ccrName + wxString::Format(" p%d", (node + 1));
         }
-        if (std::find(channelNames.begin(), channelNames.end(), nm) == channelNames.end()) {
+        if (channelNames.find(nm.ToStdString()) == channelNames.end()) {
             nm = ccrName + wxString::Format(" P %02d", (node + 1));
         }
         MapChannelInformation(effectManager,
-            layer, input_xml,
+            layer, index,
             nm, s->_color,
             *mc, eraseExisting);
         node++;
     }
 }
 
-void MapCCR(const std::vector<std::string>& channelNames, ModelElement* model, xLightsImportModelNode* m, Model* mc, wxXmlDocument &input_xml, EffectManager& effectManager, bool eraseExisting)
+void MapCCR(const std::unordered_set<std::string>& channelNames, ModelElement* model, xLightsImportModelNode* m, Model* mc, const LMSChannelIndex &index, EffectManager& effectManager, bool eraseExisting)
 {
     if (mc->GetDisplayAs() == "ModelGroup")
     {
@@ -2736,17 +2945,17 @@ void MapCCR(const std::vector<std::string>& channelNames, ModelElement* model, x
         int node = 0;
         for (auto it = mg->Models().begin(); it != mg->Models().end(); ++it)
         {
-            MapCCRModel(node, channelNames, model, m, *it, input_xml, effectManager, eraseExisting);
+            MapCCRModel(node, channelNames, model, m, *it, index, effectManager, eraseExisting);
         }
     }
     else
     {
         int node = 0;
-        MapCCRModel(node, channelNames, model, m, mc, input_xml, effectManager, eraseExisting);
+        MapCCRModel(node, channelNames, model, m, mc, index, effectManager, eraseExisting);
     }
 }
 
-bool xLightsFrame::ImportLMS(wxXmlDocument &input_xml, const wxFileName &filename)
+bool xLightsFrame::ImportLMS(wxXmlDocument &input_xml, const wxFileName &filename, bool effectsPending)
 {
     static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
     xLightsImportChannelMapDialog dlg(this, filename, true, true, true, true, false);
@@ -2754,6 +2963,8 @@ bool xLightsFrame::ImportLMS(wxXmlDocument &input_xml, const wxFileName &filenam
     dlg.xlights = this;
     std::vector<std::string> timingTrackNames;
     std::map<std::string, wxXmlNode*> timingTracks;
+    std::unordered_set<std::string> channelNameSet;
+    std::unordered_set<std::string> ccrNameSet;
 
     for(wxXmlNode* e=input_xml.GetRoot()->GetChildren(); e!=nullptr; e=e->GetNext()) {
         if (e->GetName() == "channels"){
@@ -2766,42 +2977,28 @@ bool xLightsFrame::ImportLMS(wxXmlDocument &input_xml, const wxFileName &filenam
                         std::string color = chan->GetAttribute("color").ToStdString();
                         std::string unit = chan->GetAttribute("unit").ToStdString();
                         std::string circuit = chan->GetAttribute("circuit").ToStdString();
-                        if (std::find(begin(dlg.channelNames), end(dlg.channelNames), name) != end(dlg.channelNames)) {
+                        if (channelNameSet.find(name) != channelNameSet.end()) {
                             name += "_Unit_" + unit + "_Circuit_" + circuit;
                         }
                         dlg.channelColors[name] = GetColor(color);
                     }
 
                     bool ccr = false;
-                    if (chan->GetName() == "rgbChannel") {
-                        int idxDP = name.find("-P");
-                        int idxUP = name.find(" P");
-                        int idxSP = name.find(" p");
-                        if (idxUP > idxSP) {
-                            idxSP = idxUP;
-                        }
-                        if (idxDP > idxSP) {
-                            idxSP = idxDP;
-                        }
-                        if (idxSP != wxNOT_FOUND) {
-                            int i = wxAtoi(name.substr(idxSP + 2, name.size()));
-                            if (i > 0 && name != "")
-                            {
-                                ccr = true;
-                                dlg.channelNames.push_back(name);
-                                //if (std::find(dlg.ccrNames.begin(), dlg.ccrNames.end(), name.substr(0, idxSP - 1)) == dlg.ccrNames.end())
-                                if (name.substr(0, idxSP) != "" && std::find(dlg.ccrNames.begin(), dlg.ccrNames.end(), name.substr(0, idxSP)) == dlg.ccrNames.end())
-                                {
-                                    //dlg.ccrNames.push_back(name.substr(0, idxSP - 1));
-                                    dlg.ccrNames.push_back(name.substr(0, idxSP));
-                                }
-                            }
+                    std::string ccrName;
+                    if (chan->GetName() == "rgbChannel" && IsLMSCCRChannel(name, ccrName)) {
+                        ccr = true;
+                        dlg.channelNames.push_back(name);
+                        channelNameSet.insert(name);
+                        if (ccrName != "" && ccrNameSet.insert(ccrName).second)
+                        {
+                            dlg.ccrNames.push_back(ccrName);
                         }
                     }
 
                     if (!ccr && name != "")
                     {
                         dlg.channelNames.push_back(name);
+                        channelNameSet.insert(name);
                     }
                 }
             }
@@ -2835,6 +3032,83 @@ bool xLightsFrame::ImportLMS(wxXmlDocument &input_xml, const wxFileName &filenam
         return false;
     }
 
+    if (effectsPending) {
+        // now we know what is mapped read the effects of just those channels
+        std::unordered_set<std::string> mapped;
+        std::unordered_set<std::string> mappedCCRs;
+        for (size_t i = 0; i < dlg._dataModel->GetChildCount(); ++i) {
+            xLightsImportModelNode* m = dlg._dataModel->GetNthChild(i);
+            std::list<xLightsImportModelNode*> nodes = { m };
+            for (size_t j = 0; j < m->GetChildCount(); j++) {
+                xLightsImportModelNode* s = m->GetNthChild(j);
+                nodes.push_back(s);
+                for (size_t n = 0; n < s->GetChildCount(); n++) {
+                    nodes.push_back(s->GetNthChild(n));
+                }
+            }
+            for (auto node : nodes) {
+                std::string mapping = node->_mapping.ToStdString();
+                if (mapping == "") continue;
+                if (ccrNameSet.find(mapping) != ccrNameSet.end()) {
+                    mappedCCRs.insert(mapping);
+                } else {
+                    mapped.insert(mapping);
+                }
+            }
+        }
+        auto isMapped = [&mapped, &mappedCCRs](wxXmlNode* chan) {
+            std::string name = chan->GetAttribute("name").ToStdString();
+            if (mapped.find(name) != mapped.end()) return true;
+            if (mapped.find(name + "_Unit_" + chan->GetAttribute("unit").ToStdString() + "_Circuit_" + chan->GetAttribute("circuit").ToStdString()) != mapped.end()) return true;
+            std::string ccrName;
+            return IsLMSCCRChannel(name, ccrName) && mappedCCRs.find(ccrName) != mappedCCRs.end();
+        };
+
+        // rgb channels come after the channels they use so work out which channels they need first
+        std::unordered_set<std::string> savedIndexes;
+        for (wxXmlNode* e = input_xml.GetRoot()->GetChildren(); e != nullptr; e = e->GetNext()) {
+            if (e->GetName() != "channels") continue;
+            for (wxXmlNode* chan = e->GetChildren(); chan != nullptr; chan = chan->GetNext()) {
+                if (chan->GetName() == "rgbChannel" && isMapped(chan)) {
+                    for (wxXmlNode *n = chan->GetChildren(); n != nullptr; n = n->GetNext()) {
+                        if (n->GetName() != "channels") continue;
+                        for (wxXmlNode *n2 = n->GetChildren(); n2 != nullptr; n2 = n2->GetNext()) {
+                            savedIndexes.insert(n2->GetAttribute("savedIndex").ToStdString());
+                        }
+                    }
+                }
+            }
+        }
+
+        XmlStreamReader reader(filename.GetFullPath());
+        reader.Watch("channels/channel");
+        reader.Watch("channels/rgbChannel");
+        reader.Watch("timingGrids/timingGrid");
+        wxXmlDocument effects_xml;
+        bool ok = reader.Read([&isMapped, &savedIndexes](const std::string& path, wxXmlNode* node) {
+            if (path == "timingGrids/timingGrid") return true;
+            if (isMapped(node)) return true;
+            return node->GetName() == "channel" && savedIndexes.find(node->GetAttribute("savedIndex").ToStdString()) != savedIndexes.end();
+        }, MakeImportProgress(this, filename), &effects_xml);
+        if (!ok || effects_xml.GetRoot() == nullptr) {
+            logger_base.error("LMS Import: Unable to read the effects from %s.", (const char *)filename.GetFullPath().c_str());
+            return false;
+        }
+        input_xml.SetRoot(effects_xml.DetachRoot());
+
+        timingTracks.clear();
+        for (wxXmlNode* e = input_xml.GetRoot()->GetChildren(); e != nullptr; e = e->GetNext()) {
+            if (e->GetName() != "timingGrids") continue;
+            for (wxXmlNode* timing = e->GetChildren(); timing != nullptr; timing = timing->GetNext()) {
+                std::string name = timing->GetAttribute("name", "").ToStdString();
+                if (timing->GetAttribute("type", "") != "fixed" && name != "") {
+                    timingTracks[name] = timing;
+                }
+            }
+        }
+    }
+    LMSChannelIndex index(input_xml);
+
     if (dlg.TimeAdjustSpinCtrl->GetValue() != 0) {
         int offset = dlg.TimeAdjustSpinCtrl->GetValue();
         AdjustAllTimings(input_xml.GetRoot(), offset / 10);
@@ -2896,14 +3170,14 @@ bool xLightsFrame::ImportLMS(wxXmlDocument &input_xml, const wxFileName &filenam
             }
             else
             {
-                if (std::find(dlg.ccrNames.begin(), dlg.ccrNames.end(), m->_mapping) != dlg.ccrNames.end())
+                if (ccrNameSet.find(m->_mapping.ToStdString()) != ccrNameSet.end())
                 {
-                    MapCCR(dlg.channelNames, model, m, mc, input_xml, effectManager, dlg.CheckBox_EraseExistingEffects->GetValue());
+                    MapCCR(channelNameSet, model, m, mc, index, effectManager, dlg.CheckBox_EraseExistingEffects->GetValue());
                 }
                 else
                 {
                     MapChannelInformation(effectManager,
-                        model->GetEffectLayer(0), input_xml,
+                        model->GetEffectLayer(0), index,
                         m->_mapping,
                         m->_color, *mc, dlg.CheckBox_EraseExistingEffects->GetValue());
                 }
@@ -2925,11 +3199,11 @@ bool xLightsFrame::ImportLMS(wxXmlDocument &input_xml, const wxFileName &filenam
                 }
                 else
                 {
-                    if (std::find(dlg.ccrNames.begin(), dlg.ccrNames.end(), s->_mapping) != dlg.ccrNames.end())
+                    if (ccrNameSet.find(s->_mapping.ToStdString()) != ccrNameSet.end())
                     {
                         StrandElement *se = model->GetStrand(str);
                         if (se != nullptr) {
-                            MapCCRStrand(dlg.channelNames, se, s, mc, input_xml, effectManager, dlg.CheckBox_EraseExistingEffects->GetValue());
+                            MapCCRStrand(channelNameSet, se, s, mc, index, effectManager, dlg.CheckBox_EraseExistingEffects->GetValue());
                         }
                         else                             {
                             logger_base.debug("LMS Import: Strand %d not found.", str);
@@ -2940,7 +3214,7 @@ bool xLightsFrame::ImportLMS(wxXmlDocument &input_xml, const wxFileName &filenam
                         SubModelElement *ste = model->GetSubModel(str);
                         if (ste != nullptr) {
                             MapChannelInformation(effectManager,
-                                ste->GetEffectLayer(0), input_xml,
+                                ste->GetEffectLayer(0), index,
                                 s->_mapping,
                                 s->_color, *mc, dlg.CheckBox_EraseExistingEffects->GetValue());
                         }
@@ -2968,7 +3242,7 @@ bool xLightsFrame::ImportLMS(wxXmlDocument &input_xml, const wxFileName &filenam
                             NodeLayer *nl = stre->GetNodeLayer(n, true);
                             if (nl != nullptr) {
                                 MapChannelInformation(effectManager,
-                                    nl, input_xml,
+                                    nl, index,
                                     ns->_mapping,
                                     ns->_color, *mc, dlg.CheckBox_EraseExistingEffects->GetValue());
                             }
@@ -4435,7 +4709,7 @@ void MapS5Effects(const EffectManager& effectManager, SubModelElement* se, const
     }
 }
 
-bool xLightsFrame::ImportS5(wxXmlDocument &input_xml, const wxFileName &filename)
+bool xLightsFrame::ImportS5(wxXmlDocument &input_xml, const wxFileName &filename, bool effectsPending)
 {
     static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
 
@@ -4464,6 +4738,16 @@ bool xLightsFrame::ImportS5(wxXmlDocument &input_xml, const wxFileName &filename
         return false;
     }
 
+    if (effectsPending) {
+        // now we know what is mapped read the effects of just those props ... lorEdit sees the new root
+        wxXmlDocument effects_xml;
+        if (!ReadMappedLORProps(this, filename, dlg._dataModel, effects_xml)) {
+            logger_base.error("S5 Import: Unable to read the effects from %s.", (const char *)filename.GetFullPath().c_str());
+            return false;
+        }
+        input_xml.SetRoot(effects_xml.DetachRoot());
+    }
+
     logger_base.debug("Importing S5 effects from %s.", (const char *)filename.GetFullPath().c_str());
 
     int offset = dlg.TimeAdjustSpinCtrl->GetValue();
@@ -4594,7 +4878,7 @@ bool xLightsFrame::ImportS5(wxXmlDocument &input_xml, const wxFileName &filename
     return true;
 }
 
-bool xLightsFrame::ImportLPE(wxXmlDocument &input_xml, const wxFileName &filename)
+bool xLightsFrame::ImportLPE(wxXmlDocument &input_xml, const wxFileName &filename, bool effectsPending)
 {
     static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
 
@@ -4641,6 +4925,16 @@ bool xLightsFrame::ImportLPE(wxXmlDocument &input_xml, const wxFileName &filenam
         return false;
     }
 
+    if (effectsPending) {
+        // now we know what is mapped read the effects of just those props
+        wxXmlDocument effects_xml;
+        if (!ReadMappedLORProps(this, filename, dlg._dataModel, effects_xml)) {
+            logger_base.error("LPE Import: Unable to read the effects from %s.", (const char *)filename.GetFullPath().c_str());
+            return false;
+        }
+        input_xml.SetRoot(effects_xml.DetachRoot());
+    }
+
     logger_base.debug("Importing LPE effects from %s.", (const char *)filename.GetFullPath().c_str());
 
     if (dlg.TimeAdjustSpinCtrl->GetValue() != 0) {
@@ -9,6 +9,7 @@
  **************************************************************/
 
 #include <wx/wx.h>
+#include <wx/stopwatch.h>
 
 
 #include <log4cpp/Category.hh>
@@ -26,6 +27,8 @@
 
 #include "SequenceData.h"
 #include "UtilFunctions.h"
+#include "SpecialOptions.h"
+#include "Parallel.h"
 
 const unsigned char FrameData::_constzero = 0;
 
@@ -92,6 +95,9 @@ SequenceData::SequenceData() : _invalidFrame()
     _numChannels = 0;
     _bytesPerFrame = 0;
     _frameTime = 50;
+    _sparse = false;
+    _sparseZeroFrame = nullptr;
+    _sparseFramesAllocated = 0;
 }
 
 SequenceData::~SequenceData()
@@ -112,6 +118,17 @@ SequenceData::DataBlock::~DataBlock()
 
 void SequenceData::Cleanup()
 {
+    if (_sparseZeroFrame != nullptr) {
+        for (auto& f : _frames) {
+            unsigned char* d = f._data.load();
+            if (d != _sparseZeroFrame) {
+                free(d);
+            }
+        }
+        free(_sparseZeroFrame);
+        _sparseZeroFrame = nullptr;
+        _sparseFramesAllocated = 0;
+    }
     _frames.clear();
 #ifdef USE_MMAP_BLOCKS
     for (auto& p : _dataBlocks) {
@@ -273,8 +290,17 @@ void SequenceData::init(unsigned int numChannels, unsigned int numFrames, unsign
     _numFrames = numFrames;
     _frameTime = frameTime;
     _bytesPerFrame = roundTo4(numChannels);
+    _sparse = SpecialOptions::GetOption("SparseSequenceData", "false") == "true";
 
-    if (numFrames > 0 && numChannels > 0) {
+    if (numFrames > 0 && numChannels > 0 && _sparse) {
+        _frames.reserve(numFrames);
+        _sparseZeroFrame = checkBlockPtr((unsigned char*)calloc(1, _bytesPerFrame), _bytesPerFrame);
+        for (unsigned int frame = 0; frame < numFrames; ++frame) {
+            _frames.push_back(FrameData(_numChannels, _sparseZeroFrame, this));
+        }
+        logger_base.debug("Sparse frame data. Frames=%d, Channels=%d, Frames are allocated when first written.", _numFrames, _numChannels);
+    }
+    else if (numFrames > 0 && numChannels > 0) {
         _frames.reserve(numFrames);
         size_t sizeRemaining = (size_t)_bytesPerFrame * (size_t)_numFrames;
         size_t blockSize = 0;
@@ -301,6 +327,70 @@ void SequenceData::init(unsigned int numChannels, unsigned int numFrames, unsign
     _invalidFrame._numChannels = _numChannels;
 }
 
+unsigned char* FrameData::Materialise()
+{
+    return _owner->AllocSparseFrame(*this);
+}
+
+unsigned char* SequenceData::AllocSparseFrame(FrameData& frame)
+{
+    unsigned char* d = (unsigned char*)calloc(1, _bytesPerFrame);
+    if (d == nullptr) {
+        return checkBlockPtr(d, _bytesPerFrame);
+    }
+
+    // render threads write different channels of the same frame so two of them can race to
+    // allocate it ... the loser frees its copy and uses the winners
+    unsigned char* expected = _sparseZeroFrame;
+    if (frame._data.compare_exchange_strong(expected, d, std::memory_order_acq_rel)) {
+        ++_sparseFramesAllocated;
+        return d;
+    }
+    free(d);
+    return expected;
+}
+
+size_t SequenceData::Compact()
+{
+    static log4cpp::Category& logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+    if (!_sparse || _sparseZeroFrame == nullptr) return 0;
+
+    wxStopWatch sw;
+    std::atomic_size_t released(0);
+    parallel_for(0, (int)_frames.size(), [this, &released](int frame) {
+        FrameData& f = _frames[frame];
+        unsigned char* d = f._data.load();
+        if (d != _sparseZeroFrame && memcmp(d, _sparseZeroFrame, _bytesPerFrame) == 0) {
+            f._data.store(_sparseZeroFrame);
+            free(d);
+            ++released;
+        }
+    }, 64);
+    _sparseFramesAllocated -= released.load();
+
+    logger_base.debug("Sparse frame data compacted in %ldms. Released %d frames, %d of %d frames allocated, %ldMB.",
+        sw.Time(), (int)released, (int)_sparseFramesAllocated, _numFrames, (long)(GetAllocatedBytes() / (1024 * 1024)));
+    return released;
+}
+
+size_t SequenceData::ReleaseFrames(unsigned int startFrame, unsigned int endFrame)
+{
+    if (!_sparse || _sparseZeroFrame == nullptr) return 0;
+
+    size_t released = 0;
+    for (unsigned int frame = startFrame; frame <= endFrame && frame < _numFrames; frame++) {
+        FrameData& f = _frames[frame];
+        unsigned char* d = f._data.load();
+        if (d != _sparseZeroFrame) {
+            f._data.store(_sparseZeroFrame);
+            free(d);
+            ++released;
+        }
+    }
+    _sparseFramesAllocated -= released;
+    return released;
+}
+
 // This encodes the sequence data grouped by channel
 wxString SequenceData::base64_encode()
 {
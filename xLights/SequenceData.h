@@ -11,9 +11,12 @@
  **************************************************************/
 
 #include <wx/wx.h>
+#include <atomic>
 #include <memory>
 #include <mutex>
 
+class SequenceData;
+
 class FrameData {
     FrameData(const FrameData&) = delete;
     FrameData &operator=(const FrameData& d) = delete;
@@ -21,32 +24,50 @@ class FrameData {
     static const unsigned char _constzero;
     unsigned char _zero;
     unsigned int _numChannels;
-    unsigned char* _data;
+    std::atomic<unsigned char*> _data;
+    // sparse frames point at a zero frame shared by the whole sequence until they are first written
+    const unsigned char* _sharedZero;
+    SequenceData* _owner;
     friend class SequenceData;
     
-    FrameData() : _zero(0), _numChannels(0), _data(nullptr) {}
-    FrameData(unsigned int nc, unsigned char *d) : _zero(0), _numChannels(nc), _data(d) {}
+    FrameData() : _zero(0), _numChannels(0), _data(nullptr), _sharedZero(nullptr), _owner(nullptr) {}
+    FrameData(unsigned int nc, unsigned char *d) : _zero(0), _numChannels(nc), _data(d), _sharedZero(nullptr), _owner(nullptr) {}
+    FrameData(unsigned int nc, unsigned char* zero, SequenceData* owner) : _zero(0), _numChannels(nc), _data(zero), _sharedZero(zero), _owner(owner) {}
+
+    unsigned char* Materialise();
+    unsigned char* WritableData() {
+        unsigned char* d = _data.load(std::memory_order_acquire);
+        if (_sharedZero != nullptr && d == _sharedZero) {
+            d = Materialise();
+        }
+        return d;
+    }
 
 public:
-    FrameData(const FrameData && d) noexcept : _zero(d._zero), _numChannels(d._numChannels), _data(d._data) {}
+    FrameData(const FrameData && d) noexcept : _zero(d._zero), _numChannels(d._numChannels), _data(d._data.load()), _sharedZero(d._sharedZero), _owner(d._owner) {}
     
+    bool IsAllocated() const { return _sharedZero == nullptr || _data.load(std::memory_order_acquire) != _sharedZero; }
+
     void Zero() {
-        memset(_data, 0x00, _numChannels);
+        // an unallocated sparse frame is already zero
+        if (!IsAllocated()) return;
+        memset(_data.load(std::memory_order_acquire), 0x00, _numChannels);
     }
     void Zero(unsigned int start, unsigned int count) {
         if (start < 0) return;
         if (count < 1) return;
         if (start + count > _numChannels) return;
-        memset(&_data[start], 0x00, count);
+        if (!IsAllocated()) return;
+        memset(&_data.load(std::memory_order_acquire)[start], 0x00, count);
     }
     
     unsigned char &operator[](unsigned int channel) {
         wxASSERT(_zero == 0);
-        return channel < _numChannels ? _data[channel] : _zero;
+        return channel < _numChannels ? WritableData()[channel] : _zero;
     }
     
     const unsigned char *operator[](unsigned int channel) const {
-        const unsigned char* cdata = _data;
+        const unsigned char* cdata = _data.load(std::memory_order_acquire);
         return channel < _numChannels ? &cdata[channel] : &_constzero;
     }
 };
@@ -80,12 +101,19 @@ class SequenceData {
     unsigned int _numFrames;
     unsigned int _frameTime;
 
+    // sparse mode ... frames are allocated individually the first time they are written
+    bool _sparse;
+    unsigned char* _sparseZeroFrame;
+    std::atomic<size_t> _sparseFramesAllocated;
+
     SequenceData(const SequenceData&) = delete;  //make sure we cannot "copy" these
     SequenceData &operator=(const SequenceData& rgb) = delete;
 
     void Cleanup();
     unsigned char *checkBlockPtr(unsigned char *block, size_t sizeRemaining);
     static unsigned char *AllocBlock(size_t requested, size_t &szAllocated, BlockType &bt);
+    unsigned char* AllocSparseFrame(FrameData& frame);
+    friend class FrameData;
 public:
     SequenceData();
     virtual ~SequenceData();
@@ -110,7 +138,24 @@ public:
     unsigned int NumChannels() const { return _numChannels;}
     unsigned int NumFrames() const { return _numFrames;}
     unsigned int FrameTime() const { return _frameTime;}
-    bool IsValidData() const { return !_dataBlocks.empty(); }
+    bool IsValidData() const { return !_dataBlocks.empty() || _sparseZeroFrame != nullptr; }
+
+    // Sparse mode is enabled using the special option SparseSequenceData=true. Frames which have
+    // never been written share a single zero frame so only frames which have been rendered, or
+    // loaded from a fseq, use memory
+    bool IsSparse() const { return _sparse; }
+    size_t GetAllocatedFrameCount() const { return _sparse ? _sparseFramesAllocated.load() : _numFrames; }
+    size_t GetAllocatedBytes() const { return GetAllocatedFrameCount() * (size_t)_bytesPerFrame; }
+
+    // returns frames which are entirely zero to the shared zero frame.
+    // Must only be called when nothing is rendering into or reading from the data
+    // returns the number of frames released
+    size_t Compact();
+
+    // returns a range of frames to the shared zero frame whatever they hold freeing their memory.
+    // Must only be called when nothing is rendering into or reading from those frames
+    // returns the number of frames released
+    size_t ReleaseFrames(unsigned int startFrame, unsigned int endFrame);
 
     // encodes contents of SeqData in channel order
     wxString base64_encode();
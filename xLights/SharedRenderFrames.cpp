@@ -0,0 +1,234 @@
+/***************************************************************
+ * This source files comes from the xLights project
+ * https://www.xlights.org
+ * https://github.com/smeighan/xLights
+ * See the github commit history for a record of contributing
+ * developers.
+ * Copyright claimed based on commit dates recorded in Github
+ * License: https://github.com/smeighan/xLights/blob/master/License.txt
+ **************************************************************/
+
+#include "SharedRenderFrames.h"
+#include "RenderBuffer.h"
+#include "UtilClasses.h"
+#include "sequencer/Element.h"
+#include "sequencer/EffectLayer.h"
+#include "sequencer/Effect.h"
+#include "effects/EffectManager.h"
+#include "effects/RenderableEffect.h"
+
+#include <log4cpp/Category.hh>
+
+// the most pixel data kept for other models at once ... past this the oldest frames are dropped
+#define MAX_SHARED_FRAME_BYTES (256 * 1024 * 1024)
+
+bool SharedRenderFrames::SizeKey::operator<(const SizeKey& k) const
+{
+    if (bufferWi != k.bufferWi) return bufferWi < k.bufferWi;
+    if (bufferHt != k.bufferHt) return bufferHt < k.bufferHt;
+    if (modelBufferWi != k.modelBufferWi) return modelBufferWi < k.modelBufferWi;
+    return modelBufferHt < k.modelBufferHt;
+}
+
+bool SharedRenderFrames::SizeKey::operator==(const SizeKey& k) const
+{
+    return bufferWi == k.bufferWi && bufferHt == k.bufferHt && modelBufferWi == k.modelBufferWi && modelBufferHt == k.modelBufferHt;
+}
+
+bool SharedRenderFrames::FrameKey::operator<(const FrameKey& k) const
+{
+    if (frame != k.frame) return frame < k.frame;
+    return size < k.size;
+}
+
+int SharedRenderFrames::Group::GetUsers(const SizeKey& size) const
+{
+    int users = unsized + variable;
+    auto it = sized.find(size);
+    if (it != sized.end()) {
+        users += it->second;
+    }
+    return users;
+}
+
+SharedRenderFrames::SharedRenderFrames(const std::list<Element*>& elements, EffectManager& effectManager) : _hits(0), _misses(0), _dropped(0), _bytes(0)
+{
+    static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    // effects render identically if they are the same effect with the same settings, palette and timing
+    std::map<std::string, std::list<const Effect*>> matching;
+    for (const auto& el : elements) {
+        for (size_t l = 0; l < el->GetEffectLayerCount(); ++l) {
+            EffectLayer* layer = el->GetEffectLayer(l);
+            for (int e = 0; e < layer->GetEffectCount(); ++e) {
+                const Effect* effect = layer->GetEffect(e);
+                if (effect->GetEffectIndex() == -1 || effect->IsRenderDisabled()) {
+                    continue;
+                }
+
+                RenderableEffect* reff = effectManager.GetEffect(effect->GetEffectIndex());
+                if (reff == nullptr || !reff->CanShareRender()) {
+                    continue;
+                }
+
+                // canvas and persistent effects start from whatever is already in the buffer
+                const SettingsMap& settings = effect->GetSettings();
+                if (settings.Get("T_CHECKBOX_Canvas", "0") == "1" || settings.Get("B_CHECKBOX_OverlayBkg", "0") == "1") {
+                    continue;
+                }
+
+                std::string key = effect->GetEffectName() + "\n" +
+                                  effect->GetSettingsAsString() + "\n" +
+                                  effect->GetPaletteAsString() + "\n" +
+                                  std::to_string(effect->GetStartTimeMS()) + "-" + std::to_string(effect->GetEndTimeMS());
+                matching[key].push_back(effect);
+            }
+        }
+    }
+
+    for (const auto& it : matching) {
+        if (it.second.size() < 2) {
+            continue;
+        }
+        _groups.push_back(std::make_unique<Group>());
+        Group* group = _groups.back().get();
+        group->unsized = it.second.size();
+        for (const auto& effect : it.second) {
+            const Element* element = effect->GetParentEffectLayer()->GetParentElement();
+            SharedEffect& se = _effects[effect];
+            se.group = group;
+            se.element = element;
+            se.changeCount = element->getChangeCount();
+        }
+    }
+
+    if (!_groups.empty()) {
+        logger_base.debug("Render will share frames between %d effects in %d groups.", (int)_effects.size(), (int)_groups.size());
+    }
+}
+
+SharedRenderFrames::SharedEffect* SharedRenderFrames::GetSharedEffect(const Effect* effect)
+{
+    auto it = _effects.find(effect);
+    if (it == _effects.end()) {
+        return nullptr;
+    }
+
+    // if the model has been changed while rendering its effects may no longer match
+    if (it->second.element->getChangeCount() != it->second.changeCount) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+SharedRenderFrames::FrameKey SharedRenderFrames::GetKey(const RenderBuffer& buffer)
+{
+    return { buffer.curPeriod - buffer.curEffStartPer, { buffer.BufferWi, buffer.BufferHt, buffer.ModelBufferWi, buffer.ModelBufferHt } };
+}
+
+void SharedRenderFrames::SetSize(SharedEffect& se, const SizeKey& size)
+{
+    Group* group = se.group;
+    if (se.variable || (se.sized && se.size == size)) {
+        return;
+    }
+
+    if (!se.sized) {
+        se.sized = true;
+        se.size = size;
+        --group->unsized;
+        ++group->sized[size];
+    } else {
+        // the buffer changed size part way through the effect so it could want a frame of any size
+        se.variable = true;
+        --group->sized[se.size];
+        ++group->variable;
+    }
+
+    // frames of other sizes may have been waiting only on this member
+    for (auto it = group->frames.begin(); it != group->frames.end();) {
+        auto next = std::next(it);
+        if (it->first.size != size && it->second.uses >= group->GetUsers(it->first.size)) {
+            EraseFrame(group, it);
+        }
+        it = next;
+    }
+}
+
+void SharedRenderFrames::UseFrame(Group* group, std::map<FrameKey, Frame>::iterator it)
+{
+    // once every model which could want the frame has had it, it is no longer needed
+    if (++it->second.uses >= group->GetUsers(it->first.size)) {
+        EraseFrame(group, it);
+    }
+}
+
+void SharedRenderFrames::EraseFrame(Group* group, std::map<FrameKey, Frame>::iterator it)
+{
+    _bytes -= it->second.pixels.size() * sizeof(xlColor);
+    group->frames.erase(it);
+}
+
+bool SharedRenderFrames::GetFrame(const Effect* effect, RenderBuffer& buffer)
+{
+    SharedEffect* se = GetSharedEffect(effect);
+    if (se == nullptr || buffer.IsDmxBuffer()) {
+        return false;
+    }
+
+    FrameKey key = GetKey(buffer);
+    Group* group = se->group;
+    std::unique_lock<std::mutex> lock(group->lock);
+    SetSize(*se, key.size);
+    auto it = group->frames.find(key);
+    if (it == group->frames.end() || it->second.pixels.size() != buffer.pixels.size()) {
+        ++_misses;
+        return false;
+    }
+
+    buffer.pixels = it->second.pixels;
+    UseFrame(group, it);
+    ++_hits;
+    return true;
+}
+
+void SharedRenderFrames::AddFrame(const Effect* effect, RenderBuffer& buffer)
+{
+    SharedEffect* se = GetSharedEffect(effect);
+    if (se == nullptr || buffer.IsDmxBuffer() || buffer.pixels.empty()) {
+        return;
+    }
+
+    FrameKey key = GetKey(buffer);
+    Group* group = se->group;
+    std::unique_lock<std::mutex> lock(group->lock);
+    SetSize(*se, key.size);
+
+    auto it = group->frames.find(key);
+    if (it != group->frames.end()) {
+        // another model rendered it at the same time ... ours is identical so just count the use
+        UseFrame(group, it);
+        return;
+    }
+    if (group->GetUsers(key.size) <= 1) {
+        // no other model can use it
+        return;
+    }
+
+    size_t bytes = buffer.pixels.size() * sizeof(xlColor);
+    // keep under the cap by dropping this group's oldest frames ... models render in frame order
+    // so the oldest are the ones least likely to still be wanted
+    while (_bytes + bytes > MAX_SHARED_FRAME_BYTES && !group->frames.empty()) {
+        EraseFrame(group, group->frames.begin());
+        ++_dropped;
+    }
+    if (_bytes + bytes > MAX_SHARED_FRAME_BYTES) {
+        ++_dropped;
+        return;
+    }
+
+    Frame& frame = group->frames[key];
+    frame.pixels = buffer.pixels;
+    frame.uses = 1;
+    _bytes += bytes;
+}
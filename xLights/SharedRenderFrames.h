@@ -0,0 +1,124 @@
+#pragma once
+
+/***************************************************************
+ * This source files comes from the xLights project
+ * https://www.xlights.org
+ * https://github.com/smeighan/xLights
+ * See the github commit history for a record of contributing
+ * developers.
+ * Copyright claimed based on commit dates recorded in Github
+ * License: https://github.com/smeighan/xLights/blob/master/License.txt
+ **************************************************************/
+
+#include <atomic>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Color.h"
+
+class Effect;
+class Element;
+class EffectManager;
+class RenderBuffer;
+
+// Frames rendered during one render which can be reused by other models.
+//
+// Shows often have the same effect with the same settings, palette and timing on many identical
+// models (mini trees, arches, candy canes). For effects whose output depends only on those and
+// the buffer size the first model to render a frame keeps it and every other matching model
+// copies it rather than rendering it again. Unlike the render cache this only lives for the
+// length of the render and is shared between models.
+class SharedRenderFrames
+{
+public:
+
+    // groups the effects on these elements which render identically ... main thread only
+    SharedRenderFrames(const std::list<Element*>& elements, EffectManager& effectManager);
+
+    // true if any effects were found which can share frames
+    bool HasSharedEffects() const { return !_effects.empty(); }
+
+    // copies the frame into the buffer if a matching model has already rendered it
+    bool GetFrame(const Effect* effect, RenderBuffer& buffer);
+    // keeps the frame just rendered into the buffer for the other models
+    void AddFrame(const Effect* effect, RenderBuffer& buffer);
+
+    size_t GetSharedEffectCount() const { return _effects.size(); }
+    size_t GetGroupCount() const { return _groups.size(); }
+    uint64_t GetHits() const { return _hits; }
+    uint64_t GetMisses() const { return _misses; }
+    // frames dropped early to keep under the memory cap
+    uint64_t GetDropped() const { return _dropped; }
+
+private:
+
+    struct SizeKey
+    {
+        int bufferWi;
+        int bufferHt;
+        int modelBufferWi;
+        int modelBufferHt;
+
+        bool operator<(const SizeKey& k) const;
+        bool operator==(const SizeKey& k) const;
+        bool operator!=(const SizeKey& k) const { return !(*this == k); }
+    };
+
+    struct FrameKey
+    {
+        int frame;
+        SizeKey size;
+
+        bool operator<(const FrameKey& k) const;
+    };
+
+    struct Frame
+    {
+        xlColorVector pixels;
+        int uses = 0;
+    };
+
+    // Members only share frames with members whose buffers are the same size and the sizes are not
+    // known until each renders. A member can use a frame until it has told us it is a different size.
+    struct Group
+    {
+        std::mutex lock;
+        int unsized = 0;
+        // members whose buffer size has changed part way through so they may want any size
+        int variable = 0;
+        std::map<SizeKey, int> sized;
+        std::map<FrameKey, Frame> frames;
+
+        int GetUsers(const SizeKey& size) const;
+    };
+
+    struct SharedEffect
+    {
+        Group* group;
+        const Element* element;
+        int changeCount;
+        // these are only touched under the group lock
+        bool sized = false;
+        bool variable = false;
+        SizeKey size = { 0, 0, 0, 0 };
+    };
+
+    SharedEffect* GetSharedEffect(const Effect* effect);
+    static FrameKey GetKey(const RenderBuffer& buffer);
+    // records the member's buffer size dropping frames no one left can use ... group lock must be held
+    void SetSize(SharedEffect& se, const SizeKey& size);
+    // counts the member's use of the frame dropping it once no one else can use it ... group lock must be held
+    void UseFrame(Group* group, std::map<FrameKey, Frame>::iterator it);
+    void EraseFrame(Group* group, std::map<FrameKey, Frame>::iterator it);
+
+    std::vector<std::unique_ptr<Group>> _groups;
+    std::map<const Effect*, SharedEffect> _effects;
+    std::atomic<uint64_t> _hits;
+    std::atomic<uint64_t> _misses;
+    std::atomic<uint64_t> _dropped;
+    // bytes of pixels held across all groups
+    std::atomic<size_t> _bytes;
+};
@@ -0,0 +1,451 @@
+/***************************************************************
+ * This source files comes from the xLights project
+ * https://www.xlights.org
+ * https://github.com/smeighan/xLights
+ * See the github commit history for a record of contributing
+ * developers.
+ * Copyright claimed based on commit dates recorded in Github
+ * License: https://github.com/smeighan/xLights/blob/master/License.txt
+ **************************************************************/
+
+#include <wx/wx.h>
+#include <wx/progdlg.h>
+#include <wx/stopwatch.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include "SoftwarePreviewRenderer.h"
+#include "ViewpointMgr.h"
+#include "VideoExporter.h"
+#include "SequenceData.h"
+#include "AudioManager.h"
+#include "Parallel.h"
+#include "models/Model.h"
+
+#include <log4cpp/Category.hh>
+
+namespace
+{
+    // rows are rasterised in bands so each band can be drawn on its own thread
+    const int BAND_HEIGHT = 16;
+
+    inline void BlendPixel(uint8_t* p, const xlColor& c, int coverage)
+    {
+        int a = (c.alpha * coverage) / 255;
+        if (a >= 255) {
+            p[0] = c.red;
+            p[1] = c.green;
+            p[2] = c.blue;
+        } else if (a > 0) {
+            int ia = 255 - a;
+            p[0] = (c.red * a + p[0] * ia) / 255;
+            p[1] = (c.green * a + p[1] * ia) / 255;
+            p[2] = (c.blue * a + p[2] * ia) / 255;
+        }
+    }
+}
+
+#pragma region SoftwarePreviewScene
+
+SoftwarePreviewScene::SoftwarePreviewScene(const std::vector<Model*>& models) : _models(models)
+{
+    for (const auto& m : _models) {
+        _nodeStart.push_back(_nodeCount);
+        _nodeCount += m->GetNodeCount();
+    }
+}
+
+const std::vector<SoftwarePreviewScene::Point>& SoftwarePreviewScene::GetPoints(bool is_3d)
+{
+    int i = is_3d ? 1 : 0;
+    if (!_pointsValid[i]) {
+        std::vector<Model::PreviewPoint> mp;
+        for (size_t m = 0; m < _models.size(); m++) {
+            Model* model = _models[m];
+            mp.clear();
+            model->GetPreviewPoints(is_3d, mp);
+            for (const auto& it : mp) {
+                _points[i].push_back({ it.x, it.y, it.z, it.radius, (uint32_t)(_nodeStart[m] + it.node), model->GetPixelStyle(), model->GetPixelSize() });
+            }
+        }
+        _pointsValid[i] = true;
+    }
+    return _points[i];
+}
+
+void SoftwarePreviewScene::GetNodeColours(const uint8_t* frameData, std::vector<xlColor>& colours)
+{
+    colours.resize(_nodeCount);
+
+    std::unique_lock<std::mutex> lock(_colourLock);
+    for (size_t m = 0; m < _models.size(); m++) {
+        Model* model = _models[m];
+        size_t nodeCount = model->GetNodeCount();
+        xlColor* out = &colours[_nodeStart[m]];
+        for (size_t n = 0; n < nodeCount; n++) {
+            model->SetNodeChannelValues(n, &frameData[model->NodeStartChannel(n)]);
+            out[n] = model->GetNodePreviewColor(n);
+        }
+    }
+}
+
+#pragma endregion
+
+#pragma region SoftwarePreviewRenderer
+
+SoftwarePreviewRenderer::SoftwarePreviewRenderer(SoftwarePreviewScene& scene, int width, int height) :
+    _scene(scene), _width(width), _height(height)
+{
+}
+
+void SoftwarePreviewRenderer::SetVirtualCanvasSize(int width, int height, bool center2D0)
+{
+    _virtualWidth = width;
+    _virtualHeight = height;
+    _center2D0 = center2D0;
+}
+
+void SoftwarePreviewRenderer::SetBackground(const wxString& imageFile, bool scaleImage, int brightness, int alpha)
+{
+    _backgroundImage = wxImage();
+    if (imageFile != "" && wxFileExists(imageFile)) {
+        _backgroundImage.LoadFile(imageFile);
+    }
+    _scaleImage = scaleImage;
+    _backgroundBrightness = brightness;
+    _backgroundAlpha = alpha;
+}
+
+void SoftwarePreviewRenderer::Prepare(const PreviewCamera& camera)
+{
+    // the view and projection here must match ModelPreview::StartDrawing
+    bool is_3d = camera.GetIs3D();
+    glm::mat4 projView;
+    float radiusScale = 1.0f;
+    float pointScale = 1.0f;
+    if (!is_3d) {
+        float scale2d = 1.0f;
+        float scale_corrx = 0.0f;
+        float scale_corry = 0.0f;
+        if (_virtualWidth != 0 && _virtualHeight != 0) {
+            float scale2dh = (float)_height / (float)_virtualHeight;
+            float scale2dw = (float)_width / (float)_virtualWidth;
+            if (scale2dh < scale2dw) {
+                scale2d = scale2dh;
+                scale_corrx = ((scale2dw * (float)_virtualWidth - (scale2d * (float)_virtualWidth)) * camera.GetZoom()) / 2.0f;
+            } else {
+                scale2d = scale2dw;
+                scale_corry = ((scale2dh * (float)_virtualHeight - (scale2d * (float)_virtualHeight)) * camera.GetZoom()) / 2.0f;
+            }
+        }
+        glm::mat4 ViewScale = glm::scale(glm::mat4(1.0f), glm::vec3(camera.GetZoom() * scale2d, camera.GetZoom() * scale2d, 1.0f));
+        glm::mat4 ViewTranslate = glm::translate(glm::mat4(1.0f), glm::vec3(camera.GetPanX() * camera.GetZoom() - camera.GetZoomCorrX() + scale_corrx, camera.GetPanY() * camera.GetZoom() - camera.GetZoomCorrY() + scale_corry, 0.0f));
+        glm::mat4 ViewMatrix = ViewTranslate * ViewScale;
+        if (_center2D0) {
+            glm::mat4 cTranslate = glm::translate(glm::mat4(1.0f), glm::vec3(((float)_virtualWidth) / 2.0f, 0.0f, 0.0f));
+            ViewMatrix = ViewTranslate * ViewScale * cTranslate;
+        }
+        glm::mat4 ProjMatrix = glm::ortho(0.0f, (float)_width, 0.0f, (float)_height);
+        projView = ProjMatrix * ViewMatrix;
+        radiusScale = camera.GetZoom() * scale2d;
+        pointScale = scale2d;
+    } else {
+        glm::mat4 ViewTranslatePan = glm::translate(glm::mat4(1.0f), glm::vec3(camera.GetPosX() + camera.GetPanX(), camera.GetPosY() + camera.GetPanY(), camera.GetPosZ() + camera.GetPanZ()));
+        glm::mat4 ViewTranslateDistance = glm::translate(glm::mat4(1.0f), glm::vec3(1.0f, 1.0f, camera.GetDistance() * camera.GetZoom()));
+        glm::mat4 ViewRotateX = glm::rotate(glm::mat4(1.0f), glm::radians(camera.GetAngleX()), glm::vec3(1.0f, 0.0f, 0.0f));
+        glm::mat4 ViewRotateY = glm::rotate(glm::mat4(1.0f), glm::radians(camera.GetAngleY()), glm::vec3(0.0f, 1.0f, 0.0f));
+        glm::mat4 ViewMatrix = ViewTranslateDistance * ViewRotateX * ViewRotateY * ViewTranslatePan;
+        glm::mat4 ProjMatrix = glm::perspective(glm::radians(45.0f), (float)_width / (float)_height, 1.0f, 20000.0f);
+        projView = ProjMatrix * ViewMatrix;
+        // pixels per world unit at a clip w of 1
+        radiusScale = ProjMatrix[1][1] * (float)_height / 2.0f;
+    }
+
+    // node positions do not change during an export so project them once
+    const std::vector<SoftwarePreviewScene::Point>& points = _scene.GetPoints(is_3d);
+    std::vector<float> depth;
+    _points.clear();
+    _points.reserve(points.size());
+    for (const auto& it : points) {
+        glm::vec4 clip = projView * glm::vec4(it.x, it.y, it.z, 1.0f);
+        if (clip.w <= 0.0001f) continue;
+        ScreenPoint p;
+        p.x = (clip.x / clip.w + 1.0f) * 0.5f * (float)_width;
+        p.y = (1.0f - clip.y / clip.w) * 0.5f * (float)_height;
+        p.colour = it.colour;
+        p.style = it.style;
+        if (it.style > 1) {
+            p.radius = it.radius * radiusScale / clip.w;
+        } else {
+            p.radius = std::max(1.0f, (float)it.size * pointScale) / 2.0f;
+        }
+        if (p.x + p.radius < 0 || p.y + p.radius < 0 || p.x - p.radius > _width || p.y - p.radius > _height) continue;
+        _points.push_back(p);
+        depth.push_back(clip.w);
+    }
+
+    if (is_3d) {
+        // there is no depth buffer so draw the furthest nodes first
+        std::vector<uint32_t> order(_points.size());
+        for (uint32_t i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [&depth](uint32_t a, uint32_t b) { return depth[a] > depth[b]; });
+        std::vector<ScreenPoint> sorted;
+        sorted.reserve(_points.size());
+        for (auto i : order) {
+            sorted.push_back(_points[i]);
+        }
+        _points.swap(sorted);
+    }
+
+    _bands.clear();
+    _bands.resize((_height + BAND_HEIGHT - 1) / BAND_HEIGHT);
+    for (uint32_t i = 0; i < _points.size(); i++) {
+        const ScreenPoint& p = _points[i];
+        int first = std::max(0, (int)std::floor(p.y - p.radius - 1.0f) / BAND_HEIGHT);
+        int last = std::min((int)_bands.size() - 1, (int)std::floor(p.y + p.radius + 1.0f) / BAND_HEIGHT);
+        for (int b = first; b <= last; b++) {
+            _bands[b].push_back(i);
+        }
+    }
+
+    PrepareBackground(projView);
+}
+
+void SoftwarePreviewRenderer::PrepareBackground(const glm::mat4& projView)
+{
+    _background.clear();
+    if (!_backgroundImage.IsOk() || _virtualWidth == 0 || _virtualHeight == 0) {
+        return;
+    }
+    _background.resize(_width * _height * 3);
+
+    int iw = _backgroundImage.GetWidth();
+    int ih = _backgroundImage.GetHeight();
+    float scaleh = 1.0f;
+    float scalew = 1.0f;
+    if (!_scaleImage) {
+        float nscaleh = float(ih) / float(_virtualHeight);
+        float nscalew = float(iw) / float(_virtualWidth);
+        if (nscalew < nscaleh) {
+            scalew = nscalew / nscaleh;
+        } else {
+            scaleh = nscaleh / nscalew;
+        }
+    }
+    float x0 = _center2D0 ? -(float)_virtualWidth / 2.0f : 0.0f;
+    float qw = _virtualWidth * scalew;
+    float qh = _virtualHeight * scaleh;
+
+    // the image lies on the z = 0 plane so screen to image is a homography
+    glm::mat3 h(glm::vec3(projView[0][0], projView[0][1], projView[0][3]),
+                glm::vec3(projView[1][0], projView[1][1], projView[1][3]),
+                glm::vec3(projView[3][0], projView[3][1], projView[3][3]));
+    glm::mat3 hi = glm::inverse(h);
+
+    const unsigned char* data = _backgroundImage.GetData();
+    const unsigned char* alpha = _backgroundImage.HasAlpha() ? _backgroundImage.GetAlpha() : nullptr;
+    int scale = _backgroundBrightness * _backgroundAlpha * 255 / 100;
+
+    parallel_for(0, _height, [&](int y) {
+        uint8_t* row = &_background[y * _width * 3];
+        float ny = 1.0f - ((float)y + 0.5f) / (float)_height * 2.0f;
+        for (int x = 0; x < _width; x++) {
+            float nx = ((float)x + 0.5f) / (float)_width * 2.0f - 1.0f;
+            glm::vec3 p = hi * glm::vec3(nx, ny, 1.0f);
+            if (p.z <= 0.0f) continue;
+            float u = (p.x / p.z - x0) / qw;
+            float v = (p.y / p.z) / qh;
+            if (u < 0.0f || u >= 1.0f || v < 0.0f || v >= 1.0f) continue;
+            int ix = std::min(iw - 1, (int)(u * iw));
+            int iy = std::min(ih - 1, (int)((1.0f - v) * ih));
+            int idx = iy * iw + ix;
+            int s = alpha == nullptr ? scale : scale * alpha[idx] / 255;
+            row[x * 3] = data[idx * 3] * s / 25500;
+            row[x * 3 + 1] = data[idx * 3 + 1] * s / 25500;
+            row[x * 3 + 2] = data[idx * 3 + 2] * s / 25500;
+        }
+    }, 32);
+}
+
+void SoftwarePreviewRenderer::DrawPoint(const ScreenPoint& p, uint8_t* buf, int y0, int y1) const
+{
+    const xlColor& c = _colours[p.colour];
+    if (c.alpha == 0) return;
+
+    float r = std::max(0.5f, p.radius);
+    int top = std::max(y0, (int)std::floor(p.y - r));
+    int bottom = std::min(y1, (int)std::ceil(p.y + r) + 1);
+    int left = std::max(0, (int)std::floor(p.x - r));
+    int right = std::min(_width, (int)std::ceil(p.x + r) + 1);
+
+    for (int y = top; y < bottom; y++) {
+        float dy = (float)y + 0.5f - p.y;
+        uint8_t* row = buf + y * _width * 3;
+        for (int x = left; x < right; x++) {
+            float dx = (float)x + 0.5f - p.x;
+            int coverage;
+            switch (p.style) {
+            case 0: // square
+                coverage = (std::abs(dx) <= r && std::abs(dy) <= r) ? 255 : 0;
+                break;
+            case 1: // smooth ... antialiased disc
+            {
+                float d = r + 0.5f - std::sqrt(dx * dx + dy * dy);
+                coverage = d >= 1.0f ? 255 : (d <= 0.0f ? 0 : (int)(d * 255.0f));
+                break;
+            }
+            case 2: // solid circle
+                coverage = (dx * dx + dy * dy <= r * r) ? 255 : 0;
+                break;
+            default: // blended circle fades to transparent at the edge
+            {
+                float d = 1.0f - std::sqrt(dx * dx + dy * dy) / r;
+                coverage = d <= 0.0f ? 0 : (int)(d * 255.0f);
+                break;
+            }
+            }
+            if (coverage > 0) {
+                BlendPixel(row + x * 3, c, coverage);
+            }
+        }
+    }
+}
+
+bool SoftwarePreviewRenderer::Render(const uint8_t* frameData, uint8_t* buf, int bufSize)
+{
+    if (bufSize < _width * _height * 3) return false;
+
+    _scene.GetNodeColours(frameData, _colours);
+
+    parallel_for(0, (int)_bands.size(), [this, buf](int b) {
+        int y0 = b * BAND_HEIGHT;
+        int y1 = std::min(_height, y0 + BAND_HEIGHT);
+        size_t offset = y0 * _width * 3;
+        size_t size = (y1 - y0) * _width * 3;
+        if (_background.empty()) {
+            memset(buf + offset, 0, size);
+        } else {
+            memcpy(buf + offset, &_background[offset], size);
+        }
+        for (auto i : _bands[b]) {
+            DrawPoint(_points[i], buf, y0, y1);
+        }
+    });
+    return true;
+}
+
+bool SoftwarePreviewRenderer::ExportVideos(wxWindow* parent, const std::vector<std::pair<std::string, SoftwarePreviewRenderer*>>& views,
+                                           const SequenceData& seqData, AudioManager* audio, std::string& error)
+{
+    static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    int frameCount = seqData.NumFrames();
+    int audioSampleRate = audio == nullptr ? 0 : audio->GetRate();
+    if (frameCount == 0 || views.empty()) return false;
+
+    std::atomic_bool cancelled(false);
+    std::vector<std::atomic_int> progress(views.size());
+    std::vector<std::atomic_bool> done(views.size());
+    std::vector<std::string> errors(views.size());
+    std::vector<std::thread> threads;
+
+    wxStopWatch sw;
+    for (size_t i = 0; i < views.size(); i++) {
+        progress[i] = 0;
+        done[i] = false;
+        threads.emplace_back([&, i]() {
+            const std::string& path = views[i].first;
+            SoftwarePreviewRenderer* renderer = views[i].second;
+            try {
+                // the renderer fills the whole buffer so it must already be the even size the encoder wants
+                GenericVideoExporter exporter(path, GenericVideoExporter::makeRGB24Params(renderer->GetWidth(), renderer->GetHeight(), 1000u / seqData.FrameTime(), audioSampleRate), audioSampleRate == 0);
+
+                exporter.setGetVideoCallback([&seqData, renderer, frameCount](uint8_t* buf, int bufSize, unsigned frameIndex) {
+                    const FrameData& frameData(seqData[std::min(frameIndex, (unsigned)frameCount - 1)]);
+                    return renderer->Render(frameData[0], buf, bufSize);
+                });
+                if (audio != nullptr) {
+                    auto audioFrameIndex = std::make_shared<long>(0);
+                    exporter.setGetAudioCallback([audio, audioFrameIndex](float* leftCh, float* rightCh, int frameSize) {
+                        long trackSize = audio->GetTrackSize();
+                        long clampedSize = std::min((long)frameSize, trackSize - *audioFrameIndex);
+                        if (clampedSize > 0) {
+                            const float* leftptr = audio->GetLeftDataPtr(*audioFrameIndex);
+                            const float* rightptr = audio->GetRightDataPtr(*audioFrameIndex);
+                            if (leftptr != nullptr) {
+                                std::memcpy(leftCh, leftptr, clampedSize * sizeof(float));
+                                std::memcpy(rightCh, rightptr, clampedSize * sizeof(float));
+                                *audioFrameIndex += frameSize;
+                            }
+                        }
+                        return true;
+                    });
+                }
+                exporter.setQueryForCancelCallback([&cancelled]() { return (bool)cancelled; });
+                exporter.setProgressReportCallback([&progress, i](int value) { progress[i] = value; });
+
+                exporter.initialize();
+                exporter.exportFrames(frameCount);
+                if (!cancelled) {
+                    exporter.completeExport();
+                }
+            } catch (const std::runtime_error& re) {
+                errors[i] = re.what();
+            }
+            done[i] = true;
+        });
+    }
+
+    {
+        int style = wxPD_APP_MODAL | wxPD_AUTO_HIDE | wxPD_CAN_ABORT;
+        wxProgressDialog dlg(_("Export progress"), _("Exporting video..."), 100, parent, style);
+        bool running = true;
+        while (running) {
+            running = false;
+            int p = 100;
+            for (size_t i = 0; i < views.size(); i++) {
+                if (!done[i]) {
+                    running = true;
+                    p = std::min(p, (int)progress[i]);
+                }
+            }
+            if (running) {
+                if (!dlg.Update(std::min(p, 99))) {
+                    cancelled = true;
+                }
+                wxMilliSleep(50);
+            }
+        }
+        dlg.Hide();
+    }
+
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    bool status = true;
+    for (size_t i = 0; i < views.size(); i++) {
+        if (errors[i] != "") {
+            logger_base.error("Error exporting video %s : %s", (const char*)views[i].first.c_str(), (const char*)errors[i].c_str());
+            error = errors[i];
+            status = false;
+        }
+    }
+    if (cancelled) {
+        logger_base.info("Software video export was cancelled.");
+    }
+    logger_base.debug("Software rendered %d frames to %d videos in %ldms.", frameCount, (int)views.size(), sw.Time());
+    return status;
+}
+
+#pragma endregion
@@ -0,0 +1,128 @@
+#pragma once
+
+/***************************************************************
+ * This source files comes from the xLights project
+ * https://www.xlights.org
+ * https://github.com/smeighan/xLights
+ * See the github commit history for a record of contributing
+ * developers.
+ * Copyright claimed based on commit dates recorded in Github
+ * License: https://github.com/smeighan/xLights/blob/master/License.txt
+ **************************************************************/
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <wx/image.h>
+
+#include <glm/glm.hpp>
+
+#include "Color.h"
+
+class Model;
+class PreviewCamera;
+class SequenceData;
+class AudioManager;
+class wxWindow;
+
+// The models shown in a preview captured so they can be drawn without OpenGL.
+//
+// The node positions are captured once (they do not change while a sequence is exported)
+// and only the node colours are recalculated each frame. One scene can be shared by any
+// number of renderers each looking at it from a different camera.
+class SoftwarePreviewScene
+{
+public:
+
+    struct Point
+    {
+        float x;
+        float y;
+        float z;
+        float radius;   // world space radius for the circle pixel styles
+        uint32_t colour; // index into the node colours
+        int style;
+        int size;
+    };
+
+    SoftwarePreviewScene(const std::vector<Model*>& models);
+
+    // the node coordinates of every model ... must be called on the main thread
+    const std::vector<Point>& GetPoints(bool is_3d);
+
+    size_t GetNodeCount() const { return _nodeCount; }
+
+    // works out the colour of every node for a frame of channel data. The models hold the
+    // node colours so this is serialised across all the renderers using the scene
+    void GetNodeColours(const uint8_t* frameData, std::vector<xlColor>& colours);
+
+private:
+
+    std::vector<Model*> _models;
+    std::vector<size_t> _nodeStart;
+    size_t _nodeCount = 0;
+    std::vector<Point> _points[2];
+    bool _pointsValid[2] = { false, false };
+    std::mutex _colourLock;
+};
+
+// Draws a scene from one camera into an RGB24 buffer using the CPU. This produces the same
+// picture as the house preview (node positions, pixel styles and sizes and the background
+// image) without needing an OpenGL context so it can be used to export video on machines
+// without a usable GPU and to export several viewpoints at once.
+class SoftwarePreviewRenderer
+{
+public:
+
+    SoftwarePreviewRenderer(SoftwarePreviewScene& scene, int width, int height);
+
+    void SetVirtualCanvasSize(int width, int height, bool center2D0);
+    void SetBackground(const wxString& imageFile, bool scaleImage, int brightness, int alpha);
+
+    // projects the scene and background through the camera ... must be called on the main thread
+    void Prepare(const PreviewCamera& camera);
+
+    int GetWidth() const { return _width; }
+    int GetHeight() const { return _height; }
+
+    // draws a frame of channel data. The buffer is rows of RGB24 top to bottom
+    bool Render(const uint8_t* frameData, uint8_t* buf, int bufSize);
+
+    // exports the sequence as one video per renderer with all of them rendered and encoded at the same time
+    static bool ExportVideos(wxWindow* parent, const std::vector<std::pair<std::string, SoftwarePreviewRenderer*>>& views,
+                             const SequenceData& seqData, AudioManager* audio, std::string& error);
+
+private:
+
+    struct ScreenPoint
+    {
+        float x;
+        float y;
+        float radius;
+        uint32_t colour;
+        int style;
+    };
+
+    void PrepareBackground(const glm::mat4& projView);
+    void DrawPoint(const ScreenPoint& p, uint8_t* buf, int y0, int y1) const;
+
+    SoftwarePreviewScene& _scene;
+    int _width;
+    int _height;
+    int _virtualWidth = 0;
+    int _virtualHeight = 0;
+    bool _center2D0 = false;
+
+    wxImage _backgroundImage;
+    bool _scaleImage = false;
+    int _backgroundBrightness = 100;
+    int _backgroundAlpha = 100;
+
+    std::vector<ScreenPoint> _points;           // in the order they are drawn
+    std::vector<std::vector<uint32_t>> _bands;  // the points touching each band of rows
+    std::vector<uint8_t> _background;
+    std::vector<xlColor> _colours;
+};
@@ -43,6 +43,7 @@ extern "C"
 #include "xLightsMain.h"
 #include "FSEQFile.h"
 #include "CopyFormat1.h"
+#include "SpecialOptions.h"
 
 #include <log4cpp/Category.hh>
 
@@ -1470,3 +1471,73 @@ void xLightsFrame:: WriteFalconPiFile(const wxString& filename)
     
     FileConverter::WriteFalconPiFile(write_params);
 }
+
+// A batch render can render the sequence a window of frames at a time writing each window to the
+// fseq as soon as it is complete and then releasing it so the memory used depends on the window size
+// rather than the length of the sequence. Enabled using the special options WindowedRender=true and
+// SparseSequenceData=true. WindowedRenderSeconds sets the window size (default 30).
+bool xLightsFrame::IsWindowedRenderPossible()
+{
+    static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    if (SpecialOptions::GetOption("WindowedRender", "false") != "true") return false;
+
+    if (!_seqData.IsSparse()) {
+        logger_base.warn("Windowed render needs sparse sequence data ... rendering the whole sequence.");
+        return false;
+    }
+
+    // data layers are merged over the whole sequence either side of the effects so need every frame in memory
+    DataLayerSet& data_layers = CurrentSeqXmlFile->GetDataLayers();
+    for (int i = 0; i < data_layers.GetNumLayers(); i++) {
+        DataLayer* layer = data_layers.GetDataLayer(i);
+        if (layer->GetName() != "Nutcracker" || layer->GetDataSource() == xLightsXmlFile::CANVAS_MODE) {
+            logger_base.info("Windowed render not possible with data layers ... rendering the whole sequence.");
+            return false;
+        }
+    }
+    return true;
+}
+
+bool xLightsFrame::RenderGridToFalconPiFile(const wxString& filename, std::function<void()>&& callback)
+{
+    static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    ConvertParameters write_params(filename,                                     // filename
+                                   _seqData,                                      // sequence data object
+                                   &_outputManager,                               // global network info
+                                   ConvertParameters::READ_MODE_LOAD_MAIN,       // file read mode
+                                   this,                                         // xLights main frame
+                                   nullptr,
+                                   nullptr,
+                                   &mediaFilename, // media filename
+                                   nullptr,
+                                   filename);
+
+    FSEQFile* file = FileConverter::CreateFalconPiFile(write_params);
+    if (file == nullptr) {
+        return false;
+    }
+
+    int seconds = wxAtoi(SpecialOptions::GetOption("WindowedRenderSeconds", "30"));
+    if (seconds < 1) seconds = 30;
+    int windowFrames = std::max(1, seconds * 1000 / (int)_seqData.FrameTime());
+
+    // whatever was loaded from the old fseq is about to be rendered over
+    _seqData.ReleaseFrames(0, _seqData.NumFrames() - 1);
+
+    std::function<void()> cb(std::move(callback));
+    RenderGridToSeqDataWindowed(windowFrames, [this, file](int start, int end) {
+        for (int x = start; x <= end; x++) {
+            file->addFrame(x, _seqData[x][0]);
+        }
+        _seqData.ReleaseFrames(start, end);
+        logger_base.debug("Render window frames %d-%d written to fseq. %ldMB of frame data in use.",
+            start, end, (long)(_seqData.GetAllocatedBytes() / (1024 * 1024)));
+    }, [file, cb] {
+        file->finalize();
+        delete file;
+        cb();
+    });
+    return true;
+}
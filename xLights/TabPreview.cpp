@@ -29,7 +29,8 @@ void xLightsFrame::ShowPreviewTime(long ElapsedMSec)
 void xLightsFrame::PreviewOutput(int period)
 {
     TimerOutput(period);
-    modelPreview->Render(&_seqData[period][0]);
+    const FrameData& frame(_seqData[period]);
+    modelPreview->Render(frame[0]);
 }
 
 void xLightsFrame::SetStoredLayoutGroup(const std::string &group)
@@ -297,6 +297,7 @@ wxString xLightsFrame::LoadEffectsFileNoCheck()
         SetXmlSetting("renderCacheDir", showDirectory);
         UnsavedRgbEffectsChanges = true;
     }
+    UpdateAudioCacheFolder();
 
     mStoredLayoutGroup = GetXmlSetting("storedLayoutGroup", "Default");
 
@@ -1069,22 +1070,31 @@ void xLightsFrame::OpenRenderAndSaveSequences(const wxArrayString &origFilenames
     ProgressBar->Show();
     GaugeSizer->Layout();
     logger_base.info("Rendering on save.");
-    RenderIseqData(true, nullptr); // render ISEQ layers below the Nutcracker layer
-    logger_base.info("   iseq below effects done.");
+
+    // a windowed render writes the fseq as it goes so there is nothing left to write when it is done
+    bool windowed = IsWindowedRenderPossible();
+    if (!windowed) {
+        RenderIseqData(true, nullptr); // render ISEQ layers below the Nutcracker layer
+        logger_base.info("   iseq below effects done.");
+    }
     ProgressBar->SetValue(10);
-    RenderGridToSeqData([this, sw, fileNames, exitOnDone] {
+    std::function<void()> done = [this, sw, fileNames, exitOnDone, windowed] {
         static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
         logger_base.info("   Effects done.");
         ProgressBar->SetValue(90);
-        RenderIseqData(false, nullptr);  // render ISEQ layers above the Nutcracker layer
-        logger_base.info("   iseq above effects done. Render complete.");
+        if (!windowed) {
+            RenderIseqData(false, nullptr);  // render ISEQ layers above the Nutcracker layer
+            logger_base.info("   iseq above effects done. Render complete.");
+        }
         ProgressBar->SetValue(100);
         ProgressBar->Hide();
         GaugeSizer->Layout();
 
-        logger_base.info("Saving fseq file.");
-        SetStatusText(_("Saving ") + xlightsFilename + _(" ... Writing fseq."));
-        WriteFalconPiFile(xlightsFilename);
+        if (!windowed) {
+            logger_base.info("Saving fseq file.");
+            SetStatusText(_("Saving ") + xlightsFilename + _(" ... Writing fseq."));
+            WriteFalconPiFile(xlightsFilename);
+        }
         logger_base.info("fseq file done.");
         DisplayXlightsFilename(xlightsFilename);
         float elapsedTime = sw.Time()/1000.0; // now stop stopwatch timer and get elapsed time. change into seconds from ms
@@ -1095,7 +1105,16 @@ void xLightsFrame::OpenRenderAndSaveSequences(const wxArrayString &origFilenames
         mLastAutosaveCount = mSavedChangeCount;
 
         CallAfter(&xLightsFrame::OpenRenderAndSaveSequences, fileNames, exitOnDone);
-    } );
+    };
+
+    if (!windowed) {
+        RenderGridToSeqData(std::move(done));
+    } else if (!RenderGridToFalconPiFile(xlightsFilename, std::move(done))) {
+        // the fseq could not be created and that has been reported so move on to the next sequence
+        ProgressBar->Hide();
+        GaugeSizer->Layout();
+        CallAfter(&xLightsFrame::OpenRenderAndSaveSequences, fileNames, exitOnDone);
+    }
 }
 
 void xLightsFrame::SaveSequence()
@@ -516,20 +516,17 @@ void GenericVideoExporter::pushAudioUntilPacketFilled()
 }
 
 
-namespace
+GenericVideoExporter::Params GenericVideoExporter::makeRGB24Params( int width, int height, int fps, int audioSampleRate )
 {
-    GenericVideoExporter::Params makeParams( int width, int height, int fps, int audioSampleRate )
+    GenericVideoExporter::Params p =
     {
-        GenericVideoExporter::Params p =
-        {
-            AV_PIX_FMT_RGB24,
-            width,
-            height,
-            fps,
-            audioSampleRate
-        };
-        return p;
-    }
+        AV_PIX_FMT_RGB24,
+        width,
+        height,
+        fps,
+        audioSampleRate
+    };
+    return p;
 }
 
 VideoExporter::VideoExporter( wxWindow *parent,
@@ -537,7 +534,7 @@ VideoExporter::VideoExporter( wxWindow *parent,
                               unsigned int frameDuration, unsigned int frameCount,
                               int audioChannelCount, int audioSampleRate,
                               const std::string& outPath )
-    : GenericVideoExporter( outPath, makeParams( width * scaleFactor, height * scaleFactor, 1000u / frameDuration, audioSampleRate ), audioSampleRate == 0 )
+    : GenericVideoExporter( outPath, makeRGB24Params( width * scaleFactor, height * scaleFactor, 1000u / frameDuration, audioSampleRate ), audioSampleRate == 0 )
     , _parent( parent )
     , _frameCount( frameCount )
 {
@@ -49,6 +49,9 @@ public:
    typedef std::function< void( int ) > ProgressReportCb;
 
    GenericVideoExporter( const std::string& outPath, const Params& inParams, bool videoOnly = false );
+
+   // RGB24 input ... the only format the exporter accepts
+   static Params makeRGB24Params( int width, int height, int fps, int audioSampleRate );
    virtual ~GenericVideoExporter();
 
    void setGetVideoCallback( GetVideoFrameCb fn ) { _getVideo = fn; }
@@ -9,9 +9,11 @@
  **************************************************************/
 
 #include "Vixen3.h"
+#include "XmlStreamReader.h"
 
 #include <list>
 #include <math.h>
+#include <memory>
 
 #include <wx/wx.h>
 #include <wx/file.h>
@@ -234,327 +236,308 @@ Vixen3::Vixen3(const std::string& filename, const std::string& system)
         }
     }
 
-    wxXmlDocument doc(filename);
+    // .tim files can be hundreds of MB so rather than loading the whole document each timing and effect
+    // is converted as soon as it has been read and then thrown away
+    XmlStreamReader reader(filename);
+    reader.Watch("MarkCollections/MarkCollection");
+    reader.Watch("LabeledMarkCollections/d1p1:anyType");
+    if (models.size() > 0)
+    {
+        reader.Watch("_effectNodeSurrogates/EffectNodeSurrogate");
+        reader.Watch("_dataModels/d1p1:anyType");
+    }
 
-    std::map<std::string, wxXmlNode*> effectSettings;
-    wxArrayString markNames;
+    std::map<std::string, std::unique_ptr<wxXmlNode>> effectSettings;
     int unnamed = 1;
-    for (wxXmlNode *n = doc.GetRoot(); n != nullptr; n = n->GetNext())
+    reader.Read([this, &models, &effectSettings, &unnamed](const std::string& path, wxXmlNode* nnn)
     {
-        if (n->GetName() == "TimedSequenceData")
+        if (path == "MarkCollections/MarkCollection")
         {
-            for (wxXmlNode* nn = n->GetChildren(); nn != nullptr; nn = nn->GetNext())
+            std::string name;
+            std::list<VixenTiming> timing;
+            for (wxXmlNode* nnnn = nnn->GetChildren(); nnnn != nullptr; nnnn = nnnn->GetNext())
             {
-                if (nn->GetName() == "MarkCollections")
+                if (nnnn->GetName() == "Name")
                 {
-                    for (wxXmlNode* nnn = nn->GetChildren(); nnn != nullptr; nnn = nnn->GetNext())
-                    {
-                        if (nnn->GetName() == "MarkCollection")
-                        {
-                            std::string name;
-                            std::list<VixenTiming> timing;
-                            for (wxXmlNode* nnnn = nnn->GetChildren(); nnnn != nullptr; nnnn = nnnn->GetNext())
-                            {
-                                if (nnnn->GetName() == "Name")
-                                {
-                                    name = nnnn->GetChildren()->GetContent();
-                                }
-                                else if (nnnn->GetName() == "Marks")
-                                {
-                                    float last = 0;
-                                    for (wxXmlNode* nnnnn = nnnn->GetChildren(); nnnnn != nullptr; nnnnn = nnnnn->GetNext())
-                                    {
-                                        if (nnnnn->GetName() == "d3p1:duration")
-                                        {
-                                            auto markTime = nnnnn->GetChildren()->GetContent();
-                                            if (markTime.StartsWith("PT"))
-                                            {
-                                                markTime = markTime.AfterFirst('T');
-                                            }
-                                            float mins = 0;
-                                            if (markTime.Contains('M'))
-                                            {
-                                                mins = wxAtof(markTime.BeforeFirst('M'));
-                                                markTime = markTime.AfterFirst('M');
-                                            }
-                                            float secs = 0;
-                                            if (markTime.EndsWith("S"))
-                                            {
-                                                secs = wxAtof(markTime.BeforeLast('S'));
-                                            }
-                                            float mt = mins * 60.0 + secs;
-                                            timing.push_back(VixenTiming(last, mt, ""));
-                                            last = mt;
-                                        }
-                                    }
-                                }
-                            }
-                            _timingData[name] = timing;
-                            _timingType[name] = "Generic";
-                        }
-                    }
+                    name = nnnn->GetChildren()->GetContent();
                 }
-                else if (nn->GetName() == "LabeledMarkCollections")
+                else if (nnnn->GetName() == "Marks")
                 {
-                    for (wxXmlNode* nnn = nn->GetChildren(); nnn != nullptr; nnn = nnn->GetNext())
+                    float last = 0;
+                    for (wxXmlNode* nnnnn = nnnn->GetChildren(); nnnnn != nullptr; nnnnn = nnnnn->GetNext())
                     {
-                        if (nnn->GetName() == "d1p1:anyType")
+                        if (nnnnn->GetName() == "d3p1:duration")
                         {
-                            std::list<VixenTiming> timing;
-                            std::string name = ""; 
-                            std::string type = "Generic";
-
-                            for (wxXmlNode* nnnn = nnn->GetChildren(); nnnn != nullptr; nnnn = nnnn->GetNext())
+                            auto markTime = nnnnn->GetChildren()->GetContent();
+                            if (markTime.StartsWith("PT"))
                             {
-                                if (nnnn->GetName() == "d2p1:Name")
-                                {
-                                    if (nnnn->GetChildren() != nullptr)
-                                    {
-                                        name = nnnn->GetChildren()->GetContent().ToStdString();
-                                    }
-                                }
-                                else if (nnnn->GetName() == "d2p1:CollectionType")
-                                {
-                                    if (nnnn->GetChildren() != nullptr)
-                                    {
-                                        type = nnnn->GetChildren()->GetContent().ToStdString();
-                                    }
-                                }
-                                else if (nnnn->GetName() == "d2p1:Marks")
-                                {
-                                    float last = 0;
-                                    for (wxXmlNode* nnnnn = nnnn->GetChildren(); nnnnn != nullptr; nnnnn = nnnnn->GetNext())
-                                    {
-                                        float duration = 0;
-                                        float end = 0;
-                                        std::string label = "";
-                                        if (nnnnn->GetName() == "d1p1:anyType")
-                                        {
-                                            for (wxXmlNode* nnnnnn = nnnnn->GetChildren(); nnnnnn != nullptr; nnnnnn = nnnnnn->GetNext())
-                                            {
-                                                if (nnnnnn->GetName() == "d2p1:StartTime")
-                                                {
-                                                    wxString markTime = nnnnnn->GetChildren()->GetContent();
-                                                    if (markTime.StartsWith("PT"))
-                                                    {
-                                                        markTime = markTime.AfterFirst('T');
-                                                    }
-
-                                                    float mins = 0;
-                                                    if (markTime.Contains("M"))
-                                                    {
-                                                        mins = wxAtof(markTime.BeforeFirst('M'));
-                                                        markTime = markTime.AfterFirst('M');
-                                                    }
-
-                                                    float secs = 0;
-                                                    if (markTime.EndsWith("S"))
-                                                    {
-                                                        markTime = markTime.BeforeLast('S');
-                                                        secs = wxAtof(markTime);
-                                                    }
-
-                                                    end = mins * 60 + secs;
-                                                }
-                                                else if (nnnnnn->GetName() == "d2p1:Duration")
-                                                {
-                                                    wxString markTime = nnnnnn->GetChildren()->GetContent();
-                                                    if (markTime.StartsWith("PT"))
-                                                    {
-                                                        markTime = markTime.AfterFirst('T');
-                                                    }
-
-                                                    float mins = 0;
-                                                    if (markTime.Contains("M"))
-                                                    {
-                                                        mins = wxAtof(markTime.BeforeFirst('M'));
-                                                        markTime = markTime.AfterFirst('M');
-                                                    }
-
-                                                    float secs = 0;
-                                                    if (markTime.EndsWith("S"))
-                                                    {
-                                                        markTime = markTime.BeforeLast('S');
-                                                        secs = wxAtof(markTime);
-                                                    }
-
-                                                    duration = mins * 60 + secs;
-                                                }
-                                                else if (nnnnnn->GetName() == "d2p1:Text")
-                                                {
-                                                    if (nnnnnn->GetChildren() != nullptr)
-                                                    {
-                                                        label = nnnnnn->GetChildren()->GetContent().ToStdString();
-                                                    }
-                                                }
-                                            }
-                                            if (label == "")
-                                            {
-                                                // if labels are blank then we ignore duration
-                                                if (end != 0 && end > last)
-                                                {
-                                                    timing.push_back(VixenTiming(last, end, ""));
-                                                    last = end;
-                                                }
-                                                else
-                                                {
-                                                    //wxASSERT(false);
-                                                }
-                                            }
-                                            else
-                                            {
-                                                // end is actually the start and we trust the duration
-                                                if (duration > 0)
-                                                {
-                                                    float s = std::max(last, end);
-                                                    if (s < end + duration)
-                                                    {
-                                                        float e = s + duration;
-                                                        if (last > end)
-                                                        {
-                                                            duration -= (last - end);
-                                                        }
-                                                        timing.push_back(VixenTiming(s, e, label));
-                                                        last = e;
-                                                    }
-                                                    else
-                                                    {
-                                                        //wxASSERT(false);
-                                                    }
-                                                }
-                                                else
-                                                {
-                                                    //wxASSERT(false);
-                                                }
-                                            }
-                                        }
-                                    }
-                                }
+                                markTime = markTime.AfterFirst('T');
                             }
-
-                            if (name == "")
+                            float mins = 0;
+                            if (markTime.Contains('M'))
+                            {
+                                mins = wxAtof(markTime.BeforeFirst('M'));
+                                markTime = markTime.AfterFirst('M');
+                            }
+                            float secs = 0;
+                            if (markTime.EndsWith("S"))
                             {
-                                name = wxString::Format("Unnamed %d", unnamed++).ToStdString();
+                                secs = wxAtof(markTime.BeforeLast('S'));
                             }
-                            _timingData[name] = timing;
-                            _timingType[name] = type;
+                            float mt = mins * 60.0 + secs;
+                            timing.push_back(VixenTiming(last, mt, ""));
+                            last = mt;
                         }
                     }
                 }
-                else if (nn->GetName() == "_effectNodeSurrogates" && models.size() > 0)
+            }
+            _timingData[name] = timing;
+            _timingType[name] = "Generic";
+        }
+        else if (path == "LabeledMarkCollections/d1p1:anyType")
+        {
+            std::list<VixenTiming> timing;
+            std::string name = ""; 
+            std::string type = "Generic";
+
+            for (wxXmlNode* nnnn = nnn->GetChildren(); nnnn != nullptr; nnnn = nnnn->GetNext())
+            {
+                if (nnnn->GetName() == "d2p1:Name")
+                {
+                    if (nnnn->GetChildren() != nullptr)
+                    {
+                        name = nnnn->GetChildren()->GetContent().ToStdString();
+                    }
+                }
+                else if (nnnn->GetName() == "d2p1:CollectionType")
+                {
+                    if (nnnn->GetChildren() != nullptr)
+                    {
+                        type = nnnn->GetChildren()->GetContent().ToStdString();
+                    }
+                }
+                else if (nnnn->GetName() == "d2p1:Marks")
                 {
-                    for (wxXmlNode* nnn = nn->GetChildren(); nnn != nullptr; nnn = nnn->GetNext())
+                    float last = 0;
+                    for (wxXmlNode* nnnnn = nnnn->GetChildren(); nnnnn != nullptr; nnnnn = nnnnn->GetNext())
                     {
-                        if (nnn->GetName() == "EffectNodeSurrogate")
+                        float duration = 0;
+                        float end = 0;
+                        std::string label = "";
+                        if (nnnnn->GetName() == "d1p1:anyType")
                         {
-                            wxString effectSettingId;
-                            wxString modelId;
-                            float start = 0.0;
-                            float duration = 0.0;
-                            for (wxXmlNode* nnnn = nnn->GetChildren(); nnnn != nullptr; nnnn = nnnn->GetNext())
+                            for (wxXmlNode* nnnnnn = nnnnn->GetChildren(); nnnnnn != nullptr; nnnnnn = nnnnnn->GetNext())
                             {
-                                if (nnnn->GetName() == "InstanceId")
-                                {
-                                    effectSettingId = nnnn->GetChildren()->GetContent();
-                                }
-                                else if (nnnn->GetName() == "StartTime")
+                                if (nnnnnn->GetName() == "d2p1:StartTime")
                                 {
-                                    auto markTime = nnnn->GetChildren()->GetContent();
+                                    wxString markTime = nnnnnn->GetChildren()->GetContent();
                                     if (markTime.StartsWith("PT"))
                                     {
                                         markTime = markTime.AfterFirst('T');
                                     }
+
                                     float mins = 0;
-                                    if (markTime.Contains('M'))
+                                    if (markTime.Contains("M"))
                                     {
                                         mins = wxAtof(markTime.BeforeFirst('M'));
                                         markTime = markTime.AfterFirst('M');
                                     }
+
                                     float secs = 0;
                                     if (markTime.EndsWith("S"))
                                     {
-                                        secs = wxAtof(markTime.BeforeLast('S'));
+                                        markTime = markTime.BeforeLast('S');
+                                        secs = wxAtof(markTime);
                                     }
-                                    start = mins * 60.0 + secs;
+
+                                    end = mins * 60 + secs;
                                 }
-                                else if (nnnn->GetName() == "TimeSpan")
+                                else if (nnnnnn->GetName() == "d2p1:Duration")
                                 {
-                                    auto markTime = nnnn->GetChildren()->GetContent();
+                                    wxString markTime = nnnnnn->GetChildren()->GetContent();
                                     if (markTime.StartsWith("PT"))
                                     {
                                         markTime = markTime.AfterFirst('T');
                                     }
+
                                     float mins = 0;
-                                    if (markTime.Contains('M'))
+                                    if (markTime.Contains("M"))
                                     {
                                         mins = wxAtof(markTime.BeforeFirst('M'));
                                         markTime = markTime.AfterFirst('M');
                                     }
+
                                     float secs = 0;
                                     if (markTime.EndsWith("S"))
                                     {
-                                        secs = wxAtof(markTime.BeforeLast('S'));
+                                        markTime = markTime.BeforeLast('S');
+                                        secs = wxAtof(markTime);
                                     }
-                                    duration = mins * 60.0 + secs;
+
+                                    duration = mins * 60 + secs;
                                 }
-                                else if (nnnn->GetName() == "TargetNodes")
+                                else if (nnnnnn->GetName() == "d2p1:Text")
                                 {
-                                    for (wxXmlNode* nnnnn = nnnn->GetChildren(); nnnnn != nullptr; nnnnn = nnnnn->GetNext())
+                                    if (nnnnnn->GetChildren() != nullptr)
                                     {
-                                        if (nnnnn->GetName() == "ChannelNodeReferenceSurrogate")
-                                        {
-                                            for (wxXmlNode* nnnnnn = nnnnn->GetChildren(); nnnnnn != nullptr; nnnnnn = nnnnnn->GetNext())
-                                            {
-                                                if (nnnnnn->GetName() == "NodeId")
-                                                {
-                                                    modelId = nnnnnn->GetChildren()->GetContent();
-                                                }
-                                            }
-                                        }
+                                        label = nnnnnn->GetChildren()->GetContent().ToStdString();
                                     }
                                 }
                             }
-                            VixenEffect ve(start, start + duration, effectSettingId.ToStdString());
-
-                            auto m = models.find(modelId.ToStdString());
-
-                            if (m != models.end())
+                            if (label == "")
                             {
-                                _effectData[m->second].push_back(ve);
+                                // if labels are blank then we ignore duration
+                                if (end != 0 && end > last)
+                                {
+                                    timing.push_back(VixenTiming(last, end, ""));
+                                    last = end;
+                                }
+                                else
+                                {
+                                    //wxASSERT(false);
+                                }
                             }
                             else
                             {
-                                logger_base.warn("Vixen3: model not found for effect. %s", (const char*)modelId.c_str());
-                                wxASSERT(false);
+                                // end is actually the start and we trust the duration
+                                if (duration > 0)
+                                {
+                                    float s = std::max(last, end);
+                                    if (s < end + duration)
+                                    {
+                                        float e = s + duration;
+                                        if (last > end)
+                                        {
+                                            duration -= (last - end);
+                                        }
+                                        timing.push_back(VixenTiming(s, e, label));
+                                        last = e;
+                                    }
+                                    else
+                                    {
+                                        //wxASSERT(false);
+                                    }
+                                }
+                                else
+                                {
+                                    //wxASSERT(false);
+                                }
                             }
                         }
                     }
                 }
-                else if (nn->GetName() == "_dataModels" && models.size() > 0)
+            }
+
+            if (name == "")
+            {
+                name = wxString::Format("Unnamed %d", unnamed++).ToStdString();
+            }
+            _timingData[name] = timing;
+            _timingType[name] = type;
+        }
+        else if (path == "_effectNodeSurrogates/EffectNodeSurrogate")
+        {
+            wxString effectSettingId;
+            wxString modelId;
+            float start = 0.0;
+            float duration = 0.0;
+            for (wxXmlNode* nnnn = nnn->GetChildren(); nnnn != nullptr; nnnn = nnnn->GetNext())
+            {
+                if (nnnn->GetName() == "InstanceId")
+                {
+                    effectSettingId = nnnn->GetChildren()->GetContent();
+                }
+                else if (nnnn->GetName() == "StartTime")
+                {
+                    auto markTime = nnnn->GetChildren()->GetContent();
+                    if (markTime.StartsWith("PT"))
+                    {
+                        markTime = markTime.AfterFirst('T');
+                    }
+                    float mins = 0;
+                    if (markTime.Contains('M'))
+                    {
+                        mins = wxAtof(markTime.BeforeFirst('M'));
+                        markTime = markTime.AfterFirst('M');
+                    }
+                    float secs = 0;
+                    if (markTime.EndsWith("S"))
+                    {
+                        secs = wxAtof(markTime.BeforeLast('S'));
+                    }
+                    start = mins * 60.0 + secs;
+                }
+                else if (nnnn->GetName() == "TimeSpan")
+                {
+                    auto markTime = nnnn->GetChildren()->GetContent();
+                    if (markTime.StartsWith("PT"))
+                    {
+                        markTime = markTime.AfterFirst('T');
+                    }
+                    float mins = 0;
+                    if (markTime.Contains('M'))
+                    {
+                        mins = wxAtof(markTime.BeforeFirst('M'));
+                        markTime = markTime.AfterFirst('M');
+                    }
+                    float secs = 0;
+                    if (markTime.EndsWith("S"))
+                    {
+                        secs = wxAtof(markTime.BeforeLast('S'));
+                    }
+                    duration = mins * 60.0 + secs;
+                }
+                else if (nnnn->GetName() == "TargetNodes")
                 {
-                    for (wxXmlNode* nnn = nn->GetChildren(); nnn != nullptr; nnn = nnn->GetNext())
+                    for (wxXmlNode* nnnnn = nnnn->GetChildren(); nnnnn != nullptr; nnnnn = nnnnn->GetNext())
                     {
-                        if (nnn->GetName() == "d1p1:anyType")
+                        if (nnnnn->GetName() == "ChannelNodeReferenceSurrogate")
                         {
-                            auto type = nnn->GetAttribute("i:type", "");
-                            if (type != "")
+                            for (wxXmlNode* nnnnnn = nnnnn->GetChildren(); nnnnnn != nullptr; nnnnnn = nnnnnn->GetNext())
                             {
-                                wxString id;
-                                for (wxXmlNode* nnnn = nnn->GetChildren(); id == "" && nnnn != nullptr; nnnn = nnnn->GetNext())
+                                if (nnnnnn->GetName() == "NodeId")
                                 {
-                                    if (nnnn->GetName() == "ModuleInstanceId")
-                                    {
-                                        id = nnnn->GetChildren()->GetContent();
-                                    }
+                                    modelId = nnnnnn->GetChildren()->GetContent();
                                 }
-                                effectSettings[id.ToStdString()] = nnn;
                             }
                         }
                     }
                 }
             }
+            VixenEffect ve(start, start + duration, effectSettingId.ToStdString());
+
+            auto m = models.find(modelId.ToStdString());
+
+            if (m != models.end())
+            {
+                _effectData[m->second].push_back(ve);
+            }
+            else
+            {
+                logger_base.warn("Vixen3: model not found for effect. %s", (const char*)modelId.c_str());
+                wxASSERT(false);
+            }
+        }
+        else if (path == "_dataModels/d1p1:anyType")
+        {
+            auto type = nnn->GetAttribute("i:type", "");
+            if (type != "")
+            {
+                wxString id;
+                for (wxXmlNode* nnnn = nnn->GetChildren(); id == "" && nnnn != nullptr; nnnn = nnnn->GetNext())
+                {
+                    if (nnnn->GetName() == "ModuleInstanceId")
+                    {
+                        id = nnnn->GetChildren()->GetContent();
+                    }
+                }
+                // the settings are needed once all the effects have been read so keep them
+                effectSettings[id.ToStdString()].reset(nnn);
+                return true;
+            }
         }
-    }
+        return false;
+    });
 
     // hook up all the effect settings
     for (auto it = _effectData.begin(); it != _effectData.end(); ++it)
@@ -0,0 +1,219 @@
+/***************************************************************
+ * This source files comes from the xLights project
+ * https://www.xlights.org
+ * https://github.com/smeighan/xLights
+ * See the github commit history for a record of contributing
+ * developers.
+ * Copyright claimed based on commit dates recorded in Github
+ * License: https://github.com/smeighan/xLights/blob/master/License.txt
+ **************************************************************/
+
+#include "XmlStreamReader.h"
+
+#include <wx/file.h>
+#include <wx/xml/xml.h>
+
+#include <vector>
+
+#include "../include/spxml-0.5/spxmlparser.hpp"
+#include "../include/spxml-0.5/spxmlevent.hpp"
+
+#include <log4cpp/Category.hh>
+
+static const int STREAM_READ_BLOCK_SIZE = 1024 * 1024;
+
+namespace
+{
+    // an element which has been started but not yet ended
+    struct OpenElement
+    {
+        enum Mode
+        {
+            SKIP,     // not wanted ... nothing is built for it or anything under it
+            ANCESTOR, // above a watched path ... kept as an empty copy if anything under it is kept
+            BUILD     // at or under a watched path
+        };
+
+        Mode mode;
+        wxXmlNode* node;
+        wxXmlNode* last; // the last child added so adding the next one does not walk the list
+        bool watched;    // this is the element the callback gets
+        bool kept;       // an ancestor with something kept below it
+        size_t pathLength;
+    };
+
+    void AppendChild(OpenElement& parent, wxXmlNode* child)
+    {
+        if (parent.last == nullptr) {
+            parent.node->AddChild(child);
+        } else {
+            parent.node->InsertChildAfter(child, parent.last);
+        }
+        parent.last = child;
+    }
+
+    wxXmlNode* CreateElement(SP_XmlStartTagEvent* tag)
+    {
+        wxXmlNode* node = new wxXmlNode(wxXML_ELEMENT_NODE, wxString::FromUTF8(tag->getName()));
+        for (int i = 0; i < tag->getAttrCount(); i++) {
+            const char* value = nullptr;
+            const char* name = tag->getAttr(i, &value);
+            node->AddAttribute(wxString::FromUTF8(name), wxString::FromUTF8(value == nullptr ? "" : value));
+        }
+        return node;
+    }
+}
+
+void XmlStreamReader::Watch(const std::string& path)
+{
+    _watch.insert(path);
+    for (size_t i = path.find('/'); i != std::string::npos; i = path.find('/', i + 1)) {
+        _ancestors.insert(path.substr(0, i));
+    }
+}
+
+bool XmlStreamReader::Read(ElementCallback element, ProgressCallback progress, wxXmlDocument* pruned)
+{
+    static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    _error = "";
+
+    wxFile file;
+    if (!wxFile::Exists(_filename) || !file.Open(_filename)) {
+        _error = "Unable to open " + _filename.ToStdString();
+        logger_base.error("XmlStreamReader: %s.", (const char*)_error.c_str());
+        return false;
+    }
+    wxFileOffset size = file.Length();
+    wxFileOffset done = 0;
+
+    SP_XmlPullParser parser;
+    std::vector<char> bytes(STREAM_READ_BLOCK_SIZE);
+    std::vector<OpenElement> open;
+    std::string path;
+    bool sawRoot = false;
+    bool finished = false;
+
+    while (!finished) {
+        SP_XmlPullEvent* event = parser.getNext();
+        if (event == nullptr) {
+            if (parser.getError() != nullptr) {
+                _error = parser.getError();
+                break;
+            }
+            ssize_t read = file.Read(&bytes[0], bytes.size());
+            if (read <= 0) {
+                break;
+            }
+            parser.append(&bytes[0], read);
+            done += read;
+            if (progress != nullptr) {
+                progress(done, size);
+            }
+            continue;
+        }
+
+        switch (event->getEventType()) {
+        case SP_XmlPullEvent::eEndDocument:
+            finished = true;
+            break;
+        case SP_XmlPullEvent::eStartTag: {
+            SP_XmlStartTagEvent* tag = (SP_XmlStartTagEvent*)event;
+            OpenElement e = { OpenElement::SKIP, nullptr, nullptr, false, false, path.size() };
+            if (open.empty()) {
+                // the root
+                sawRoot = true;
+                e.mode = OpenElement::ANCESTOR;
+                e.node = CreateElement(tag);
+            } else {
+                OpenElement& parent = open.back();
+                if (parent.mode != OpenElement::SKIP) {
+                    if (open.size() > 1) path += "/";
+                    path += tag->getName();
+                }
+                if (parent.mode == OpenElement::BUILD) {
+                    if (_ignore.find(path) == _ignore.end()) {
+                        e.mode = OpenElement::BUILD;
+                        e.node = CreateElement(tag);
+                        AppendChild(parent, e.node);
+                    }
+                } else if (parent.mode == OpenElement::ANCESTOR) {
+                    if (_watch.find(path) != _watch.end()) {
+                        e.mode = OpenElement::BUILD;
+                        e.watched = true;
+                        e.node = CreateElement(tag);
+                    } else if (_ancestors.find(path) != _ancestors.end()) {
+                        e.mode = OpenElement::ANCESTOR;
+                        e.node = CreateElement(tag);
+                    }
+                }
+            }
+            open.push_back(e);
+            break;
+        }
+        case SP_XmlPullEvent::eCData:
+            if (!open.empty() && open.back().mode == OpenElement::BUILD) {
+                OpenElement& e = open.back();
+                wxString text = wxString::FromUTF8(((SP_XmlCDataEvent*)event)->getText());
+                if (e.last != nullptr && e.last->GetType() == wxXML_TEXT_NODE) {
+                    e.last->SetContent(e.last->GetContent() + text);
+                } else {
+                    AppendChild(e, new wxXmlNode(wxXML_TEXT_NODE, wxEmptyString, text));
+                }
+            }
+            break;
+        case SP_XmlPullEvent::eEndTag: {
+            if (open.empty()) break;
+            OpenElement e = open.back();
+            open.pop_back();
+
+            if (e.watched) {
+                OpenElement& parent = open.back();
+                if (element(path, e.node)) {
+                    if (pruned != nullptr) {
+                        AppendChild(parent, e.node);
+                        parent.kept = true;
+                    }
+                } else {
+                    delete e.node;
+                }
+            } else if (e.mode == OpenElement::ANCESTOR) {
+                if (open.empty()) {
+                    if (pruned != nullptr) {
+                        pruned->SetRoot(e.node);
+                    } else {
+                        delete e.node;
+                    }
+                    finished = true;
+                } else if (e.kept) {
+                    AppendChild(open.back(), e.node);
+                    open.back().kept = true;
+                } else {
+                    delete e.node;
+                }
+            }
+            path.resize(e.pathLength);
+            break;
+        }
+        default:
+            break;
+        }
+        delete event;
+    }
+
+    // anything still open was never handed over
+    for (auto& e : open) {
+        if (e.mode == OpenElement::ANCESTOR || e.watched) {
+            delete e.node;
+        }
+    }
+
+    if (_error == "" && (!sawRoot || !open.empty())) {
+        _error = "Unexpected end of file";
+    }
+    if (_error != "") {
+        logger_base.error("XmlStreamReader: error reading %s: %s.", (const char*)_filename.c_str(), (const char*)_error.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+/***************************************************************
+ * This source files comes from the xLights project
+ * https://www.xlights.org
+ * https://github.com/smeighan/xLights
+ * See the github commit history for a record of contributing
+ * developers.
+ * Copyright claimed based on commit dates recorded in Github
+ * License: https://github.com/smeighan/xLights/blob/master/License.txt
+ **************************************************************/
+
+#include <wx/string.h>
+#include <wx/filefn.h>
+
+#include <functional>
+#include <string>
+#include <unordered_set>
+
+class wxXmlDocument;
+class wxXmlNode;
+
+// Streams an xml file through the spxml pull parser so a large sequence never has to be held in
+// memory as a whole document.
+//
+// Paths are the element names below the root joined with '/' eg "channels/channel". Each element
+// found at a watched path is built into a wxXmlNode, along with everything under it except ignored
+// paths, and handed to the callback as soon as its end tag is read. The callback returns true to keep
+// the element. Kept elements go into the pruned document, when one is given, below empty copies of
+// the elements above them. Without a pruned document the callback owns the kept elements. Elements
+// which are not kept are deleted as soon as the callback returns.
+class XmlStreamReader
+{
+public:
+    typedef std::function<bool(const std::string& path, wxXmlNode* node)> ElementCallback;
+    typedef std::function<void(wxFileOffset done, wxFileOffset size)> ProgressCallback;
+
+    XmlStreamReader(const wxString& filename) : _filename(filename) {}
+
+    void Watch(const std::string& path);
+    void Ignore(const std::string& path) { _ignore.insert(path); }
+
+    // returns false if the file could not be read or is not well formed
+    bool Read(ElementCallback element, ProgressCallback progress = nullptr, wxXmlDocument* pruned = nullptr);
+    const std::string& GetError() const { return _error; }
+
+private:
+    wxString _filename;
+    std::unordered_set<std::string> _watch;
+    std::unordered_set<std::string> _ancestors; // every path above a watched path
+    std::unordered_set<std::string> _ignore;
+    std::string _error;
+};
@@ -23,6 +23,7 @@
 #include "../../include/butterfly-64.xpm"
 
 #include "../Parallel.h"
+#include "../ColorKernels.h"
 
 ButterflyEffect::ButterflyEffect(int i) : RenderableEffect(i, "Butterfly", butterfly_16, butterfly_24, butterfly_32, butterfly_48, butterfly_64)
 {
@@ -110,6 +111,15 @@ void ButterflyEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuf
         double n,x1,y1,f;
         double rx,ry,cx,cy,v,time,multiplier;
 
+        // the rainbow hues for the column are converted to colours in one go once it is done
+        std::vector<double> hues;
+        std::vector<int> hueY;
+        if (Style <= 5 && ColorScheme == 0)
+        {
+            hues.reserve(buffer.BufferHt);
+            hueY.reserve(buffer.BufferHt);
+        }
+
         for (y=0; y<buffer.BufferHt; y++)
         {
             switch (Style)
@@ -206,14 +216,12 @@ void ButterflyEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuf
             {
                 
                 
-                hsv.saturation=1.0;
-                hsv.value=1.0;
                 if (Chunks <= 1 || int(h*Chunks) % Skip != 0)
                 {
                     if (ColorScheme == 0)
                     {
-                        hsv.hue=h;
-                        buffer.SetPixel(x,y,hsv);
+                        hues.push_back(h);
+                        hueY.push_back(y);
                     }
                     else
                     {
@@ -309,6 +317,17 @@ void ButterflyEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuf
                 buffer.SetPixel(x,y,color);
             }
         }
+
+        if (!hues.empty())
+        {
+            std::vector<double> ones(hues.size(), 1.0);
+            xlColorVector colors(hues.size());
+            ColorKernels::HSVToRGB(&hues[0], &ones[0], &ones[0], &colors[0].red, hues.size());
+            for (size_t i = 0; i < hues.size(); i++)
+            {
+                buffer.SetPixel(x, hueY[i], colors[i]);
+            }
+        }
     }, block);
 }
 
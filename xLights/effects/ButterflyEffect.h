@@ -28,6 +28,7 @@ class ButterflyEffect : public RenderableEffect
         virtual ~ButterflyEffect();
         virtual void SetDefaultParameters() override;
         virtual void Render(Effect *effect, SettingsMap &settings, RenderBuffer &buffer) override;
+        virtual bool CanShareRender() const override { return true; }
         virtual bool AppropriateOnNodes() const override { return false; }
         virtual bool CanRenderPartialTimeInterval() const override { return true; }
         virtual bool SupportsRenderCache(const SettingsMap& settings) const override { return true; }
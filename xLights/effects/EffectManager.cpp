@@ -138,7 +138,12 @@ void EffectManager::add(RenderableEffect *eff) {
 }
 
 RenderableEffect *EffectManager::GetEffect(const std::string &str) const {
-    return effectsByName[str];
+    // dont use [] as it would add unknown names to the map ... this is called from multiple threads while loading
+    auto it = effectsByName.find(str);
+    if (it == effectsByName.end()) {
+        return nullptr;
+    }
+    return it->second;
 }
 
 int EffectManager::GetEffectIndex(const std::string &effectName) const {
@@ -58,6 +58,7 @@ class FanEffect : public RenderableEffect
         virtual ~FanEffect();
 
         virtual void Render(Effect *effect, SettingsMap &settings, RenderBuffer &buffer) override;
+        virtual bool CanShareRender() const override { return true; }
         virtual void SetDefaultParameters() override;
         virtual int DrawEffectBackground(const Effect *e, int x1, int y1, int x2, int y2,
                                          DrawGLUtils::xlAccumulator &backgrounds, xlColor* colorMask, bool ramps) override;
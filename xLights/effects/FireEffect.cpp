@@ -165,8 +165,24 @@ public:
     virtual ~FireRenderCache() {};
 
     std::vector<int> FireBuffer;
+
+    virtual bool Serialise(std::vector<uint8_t>& data) const override
+    {
+        WriteAll(data, FireBuffer);
+        return true;
+    }
+    virtual bool Restore(const std::vector<uint8_t>& data) override
+    {
+        size_t pos = 0;
+        return ReadAll(data, pos, FireBuffer);
+    }
 };
 
+EffectRenderCache* FireEffect::CreateRenderCache() const
+{
+    return new FireRenderCache();
+}
+
 static FireRenderCache* GetCache(RenderBuffer &buffer, int id) {
     FireRenderCache *cache = (FireRenderCache*)buffer.infoCache[id];
     if (cache == nullptr) {
@@ -49,6 +49,7 @@ class GalaxyEffect : public RenderableEffect
         virtual ~GalaxyEffect();
     
         virtual void Render(Effect *effect, SettingsMap &settings, RenderBuffer &buffer) override;
+        virtual bool CanShareRender() const override { return true; }
         virtual int DrawEffectBackground(const Effect *e, int x1, int y1, int x2, int y2,
                                          DrawGLUtils::xlAccumulator &backgrounds, xlColor* colorMask, bool ramps) override;
         virtual void SetDefaultParameters() override;
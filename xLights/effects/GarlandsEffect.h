@@ -25,6 +25,7 @@ class GarlandsEffect : public RenderableEffect
         virtual ~GarlandsEffect();
         virtual void SetDefaultParameters() override;
         virtual void Render(Effect *effect, SettingsMap &settings, RenderBuffer &buffer) override;
+        virtual bool CanShareRender() const override { return true; }
         virtual bool AppropriateOnNodes() const override { return false; }
         virtual bool CanRenderPartialTimeInterval() const override { return true; }
 protected:
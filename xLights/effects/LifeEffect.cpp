@@ -63,8 +63,26 @@ public:
     int LastLifeCount;
     int LastLifeType;
     int LastLifeState;
+
+    virtual bool Serialise(std::vector<uint8_t>& data) const override
+    {
+        Write(data, LastLifeCount);
+        Write(data, LastLifeType);
+        Write(data, LastLifeState);
+        return true;
+    }
+    virtual bool Restore(const std::vector<uint8_t>& data) override
+    {
+        size_t pos = 0;
+        return Read(data, pos, LastLifeCount) && Read(data, pos, LastLifeType) && Read(data, pos, LastLifeState);
+    }
 };
 
+EffectRenderCache* LifeEffect::CreateRenderCache() const
+{
+    return new LifeRenderCache();
+}
+
 void LifeEffect::SetDefaultParameters() {
     LifePanel *lp = (LifePanel*)panel;
     if (lp == nullptr) {
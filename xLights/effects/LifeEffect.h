@@ -19,6 +19,7 @@ public:
     virtual ~LifeEffect();
     virtual void SetDefaultParameters() override;
     virtual void Render(Effect* effect, SettingsMap& settings, RenderBuffer& buffer) override;
+    virtual EffectRenderCache* CreateRenderCache() const override;
     virtual bool AppropriateOnNodes() const override { return false; }
 protected:
     virtual wxPanel* CreatePanel(wxWindow* parent) override;
@@ -49,6 +49,7 @@ class MarqueeEffect : public RenderableEffect
         virtual ~MarqueeEffect();    
         virtual void SetDefaultParameters() override;
         virtual void Render(Effect *effect, SettingsMap &settings, RenderBuffer &buffer) override;
+        virtual bool CanShareRender() const override { return true; }
         virtual bool CanRenderPartialTimeInterval() const override { return true; }
 
     protected:
@@ -123,8 +123,26 @@ public:
     int effectState;
     MeteorList meteors;
     MeteorRadialList meteorsRadial;
+
+    virtual bool Serialise(std::vector<uint8_t>& data) const override
+    {
+        Write(data, effectState);
+        WriteAll(data, meteors);
+        WriteAll(data, meteorsRadial);
+        return true;
+    }
+    virtual bool Restore(const std::vector<uint8_t>& data) override
+    {
+        size_t pos = 0;
+        return Read(data, pos, effectState) && ReadAll(data, pos, meteors) && ReadAll(data, pos, meteorsRadial);
+    }
 };
 
+EffectRenderCache* MeteorsEffect::CreateRenderCache() const
+{
+    return new MeteorsRenderCache();
+}
+
 
 static MeteorsRenderCache* GetCache(RenderBuffer &buffer, int id) {
     MeteorsRenderCache *cache = (MeteorsRenderCache*)buffer.infoCache[id];
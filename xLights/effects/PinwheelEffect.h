@@ -42,6 +42,7 @@ class PinwheelEffect : public RenderableEffect
         virtual ~PinwheelEffect();
         virtual void SetDefaultParameters() override;
         virtual void Render(Effect *effect, SettingsMap &settings, RenderBuffer &buffer) override;
+        virtual bool CanShareRender() const override { return true; }
         virtual bool SupportsRadialColorCurves(const SettingsMap &SettingsMap) const override { return true; }
         virtual bool needToAdjustSettings(const std::string &version) override;
         virtual void adjustSettings(const std::string &version, Effect *effect, bool removeDefaults = true) override;
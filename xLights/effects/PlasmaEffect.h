@@ -22,6 +22,7 @@ class PlasmaEffect : public RenderableEffect
         virtual ~PlasmaEffect();
         virtual void SetDefaultParameters() override;
         virtual void Render(Effect *effect, SettingsMap &settings, RenderBuffer &buffer) override;
+        virtual bool CanShareRender() const override { return true; }
         virtual bool CanRenderPartialTimeInterval() const override { return true; }
         virtual bool SupportsRenderCache(const SettingsMap& settings) const override { return true; }
     protected:
@@ -21,6 +21,7 @@
 #include <wx/spinctrl.h>
 
 #include <sstream>
+#include <list>
 #include "../UtilFunctions.h"
 #include "../ValueCurveButton.h"
 #include "PixelBuffer.h"
@@ -422,85 +423,55 @@ void RenderableEffect::adjustSettings(const std::string &version, Effect *effect
 }
 
 void RenderableEffect::RemoveDefaults(const std::string &version, Effect *effect) {
-    SettingsMap &palette = effect->GetPaletteMap();
-    bool changed = false;
-    if (palette.Get("C_CHECKBOX_Palette1", "") == "0") {
-        palette.erase("C_CHECKBOX_Palette1");
-        changed = true;
-    }
-    if (palette.Get("C_CHECKBOX_Palette2", "") == "0") {
-        palette.erase("C_CHECKBOX_Palette2");
-        changed = true;
-    }
-    if (palette.Get("C_CHECKBOX_Palette3", "") == "0") {
-        palette.erase("C_CHECKBOX_Palette3");
-        changed = true;
-    }
-    if (palette.Get("C_CHECKBOX_Palette4", "") == "0") {
-        palette.erase("C_CHECKBOX_Palette4");
-        changed = true;
-    }
-    if (palette.Get("C_CHECKBOX_Palette5", "") == "0") {
-        palette.erase("C_CHECKBOX_Palette5");
-        changed = true;
-    }
-    if (palette.Get("C_CHECKBOX_Palette6", "") == "0") {
-        palette.erase("C_CHECKBOX_Palette6");
-        changed = true;
-    }
-    if (palette.Get("C_CHECKBOX_Palette7", "") == "0") {
-        palette.erase("C_CHECKBOX_Palette7");
-        changed = true;
-    }
-    if (palette.Get("C_CHECKBOX_Palette8", "") == "0") {
-        palette.erase("C_CHECKBOX_Palette8");
-        changed = true;
-    }
-    if (palette.Get("C_SLIDER_Brightness", "") == "100") {
-        palette.erase("C_SLIDER_Brightness");
-        changed = true;
-    }
-    if (palette.Get("C_SLIDER_Color_HueAdjust", "") == "0") {
-        palette.erase("C_SLIDER_Color_HueAdjust");
-        changed = true;
-    }
-    if (palette.Get("C_SLIDER_Color_SaturationAdjust", "") == "0") {
-        palette.erase("C_SLIDER_Color_SaturationAdjust");
-        changed = true;
-    }
-    if (palette.Get("C_SLIDER_Color_ValueAdjust", "") == "0") {
-        palette.erase("C_SLIDER_Color_ValueAdjust");
-        changed = true;
-    }
-    if (palette.Get("C_SLIDER_Contrast", "") == "0") {
-        palette.erase("C_SLIDER_Contrast");
-        changed = true;
-    }
-    if (palette.Get("C_SLIDER_SparkleFrequency", "") == "0") {
-        palette.erase("C_SLIDER_SparkleFrequency");
-        changed = true;
+    static const std::vector<std::pair<std::string, std::string>> PALETTE_DEFAULTS {
+        { "C_CHECKBOX_Palette1", "0" }, { "C_CHECKBOX_Palette2", "0" }, { "C_CHECKBOX_Palette3", "0" },
+        { "C_CHECKBOX_Palette4", "0" }, { "C_CHECKBOX_Palette5", "0" }, { "C_CHECKBOX_Palette6", "0" },
+        { "C_CHECKBOX_Palette7", "0" }, { "C_CHECKBOX_Palette8", "0" },
+        { "C_SLIDER_Brightness", "100" }, { "C_SLIDER_Color_HueAdjust", "0" },
+        { "C_SLIDER_Color_SaturationAdjust", "0" }, { "C_SLIDER_Color_ValueAdjust", "0" },
+        { "C_SLIDER_Contrast", "0" }, { "C_SLIDER_SparkleFrequency", "0" }
+    };
+    static const std::vector<std::pair<std::string, std::string>> SETTINGS_DEFAULTS {
+        { "T_CHECKBOX_LayerMorph", "0" }, { "T_CHECKBOX_OverlayBkg", "0" },
+        { "T_CHOICE_LayerMethod", "Normal" }, { "T_SLIDER_EffectLayerMix", "0" }
+    };
+
+    // the maps are read through the shared pointers and only taken for writing if there is a default to
+    // remove so effects with nothing to remove keep sharing their maps
+
+    std::list<std::string> remove;
+    auto currentPalette = effect->GetPaletteMapPtr();
+    for (const auto& it : PALETTE_DEFAULTS) {
+        if (currentPalette->Get(it.first, "") == it.second) {
+            remove.push_back(it.first);
+        }
     }
-    if (changed) {
+    if (!remove.empty()) {
+        SettingsMap &palette = effect->GetPaletteMap();
+        for (const auto& it : remove) {
+            palette.erase(it);
+        }
         effect->PaletteMapUpdated();
     }
-    SettingsMap &settings = effect->GetSettings();
-    if (settings.Get("T_CHECKBOX_LayerMorph", "") == "0") {
-        settings.erase("T_CHECKBOX_LayerMorph");
-    }
-    if (settings.Get("T_CHECKBOX_OverlayBkg", "") == "0") {
-        settings.erase("T_CHECKBOX_OverlayBkg");
-    }
-    if (settings.Get("T_CHOICE_LayerMethod", "") == "Normal") {
-        settings.erase("T_CHOICE_LayerMethod");
+
+    remove.clear();
+    auto current = effect->GetSettingsPtr();
+    for (const auto& it : SETTINGS_DEFAULTS) {
+        if (current->Get(it.first, "") == it.second) {
+            remove.push_back(it.first);
+        }
     }
-    if (settings.Get("T_SLIDER_EffectLayerMix", "") == "0") {
-        settings.erase("T_SLIDER_EffectLayerMix");
+    if (current->GetFloat("T_TEXTCTRL_Fadein", 1.0f) == 0.0f) {
+        remove.push_back("T_TEXTCTRL_Fadein");
     }
-    if (settings.GetFloat("T_TEXTCTRL_Fadein", 1.0f) == 0.0f) {
-        settings.erase("T_TEXTCTRL_Fadein");
+    if (current->GetFloat("T_TEXTCTRL_Fadeout", 1.0f) == 0.0f) {
+        remove.push_back("T_TEXTCTRL_Fadeout");
     }
-    if (settings.GetFloat("T_TEXTCTRL_Fadeout", 1.0f) == 0.0f) {
-        settings.erase("T_TEXTCTRL_Fadeout");
+    if (!remove.empty()) {
+        SettingsMap &settings = effect->GetSettings();
+        for (const auto& it : remove) {
+            settings.erase(it);
+        }
     }
 }
 
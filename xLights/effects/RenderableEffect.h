@@ -23,6 +23,7 @@ class SequenceElements;
 class Effect;
 class SettingsMap;
 class RenderBuffer;
+class EffectRenderCache;
 class wxSlider;
 class wxCheckBox;
 class AudioManager;
@@ -66,6 +67,11 @@ class RenderableEffect
         //Methods for rendering the effect
         virtual bool CanRenderOnBackgroundThread(Effect *effect, const SettingsMap &settings, RenderBuffer &buffer) { return true; }
         virtual bool SupportsRenderCache(const SettingsMap& settings) const;
+        // effects whose render cache can be checkpointed return an empty one to restore a checkpoint into
+        virtual EffectRenderCache* CreateRenderCache() const { return nullptr; }
+        // true if the frames depend only on the settings, palette, timing and buffer size so identical
+        // effects on other models can use them
+        virtual bool CanShareRender() const { return false; }
         virtual void Render(Effect *effect, SettingsMap &settings, RenderBuffer &buffer) = 0;
         virtual void RenameTimingTrack(std::string oldname, std::string newname, Effect *effect) { }
         virtual std::list<std::string> CheckEffectSettings(const SettingsMap& settings, AudioManager* media, Model* model, Effect* eff, bool renderCache) { std::list<std::string> res; return res; };
@@ -142,8 +142,28 @@ public:
     int LastSnowflakeType;
     std::string LastFalling;
     int effectState;
+
+    virtual bool Serialise(std::vector<uint8_t>& data) const override
+    {
+        Write(data, LastSnowflakeCount);
+        Write(data, LastSnowflakeType);
+        WriteAll(data, LastFalling);
+        Write(data, effectState);
+        return true;
+    }
+    virtual bool Restore(const std::vector<uint8_t>& data) override
+    {
+        size_t pos = 0;
+        return Read(data, pos, LastSnowflakeCount) && Read(data, pos, LastSnowflakeType) &&
+               ReadAll(data, pos, LastFalling) && Read(data, pos, effectState);
+    }
 };
 
+EffectRenderCache* SnowflakesEffect::CreateRenderCache() const
+{
+    return new SnowflakesRenderCache();
+}
+
 void SnowflakesEffect::SetDefaultParameters()
 {
     SnowflakesPanel *sp = (SnowflakesPanel*)panel;
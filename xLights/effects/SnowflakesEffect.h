@@ -25,6 +25,7 @@ class SnowflakesEffect : public RenderableEffect
         virtual ~SnowflakesEffect();
         virtual void SetDefaultParameters() override;
         virtual void Render(Effect *effect, SettingsMap &settings, RenderBuffer &buffer) override;
+        virtual EffectRenderCache* CreateRenderCache() const override;
 protected:
         virtual wxPanel *CreatePanel(wxWindow *parent) override;
         virtual bool needToAdjustSettings(const std::string &version) override;
@@ -22,6 +22,7 @@
 
 
 #include "../Parallel.h"
+#include "../ColorKernels.h"
 
 SpiralsEffect::SpiralsEffect(int id) : RenderableEffect(id, "Spirals", spirals_16, spirals_24, spirals_32, spirals_48, spirals_64)
 {
@@ -112,6 +113,23 @@ void SpiralsEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuffe
 
         std::function<void(int)> spiralF = [&](int thick) {
             int strand = (strand_base + thick) % buffer.BufferWi;
+            double f = 1.0;
+            if (Rotation < 0) {
+                f = double(thick + 1) / SpiralThickness;
+            } else {
+                f = double(SpiralThickness - thick) / SpiralThickness;
+            }
+
+            // without alpha the 3D shading darkens the whole strand by the same factor so the
+            // colours are collected and darkened together
+            bool shade = Show3D && !buffer.allowAlpha;
+            xlColorVector shaded;
+            std::vector<int> shadedX;
+            if (shade) {
+                shaded.reserve(buffer.BufferHt);
+                shadedX.reserve(buffer.BufferHt);
+            }
+
             for (int y = 0; y < buffer.BufferHt; y++) {
                 int x = (int)((strand + SpiralState / 10.0 + y * Rotation / buffer.BufferHt)) % buffer.BufferWi;
                 if (x < 0) x += buffer.BufferWi;
@@ -123,28 +141,25 @@ void SpiralsEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuffe
                 if (Blend) {
                     buffer.GetMultiColorBlend(double(buffer.BufferHt - y - 1) / double(buffer.BufferHt), false, color);
                 }
-                if (Show3D) {
-                    double f = 1.0;
-
-                    if (Rotation < 0) {
-                        f = double(thick + 1) / SpiralThickness;
-                    } else {
-                        f = double(SpiralThickness - thick) / SpiralThickness;
-                    }
-                    if (buffer.allowAlpha) {
-                        xlColor c(color);
-                        c.alpha = 255.0 * f;
-                        buffer.SetPixel(x, y, c);
-                    } else {
-                        HSVValue hsv;
-                        buffer.Color2HSV(color, hsv);
-                        hsv.value *= f;
-                        buffer.SetPixel(x, y, hsv);
-                    }
+                if (shade) {
+                    shaded.push_back(color);
+                    shadedX.push_back(x);
+                } else if (Show3D) {
+                    xlColor c(color);
+                    c.alpha = 255.0 * f;
+                    buffer.SetPixel(x, y, c);
                 } else {
                     buffer.SetPixel(x, y, color);
                 }
             }
+
+            if (shade && !shaded.empty()) {
+                ColorKernels::ScaleValue(&shaded[0].red, shaded.size(), f);
+                for (int y = 0; y < (int)shaded.size(); y++) {
+                    shaded[y].alpha = 255;
+                    buffer.SetPixel(shadedX[y], y, shaded[y]);
+                }
+            }
         };
         
         if ((!isSpacial && !Blend) && SpiralThickness > 2) {
@@ -32,6 +32,7 @@ class SpiralsEffect : public RenderableEffect {
         virtual ~SpiralsEffect();
         virtual void SetDefaultParameters() override;
         virtual void Render(Effect *effect, SettingsMap &settings, RenderBuffer &buffer) override;
+        virtual bool CanShareRender() const override { return true; }
         virtual bool SupportsLinearColorCurves(const SettingsMap &SettingsMap) const override;
         virtual bool CanRenderPartialTimeInterval() const override { return true; }
 
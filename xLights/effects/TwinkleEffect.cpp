@@ -56,8 +56,32 @@ public:
     int num_lights;
     int curNumStrobe;
     std::atomic_int lights_to_renew;
+
+    virtual bool Serialise(std::vector<uint8_t>& data) const override
+    {
+        WriteAll(data, strobe);
+        Write(data, num_lights);
+        Write(data, curNumStrobe);
+        Write(data, (int)lights_to_renew);
+        return true;
+    }
+    virtual bool Restore(const std::vector<uint8_t>& data) override
+    {
+        size_t pos = 0;
+        int renew = 0;
+        if (!ReadAll(data, pos, strobe) || !Read(data, pos, num_lights) || !Read(data, pos, curNumStrobe) || !Read(data, pos, renew)) {
+            return false;
+        }
+        lights_to_renew = renew;
+        return true;
+    }
 };
 
+EffectRenderCache* TwinkleEffect::CreateRenderCache() const
+{
+    return new TwinkleRenderCache();
+}
+
 void TwinkleEffect::SetDefaultParameters()
 {
     TwinklePanel *tp = (TwinklePanel*)panel;
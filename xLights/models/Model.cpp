@@ -4518,6 +4518,28 @@ void Model::DisplayModelOnWindow(ModelPreview* preview, DrawGLUtils::xlAccumulat
     DrawGLUtils::xlAccumulator &va = needTransparent ? tva : sva;
     va.PreAlloc(maxVertexCount);
 
+    // when drawing the node colours the geometry is usually unchanged from the last frame
+    float probe[12];
+    bool useCache = c == nullptr;
+    if (useCache) {
+        GetPreviewGeometryProbe(probe);
+        if (DrawCachedPreviewGeometry(previewGeometry[0], va, probe)) {
+            minx = std::min(minx, previewGeometry[0].minx);
+            miny = std::min(miny, previewGeometry[0].miny);
+            maxx = std::max(maxx, previewGeometry[0].maxx);
+            maxy = std::max(maxy, previewGeometry[0].maxy);
+            if (pixelStyle > 1) {
+                va.Finish(GL_TRIANGLES);
+            } else {
+                va.Finish(GL_POINTS, pixelStyle == 1 ? GL_POINT_SMOOTH : 0, preview->calcPixelSize(pixelSize));
+            }
+            return;
+        }
+    }
+    unsigned int startVertex = va.count;
+    std::vector<uint32_t> order;
+    std::vector<uint32_t> vertexStart;
+
     int first = 0;
     int last = NodeCount;
     int buffFirst = -1;
@@ -4559,6 +4581,10 @@ void Model::DisplayModelOnWindow(ModelPreview* preview, DrawGLUtils::xlAccumulat
                 }
             }
         }
+        if (useCache) {
+            order.push_back(n);
+            vertexStart.push_back(va.count - startVertex);
+        }
         size_t CoordCount=GetCoordCount(n);
         for(size_t c2=0; c2 < CoordCount; c2++) {
             // draw node on screen
@@ -4589,6 +4615,9 @@ void Model::DisplayModelOnWindow(ModelPreview* preview, DrawGLUtils::xlAccumulat
             }
         }
     }
+    if (useCache) {
+        SavePreviewGeometry(previewGeometry[0], va, probe, startVertex, order, vertexStart);
+    }
     if (pixelStyle > 1) {
         va.Finish(GL_TRIANGLES);
     } else {
@@ -4642,6 +4671,24 @@ void Model::DisplayModelOnWindow(ModelPreview* preview, DrawGLUtils::xl3Accumula
     DrawGLUtils::xl3Accumulator& vaLines = lva;
     vaLines.PreAlloc(2*maxVertexCount);
 
+    // when drawing the node colours the geometry is usually unchanged from the last frame
+    float probe[12];
+    bool useCache = c == nullptr && !wiring && !highlightFirst && highlightpixel == 0 && !(allowSelected && GroupSelected);
+    if (useCache) {
+        GetPreviewGeometryProbe(probe);
+        if (DrawCachedPreviewGeometry(previewGeometry[1], va, probe)) {
+            if (pixelStyle > 1) {
+                va.Finish(GL_TRIANGLES);
+            } else {
+                va.Finish(GL_POINTS, pixelStyle == 1 ? GL_POINT_SMOOTH : 0, preview->calcPixelSize(pixelSize));
+            }
+            return;
+        }
+    }
+    unsigned int startVertex = va.count;
+    std::vector<uint32_t> order;
+    std::vector<uint32_t> vertexStart;
+
     int first = 0;
     int last = NodeCount;
     int buffFirst = -1;
@@ -4692,6 +4739,10 @@ void Model::DisplayModelOnWindow(ModelPreview* preview, DrawGLUtils::xl3Accumula
                 }
             }
         }
+        if (useCache) {
+            order.push_back(n);
+            vertexStart.push_back(va.count - startVertex);
+        }
         size_t CoordCount=GetCoordCount(n);
         for (size_t c2=0; c2 < CoordCount; c2++) {
             // draw node on screen
@@ -4755,6 +4806,9 @@ void Model::DisplayModelOnWindow(ModelPreview* preview, DrawGLUtils::xl3Accumula
     if (wiring && vaLines.count > 0) {
         vaLines.Finish(GL_LINES, GL_LINE_SMOOTH, 1.7f);
     }
+    if (useCache) {
+        SavePreviewGeometry(previewGeometry[1], va, probe, startVertex, order, vertexStart);
+    }
     if (pixelStyle > 1) {
         va.Finish(GL_TRIANGLES);
     }
@@ -4766,6 +4820,167 @@ void Model::DisplayModelOnWindow(ModelPreview* preview, DrawGLUtils::xl3Accumula
     }
 }
 
+void Model::GetPreviewPoints(bool is_3d, std::vector<PreviewPoint>& points) {
+    if (!IsActive()) { return; }
+
+    ModelScreenLocation& screenLocation = GetModelScreenLocation();
+    screenLocation.PrepareToDraw(is_3d, false);
+
+    float r = ((float)pixelSize) / 2.0f;
+    for (size_t n = 0; n < Nodes.size(); n++) {
+        size_t CoordCount = GetCoordCount(n);
+        for (size_t c2 = 0; c2 < CoordCount; c2++) {
+            float sx = Nodes[n]->Coords[c2].screenX;
+            float sy = Nodes[n]->Coords[c2].screenY;
+            float sz = Nodes[n]->Coords[c2].screenZ;
+            float radius = 0.0f;
+            if (pixelStyle > 1) {
+                if (is_3d) {
+                    // in 3D the circle is built around the untranslated coordinate so it scales with the model
+                    float ex = sx + r;
+                    float ey = sy;
+                    float ez = sz;
+                    screenLocation.TranslatePoint(ex, ey, ez);
+                    float cx = sx;
+                    float cy = sy;
+                    float cz = sz;
+                    screenLocation.TranslatePoint(cx, cy, cz);
+                    radius = std::sqrt((ex - cx) * (ex - cx) + (ey - cy) * (ey - cy) + (ez - cz) * (ez - cz));
+                } else {
+                    radius = r;
+                }
+            }
+            screenLocation.TranslatePoint(sx, sy, sz);
+            points.push_back({ (uint32_t)n, sx, sy, sz, radius });
+        }
+    }
+}
+
+xlColor Model::GetNodePreviewColor(size_t nodenum) const {
+    xlColor color = GetNodeColor(nodenum);
+    if (modelDimmingCurve != nullptr) {
+        modelDimmingCurve->reverse(color);
+    }
+    if (StrobeRate) {
+        int r = rand() % 5;
+        if (r != 0) {
+            color = xlBLACK;
+        }
+    }
+    ApplyTransparency(color, transparency, blackTransparency);
+    return color;
+}
+
+void Model::GetPreviewGeometryProbe(float probe[12]) const {
+    // every screen location transform is affine so where it puts the origin and the unit axes
+    // identifies it ... if these move the model has been moved, scaled or rotated
+    static const float axes[4][3] = { { 0, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } };
+    for (int i = 0; i < 4; i++) {
+        float x = axes[i][0];
+        float y = axes[i][1];
+        float z = axes[i][2];
+        GetModelScreenLocation().TranslatePoint(x, y, z);
+        probe[i * 3] = x;
+        probe[i * 3 + 1] = y;
+        probe[i * 3 + 2] = z;
+    }
+}
+
+bool Model::DrawCachedPreviewGeometry(PreviewGeometryCache& cache, DrawGLUtils::xlAccumulator& va, const float probe[12]) {
+    if (cache.IsEmpty() || cache.order.size() != Nodes.size() || cache.coordsPerVertex != va.coordsPerVertex ||
+        cache.pixelStyle != pixelStyle || cache.pixelSize != pixelSize || memcmp(cache.probe, probe, sizeof(cache.probe)) != 0) {
+        return false;
+    }
+
+    unsigned int vcount = cache.vertexStart.back();
+    va.PreAlloc(vcount);
+    uint8_t* colors = &va.colors[va.count * 4];
+    const float* coord = cache.coords.data();
+    xlColor color;
+    for (size_t i = 0; i < cache.order.size(); i++) {
+        const NodeBaseClassPtr& node = Nodes[cache.order[i]];
+        size_t CoordCount = GetCoordCount(cache.order[i]);
+        if (CoordCount != cache.coordStart[i + 1] - cache.coordStart[i]) {
+            return false;
+        }
+        for (size_t c2 = 0; c2 < CoordCount; c2++, coord += 3) {
+            if (node->Coords[c2].screenX != coord[0] || node->Coords[c2].screenY != coord[1] || node->Coords[c2].screenZ != coord[2]) {
+                return false;
+            }
+        }
+
+        node->GetColor(color);
+        if (node->model->modelDimmingCurve != nullptr) {
+            node->model->modelDimmingCurve->reverse(color);
+        }
+        if (node->model->StrobeRate) {
+            int r = rand() % 5;
+            if (r != 0) {
+                color = xlBLACK;
+            }
+        }
+        xlColor ccolor(color);
+        xlColor ecolor(color);
+        ApplyTransparency(ccolor, transparency, blackTransparency);
+        if (pixelStyle < 3) {
+            ecolor = ccolor;
+        } else {
+            ecolor.alpha = 0;
+        }
+        // circles are triangles of edge, edge, centre
+        for (uint32_t v = cache.vertexStart[i]; v < cache.vertexStart[i + 1]; v++) {
+            const xlColor& vc = (v - cache.vertexStart[i]) % 3 == 2 ? ccolor : ecolor;
+            uint8_t* cp = &colors[v * 4];
+            cp[0] = vc.Red();
+            cp[1] = vc.Green();
+            cp[2] = vc.Blue();
+            cp[3] = vc.Alpha();
+        }
+    }
+    memcpy(&va.vertices[va.count * va.coordsPerVertex], cache.vertices.data(), cache.vertices.size() * sizeof(float));
+    va.count += vcount;
+    return true;
+}
+
+void Model::SavePreviewGeometry(PreviewGeometryCache& cache, const DrawGLUtils::xlAccumulator& va, const float probe[12],
+                                unsigned int startVertex, std::vector<uint32_t>& order, std::vector<uint32_t>& vertexStart) {
+    cache.Clear();
+    cache.coordsPerVertex = va.coordsPerVertex;
+    cache.pixelStyle = pixelStyle;
+    cache.pixelSize = pixelSize;
+    memcpy(cache.probe, probe, sizeof(cache.probe));
+    cache.order.swap(order);
+    cache.vertexStart.swap(vertexStart);
+    cache.vertexStart.push_back(va.count - startVertex);
+
+    cache.coordStart.reserve(cache.order.size() + 1);
+    for (auto n : cache.order) {
+        cache.coordStart.push_back(cache.coords.size() / 3);
+        size_t CoordCount = GetCoordCount(n);
+        for (size_t c2 = 0; c2 < CoordCount; c2++) {
+            cache.coords.push_back(Nodes[n]->Coords[c2].screenX);
+            cache.coords.push_back(Nodes[n]->Coords[c2].screenY);
+            cache.coords.push_back(Nodes[n]->Coords[c2].screenZ);
+        }
+    }
+    cache.coordStart.push_back(cache.coords.size() / 3);
+
+    cache.vertices.assign(&va.vertices[startVertex * va.coordsPerVertex], &va.vertices[va.count * va.coordsPerVertex]);
+
+    // bounds of the points or circle centres as the full draw calculates them
+    cache.minx = cache.miny = 999999.0f;
+    cache.maxx = cache.maxy = -999999.0f;
+    unsigned int step = pixelStyle > 1 ? 3 : 1;
+    for (unsigned int v = step - 1; v < va.count - startVertex; v += step) {
+        float x = cache.vertices[v * va.coordsPerVertex];
+        float y = cache.vertices[v * va.coordsPerVertex + 1];
+        cache.minx = std::min(cache.minx, x);
+        cache.miny = std::min(cache.miny, y);
+        cache.maxx = std::max(cache.maxx, x);
+        cache.maxy = std::max(cache.maxy, y);
+    }
+}
+
 wxString Model::GetNodeNear(ModelPreview* preview, wxPoint pt, bool flip)
 {
     int w, h;
@@ -333,6 +333,20 @@ public:
     virtual void DisplayModelOnWindow(ModelPreview* preview, DrawGLUtils::xlAccumulator& solidVa, DrawGLUtils::xlAccumulator& transparentVa, float& minx, float& miny, float& maxx, float& maxy, bool is_3d = false, const xlColor* color = NULL, bool allowSelected = false);
     virtual void DisplayModelOnWindow(ModelPreview* preview, DrawGLUtils::xl3Accumulator& solidVa3, DrawGLUtils::xl3Accumulator& transparentVa3, DrawGLUtils::xl3Accumulator& lva, bool is_3d = false, const xlColor* color = NULL, bool allowSelected = false, bool wiring = false, bool highlightFirst = false, int highlightpixel = 0);
     virtual void DisplayEffectOnWindow(ModelPreview* preview, double pointSize);
+
+    // Used to draw the model without OpenGL. A point is returned for every node coordinate
+    // after the screen location transform with the world space radius of the circle drawn
+    // around it for the circle pixel styles
+    struct PreviewPoint {
+        uint32_t node;
+        float x;
+        float y;
+        float z;
+        float radius;
+    };
+    void GetPreviewPoints(bool is_3d, std::vector<PreviewPoint>& points);
+    // the node colour as the preview draws it ... after dimming, strobe and transparency
+    xlColor GetNodePreviewColor(size_t nodenum) const;
     virtual int NodeRenderOrder() { return 0; }
     wxString GetNodeNear(ModelPreview* preview, wxPoint pt, bool flip);
     std::vector<int> GetNodesInBoundingBox(ModelPreview* preview, wxPoint start, wxPoint end);
@@ -552,6 +566,35 @@ protected:
     std::vector<int> layerSizes; // inside to outside
 
     unsigned int maxVertexCount;
+
+    // The vertices generated the last time the model was drawn with its node colours. While the
+    // screen location and node coordinates are unchanged following frames copy these and only
+    // recalculate the colours which is all that changes while a sequence plays
+    class PreviewGeometryCache {
+    public:
+        void Clear() { order.clear(); vertices.clear(); coords.clear(); vertexStart.clear(); coordStart.clear(); }
+        bool IsEmpty() const { return order.empty(); }
+
+        unsigned int coordsPerVertex = 0;
+        int pixelStyle = -1;
+        int pixelSize = -1;
+        float probe[12];                   // the screen location transform applied to the unit axes
+        std::vector<uint32_t> order;       // node index in the order they were drawn
+        std::vector<uint32_t> vertexStart; // first vertex of each drawn node plus the end
+        std::vector<uint32_t> coordStart;  // first coord of each drawn node plus the end
+        std::vector<float> coords;         // untranslated node coordinates used to detect layout changes
+        std::vector<float> vertices;
+        float minx = 0;
+        float miny = 0;
+        float maxx = 0;
+        float maxy = 0;
+    };
+    PreviewGeometryCache previewGeometry[2]; // 2D and 3D
+
+    void GetPreviewGeometryProbe(float probe[12]) const;
+    bool DrawCachedPreviewGeometry(PreviewGeometryCache& cache, DrawGLUtils::xlAccumulator& va, const float probe[12]);
+    void SavePreviewGeometry(PreviewGeometryCache& cache, const DrawGLUtils::xlAccumulator& va, const float probe[12],
+                             unsigned int startVertex, std::vector<uint32_t>& order, std::vector<uint32_t>& vertexStart);
 };
 
 template <class ScreenLocation>
@@ -605,14 +605,14 @@ bool ModelGroup::Reset(bool zeroBased) {
     return true;
 }
 
-void ModelGroup::ResetModels()
+void ModelGroup::ResetModels(bool resetSubGroups)
 {
     models.clear();
     wxArrayString mn = wxSplit(ModelXml->GetAttribute("models"), ',');
     for (int x = 0; x < mn.size(); x++) {
         Model *c = modelManager.GetModel(mn[x].Trim(true).Trim(false).ToStdString());
         if (c != nullptr && c != this) {
-            if (c->GetDisplayAs() == "ModelGroup") {
+            if (resetSubGroups && c->GetDisplayAs() == "ModelGroup") {
                 static_cast<ModelGroup*>(c)->ResetModels();
             }
             models.push_back(c);
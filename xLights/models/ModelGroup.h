@@ -64,7 +64,7 @@ class ModelGroup : public ModelWithScreenLocation<BoxedScreenLocation>
         virtual int GetNumStrands() const override { return 0;}
 
         bool Reset(bool zeroBased = false);
-        void ResetModels();
+        void ResetModels(bool resetSubGroups = true);
     protected:
         static std::vector<std::string> GROUP_BUFFER_STYLES;
 
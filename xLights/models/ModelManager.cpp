@@ -50,6 +50,79 @@
 #include "Parallel.h"
 #include <log4cpp/Category.hh>
 
+#include <functional>
+
+namespace
+{
+    // Orders a dependency graph into levels where everything in a level only depends on
+    // things in earlier levels so everything within a level can be processed at once.
+    // Anything that cant be placed is part of a loop and is returned in leftOver.
+    std::vector<std::vector<int>> GetDependencyLevels(const std::vector<std::vector<int>>& dependsOn, std::vector<int>& leftOver)
+    {
+        std::vector<std::vector<int>> dependants(dependsOn.size());
+        std::vector<int> waiting(dependsOn.size(), 0);
+        for (int i = 0; i < (int)dependsOn.size(); i++) {
+            for (const auto& d : dependsOn[i]) {
+                dependants[d].push_back(i);
+                waiting[i]++;
+            }
+        }
+
+        std::vector<std::vector<int>> levels;
+        std::vector<int> level;
+        for (int i = 0; i < (int)dependsOn.size(); i++) {
+            if (waiting[i] == 0) level.push_back(i);
+        }
+        while (!level.empty()) {
+            std::vector<int> next;
+            for (const auto& i : level) {
+                for (const auto& d : dependants[i]) {
+                    if (--waiting[d] == 0) next.push_back(d);
+                }
+            }
+            levels.push_back(std::move(level));
+            level = std::move(next);
+        }
+
+        leftOver.clear();
+        for (int i = 0; i < (int)dependsOn.size(); i++) {
+            if (waiting[i] > 0) leftOver.push_back(i);
+        }
+        return levels;
+    }
+
+    // the model a >model:n, <model:n or @model:n start channel is chained from ... chaining from a submodel depends on its parent
+    std::string GetStartChannelModel(const std::string& startChannel)
+    {
+        std::string sc = Trim(startChannel);
+        if (sc.empty() || (sc[0] != '>' && sc[0] != '<' && sc[0] != '@')) return "";
+
+        std::string name = Trim(sc.substr(1, sc.find(':') == std::string::npos ? std::string::npos : sc.find(':') - 1));
+        if (name.find('/') != std::string::npos) {
+            name = Trim(name.substr(0, name.find('/')));
+        }
+        return name;
+    }
+
+    // everything a model's start channel is calculated from ... its own settings and where the models it is chained from sit
+    size_t GetStartChannelSignature(const Model* model, const std::vector<int>& dependsOn, const std::vector<Model*>& chain)
+    {
+        size_t sig = 0;
+        auto combine = [&sig](size_t h) { sig ^= h + 0x9e3779b9 + (sig << 6) + (sig >> 2); };
+
+        for (wxXmlAttribute* a = model->GetModelXml()->GetAttributes(); a != nullptr; a = a->GetNext()) {
+            combine(std::hash<std::string>()(a->GetName().ToStdString()));
+            combine(std::hash<std::string>()(a->GetValue().ToStdString()));
+        }
+        for (const auto& d : dependsOn) {
+            combine(chain[d]->GetFirstChannel());
+            combine(chain[d]->GetLastChannel());
+            combine(chain[d]->CouldComputeStartChannel ? 1 : 0);
+        }
+        return sig;
+    }
+}
+
 ModelManager::ModelManager(OutputManager* outputManager, xLightsFrame* xl) :
     _outputManager(outputManager),
     xlights(xl),
@@ -79,6 +152,7 @@ void ModelManager::clear()
         }
     }
     models.clear();
+    _startChannelSignatures.clear();
 }
 
 inline BaseObject *ModelManager::GetObject(const std::string &name) const {
@@ -263,12 +337,38 @@ void ModelManager::ResetModelGroups() const
     //logger_base.debug("ModelManager resetting groups.");
 
     // This goes through all the model groups which hold model pointers and ensure their model pointers are correct
+    // Groups within groups are reset before the groups containing them so each group is only reset once
     std::lock_guard<std::recursive_mutex> lock(_modelMutex);
+
+    std::vector<ModelGroup*> groups;
+    std::map<std::string, int> index;
     for (const auto& it : models) {
         if (it.second != nullptr && it.second->GetDisplayAs() == "ModelGroup") {
-            ((ModelGroup*)(it.second))->ResetModels();
+            index[it.first] = groups.size();
+            groups.push_back((ModelGroup*)(it.second));
         }
     }
+
+    std::vector<std::vector<int>> dependsOn(groups.size());
+    for (int i = 0; i < (int)groups.size(); i++) {
+        wxArrayString mn = wxSplit(groups[i]->GetModelXml()->GetAttribute("models"), ',');
+        for (const auto& it : mn) {
+            auto g = index.find(Trim(it.ToStdString()));
+            if (g != index.end() && g->second != i) {
+                dependsOn[i].push_back(g->second);
+            }
+        }
+    }
+
+    std::vector<int> leftOver;
+    for (const auto& level : GetDependencyLevels(dependsOn, leftOver)) {
+        for (const auto& it : level) {
+            groups[it]->ResetModels(false);
+        }
+    }
+    for (const auto& it : leftOver) {
+        groups[it]->ResetModels(false);
+    }
 }
 
 std::string ModelManager::GetLastModelOnPort(const std::string& controllerName, int port, const std::string& excludeModel, const std::string& protocol) const
@@ -399,90 +499,92 @@ void ModelManager::AddModelGroups(wxXmlNode* n, int w, int h, const std::string&
 
 bool ModelManager::RecalcStartChannels() const {
     static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
-    std::lock_guard<std::recursive_mutex> lock(_modelMutex);
+    std::unique_lock<std::recursive_mutex> lock(_modelMutex);
 
     wxStopWatch sw;
-    bool changed = false;
-    std::set<std::string> modelsDone;
 
+    // Models chained from other models (>model:1, <model:1 or @model:1) form a dependency graph. Each level of
+    // it only depends on the levels before so a whole level can be calculated at once and a chained
+    // model only needs calculating again if it or a model it is chained from has changed.
+    std::vector<Model*> chain;
+    std::map<std::string, int> index;
     for (const auto& it : models) {
-        it.second->CouldComputeStartChannel = false;
+        if (it.second->GetDisplayAs() != "ModelGroup") {
+            index[it.first] = chain.size();
+            chain.push_back(it.second);
+        }
     }
 
-    // first go through all models whose start channels are not dependent on other models
-    for (const auto& it : models) {
-        if (it.second->GetDisplayAs() != "ModelGroup")
-        {
-            char first = '0';
-            if (Trim(it.second->ModelStartChannel) != "") first = Trim(it.second->ModelStartChannel)[0];
-            if (first != '>' && first != '@')
-            {
-                modelsDone.emplace(it.first);
-                auto oldsc = it.second->GetFirstChannel();
-                it.second->SetFromXml(it.second->GetModelXml());
-                if (oldsc != it.second->GetFirstChannel())
-                {
-                    changed = true;
+    std::vector<std::vector<int>> dependsOn(chain.size());
+    for (int i = 0; i < (int)chain.size(); i++) {
+        std::set<std::string> names;
+        names.insert(GetStartChannelModel(chain[i]->GetModelXml()->GetAttribute("StartChannel").ToStdString()));
+        if (chain[i]->GetModelXml()->GetAttribute("Advanced", "0") == "1") {
+            for (wxXmlAttribute* a = chain[i]->GetModelXml()->GetAttributes(); a != nullptr; a = a->GetNext()) {
+                if (a->GetName().StartsWith("String") && a->GetName().Mid(6).IsNumber()) {
+                    names.insert(GetStartChannelModel(a->GetValue().ToStdString()));
                 }
             }
         }
+        for (const auto& it : names) {
+            auto m = index.find(it);
+            if (m != index.end() && m->second != i) {
+                dependsOn[i].push_back(m->second);
+            }
+        }
     }
 
-    // now go through all undone models that depend on something
-    bool workDone = false;
-    do
-    {
-        workDone = false;
+    std::vector<int> leftOver;
+    auto levels = GetDependencyLevels(dependsOn, leftOver);
 
-        for (const auto& it : models) {
-            if (it.second->GetDisplayAs() != "ModelGroup")
-            {
-                char first = '0';
-                if (Trim(it.second->ModelStartChannel) != "") first = Trim(it.second->ModelStartChannel)[0];
-                if ((first == '>' || first == '@') && !it.second->CouldComputeStartChannel)
-                {
-                    std::string dependsOn = Trim(Trim(it.second->ModelStartChannel).substr(1, Trim(it.second->ModelStartChannel).find(':') - 1));
-                    if (modelsDone.find(dependsOn) != modelsDone.end())
-                    {
-                        // the depends on model is done
-                        modelsDone.emplace(it.first);
-                        auto oldsc = it.second->GetFirstChannel();
-                        it.second->SetFromXml(it.second->GetModelXml());
-                        if (oldsc != it.second->GetFirstChannel())
-                        {
-                            changed = true;
-                        }
-                        if (it.second->CouldComputeStartChannel)
-                        {
-                            workDone = true;
-                        }
-                    }
-                }
+    // models look each other up while they calculate their start channels so let them at the list
+    lock.unlock();
+
+    std::atomic<bool> changed(false);
+    int calculated = 0;
+    for (const auto& level : levels) {
+        std::vector<int> todo;
+        for (const auto& it : level) {
+            auto last = _startChannelSignatures.find(chain[it]->GetName());
+            if (dependsOn[it].empty() || !chain[it]->CouldComputeStartChannel || last == _startChannelSignatures.end() ||
+                last->second != GetStartChannelSignature(chain[it], dependsOn[it], chain)) {
+                todo.push_back(it);
             }
         }
 
-    } while (workDone);
+        parallel_for(0, todo.size(), [&chain, &todo, &changed](int i) {
+            Model* m = chain[todo[i]];
+            auto oldsc = m->GetFirstChannel();
+            m->SetFromXml(m->GetModelXml());
+            if (oldsc != m->GetFirstChannel()) {
+                changed = true;
+            }
+        });
+
+        for (const auto& it : todo) {
+            _startChannelSignatures[chain[it]->GetName()] = GetStartChannelSignature(chain[it], dependsOn[it], chain);
+        }
+        calculated += todo.size();
+    }
+
+    // anything left is chained in a loop so will fail but still needs loading
+    for (const auto& it : leftOver) {
+        auto oldsc = chain[it]->GetFirstChannel();
+        chain[it]->SetFromXml(chain[it]->GetModelXml());
+        if (oldsc != chain[it]->GetFirstChannel()) {
+            changed = true;
+        }
+        _startChannelSignatures.erase(chain[it]->GetName());
+    }
 
-    // now process anything unprocessed
     int countInvalid = 0;
-    for (const auto& it : models) {
-        if (it.second->GetDisplayAs() != "ModelGroup") {
-            char first = '0';
-            if (Trim(it.second->ModelStartChannel) != "") first = Trim(it.second->ModelStartChannel)[0];
-            if ((first == '>' || first == '@') && !it.second->CouldComputeStartChannel) {
-                modelsDone.emplace(it.first);
-                auto oldsc = it.second->GetFirstChannel();
-                it.second->SetFromXml(it.second->GetModelXml());
-                if (oldsc != it.second->GetFirstChannel()) {
-                    changed = true;
-                }
-            }
-            if (!it.second->CouldComputeStartChannel) {
-                countInvalid++;
-            }
+    for (const auto& it : chain) {
+        if (!it->CouldComputeStartChannel) {
+            countInvalid++;
         }
     }
 
+    lock.lock();
     ResetModelGroups();
 
     // Commenting out as this doesn't need to happen unless we have changes and when we do it is redundant as the only
@@ -490,7 +592,7 @@ bool ModelManager::RecalcStartChannels() const {
     //xlights->GetOutputModelManager()->AddASAPWork(OutputModelManager::WORK_RELOAD_MODELLIST, "RecalcStartChannels");
 
     long end = sw.Time();
-    logger_base.debug("RecalcStartChannels takes %ldms.", end);
+    logger_base.debug("RecalcStartChannels takes %ldms. %d of %d models recalculated across %d levels.", end, calculated + (int)leftOver.size(), (int)chain.size(), (int)levels.size());
 
     if (countInvalid > 0) {
         DisplayStartChannelCalcWarning();
@@ -892,9 +994,30 @@ bool ModelManager::LoadGroups(wxXmlNode* groupNode, int previewW, int previewH)
 
     std::list<wxXmlNode*> toBeDone;
     std::list<std::string> allModels;
-    std::lock_guard<std::recursive_mutex> lock(_modelMutex);
+    std::unique_lock<std::recursive_mutex> lock(_modelMutex);
+
+    // Groups whose models all exist dont depend on each other so are built in parallel. Building
+    // a group looks up its models so the model list is unlocked while they are built
+    auto buildGroups = [this, previewW, previewH, &lock](const std::vector<wxXmlNode*>& nodes, bool reset) {
+        std::vector<ModelGroup*> built(nodes.size());
+        std::vector<uint8_t> resetOk(nodes.size(), 1);
+        lock.unlock();
+        parallel_for(0, nodes.size(), [this, previewW, previewH, reset, &nodes, &built, &resetOk](int i) {
+            built[i] = new ModelGroup(nodes[i], *this, previewW, previewH);
+            if (reset) {
+                resetOk[i] = built[i]->Reset() ? 1 : 0;
+            }
+        });
+        lock.lock();
+        for (size_t i = 0; i < nodes.size(); i++) {
+            wxASSERT(resetOk[i]);
+            models[built[i]->name] = built[i];
+            built[i]->SetLayoutGroup(nodes[i]->GetAttribute("LayoutGroup", "Unassigned").ToStdString());
+        }
+    };
 
-    // do all the models without embedded groups first or where the model order means everything exists
+    // do all the models without embedded groups first
+    std::vector<wxXmlNode*> ready;
     for (wxXmlNode* e = groupNode->GetChildren(); e != nullptr; e = e->GetNext()) {
         if (e->GetName() == "modelGroup") {
             std::string name = e->GetAttribute("name").ToStdString();
@@ -902,9 +1025,7 @@ bool ModelManager::LoadGroups(wxXmlNode* groupNode, int previewW, int previewH)
                 allModels.push_back(name);
                 if (ModelGroup::AllModelsExist(e, *this))
                 {
-                    ModelGroup* model = new ModelGroup(e, *this, previewW, previewH);
-                    models[model->name] = model;
-                    model->SetLayoutGroup(e->GetAttribute("LayoutGroup", "Unassigned").ToStdString());
+                    ready.push_back(e);
                 }
                 else
                 {
@@ -913,6 +1034,7 @@ bool ModelManager::LoadGroups(wxXmlNode* groupNode, int previewW, int previewH)
             }
         }
     }
+    buildGroups(ready, false);
 
     // add in models and submodels
     for (const auto& it : models)
@@ -931,27 +1053,26 @@ bool ModelManager::LoadGroups(wxXmlNode* groupNode, int previewW, int previewH)
         changed |= ModelGroup::RemoveNonExistentModels(it, allModels);
     }
 
-    // try up to however many models we have left
+    // each pass builds the groups whose contents have now all been built
     int maxIter = toBeDone.size();
     while (maxIter > 0 && toBeDone.size() > 0)
     {
         maxIter--;
         std::list<wxXmlNode*> processing(toBeDone);
         toBeDone.clear();
+        ready.clear();
         for (const auto& it : processing) {
             if (ModelGroup::AllModelsExist(it, *this))
             {
-                ModelGroup* model = new ModelGroup(it, *this, previewW, previewH);
-                bool reset = model->Reset();
-                wxASSERT(reset);
-                models[model->name] = model;
-                model->SetLayoutGroup(it->GetAttribute("LayoutGroup", "Unassigned").ToStdString());
+                ready.push_back(it);
             }
             else
             {
                 toBeDone.push_back(it);
             }
         }
+        if (ready.empty()) break;
+        buildGroups(ready, true);
     }
 
     // anything left in toBeDone is now due to model loops
@@ -89,6 +89,7 @@ class ModelManager : public ObjectManager
     int previewWidth = 0;
     int previewHeight = 0;
     std::map<std::string, Model *> models;
+    mutable std::map<std::string, size_t> _startChannelSignatures; // what each model's start channel was last calculated from
     mutable std::recursive_mutex _modelMutex;
     std::atomic<bool> _modelsLoading;
 };
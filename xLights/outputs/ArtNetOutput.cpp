@@ -317,14 +317,15 @@ void ArtNetOutput::EndFrame(int suppressFrames) {
 
     if (!_enabled || _suspend || _datagram == nullptr) return;
 
-    if (_changed || NeedToOutput(suppressFrames)) {
+    if (IsPacketDue(0, suppressFrames)) {
         _data[12] = _sequenceNum;
         _datagram->SendTo(_remoteAddr, _data, ARTNET_PACKET_LEN - (512 - _channels));
         _sequenceNum = _sequenceNum == 255 ? 0 : _sequenceNum + 1;
+        PacketSent(0);
         FrameOutput();
-        _changed = false;
     }
     else {
+        PacketSuppressed(0);
         SkipFrame();
     }
 }
@@ -336,32 +337,22 @@ void ArtNetOutput::SetOneChannel(int32_t channel, unsigned char data) {
     if (!_enabled) return;
     wxASSERT(channel < _channels);
 
-    if (_data[channel + ARTNET_PACKET_HEADERLEN] != data) {
-        _data[channel + ARTNET_PACKET_HEADERLEN] = data;
-        _changed = true;
-    }
+    UpdateChannel(&_data[channel + ARTNET_PACKET_HEADERLEN], channel, data);
 }
 
-void ArtNetOutput::SetManyChannels(int32_t channel, unsigned char* data, size_t size) {
+void ArtNetOutput::SetManyChannels(int32_t channel, const unsigned char* data, size_t size) {
 
     if (!_enabled) return;
     wxASSERT(channel + size <= _channels);
 
     size_t chs = (std::min)((int32_t)size, _channels - channel);
-
-    if (memcmp(&_data[channel + ARTNET_PACKET_HEADERLEN], data, chs) == 0) {
-        // nothing has changed
-    }
-    else {
-        memcpy(&_data[channel + ARTNET_PACKET_HEADERLEN], data, chs);
-        _changed = true;
-    }
+    UpdateChannels(&_data[channel + ARTNET_PACKET_HEADERLEN], channel, data, chs);
 }
 
 void ArtNetOutput::AllOff() {
 
     if (!_enabled) return;
     memset(&_data[ARTNET_PACKET_HEADERLEN], 0x00, _channels);
-    _changed = true;
+    MarkAllPacketsDirty();
 }
 #pragma endregion
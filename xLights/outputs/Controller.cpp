@@ -112,6 +112,7 @@ Controller::Controller(OutputManager* om, wxXmlNode* node, const std::string& sh
     _model = node->GetAttribute("Model");
     _variant = node->GetAttribute("Variant");
     SetSuppressDuplicateFrames(node->GetAttribute("SuppressDuplicates", "0") == "1");
+    SetKeepAliveFrames(wxAtoi(node->GetAttribute("KeepAliveFrames", "0")));
 
     _dirty = false;
 }
@@ -145,6 +146,7 @@ wxXmlNode* Controller::Save() {
     node->AddAttribute("AutoLayout", _autoLayout ? "1" : "0");
     node->AddAttribute("AutoUpload", _autoUpload && SupportsAutoUpload() ? "1" : "0");
     node->AddAttribute("SuppressDuplicates", _suppressDuplicateFrames ? "1" : "0");
+    if (_keepAliveFrames != 0) node->AddAttribute("KeepAliveFrames", wxString::Format("%d", _keepAliveFrames));
     for (const auto& it : _outputs) {
         node->AddChild(it->Save());
     }
@@ -388,6 +390,16 @@ void Controller::SetSuppressDuplicateFrames(bool suppress) {
     }
 }
 
+void Controller::SetKeepAliveFrames(int keepAliveFrames) {
+
+    if (keepAliveFrames < 0) keepAliveFrames = 0;
+    if (_keepAliveFrames != keepAliveFrames) {
+        _keepAliveFrames = keepAliveFrames;
+        _dirty = true;
+        std::for_each(begin(_outputs), end(_outputs), [keepAliveFrames](Output* o) { o->SetKeepAliveFrames(keepAliveFrames); });
+    }
+}
+
 void Controller::SetGlobalFPPProxy(const std::string& globalFPPProxy)
 {
     for (const auto& it : _outputs)         {
@@ -403,6 +415,7 @@ void Controller::SetTransientData(int32_t& startChannel, int& nullnumber)
 
         // make sure data which is now kept on the controller is duplicated to the outputs so they behave as expected
         it->SetSuppressDuplicateFrames(_suppressDuplicateFrames);
+        it->SetKeepAliveFrames(_keepAliveFrames);
         it->Enable(IsActive());
 
         it->SetTransientData(startChannel, nullnumber);
@@ -562,6 +575,11 @@ void Controller::AddProperties(wxPropertyGrid* propertyGrid, ModelManager* model
     if (SupportsSuppressDuplicateFrames()) {
         p = propertyGrid->Append(new wxBoolProperty("Suppress Duplicate Frames", "SuppressDuplicates", IsSuppressDuplicateFrames()));
         p->SetEditor("CheckBox");
+        p = propertyGrid->Append(new wxUIntProperty("Keep Alive Frames", "KeepAliveFrames", GetKeepAliveFrames()));
+        p->SetAttribute("Min", 0);
+        p->SetAttribute("Max", 1000);
+        p->SetEditor("SpinCtrl");
+        p->SetHelpString("When suppressing duplicate frames unchanged data is still sent at least this often. 0 uses the global setting.");
     }
 }
 
@@ -620,6 +638,11 @@ bool Controller::HandlePropertyEvent(wxPropertyGridEvent& event, OutputModelMana
         outputModelManager->AddASAPWork(OutputModelManager::WORK_NETWORK_CHANGE, "Controller::HandlePropertyEvent::SuppressDuplicates");
         return true;
     }
+    else if (name == "KeepAliveFrames") {
+        SetKeepAliveFrames(event.GetValue().GetLong());
+        outputModelManager->AddASAPWork(OutputModelManager::WORK_NETWORK_CHANGE, "Controller::HandlePropertyEvent::KeepAliveFrames");
+        return true;
+    }
     else if (name == "AutoSize") {
         SetAutoSize(event.GetValue().GetBool(), outputModelManager);
         outputModelManager->AddASAPWork(OutputModelManager::WORK_NETWORK_CHANGE, "Controller::HandlePropertyEvent::AutoSize");
@@ -64,6 +64,7 @@ protected:
     std::string _model;                      // the model of the controller
     std::string _variant;                    // the variant of the controller
     bool _suppressDuplicateFrames = false;   // should we suppress duplicate fromes
+    int _keepAliveFrames = 0;                // most frames unchanged data is suppressed for ... 0 uses the global setting
     Output::PINGSTATE _lastPingResult = Output::PINGSTATE::PING_UNKNOWN; // last ping result
     bool _tempDisable = false;
     
@@ -153,6 +154,8 @@ public:
 
     bool IsSuppressDuplicateFrames() const { return _suppressDuplicateFrames; }
     void SetSuppressDuplicateFrames(bool suppress);
+    int GetKeepAliveFrames() const { return _keepAliveFrames; }
+    void SetKeepAliveFrames(int keepAliveFrames);
 
     void SetGlobalFPPProxy(const std::string& globalFPPProxy);
 
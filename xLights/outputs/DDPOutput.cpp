@@ -69,30 +69,30 @@ void DDPOutput::OpenDatagram() {
 #pragma region Constructors and Destructors
 DDPOutput::DDPOutput(wxXmlNode* node) : IPOutput(node) {
 
-    _fulldata = nullptr;
+    _packets = nullptr;
+    _packetCount = 0;
     _channelsPerPacket = wxAtoi(node->GetAttribute("ChannelsPerPacket"));
     _keepChannelNumbers = wxAtoi(node->GetAttribute("KeepChannelNumbers"));
     _sequenceNum = 0;
     _datagram = nullptr;
-    memset(_data, 0, sizeof(_data));
 }
 
 DDPOutput::DDPOutput() : IPOutput() {
 
     _universe = 64001;
-    _fulldata = nullptr;
+    _packets = nullptr;
+    _packetCount = 0;
     _channelsPerPacket = 1440;
     _channels = 512;
     _sequenceNum = 0;
     _datagram = nullptr;
     _keepChannelNumbers = true;
-    memset(_data, 0, sizeof(_data));
 }
 
 DDPOutput::~DDPOutput() {
 
     if (_datagram != nullptr) delete _datagram;
-    if (_fulldata != nullptr) delete _fulldata;
+    if (_packets != nullptr) free(_packets);
 }
 
 wxXmlNode* DDPOutput::Save() {
@@ -337,14 +337,19 @@ bool DDPOutput::Open() {
     if (_ip == "") return false;
     if (!IsIPValid(_resolvedIp)) return false;
 
-    if (_fulldata != nullptr) delete _fulldata;
-    _fulldata = (uint8_t*)malloc(_channels);
-    if (_fulldata == nullptr) {
-        logger_base.error("Problem allocating %d memory for DDP output '%s'.", _channels, (const char *)GetIP().c_str());
+    // the packets are laid out before IPOutput::Open so they need the packet size now
+    SetPacketChannels(GetChannelsPerPacket());
+    _packetCount = (_channels + _packetChannels - 1) / _packetChannels;
+
+    if (_packets != nullptr) free(_packets);
+    _packets = (uint8_t*)calloc(_packetCount, GetPacketSize());
+    if (_packets == nullptr) {
+        logger_base.error("Problem allocating %d memory for DDP output '%s'.", (int)(_packetCount * GetPacketSize()), (const char *)GetIP().c_str());
         _ok = false;
         return false;
     }
-    AllOff();
+    BuildPacketHeaders();
+    _due.assign(_packetCount, 0);
 
     _ok = IPOutput::Open();
     
@@ -352,10 +357,6 @@ bool DDPOutput::Open() {
         return _ok;
     }
 
-    memset(_data, 0x00, sizeof(_data));
-
-    _data[2] = 1;
-    _data[3] = DDP_ID_DISPLAY;
     _sequenceNum = 1;
 
     OpenDatagram();
@@ -372,12 +373,44 @@ void DDPOutput::Close() {
         delete _datagram;
         _datagram = nullptr;
     }
-    if (_fulldata != nullptr) {
-        free(_fulldata);
-        _fulldata = nullptr;
+    if (_packets != nullptr) {
+        free(_packets);
+        _packets = nullptr;
     }
+    _packetCount = 0;
+    _due.clear();
     IPOutput::Close();
 }
+
+// Everything in the header except the push flag and the sequence number is fixed for the
+// life of the output so it is written once here and the channel data is set directly into
+// the packets. Sending a frame is then just patching two bytes in each packet.
+void DDPOutput::BuildPacketHeaders() {
+
+    int32_t chan = _keepChannelNumbers ? (_startChannel - 1) : 0;
+    int32_t tosend = _channels;
+
+    for (int p = 0; p < _packetCount; p++) {
+        int32_t thissend = (tosend < _packetChannels) ? tosend : _packetChannels;
+        uint8_t* header = GetPacket(p);
+
+        header[0] = DDP_FLAGS1_VER1;
+        header[1] = 0;
+        header[2] = 1;
+        header[3] = DDP_ID_DISPLAY;
+
+        header[4] = (chan & 0xFF000000) >> 24;
+        header[5] = (chan & 0xFF0000) >> 16;
+        header[6] = (chan & 0xFF00) >> 8;
+        header[7] = (chan & 0xFF);
+
+        header[8] = (thissend & 0xFF00) >> 8;
+        header[9] = thissend & 0x00FF;
+
+        tosend -= thissend;
+        chan += thissend;
+    }
+}
 #pragma endregion
 
 #pragma region Frame Handling
@@ -407,45 +440,41 @@ void DDPOutput::EndFrame(int suppressFrames) {
     }
     if (_datagram == nullptr) return;
 
-    if (_changed || NeedToOutput(suppressFrames)) {
-        int32_t index = 0;
-        int32_t chan = _keepChannelNumbers ? (_startChannel - 1) : 0;
+    // only the packets holding changed channels are sent ... the push flag goes on the last one sent
+    // _due is sized in Open and every entry is rewritten here each frame
+    int lastDue = -1;
+    for (int p = 0; p < _packetCount; p++) {
+        _due[p] = IsPacketDue(p, suppressFrames) ? 1 : 0;
+        if (_due[p]) {
+            lastDue = p;
+        }
+        else {
+            PacketSuppressed(p);
+        }
+    }
+
+    if (lastDue >= 0) {
         int32_t tosend = _channels;
 
-        while (tosend > 0) {
-            int32_t thissend = (tosend < _channelsPerPacket) ? tosend : _channelsPerPacket;
+        for (int p = 0; p < _packetCount; p++) {
+            int32_t thissend = (tosend < _packetChannels) ? tosend : _packetChannels;
+            tosend -= thissend;
 
-            if (__initialised) {
-                // sync packet will boadcast later
-                _data[0] = DDP_FLAGS1_VER1;
+            if (!_due[p]) continue;
+
+            uint8_t* packet = GetPacket(p);
+            if (!__initialised && p == lastDue) {
+                packet[0] = DDP_FLAGS1_VER1 | DDP_FLAGS1_PUSH;
             }
             else {
-                if (tosend == thissend) {
-                    _data[0] = DDP_FLAGS1_VER1 | DDP_FLAGS1_PUSH;
-                }
-                else {
-                    _data[0] = DDP_FLAGS1_VER1;
-                }
+                // sync packet will boadcast later
+                packet[0] = DDP_FLAGS1_VER1;
             }
+            packet[1] = _sequenceNum;
 
-            _data[1] = (_data[1] & 0xF0) + _sequenceNum;
-
-            _data[4] = (chan & 0xFF000000) >> 24;
-            _data[5] = (chan & 0xFF0000) >> 16;
-            _data[6] = (chan & 0xFF00) >> 8;
-            _data[7] = (chan & 0xFF);
-
-            _data[8] = (thissend & 0xFF00) >> 8;
-            _data[9] = thissend & 0x00FF;
-
-            memcpy(&_data[10], _fulldata + index, thissend);
-
-            _datagram->SendTo(_remoteAddr, &_data[0], DDP_PACKET_LEN - (1440 - thissend));
+            _datagram->SendTo(_remoteAddr, packet, DDP_PACKET_HEADERLEN + thissend);
             _sequenceNum = _sequenceNum == 15 ? 1 : _sequenceNum + 1;
-
-            tosend -= thissend;
-            index += thissend;
-            chan += thissend;
+            PacketSent(p);
         }
         FrameOutput();
     } else {
@@ -463,15 +492,14 @@ void DDPOutput::SetOneChannel(int32_t channel, unsigned char data) {
         _fppProxyOutput->SetOneChannel(channel, data);
         return;
     }
-    if (_fulldata == nullptr) return;
+    if (_packets == nullptr) return;
 
-    if ((channel < _channels) && (*(_fulldata + channel) != data)) {
-        *(_fulldata + channel) = data;
-        _changed = true;
+    if (channel < _channels) {
+        UpdateChannel(GetChannelData(channel), channel, data);
     }
 }
 
-void DDPOutput::SetManyChannels(int32_t channel, unsigned char* data, size_t size) {
+void DDPOutput::SetManyChannels(int32_t channel, const unsigned char* data, size_t size) {
 
     if (!_enabled) return;
 
@@ -479,15 +507,16 @@ void DDPOutput::SetManyChannels(int32_t channel, unsigned char* data, size_t siz
         _fppProxyOutput->SetManyChannels(channel, data, size);
         return;
     }
-    if (_fulldata == nullptr) return;
-
-    size_t chs = (std::min)((int32_t)size, _channels - channel);
-
-    if (memcmp(_fulldata + channel, data, chs) == 0) {
-        // nothing changed
-    } else {
-        memcpy(_fulldata + channel, data, chs);
-        _changed = true;
+    if (_packets == nullptr) return;
+
+    // the channels are split across the packets so copy each packet's share separately
+    int32_t chs = (std::min)((int32_t)size, _channels - channel);
+    while (chs > 0) {
+        int32_t thisset = (std::min)(chs, _packetChannels - channel % _packetChannels);
+        UpdateChannels(GetChannelData(channel), channel, data, thisset);
+        channel += thisset;
+        data += thisset;
+        chs -= thisset;
     }
 }
 
@@ -499,9 +528,11 @@ void DDPOutput::AllOff() {
         _fppProxyOutput->AllOff();
         return;
     }
-    if (_fulldata == nullptr) return;
-    memset(_fulldata, 0x00, _channels);
-    _changed = true;
+    if (_packets == nullptr) return;
+    for (int p = 0; p < _packetCount; p++) {
+        memset(GetPacket(p) + DDP_PACKET_HEADERLEN, 0x00, _packetChannels);
+    }
+    MarkAllPacketsDirty();
 }
 #pragma endregion
 
@@ -509,7 +540,7 @@ void DDPOutput::AllOff() {
 #ifndef EXCLUDENETWORKUI
 void DDPOutput::AddProperties(wxPropertyGrid* propertyGrid, bool allSameSize, std::list<wxPGProperty*>& expandProperties)
 {
-    auto p = propertyGrid->Append(new wxUIntProperty("Channels Per Packet", "ChannelsPerPacket", GetChannelsPerPacket()));
+    auto p = propertyGrid->Append(new wxUIntProperty("Channels Per Packet", "ChannelsPerPacket", _channelsPerPacket));
     p->SetAttribute("Min", 1);
     p->SetAttribute("Max", 1440);
     p->SetEditor("SpinCtrl");
@@ -50,11 +50,12 @@ class Discovery;
 class DDPOutput : public IPOutput
 {
     #pragma region Member Variables
-    uint8_t _data[DDP_PACKET_LEN];
     uint8_t _sequenceNum;
     wxIPV4address _remoteAddr;
     wxDatagramSocket *_datagram;
-    uint8_t* _fulldata;
+    uint8_t* _packets;       // the packets exactly as sent ... each is a header followed by its channels
+    int _packetCount;
+    std::vector<uint8_t> _due; // per packet ... set each frame to whether the packet needs to be sent
     int _channelsPerPacket;
     bool _keepChannelNumbers;
 
@@ -64,6 +65,10 @@ class DDPOutput : public IPOutput
 
     #pragma region Private Functions
     void OpenDatagram();
+    size_t GetPacketSize() const { return DDP_PACKET_HEADERLEN + _packetChannels; }
+    uint8_t* GetPacket(int packet) const { return _packets + packet * GetPacketSize(); }
+    uint8_t* GetChannelData(int32_t channel) const { return GetPacket(channel / _packetChannels) + DDP_PACKET_HEADERLEN + channel % _packetChannels; }
+    void BuildPacketHeaders();
     #pragma  endregion
 
 public:
@@ -89,7 +94,8 @@ public:
     int GetId() const { return _universe; }
     void SetId(int id) { _universe = id; _dirty = true; }
 
-    int GetChannelsPerPacket() const { return _channelsPerPacket; }
+    // the setting limited to what a packet can hold ... the setting itself is saved as entered
+    virtual int32_t GetChannelsPerPacket() const override { return (_channelsPerPacket < 1 || _channelsPerPacket > 1440) ? 1440 : _channelsPerPacket; }
     void SetChannelsPerPacket(int cpp) { _channelsPerPacket = cpp; _dirty = true; }
 
     virtual bool IsKeepChannelNumbers() const { return _keepChannelNumbers; }
@@ -115,7 +121,7 @@ public:
 
     #pragma region Data Setting
     virtual void SetOneChannel(int32_t channel, unsigned char data) override;
-    virtual void SetManyChannels(int32_t channel, unsigned char* data, size_t size) override;
+    virtual void SetManyChannels(int32_t channel, const unsigned char* data, size_t size) override;
     virtual void AllOff() override;
     #pragma endregion
 
@@ -81,7 +81,7 @@ void DMXOutput::SetOneChannel(int32_t channel, unsigned char data) {
     }
 }
 
-void DMXOutput::SetManyChannels(int32_t channel, unsigned char data[], size_t size) {
+void DMXOutput::SetManyChannels(int32_t channel, const unsigned char data[], size_t size) {
 
     if (!_enabled) return;
     size_t chs = std::min(size, (size_t)(GetMaxChannels() - channel));
@@ -428,13 +428,15 @@ void E131Output::EndFrame(int suppressFrames) {
 
     if (_datagram == nullptr) return;
 
-    if (_changed || NeedToOutput(suppressFrames)) {
+    if (IsPacketDue(0, suppressFrames)) {
         _data[111] = _sequenceNum;
         _datagram->SendTo(_remoteAddr, _data, E131_PACKET_LEN - (512 - _channels));
         _sequenceNum = _sequenceNum == 255 ? 0 : _sequenceNum + 1;
+        PacketSent(0);
         FrameOutput();
     }
     else {
+        PacketSuppressed(0);
         SkipFrame();
     }
 }
@@ -462,13 +464,10 @@ void E131Output::SetOneChannel(int32_t channel, unsigned char data) {
         return;
     }
 
-    if (_data[channel + E131_PACKET_HEADERLEN] != data) {
-        _data[channel + E131_PACKET_HEADERLEN] = data;
-        _changed = true;
-    }
+    UpdateChannel(&_data[channel + E131_PACKET_HEADERLEN], channel, data);
 }
 
-void E131Output::SetManyChannels(int32_t channel, unsigned char* data, size_t size) {
+void E131Output::SetManyChannels(int32_t channel, const unsigned char* data, size_t size) {
 
     wxASSERT(!IsOutputCollection_CONVERT());
 
@@ -479,13 +478,7 @@ void E131Output::SetManyChannels(int32_t channel, unsigned char* data, size_t si
     } 
     else {
         size_t chs = (std::min)(size, (size_t)(GetMaxChannels() - channel));
-
-        if (memcmp(&_data[channel + E131_PACKET_HEADERLEN], data, chs) == 0) {
-            // nothing changed
-        } else {
-            memcpy(&_data[channel + E131_PACKET_HEADERLEN], data, chs);
-            _changed = true;
-        }
+        UpdateChannels(&_data[channel + E131_PACKET_HEADERLEN], channel, data, chs);
     }
 }
 
@@ -500,7 +493,7 @@ void E131Output::AllOff() {
     } 
     else {
         memset(&_data[E131_PACKET_HEADERLEN], 0x00, _channels);
-        _changed = true;
+        MarkAllPacketsDirty();
     }
 }
 #pragma endregion
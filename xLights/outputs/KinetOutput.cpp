@@ -228,16 +228,17 @@ void KinetOutput::EndFrame(int suppressFrames) {
 
     if (!_enabled || _suspend || _tempDisable|| _datagram == nullptr) return;
 
-    if (_changed || NeedToOutput(suppressFrames)) {
+    if (IsPacketDue(0, suppressFrames)) {
 		if (_version == 2) {
 			_data[17] = _sequenceNum;
 		}
         _datagram->SendTo(_remoteAddr, _data, GetHeaderPacketLength() + _channels);
         _sequenceNum = _sequenceNum == 255 ? 0 : _sequenceNum + 1;
+        PacketSent(0);
         FrameOutput();
-        _changed = false;
     }
     else {
+        PacketSuppressed(0);
         SkipFrame();
     }
 }
@@ -249,32 +250,22 @@ void KinetOutput::SetOneChannel(int32_t channel, unsigned char data) {
     if (!_enabled) return;
     wxASSERT(channel < _channels);
 
-    if (_data[channel + GetHeaderPacketLength()] != data) {
-        _data[channel + GetHeaderPacketLength()] = data;
-        _changed = true;
-    }
+    UpdateChannel(&_data[channel + GetHeaderPacketLength()], channel, data);
 }
 
-void KinetOutput::SetManyChannels(int32_t channel, unsigned char* data, size_t size) {
+void KinetOutput::SetManyChannels(int32_t channel, const unsigned char* data, size_t size) {
 
     if (!_enabled) return;
     wxASSERT(channel + size <= _channels);
 
     size_t chs = (std::min)((int32_t)size, _channels - channel);
-
-    if (memcmp(&_data[channel + GetHeaderPacketLength()], data, chs) == 0) {
-        // nothing has changed
-    }
-    else {
-        memcpy(&_data[channel + GetHeaderPacketLength()], data, chs);
-        _changed = true;
-    }
+    UpdateChannels(&_data[channel + GetHeaderPacketLength()], channel, data, chs);
 }
 
 void KinetOutput::AllOff() {
 
     if (!_enabled) return;
     memset(&_data[GetHeaderPacketLength()], 0x00, _channels);
-    _changed = true;
+    MarkAllPacketsDirty();
 }
 #pragma endregion
@@ -254,7 +254,7 @@ void LOROptimisedOutput::SetOneChannel(int32_t channel, unsigned char data) {
     _curData[channel] = data;
 }
 
-void LOROptimisedOutput::SetManyChannels(int32_t channel, unsigned char* data, size_t size) {
+void LOROptimisedOutput::SetManyChannels(int32_t channel, const unsigned char* data, size_t size) {
 
     log4cpp::Category& logger_base = log4cpp::Category::getInstance(std::string("log_base"));
 
@@ -223,11 +223,13 @@ void OPCOutput::EndFrame(int suppressFrames) {
     if (reentry) return;
     reentry = true;
 
-    if (_changed || NeedToOutput(suppressFrames)) {
+    if (IsPacketDue(0, suppressFrames)) {
         _socket->Write(_data, _channels + OPC_PACKET_HEADERLEN);
+        PacketSent(0);
         FrameOutput();
     }
     else {
+        PacketSuppressed(0);
         SkipFrame();
     }
     reentry = false;
@@ -252,13 +254,10 @@ void OPCOutput::SetOneChannel(int32_t channel, unsigned char data) {
     //    return;
     //}
 
-    if (_data[channel + OPC_PACKET_HEADERLEN] != data) {
-        _data[channel + OPC_PACKET_HEADERLEN] = data;
-        _changed = true;
-    }
+    UpdateChannel(&_data[channel + OPC_PACKET_HEADERLEN], channel, data);
 }
 
-void OPCOutput::SetManyChannels(int32_t channel, unsigned char* data, size_t size) {
+void OPCOutput::SetManyChannels(int32_t channel, const unsigned char* data, size_t size) {
 
     if (!_enabled) return;
     //if (_fppProxyOutput) {
@@ -266,13 +265,7 @@ void OPCOutput::SetManyChannels(int32_t channel, unsigned char* data, size_t siz
     //} 
     //else {
         size_t chs = (std::min)(size, (size_t)(GetMaxChannels() - channel));
-
-        if (memcmp(&_data[channel + OPC_PACKET_HEADERLEN], data, chs) == 0) {
-            // nothing changed
-        } else {
-            memcpy(&_data[channel + OPC_PACKET_HEADERLEN], data, chs);
-            _changed = true;
-        }
+        UpdateChannels(&_data[channel + OPC_PACKET_HEADERLEN], channel, data, chs);
     //}
 }
 
@@ -284,7 +277,7 @@ void OPCOutput::AllOff() {
     //} 
     //else {
         memset(&_data[OPC_PACKET_HEADERLEN], 0x00, _channels);
-        _changed = true;
+        MarkAllPacketsDirty();
     //}
 }
 #pragma endregion
@@ -73,7 +73,7 @@ void OpenDMXOutput::SetOneChannel(int32_t channel, unsigned char data) {
     }
 }
 
-void OpenDMXOutput::SetManyChannels(int32_t channel, unsigned char data[], size_t size) {
+void OpenDMXOutput::SetManyChannels(int32_t channel, const unsigned char data[], size_t size) {
 
     if (!_enabled) return;
     size_t chs = std::min(size, (size_t)(GetMaxChannels() - channel));
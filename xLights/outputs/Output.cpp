@@ -35,6 +35,9 @@
 
 #include <log4cpp/Category.hh>
 
+#include <algorithm>
+#include <cstring>
+
 #pragma region Private Functions
 void Output::Save(wxXmlNode* node) {
 
@@ -58,6 +61,7 @@ Output::Output(Output* output) {
     _channels = output->GetChannels();
     _startChannel = output->GetStartChannel();
     _suppressDuplicateFrames = output->IsSuppressDuplicateFrames();
+    _keepAliveFrames = output->GetKeepAliveFrames();
     _description_CONVERT = output->GetDescription_CONVERT();
     _autoSize_CONVERT = output->IsAutoSize_CONVERT();
     _fppProxy = output->GetFPPProxyIP();
@@ -214,6 +218,8 @@ bool Output::Open() {
     _changed = false;
     _skippedFrames = 9999;
     _lastOutputTime = 0;
+    // everything goes out on the first frame
+    SetPacketChannels(GetChannelsPerPacket());
 
     // We only proxy IP outputs
     if (IsIpOutput()) {
@@ -245,7 +251,7 @@ void Output::Close() {
 
 #pragma region Data Setting
 // channel here is 0 based
-void Output::SetManyChannels(int32_t channel, unsigned char* data, size_t size) {
+void Output::SetManyChannels(int32_t channel, const unsigned char* data, size_t size) {
 
     if (!_enabled) return;
 
@@ -261,6 +267,85 @@ void Output::SetManyChannels(int32_t channel, unsigned char* data, size_t size)
 }
 #pragma endregion 
 
+#pragma region Change Tracking
+// sizes the dirty packet tracking ... 0 means the whole output goes in one packet
+void Output::SetPacketChannels(int32_t channelsPerPacket) {
+
+    _packetChannels = channelsPerPacket > 0 ? channelsPerPacket : (std::max)(_channels, (int32_t)1);
+    size_t packets = (std::max)((int32_t)1, (_channels + _packetChannels - 1) / _packetChannels);
+    _dirtyPackets.assign(packets, 1);
+    _packetSkippedFrames.assign(packets, 9999);
+}
+
+// channel here is 0 based and dest points at where that channel is stored
+bool Output::UpdateChannels(uint8_t* dest, int32_t channel, const uint8_t* data, size_t size) {
+
+    if (_dirtyPackets.empty()) SetPacketChannels(0);
+
+    // compare packet by packet so only the packets which actually changed are marked
+    bool changed = false;
+    size_t done = 0;
+    while (done < size) {
+        int32_t ch = channel + (int32_t)done;
+        size_t packet = ch / _packetChannels;
+        size_t span = (std::min)(size - done, (size_t)(_packetChannels - ch % _packetChannels));
+        if (memcmp(dest + done, data + done, span) != 0) {
+            memcpy(dest + done, data + done, span);
+            if (packet < _dirtyPackets.size()) _dirtyPackets[packet] = 1;
+            changed = true;
+        }
+        done += span;
+    }
+    if (changed) _changed = true;
+    return changed;
+}
+
+bool Output::UpdateChannel(uint8_t* dest, int32_t channel, uint8_t data) {
+
+    if (*dest == data) return false;
+
+    if (_dirtyPackets.empty()) SetPacketChannels(0);
+    *dest = data;
+    size_t packet = channel / _packetChannels;
+    if (packet < _dirtyPackets.size()) _dirtyPackets[packet] = 1;
+    _changed = true;
+    return true;
+}
+
+void Output::MarkAllPacketsDirty() {
+
+    std::fill(begin(_dirtyPackets), end(_dirtyPackets), 1);
+    _changed = true;
+}
+
+bool Output::IsPacketDue(size_t packet, int suppressFrames) const {
+
+    if (!IsSuppressDuplicateFrames() || packet >= _dirtyPackets.size()) return true;
+    if (_dirtyPackets[packet]) return true;
+
+    // unchanged packets are still sent every so often so controllers which time out keep their data
+    int keepAlive = _keepAliveFrames > 0 ? _keepAliveFrames : suppressFrames;
+    return _packetSkippedFrames[packet] >= keepAlive;
+}
+
+void Output::PacketSent(size_t packet) {
+
+    if (packet < _dirtyPackets.size()) {
+        _dirtyPackets[packet] = 0;
+        _packetSkippedFrames[packet] = 0;
+    }
+    OutputManager::RegisterFramePacket(true);
+}
+
+void Output::PacketSuppressed(size_t packet) {
+
+    if (packet < _packetSkippedFrames.size()) {
+        _packetSkippedFrames[packet]++;
+    }
+    OutputManager::RegisterFramePacket(false);
+}
+#pragma endregion
+
 #pragma region Frame Handling
 void Output::FrameOutput() {
     _lastOutputTime = wxGetUTCTimeMillis();
@@ -11,6 +11,8 @@
  **************************************************************/
 
 #include <list>
+#include <vector>
+#include <cstdint>
 
 #include <wx/window.h>
 #include <wx/time.h>
@@ -70,6 +72,10 @@ protected:
     wxLongLong _lastOutputTime = 0;
     int _skippedFrames = 9999;
     bool _changed = false; // set to true when something in the packed has changed
+    int _keepAliveFrames = 0; // most frames an unchanged packet can be suppressed for ... 0 uses the global setting
+    int32_t _packetChannels = 0; // channels carried by each packet the output sends
+    std::vector<uint8_t> _dirtyPackets; // one entry per packet ... set when its data changes
+    std::vector<int> _packetSkippedFrames; // frames since each packet was last sent
     std::string _fppProxy;
     std::string _globalFPPProxy;
     Output *_fppProxyOutput = nullptr;
@@ -82,6 +88,20 @@ protected:
     virtual void Save(wxXmlNode* node);
 #pragma endregion
 
+#pragma region Change Tracking
+    // Outputs copy channel data in through these so the packets whose data changed are
+    // tracked in one place. EndFrame then only needs to send the packets IsPacketDue
+    // returns true for and report each one as sent or suppressed.
+    void SetPacketChannels(int32_t channelsPerPacket);
+    bool UpdateChannels(uint8_t* dest, int32_t channel, const uint8_t* data, size_t size);
+    bool UpdateChannel(uint8_t* dest, int32_t channel, uint8_t data);
+    void MarkAllPacketsDirty();
+    size_t GetPacketCount() const { return _dirtyPackets.size(); }
+    bool IsPacketDue(size_t packet, int suppressFrames) const;
+    void PacketSent(size_t packet);
+    void PacketSuppressed(size_t packet);
+#pragma endregion
+
 public:
 
     enum class PINGSTATE
@@ -166,6 +186,8 @@ public:
     virtual bool IsSerialOutput() const = 0;
     virtual bool IsOutputable() const { return true; }
 
+    virtual int32_t GetChannelsPerPacket() const { return _channels; }
+
     virtual size_t TxNonEmptyCount() const { return 0; }
     virtual bool TxEmpty() const { return true; }
 
@@ -175,6 +197,8 @@ public:
 
     void SetSuppressDuplicateFrames(const bool suppressDuplicateFrames) { _suppressDuplicateFrames = suppressDuplicateFrames; _dirty = true; }
     bool IsSuppressDuplicateFrames() const { return _suppressDuplicateFrames; }
+    void SetKeepAliveFrames(int keepAliveFrames) { _keepAliveFrames = keepAliveFrames; }
+    int GetKeepAliveFrames() const { return _keepAliveFrames; }
 
     virtual void SetTransientData(int32_t& startChannel, int nullnumber);
 
@@ -203,7 +227,7 @@ public:
 
     #pragma region Data Setting
     virtual void SetOneChannel(int32_t channel, unsigned char data) = 0;
-    virtual void SetManyChannels(int32_t channel, unsigned char* data, size_t size);
+    virtual void SetManyChannels(int32_t channel, const unsigned char* data, size_t size);
     virtual void AllOff() = 0;
     #pragma endregion 
 
@@ -37,6 +37,10 @@ int OutputManager::_lastSecond = -10;
 int OutputManager::_currentSecond = -10;
 int OutputManager::_lastSecondCount = 0;
 int OutputManager::_currentSecondCount = 0;
+std::atomic<int> OutputManager::_frameSentPackets(0);
+std::atomic<int> OutputManager::_frameSuppressedPackets(0);
+int OutputManager::_lastFrameSentPackets = 0;
+int OutputManager::_lastFrameSuppressedPackets = 0;
 bool OutputManager::__isSync = false;
 bool OutputManager::_isRetryOpen = false;
 bool OutputManager::_isInteractive = true;
@@ -397,6 +401,16 @@ bool OutputManager::ConvertModelStartChannels(wxXmlNode* modelsNode) const {
 #pragma endregion
 
 #pragma region Static Functions
+void OutputManager::RegisterFramePacket(bool sent) {
+
+    if (sent) {
+        _frameSentPackets++;
+    }
+    else {
+        _frameSuppressedPackets++;
+    }
+}
+
 void OutputManager::RegisterSentPacket() {
 
     int second = wxGetLocalTime() % 60;
@@ -1161,6 +1175,9 @@ void OutputManager::EndFrame() {
             ZCPPOutput::SendSync();
         }
     }
+
+    _lastFrameSentPackets = _frameSentPackets.exchange(0);
+    _lastFrameSuppressedPackets = _frameSuppressedPackets.exchange(0);
     _outputCriticalSection.Leave();
 }
 
@@ -1186,7 +1203,7 @@ void OutputManager::SetOneChannel(int32_t channel, unsigned char data) {
 }
 
 // channel here is zero based
-void OutputManager::SetManyChannels(int32_t channel, unsigned char* data, size_t size) {
+void OutputManager::SetManyChannels(int32_t channel, const unsigned char* data, size_t size) {
 
     if (size == 0) return;
 
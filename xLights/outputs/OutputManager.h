@@ -12,6 +12,7 @@
 
 #include <wx/thread.h>
 
+#include <atomic>
 #include <list>
 #include <string>
 #include <map>
@@ -51,6 +52,10 @@ class OutputManager
     static int _currentSecond;
     static int _lastSecondCount;
     static int _currentSecondCount;
+    static std::atomic<int> _frameSentPackets;
+    static std::atomic<int> _frameSuppressedPackets;
+    static int _lastFrameSentPackets;
+    static int _lastFrameSuppressedPackets;
     static bool _isRetryOpen;
     static bool _isInteractive;
     #pragma endregion 
@@ -78,6 +83,7 @@ public:
     #pragma region Static Functions
     static std::string GetNetworksFileName() { return NETWORKSFILE; }
     static void RegisterSentPacket();
+    static void RegisterFramePacket(bool sent); // counts the packets each output sent or suppressed as unchanged this frame
     static bool IsRetryOpen() { return _isRetryOpen; }
     static void SetRetryOpen(bool retryOpen) { _isRetryOpen = retryOpen; }
     static bool IsInteractive() { return _isInteractive; }
@@ -141,6 +147,9 @@ public:
     bool GetParallelTransmission() const { return _parallelTransmission; }
     
     int GetPacketsPerSecond() const;
+    // packets sent and packets suppressed because they had not changed in the last frame output
+    int GetLastFrameSentPackets() const { return _lastFrameSentPackets; }
+    int GetLastFrameSuppressedPackets() const { return _lastFrameSuppressedPackets; }
     
     void UpdateUnmanaged();
     
@@ -194,7 +203,7 @@ public:
 
     #pragma region Data Setting
     void SetOneChannel(int32_t channel, unsigned char data);
-    void SetManyChannels(int32_t channel, unsigned char* data, size_t size);
+    void SetManyChannels(int32_t channel, const unsigned char* data, size_t size);
     void AllOff(bool send = true);
     #pragma endregion 
 
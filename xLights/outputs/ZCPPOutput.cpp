@@ -931,7 +931,7 @@ void ZCPPOutput::SetOneChannel(int32_t channel, unsigned char data) {
     }
 }
 
-void ZCPPOutput::SetManyChannels(int32_t channel, unsigned char* data, size_t size) {
+void ZCPPOutput::SetManyChannels(int32_t channel, const unsigned char* data, size_t size) {
 
     if (!_enabled) return;
 
@@ -270,7 +270,7 @@ void xxxEthernetOutput::SetOneChannel(int32_t channel, unsigned char data) {
     }
 }
 
-void xxxEthernetOutput::SetManyChannels(int32_t channel, unsigned char data[], size_t size) {
+void xxxEthernetOutput::SetManyChannels(int32_t channel, const unsigned char data[], size_t size) {
 
     size_t chs = (std::min)(size, (size_t)(GetMaxChannels() - channel));
     if (memcmp(&_data[channel], data, chs) != 0) {
@@ -81,7 +81,7 @@ public:
 
     #pragma region Data Setting
     virtual void SetOneChannel(int32_t channel, unsigned char data) override;
-    virtual void SetManyChannels(int32_t channel, unsigned char data[], size_t size) override;
+    virtual void SetManyChannels(int32_t channel, const unsigned char data[], size_t size) override;
     virtual void AllOff() override;
     #pragma endregion 
 };
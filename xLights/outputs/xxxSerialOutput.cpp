@@ -160,7 +160,7 @@ void xxxSerialOutput::SetOneChannel(int32_t channel, unsigned char data) {
     }
 }
 
-void xxxSerialOutput::SetManyChannels(int32_t channel, unsigned char data[], size_t size) {
+void xxxSerialOutput::SetManyChannels(int32_t channel, const unsigned char data[], size_t size) {
 
     size_t chs = std::min(size, (size_t)(GetMaxChannels() - channel));
     
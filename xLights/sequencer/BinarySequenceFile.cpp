@@ -0,0 +1,635 @@
+/***************************************************************
+ * This source files comes from the xLights project
+ * https://www.xlights.org
+ * https://github.com/smeighan/xLights
+ * See the github commit history for a record of contributing
+ * developers.
+ * Copyright claimed based on commit dates recorded in Github
+ * License: https://github.com/smeighan/xLights/blob/master/License.txt
+ **************************************************************/
+
+#include <wx/file.h>
+#include <wx/filename.h>
+#include <wx/stopwatch.h>
+
+#include <unordered_map>
+#include <set>
+#include <atomic>
+
+#include "BinarySequenceFile.h"
+#include "SequenceElements.h"
+#include "Element.h"
+#include "EffectLayer.h"
+#include "Effect.h"
+#include "TimeLine.h"
+#include "../UtilFunctions.h"
+#include "../SpecialOptions.h"
+#include "../Parallel.h"
+#include "../../xSchedule/md5.h"
+
+#include <log4cpp/Category.hh>
+
+#define XSQB_MAGIC "XSQB"
+#define XSQB_VERSION 2
+#define XSQB_HASH_SIZE 32
+#define XSQB_NO_STRING 0xFFFFFFFF
+
+#define XSQB_LAYER_EFFECT 0
+#define XSQB_LAYER_SUBMODEL 1
+#define XSQB_LAYER_STRAND 2
+
+#define XSQB_ELEMENT_MODEL 0
+#define XSQB_ELEMENT_TIMING 1
+
+#define XSQB_EFFECT_PROTECTED 0x01
+#define XSQB_EFFECT_SELECTED 0x02
+
+// the fewest bytes each kind of record can take ... used to reject counts a file could not hold
+#define XSQB_MIN_STRING_SIZE 4
+#define XSQB_MIN_ELEMENT_SIZE 21
+#define XSQB_MIN_LAYER_SIZE 21
+#define XSQB_MIN_NODE_SIZE 12
+#define XSQB_EFFECT_SIZE 25
+
+#pragma region Helpers
+
+namespace
+{
+    // all values are written little endian regardless of platform
+    class BinaryWriter
+    {
+    public:
+        std::vector<uint8_t> _data;
+
+        void U8(uint8_t v) { _data.push_back(v); }
+        void U16(uint16_t v) { for (int i = 0; i < 2; i++) _data.push_back((v >> (8 * i)) & 0xFF); }
+        void U32(uint32_t v) { for (int i = 0; i < 4; i++) _data.push_back((v >> (8 * i)) & 0xFF); }
+        void I32(int32_t v) { U32((uint32_t)v); }
+        void U64(uint64_t v) { for (int i = 0; i < 8; i++) _data.push_back((v >> (8 * i)) & 0xFF); }
+        void Bytes(const void* p, size_t len) { _data.insert(_data.end(), (const uint8_t*)p, (const uint8_t*)p + len); }
+        void PatchU64(size_t pos, uint64_t v) { for (int i = 0; i < 8; i++) _data[pos + i] = (v >> (8 * i)) & 0xFF; }
+        size_t Size() const { return _data.size(); }
+    };
+
+    // reads never run past the end ... once a read fails every subsequent read fails
+    class BinaryReader
+    {
+        const uint8_t* _data;
+        size_t _size;
+        size_t _pos = 0;
+        bool _ok = true;
+
+        bool Need(size_t n) { if (!_ok || _pos + n > _size) _ok = false; return _ok; }
+
+    public:
+        BinaryReader(const uint8_t* data, size_t size) : _data(data), _size(size) {}
+
+        bool IsOk() const { return _ok; }
+        void Seek(size_t pos) { if (pos > _size) _ok = false; else _pos = pos; }
+        uint8_t U8() { if (!Need(1)) return 0; return _data[_pos++]; }
+        uint16_t U16() { if (!Need(2)) return 0; uint16_t v = 0; for (int i = 0; i < 2; i++) v |= (uint16_t)_data[_pos++] << (8 * i); return v; }
+        uint32_t U32() { if (!Need(4)) return 0; uint32_t v = 0; for (int i = 0; i < 4; i++) v |= (uint32_t)_data[_pos++] << (8 * i); return v; }
+        int32_t I32() { return (int32_t)U32(); }
+        uint64_t U64() { if (!Need(8)) return 0; uint64_t v = 0; for (int i = 0; i < 8; i++) v |= (uint64_t)_data[_pos++] << (8 * i); return v; }
+        std::string Str(size_t len) { if (!Need(len)) return ""; std::string s((const char*)_data + _pos, len); _pos += len; return s; }
+        // fails the reader if count records of at least recordSize bytes can't fit in what is left
+        bool Fits(uint64_t count, size_t recordSize) { if (!_ok || count > (_size - _pos) / recordSize) _ok = false; return _ok; }
+    };
+
+    class StringTable
+    {
+        std::unordered_map<std::string, uint32_t> _index;
+
+    public:
+        std::vector<const std::string*> _strings;
+
+        uint32_t Add(const std::string& s)
+        {
+            auto it = _index.find(s);
+            if (it != _index.end()) return it->second;
+            uint32_t res = (uint32_t)_strings.size();
+            auto ins = _index.emplace(s, res);
+            _strings.push_back(&ins.first->first);
+            return res;
+        }
+        uint32_t AddOptional(const std::string& s) { return s == "" ? XSQB_NO_STRING : Add(s); }
+    };
+
+    // size and modification time (in ms) are checked first as they are cheap
+    void GetFingerprint(const std::string& xsqPath, uint64_t& size, int64_t& modified)
+    {
+        wxFileName fn(xsqPath);
+        size = fn.GetSize().GetValue();
+        modified = fn.GetModificationTime().GetValue().GetValue();
+    }
+
+    // the contents hash catches an xsq replaced by one of the same size within the time resolution
+    // of the file system ... eg copied back from a backup or restored by a sync tool
+    std::string GetContentHash(const std::string& xsqPath)
+    {
+        wxFile f;
+        if (!f.Open(xsqPath)) return "";
+        MD5 md5;
+        std::vector<char> buffer(1024 * 1024);
+        ssize_t read;
+        while ((read = f.Read(buffer.data(), buffer.size())) > 0) {
+            md5.update(buffer.data(), (MD5::size_type)read);
+        }
+        if (read < 0) return "";
+        return md5.finalize().hexdigest();
+    }
+
+    void WriteEffects(BinaryWriter& w, StringTable& strings, EffectLayer* layer, bool timing)
+    {
+        w.U32(layer->GetEffectCount());
+        for (int k = 0; k < layer->GetEffectCount(); ++k) {
+            Effect* effect = layer->GetEffect(k);
+            w.U32(strings.Add(effect->GetEffectName()));
+            if (timing) {
+                w.U32(XSQB_NO_STRING);
+                w.U32(XSQB_NO_STRING);
+            }
+            else {
+                w.U32(strings.Add(effect->GetSettingsAsString()));
+                w.U32(strings.AddOptional(effect->GetPaletteAsString()));
+            }
+            w.I32(effect->GetID());
+            w.I32(effect->GetStartTimeMS());
+            w.I32(effect->GetEndTimeMS());
+            w.U8((effect->GetProtected() ? XSQB_EFFECT_PROTECTED : 0) | (effect->GetSelected() ? XSQB_EFFECT_SELECTED : 0));
+        }
+    }
+
+    void WriteLayerHeader(BinaryWriter& w, uint8_t kind, int index, int layer, uint32_t name)
+    {
+        w.U8(kind);
+        w.I32(index);
+        w.I32(layer);
+        w.U32(name);
+    }
+
+    // Layers are written following exactly the rules xLightsXmlFile::Save uses for the xml
+    // so loading either file produces the same sequence
+    uint32_t WriteModelElement(BinaryWriter& w, StringTable& strings, ModelElement* me)
+    {
+        uint32_t layers = 0;
+        for (int j = 0; j < (int)me->GetEffectLayerCount(); ++j) {
+            WriteLayerHeader(w, XSQB_LAYER_EFFECT, 0, j, XSQB_NO_STRING);
+            WriteEffects(w, strings, me->GetEffectLayer(j), false);
+            w.U32(0);
+            layers++;
+        }
+
+        for (int s = 0; s < me->GetSubModelAndStrandCount(); s++) {
+            SubModelElement* se = me->GetSubModel(s);
+            StrandElement* strEl = dynamic_cast<StrandElement*>(se);
+            bool strandWritten = false;
+
+            // node layers hang off the first layer of a strand
+            std::vector<int> nodes;
+            if (strEl != nullptr) {
+                for (int n = 0; n < strEl->GetNodeLayerCount(); n++) {
+                    if (strEl->GetNodeLayer(n)->GetEffectCount() != 0) nodes.push_back(n);
+                }
+            }
+
+            for (int j = 0; j < (int)se->GetEffectLayerCount(); ++j) {
+                EffectLayer* layer = se->GetEffectLayer(j);
+                if (layer->GetEffectCount() == 0) continue;
+
+                if (strEl == nullptr) {
+                    WriteLayerHeader(w, XSQB_LAYER_SUBMODEL, 0, j, strings.Add(se->GetName()));
+                }
+                else {
+                    WriteLayerHeader(w, XSQB_LAYER_STRAND, strEl->GetStrand(), j, strings.AddOptional(se->GetName()));
+                }
+                WriteEffects(w, strings, layer, false);
+                layers++;
+
+                if (strEl != nullptr && j == 0) {
+                    strandWritten = true;
+                    w.U32(nodes.size());
+                    for (const auto& n : nodes) {
+                        NodeLayer* nlayer = strEl->GetNodeLayer(n);
+                        w.I32(n);
+                        w.U32(strings.AddOptional(nlayer->GetName()));
+                        WriteEffects(w, strings, nlayer, false);
+                    }
+                }
+                else {
+                    w.U32(0);
+                }
+            }
+
+            if (strEl != nullptr && !strandWritten && nodes.size() > 0) {
+                WriteLayerHeader(w, XSQB_LAYER_STRAND, strEl->GetStrand(), 0, strings.AddOptional(se->GetName()));
+                w.U32(0);
+                w.U32(nodes.size());
+                for (const auto& n : nodes) {
+                    NodeLayer* nlayer = strEl->GetNodeLayer(n);
+                    w.I32(n);
+                    w.U32(strings.AddOptional(nlayer->GetName()));
+                    WriteEffects(w, strings, nlayer, false);
+                }
+                layers++;
+            }
+        }
+        return layers;
+    }
+
+}
+
+#pragma endregion
+
+bool BinarySequenceFile::IsEnabled()
+{
+    return SpecialOptions::GetOption("BinarySequenceCache", "false") == "true";
+}
+
+std::string BinarySequenceFile::GetSidecarPath(const std::string& xsqPath)
+{
+    return xsqPath + "b";
+}
+
+bool BinarySequenceFile::Write(const std::string& xsqPath, SequenceElements& elements)
+{
+    static log4cpp::Category& logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    wxStopWatch sw;
+    StringTable strings;
+    BinaryWriter blocks;
+
+    struct ElementEntry
+    {
+        uint32_t name;
+        uint8_t type;
+        int32_t fixed;
+        uint64_t offset;
+        uint32_t size;
+    };
+    std::vector<ElementEntry> entries;
+
+    for (size_t i = 0; i < elements.GetElementCount(); ++i) {
+        Element* element = elements.GetElement(i);
+        ElementEntry entry;
+        entry.name = strings.Add(element->GetName());
+        entry.type = element->GetType() == ElementType::ELEMENT_TYPE_TIMING ? XSQB_ELEMENT_TIMING : XSQB_ELEMENT_MODEL;
+        entry.fixed = 0;
+        entry.offset = blocks.Size();
+
+        // reserve space for the layer count
+        size_t countPos = blocks.Size();
+        blocks.U32(0);
+        uint32_t layers = 0;
+
+        if (element->GetType() == ElementType::ELEMENT_TYPE_TIMING) {
+            TimingElement* tm = dynamic_cast<TimingElement*>(element);
+            entry.fixed = tm->GetFixedTiming();
+            if (entry.fixed == 0) {
+                for (int j = 0; j < (int)tm->GetEffectLayerCount(); ++j) {
+                    WriteLayerHeader(blocks, XSQB_LAYER_EFFECT, 0, j, XSQB_NO_STRING);
+                    WriteEffects(blocks, strings, tm->GetEffectLayer(j), true);
+                    blocks.U32(0);
+                    layers++;
+                }
+            }
+        }
+        else if (element->GetType() == ElementType::ELEMENT_TYPE_MODEL) {
+            layers = WriteModelElement(blocks, strings, dynamic_cast<ModelElement*>(element));
+        }
+        for (int b = 0; b < 4; b++) blocks._data[countPos + b] = (layers >> (8 * b)) & 0xFF;
+
+        entry.size = blocks.Size() - entry.offset;
+        entries.push_back(entry);
+    }
+
+    uint64_t xsqSize;
+    int64_t xsqModified;
+    GetFingerprint(xsqPath, xsqSize, xsqModified);
+    std::string xsqHash = GetContentHash(xsqPath);
+    if (xsqHash.size() != XSQB_HASH_SIZE) {
+        logger_base.warn("Unable to hash %s so binary sequence file not written.", (const char*)xsqPath.c_str());
+        return false;
+    }
+
+    BinaryWriter w;
+    w.Bytes(XSQB_MAGIC, 4);
+    w.U16(XSQB_VERSION);
+    w.U16(0);
+    w.U64(xsqSize);
+    w.U64((uint64_t)xsqModified);
+    w.Bytes(xsqHash.c_str(), XSQB_HASH_SIZE);
+    w.U32(strings._strings.size());
+    w.U32(entries.size());
+    size_t stringTablePos = w.Size();
+    w.U64(0);
+    size_t elementTablePos = w.Size();
+    w.U64(0);
+
+    w.PatchU64(stringTablePos, w.Size());
+    for (const auto& it : strings._strings) {
+        w.U32(it->size());
+        w.Bytes(it->c_str(), it->size());
+    }
+
+    w.PatchU64(elementTablePos, w.Size());
+    size_t blockBase = w.Size() + entries.size() * (4 + 1 + 4 + 8 + 4);
+    for (const auto& it : entries) {
+        w.U32(it.name);
+        w.U8(it.type);
+        w.I32(it.fixed);
+        w.U64(blockBase + it.offset);
+        w.U32(it.size);
+    }
+    w.Bytes(blocks._data.data(), blocks.Size());
+
+    std::string sidecar = GetSidecarPath(xsqPath);
+    wxFile f;
+    if (!f.Create(sidecar, true) || f.Write(w._data.data(), w.Size()) != w.Size()) {
+        logger_base.warn("Unable to write binary sequence file %s.", (const char*)sidecar.c_str());
+        f.Close();
+        wxRemoveFile(sidecar);
+        return false;
+    }
+    f.Close();
+
+    logger_base.debug("Binary sequence file %s written: %d elements, %d unique strings, %d bytes in %ldms.",
+        (const char*)sidecar.c_str(), (int)entries.size(), (int)strings._strings.size(), (int)w.Size(), sw.Time());
+    return true;
+}
+
+bool BinarySequenceFile::Open(const std::string& xsqPath, const std::string& showDir)
+{
+    static log4cpp::Category& logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    _strings.clear();
+    _elements.clear();
+
+    std::string sidecar = GetSidecarPath(xsqPath);
+    if (!wxFileExists(sidecar)) return false;
+
+    wxStopWatch sw;
+    wxFile f;
+    if (!f.Open(sidecar)) return false;
+    std::vector<uint8_t> data(f.Length());
+    if (f.Read(data.data(), data.size()) != (ssize_t)data.size()) {
+        logger_base.warn("Binary sequence file %s could not be read.", (const char*)sidecar.c_str());
+        return false;
+    }
+    f.Close();
+
+    BinaryReader r(data.data(), data.size());
+    if (r.Str(4) != XSQB_MAGIC || r.U16() != XSQB_VERSION) {
+        logger_base.warn("Binary sequence file %s is not a version we understand ... ignored.", (const char*)sidecar.c_str());
+        return false;
+    }
+    r.U16();
+
+    uint64_t xsqSize;
+    int64_t xsqModified;
+    GetFingerprint(xsqPath, xsqSize, xsqModified);
+    if (r.U64() != xsqSize || (int64_t)r.U64() != xsqModified || r.Str(XSQB_HASH_SIZE) != GetContentHash(xsqPath)) {
+        logger_base.debug("Binary sequence file %s is stale ... loading xsq.", (const char*)sidecar.c_str());
+        return false;
+    }
+
+    uint32_t stringCount = r.U32();
+    uint32_t elementCount = r.U32();
+    uint64_t stringTable = r.U64();
+    uint64_t elementTable = r.U64();
+
+    r.Seek(stringTable);
+    if (!r.Fits(stringCount, XSQB_MIN_STRING_SIZE)) {
+        logger_base.warn("Binary sequence file %s is corrupt ... loading xsq.", (const char*)sidecar.c_str());
+        return false;
+    }
+    _strings.reserve(stringCount);
+    for (uint32_t i = 0; i < stringCount && r.IsOk(); i++) {
+        uint32_t len = r.U32();
+        _strings.push_back(r.Str(len));
+    }
+
+    std::set<uint32_t> settingsStrings;
+    auto readEffects = [&r, &settingsStrings](std::vector<BinaryEffect>& effects) {
+        uint32_t count = r.U32();
+        if (!r.Fits(count, XSQB_EFFECT_SIZE)) return;
+        effects.resize(count);
+        for (auto& e : effects) {
+            e.name = r.U32();
+            e.settings = r.U32();
+            e.palette = r.U32();
+            e.id = r.I32();
+            e.startMS = r.I32();
+            e.endMS = r.I32();
+            e.flags = r.U8();
+            if (!r.IsOk()) return;
+            if (e.settings != XSQB_NO_STRING) settingsStrings.insert(e.settings);
+        }
+    };
+
+    r.Seek(elementTable);
+    if (!r.Fits(elementCount, XSQB_MIN_ELEMENT_SIZE)) {
+        logger_base.warn("Binary sequence file %s is corrupt ... loading xsq.", (const char*)sidecar.c_str());
+        _strings.clear();
+        return false;
+    }
+    _elements.resize(elementCount);
+    std::vector<std::pair<uint64_t, uint32_t>> blocks(elementCount);
+    for (uint32_t i = 0; i < elementCount && r.IsOk(); i++) {
+        _elements[i].name = r.U32();
+        _elements[i].type = r.U8();
+        _elements[i].fixed = r.I32();
+        blocks[i].first = r.U64();
+        blocks[i].second = r.U32();
+    }
+
+    for (uint32_t i = 0; i < elementCount && r.IsOk(); i++) {
+        r.Seek(blocks[i].first);
+        uint32_t layers = r.U32();
+        if (!r.Fits(layers, XSQB_MIN_LAYER_SIZE)) break;
+        _elements[i].layers.resize(layers);
+        for (auto& l : _elements[i].layers) {
+            l.kind = r.U8();
+            l.index = r.I32();
+            l.layer = r.I32();
+            l.name = r.U32();
+            readEffects(l.effects);
+            uint32_t nodes = r.U32();
+            if (!r.Fits(nodes, XSQB_MIN_NODE_SIZE)) break;
+            l.nodes.resize(nodes);
+            for (auto& n : l.nodes) {
+                n.index = r.I32();
+                n.name = r.U32();
+                readEffects(n.effects);
+            }
+        }
+    }
+
+    // every string reference must be in range before we hand anything to the sequence
+    auto valid = [stringCount](uint32_t s) { return s == XSQB_NO_STRING || s < stringCount; };
+    bool ok = r.IsOk() && _strings.size() == stringCount;
+    for (const auto& e : _elements) {
+        if (!ok) break;
+        ok = e.name < stringCount;
+        for (const auto& l : e.layers) {
+            ok = ok && valid(l.name);
+            for (const auto& ef : l.effects) ok = ok && valid(ef.name) && valid(ef.settings) && valid(ef.palette);
+            for (const auto& n : l.nodes) {
+                ok = ok && valid(n.name);
+                for (const auto& ef : n.effects) ok = ok && valid(ef.name) && valid(ef.settings) && valid(ef.palette);
+            }
+        }
+    }
+    if (!ok) {
+        logger_base.warn("Binary sequence file %s is corrupt ... loading xsq.", (const char*)sidecar.c_str());
+        _strings.clear();
+        _elements.clear();
+        return false;
+    }
+
+    // apply the same file location fixes the xml load applies to the effect db and then to each effect
+    // because the strings are interned this is done once per unique settings string
+    for (const auto& it : settingsStrings) {
+        std::string& settings = _strings[it];
+        if (settings.find("E_FILEPICKER_Pictures_Filename") != std::string::npos) {
+            settings = FixEffectFileParameter("E_FILEPICKER_Pictures_Filename", settings, showDir).ToStdString();
+        }
+        else if (settings.find("E_TEXTCTRL_Glediator_Filename") != std::string::npos) {
+            settings = FixEffectFileParameter("E_TEXTCTRL_Glediator_Filename", settings, showDir).ToStdString();
+        }
+
+        if (settings.find("E_FILEPICKER_Pictures_Filename") != std::string::npos) {
+            settings = FixEffectFileParameter("E_FILEPICKER_Pictures_Filename", settings, "").ToStdString();
+        }
+        else if (settings.find("E_FILEPICKER_Glediator_Filename") != std::string::npos) {
+            settings = FixEffectFileParameter("E_FILEPICKER_Glediator_Filename", settings, "").ToStdString();
+        }
+    }
+
+    logger_base.debug("Binary sequence file %s opened: %d elements, %d unique strings in %ldms.",
+        (const char*)sidecar.c_str(), (int)_elements.size(), (int)_strings.size(), sw.Time());
+    return true;
+}
+
+const std::string& BinarySequenceFile::GetString(uint32_t index) const
+{
+    static const std::string empty;
+    if (index == XSQB_NO_STRING) return empty;
+    return _strings[index];
+}
+
+int BinarySequenceFile::LoadLayerEffects(EffectLayer* layer, bool timing, const std::vector<BinaryEffect>& effects, double frequency) const
+{
+    for (const auto& e : effects) {
+        int startTime = TimeLine::RoundToMultipleOfPeriod(e.startMS, frequency);
+        int endTime = TimeLine::RoundToMultipleOfPeriod(e.endMS, frequency);
+        bool prot = (e.flags & XSQB_EFFECT_PROTECTED) != 0;
+        if (timing) {
+            layer->AddEffect(0, GetString(e.name), "", "", startTime, endTime, EFFECT_NOT_SELECTED, prot);
+        }
+        else {
+            layer->AddEffect(e.id, GetString(e.name), GetString(e.settings), GetString(e.palette), startTime, endTime, EFFECT_NOT_SELECTED, prot);
+        }
+    }
+    return effects.size();
+}
+
+int BinarySequenceFile::LoadEffects(SequenceElements& elements, int sequenceDurationMS) const
+{
+    static log4cpp::Category& logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    double frequency = elements.GetFrequency();
+
+    // layers are created here and the effects are then added with one job per element ... see SequenceElements::LoadSequencerFile
+    struct ElementLoadJob
+    {
+        bool timing = false;
+        std::vector<std::pair<EffectLayer*, const std::vector<BinaryEffect>*>> layers;
+    };
+    std::vector<ElementLoadJob> jobs;
+
+    for (const auto& be : _elements) {
+        Element* element = elements.GetElement(GetString(be.name));
+        if (element == nullptr) {
+            wxASSERT(false);
+            continue;
+        }
+        bool timing = be.type == XSQB_ELEMENT_TIMING;
+
+        if (timing && be.fixed > 0) {
+            int interval = be.fixed;
+            if (interval != TimeLine::RoundToMultipleOfPeriod(interval, frequency)) {
+                int newinterval = TimeLine::RoundToMultipleOfPeriod(interval, frequency);
+                if (newinterval == 0) newinterval = 1000 / frequency;
+                logger_base.warn("Timing interval of %dms not a multiple of frame time so changed to %dms.", interval, newinterval);
+                interval = newinterval;
+            }
+            dynamic_cast<TimingElement*>(element)->SetFixedTiming(interval);
+            EffectLayer* effectLayer = element->AddEffectLayer();
+            int time = 0;
+            int end_time = TimeLine::RoundToMultipleOfPeriod(sequenceDurationMS, frequency);
+            while (time < end_time) {
+                effectLayer->AddEffect(0, "", "", "", time, time + interval, EFFECT_NOT_SELECTED, false, true); // we can suppress sort because we know we are adding them in time order
+                time += interval;
+            }
+            effectLayer->NumberEffects();
+            continue;
+        }
+
+        ElementLoadJob job;
+        job.timing = timing;
+        ModelElement* me = dynamic_cast<ModelElement*>(element);
+        for (const auto& bl : be.layers) {
+            EffectLayer* effectLayer = nullptr;
+            StrandElement* strand = nullptr;
+            if (bl.kind == XSQB_LAYER_EFFECT) {
+                effectLayer = element->AddEffectLayer();
+            }
+            else if (me == nullptr) {
+                logger_base.error("Element %s was not a model element. This typically happens when a timing track is created with the same name as a model.", (const char*)element->GetName().c_str());
+            }
+            else if (bl.kind == XSQB_LAYER_SUBMODEL) {
+                SubModelElement* se = me->GetSubModel(GetString(bl.name), true);
+                while (bl.layer >= (int)se->GetEffectLayerCount()) {
+                    se->AddEffectLayer();
+                }
+                effectLayer = se->GetEffectLayer(bl.layer);
+            }
+            else if (bl.kind == XSQB_LAYER_STRAND) {
+                strand = me->GetStrand(bl.index, true);
+                while (bl.layer >= (int)strand->GetEffectLayerCount()) {
+                    strand->AddEffectLayer();
+                }
+                effectLayer = strand->GetEffectLayer(bl.layer);
+                if (bl.name != XSQB_NO_STRING) {
+                    strand->SetName(GetString(bl.name));
+                }
+            }
+
+            if (effectLayer == nullptr) continue;
+
+            job.layers.push_back({ effectLayer, &bl.effects });
+            if (strand != nullptr) {
+                for (const auto& bn : bl.nodes) {
+                    NodeLayer* nodeLayer = strand->GetNodeLayer(bn.index, true);
+                    if (bn.name != XSQB_NO_STRING) {
+                        nodeLayer->SetName(GetString(bn.name));
+                    }
+                    job.layers.push_back({ nodeLayer, &bn.effects });
+                }
+            }
+        }
+        jobs.push_back(job);
+    }
+
+    std::atomic_int loaded(0);
+    parallel_for(0, jobs.size(), [this, &jobs, &loaded, frequency](int i) {
+        int count = 0;
+        for (const auto& it : jobs[i].layers) {
+            count += LoadLayerEffects(it.first, jobs[i].timing, *it.second, frequency);
+        }
+        loaded += count;
+    });
+
+    return loaded;
+}
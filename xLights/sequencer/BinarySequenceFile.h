@@ -0,0 +1,93 @@
+#pragma once
+
+/***************************************************************
+ * This source files comes from the xLights project
+ * https://www.xlights.org
+ * https://github.com/smeighan/xLights
+ * See the github commit history for a record of contributing
+ * developers.
+ * Copyright claimed based on commit dates recorded in Github
+ * License: https://github.com/smeighan/xLights/blob/master/License.txt
+ **************************************************************/
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+class SequenceElements;
+class EffectLayer;
+
+// A binary sidecar (.xsqb) written next to an .xsq when it is saved. It holds the same
+// content as the ColorPalettes, EffectDB and ElementEffects sections of the xsq but with
+// all settings, palette and name strings interned into one string table and each element
+// stored as a self contained block located through an offset table.
+//
+// The xsq remains the interchange format. The sidecar is only used on open when it was
+// written for exactly the xsq being opened (same size, modification time and contents hash)
+// otherwise it is ignored and the xml is loaded as normal.
+//
+// Enabled using the special option BinarySequenceCache=true
+class BinarySequenceFile
+{
+public:
+
+    static bool IsEnabled();
+    static std::string GetSidecarPath(const std::string& xsqPath);
+
+    // writes the sidecar for an xsq which has just been saved
+    static bool Write(const std::string& xsqPath, SequenceElements& elements);
+
+    // loads and validates the sidecar for this xsq ... returns false if it is missing or stale
+    bool Open(const std::string& xsqPath, const std::string& showDir);
+
+    // creates the layers and effects for every element in the sidecar
+    // returns the number of effects loaded
+    int LoadEffects(SequenceElements& elements, int sequenceDurationMS) const;
+
+    size_t GetElementCount() const { return _elements.size(); }
+    size_t GetStringCount() const { return _strings.size(); }
+
+private:
+
+    struct BinaryEffect
+    {
+        uint32_t name = 0;
+        uint32_t settings = 0;
+        uint32_t palette = 0;
+        int32_t id = 0;
+        int32_t startMS = 0;
+        int32_t endMS = 0;
+        uint8_t flags = 0;
+    };
+
+    struct BinaryNodeLayer
+    {
+        int32_t index = 0;
+        uint32_t name = 0;
+        std::vector<BinaryEffect> effects;
+    };
+
+    struct BinaryLayer
+    {
+        uint8_t kind = 0;
+        int32_t index = 0;
+        int32_t layer = 0;
+        uint32_t name = 0;
+        std::vector<BinaryEffect> effects;
+        std::vector<BinaryNodeLayer> nodes;
+    };
+
+    struct BinaryElement
+    {
+        uint32_t name = 0;
+        uint8_t type = 0;
+        int32_t fixed = 0;
+        std::vector<BinaryLayer> layers;
+    };
+
+    std::vector<std::string> _strings;
+    std::vector<BinaryElement> _elements;
+
+    const std::string& GetString(uint32_t index) const;
+    int LoadLayerEffects(EffectLayer* layer, bool timing, const std::vector<BinaryEffect>& effects, double frequency) const;
+};
@@ -18,12 +18,17 @@
 #include "../ValueCurve.h"
 #include "../UtilClasses.h"
 #include "../RenderCache.h"
+#include "../RenderBuffer.h"
 #include "../models/Model.h"
 #include "../xLightsMain.h"
 #include "../xLightsApp.h"
 #include "../effects/RenderableEffect.h"
+#include "../SpecialOptions.h"
 
 #include <unordered_map>
+#include <algorithm>
+#include <memory>
+#include <list>
 
 #include <log4cpp/Category.hh>
 
@@ -134,6 +139,134 @@ void RangeAccumulator::Add(int low, int high)
     _ranges.push_back(std::pair<int, int>(low, high));
 }
 
+// Parsed settings maps keyed by the string they were parsed from. Large sequences repeat the
+// same settings and palettes across thousands of effects so each distinct string is parsed
+// once and the map shared. The pool only holds weak references so a map is freed when the
+// last effect using it lets it go.
+class SharedSettingsPool
+{
+    std::mutex _lock;
+    std::unordered_map<std::string, std::weak_ptr<SettingsMap>> _maps;
+    size_t _purgeAt = 1024;
+
+    void Purge()
+    {
+        for (auto it = _maps.begin(); it != _maps.end(); ) {
+            if (it->second.expired()) {
+                it = _maps.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+        _purgeAt = std::max((size_t)1024, _maps.size() * 2);
+    }
+
+public:
+    std::shared_ptr<SettingsMap> Get(const std::string& str)
+    {
+        {
+            std::unique_lock<std::mutex> lock(_lock);
+            auto it = _maps.find(str);
+            if (it != _maps.end()) {
+                auto res = it->second.lock();
+                if (res != nullptr) return res;
+            }
+        }
+
+        // parse outside the lock as effects are created on many threads while loading
+        auto sm = std::make_shared<SettingsMap>();
+        sm->Parse(str);
+
+        std::unique_lock<std::mutex> lock(_lock);
+        auto& entry = _maps[str];
+        auto existing = entry.lock();
+        if (existing != nullptr) return existing;
+        entry = sm;
+        if (_maps.size() > _purgeAt) Purge();
+        return sm;
+    }
+
+    size_t GetLiveCount()
+    {
+        std::unique_lock<std::mutex> lock(_lock);
+        Purge();
+        return _maps.size();
+    }
+};
+
+static SharedSettingsPool SettingsPool;
+static SharedSettingsPool PalettePool;
+
+// Owns the render checkpoints of every effect. Checkpoints hold copies of the layer buffers so
+// across a large show they are limited to EffectCheckpointMB with the least recently used being
+// dropped first. Effects only hold weak references so a dropped checkpoint just disappears.
+class CheckpointPool
+{
+    struct Entry
+    {
+        const Effect* owner;
+        std::shared_ptr<const EffectCheckpoint> checkpoint;
+        size_t size;
+    };
+
+    std::mutex _lock;
+    std::list<Entry> _entries; // least recently used first
+    std::unordered_map<const EffectCheckpoint*, std::list<Entry>::iterator> _index;
+    size_t _size = 0;
+
+    void Erase(std::list<Entry>::iterator it)
+    {
+        _size -= it->size;
+        _index.erase(it->checkpoint.get());
+        _entries.erase(it);
+    }
+
+public:
+    static size_t GetLimit()
+    {
+        int mb = wxAtoi(SpecialOptions::GetOption("EffectCheckpointMB", "256"));
+        if (mb < 0) mb = 0;
+        return (size_t)mb * 1024 * 1024;
+    }
+
+    void Add(const Effect* owner, const std::shared_ptr<const EffectCheckpoint>& checkpoint)
+    {
+        size_t limit = GetLimit();
+        size_t size = checkpoint->GetSize();
+        std::unique_lock<std::mutex> lock(_lock);
+        _entries.push_back({ owner, checkpoint, size });
+        _index[checkpoint.get()] = std::prev(_entries.end());
+        _size += size;
+        while (_size > limit && !_entries.empty()) {
+            Erase(_entries.begin());
+        }
+    }
+
+    void Touch(const EffectCheckpoint* checkpoint)
+    {
+        std::unique_lock<std::mutex> lock(_lock);
+        auto it = _index.find(checkpoint);
+        if (it != _index.end()) {
+            _entries.splice(_entries.end(), _entries, it->second);
+        }
+    }
+
+    void Remove(const Effect* owner)
+    {
+        std::unique_lock<std::mutex> lock(_lock);
+        for (auto it = _entries.begin(); it != _entries.end(); ) {
+            auto next = std::next(it);
+            if (it->owner == owner) {
+                Erase(it);
+            }
+            it = next;
+        }
+    }
+};
+
+static CheckpointPool Checkpoints;
+
 static std::vector<std::string> CHECKBOX_IDS {
     "C_CHECKBOX_Palette1", "C_CHECKBOX_Palette2", "C_CHECKBOX_Palette3",
     "C_CHECKBOX_Palette4", "C_CHECKBOX_Palette5", "C_CHECKBOX_Palette6",
@@ -180,7 +313,7 @@ Effect::Effect(EffectLayer* parent,int id, const std::string & name, const std::
 
     mColorMask = xlColor::NilColor();
     mEffectIndex = (parent->GetParentElement() == nullptr) ? -1 : parent->GetParentElement()->GetSequenceElements()->GetEffectManager().GetEffectIndex(name);
-    mSettings.Parse(settings);
+    SetSharedSettings(settings);
 
     Element* parentElement = parent->GetParentElement();
     if (parentElement != nullptr)
@@ -193,13 +326,19 @@ Effect::Effect(EffectLayer* parent,int id, const std::string & name, const std::
     //  settings["key"] == "test val"
     // code which as a side effect creates a blank value under the key
     // an example of this is fix to issue #622
-    if (mSettings.Get("T_CHOICE_Out_Transition_Type", "XXX") == "")
-    {
-        mSettings.erase("T_CHOICE_Out_Transition_Type");
-    }
-    if (mSettings.Get("Converted", "XXX") == "")
+    if (mSettings->Get("T_CHOICE_Out_Transition_Type", "XXX") == "" || mSettings->Get("Converted", "XXX") == "")
     {
-        mSettings.erase("Converted");
+        // fixed in a copy which goes back to the pool so every effect loaded with these settings still shares
+        SettingsMap fixed(*mSettings);
+        if (fixed.Get("T_CHOICE_Out_Transition_Type", "XXX") == "")
+        {
+            fixed.erase("T_CHOICE_Out_Transition_Type");
+        }
+        if (fixed.Get("Converted", "XXX") == "")
+        {
+            fixed.erase("Converted");
+        }
+        SetSharedSettings(fixed.AsString());
     }
 
     // check for any other odd looking blank settings
@@ -228,12 +367,15 @@ Effect::Effect(EffectLayer* parent,int id, const std::string & name, const std::
         mName = new std::string(name);
     }
 
-    mPaletteMap.Parse(palette);
-    ParseColorMap(mPaletteMap, mColors, mCC);
+    SetSharedPaletteMap(palette);
+    ParseColorMap(*mPaletteMap, mColors, mCC);
 }
 
 Effect::~Effect()
 {
+    if (!mCheckpoints.empty()) {
+        Checkpoints.Remove(this);
+    }
     if (mCache) {
         mCache->Delete();
         mCache = nullptr;
@@ -246,6 +388,74 @@ Effect::~Effect()
 
 #pragma endregion
 
+#pragma region Shared settings
+
+void Effect::SetSharedSettings(const std::string& settings)
+{
+    mSettings = SettingsPool.Get(settings);
+    mSettingsShared = true;
+}
+
+void Effect::SetSharedPaletteMap(const std::string& palette)
+{
+    mPaletteMap = PalettePool.Get(palette);
+    mPaletteMapShared = true;
+}
+
+SettingsMap& Effect::Settings()
+{
+    std::unique_lock<std::recursive_mutex> lock(settingsLock);
+    // the caller is going to change the settings
+    SettingsChanged();
+    if (mSettingsShared) {
+        mSettings = std::make_shared<SettingsMap>(*mSettings);
+        mSettingsShared = false;
+    }
+    return *mSettings;
+}
+
+SettingsMap& Effect::PaletteMap()
+{
+    std::unique_lock<std::recursive_mutex> lock(settingsLock);
+    SettingsChanged();
+    if (mPaletteMapShared) {
+        mPaletteMap = std::make_shared<SettingsMap>(*mPaletteMap);
+        mPaletteMapShared = false;
+    }
+    return *mPaletteMap;
+}
+
+std::shared_ptr<const SettingsMap> Effect::GetSettingsPtr() const
+{
+    std::unique_lock<std::recursive_mutex> lock(settingsLock);
+    return mSettings;
+}
+
+std::shared_ptr<const SettingsMap> Effect::GetPaletteMapPtr() const
+{
+    std::unique_lock<std::recursive_mutex> lock(settingsLock);
+    return mPaletteMap;
+}
+
+void Effect::ShareSettings()
+{
+    std::unique_lock<std::recursive_mutex> lock(settingsLock);
+    if (!mSettingsShared) {
+        SetSharedSettings(mSettings->AsString());
+    }
+    if (!mPaletteMapShared) {
+        SetSharedPaletteMap(mPaletteMap->AsString());
+    }
+}
+
+void Effect::GetSharedSettingsCounts(size_t& settings, size_t& palettes)
+{
+    settings = SettingsPool.GetLiveCount();
+    palettes = PalettePool.GetLiveCount();
+}
+
+#pragma endregion
+
 void Effect::SetTimeToDelete()
 {
     // we can delete the effect 1 minute later ... this tries to guarantee all dangling pointers are gone at the expense of some memory use
@@ -327,9 +537,9 @@ void Effect::SetEffectName(const std::string & name)
 wxString Effect::GetDescription() const
 {
     std::unique_lock<std::recursive_mutex> lock(settingsLock);
-    if (mSettings.Contains("X_Effect_Description"))
+    if (mSettings->Contains("X_Effect_Description"))
     {
-        return mSettings["X_Effect_Description"];
+        return GetSettings()["X_Effect_Description"];
     }
     return "";
 }
@@ -378,14 +588,14 @@ void Effect::ConvertTo(int effectIndex)
         SetEffectIndex(effectIndex);
         SettingsMap newSettings;
         // remove any E_ settings as the effect type has changed
-        for (const auto& it : mSettings)
+        for (const auto& it : *mSettings)
         {
             if (!StartsWith(it.first, "E_"))
             {
                 newSettings[it.first] = it.second;
             }
         }
-        mSettings = newSettings;
+        Settings() = newSettings;
 
         std::string palette;
         std::string effectText = xLightsApp::GetFrame()->GetEffectTextFromWindows(palette);
@@ -398,7 +608,7 @@ void Effect::ConvertTo(int effectIndex)
                 auto sv = wxSplit(it, '=');
                 if (sv.size()==2)
                 {
-                    mSettings[sv[0]] = sv[1];
+                    Settings()[sv[0]] = sv[1];
                 }
             }
         }
@@ -408,24 +618,24 @@ void Effect::ConvertTo(int effectIndex)
 bool Effect::IsRenderDisabled() const
 {
     std::unique_lock<std::recursive_mutex> lock(settingsLock);
-    return mSettings.Contains("X_Effect_RenderDisabled");
+    return mSettings->Contains("X_Effect_RenderDisabled");
 }
 
 void Effect::SetRenderDisabled(bool disabled)
 {
     std::unique_lock<std::recursive_mutex> getlock(settingsLock);
     if (disabled) {
-        mSettings["X_Effect_RenderDisabled"] = "True";
+        Settings()["X_Effect_RenderDisabled"] = "True";
     }
-    else {
-        mSettings.erase("X_Effect_RenderDisabled");
+    else if (mSettings->Contains("X_Effect_RenderDisabled")) {
+        Settings().erase("X_Effect_RenderDisabled");
     }
 }
 
 bool Effect::IsLocked() const
 {
     std::unique_lock<std::recursive_mutex> lock(settingsLock);
-    return mSettings.Contains("X_Effect_Locked");
+    return mSettings->Contains("X_Effect_Locked");
 }
 
 void Effect::SetLocked(bool lock)
@@ -433,11 +643,11 @@ void Effect::SetLocked(bool lock)
     std::unique_lock<std::recursive_mutex> getlock(settingsLock);
     if (lock)
     {
-        mSettings["X_Effect_Locked"] = "True";
+        Settings()["X_Effect_Locked"] = "True";
     }
-    else
+    else if (mSettings->Contains("X_Effect_Locked"))
     {
-        mSettings.erase("X_Effect_Locked");
+        Settings().erase("X_Effect_Locked");
     }
 }
 
@@ -449,12 +659,13 @@ void Effect::IncrementChangeCount()
         mCache->Delete();
         mCache = nullptr;
     }
+    SettingsChanged();
 }
 
 std::string Effect::GetSettingsAsString() const
 {
     std::unique_lock<std::recursive_mutex> lock(settingsLock);
-    return mSettings.AsString();
+    return mSettings->AsString();
 }
 
 void Effect::SetSettings(const std::string &settings, bool keepxsettings)
@@ -464,7 +675,7 @@ void Effect::SetSettings(const std::string &settings, bool keepxsettings)
     SettingsMap x;
     if (keepxsettings)
     {
-        for (const auto& it : mSettings)
+        for (const auto& it : *mSettings)
         {
             if (it.first.size() > 2 && it.first[0] == 'X' && it.first[1] == '_')
             {
@@ -472,12 +683,12 @@ void Effect::SetSettings(const std::string &settings, bool keepxsettings)
             }
         }
     }
-    mSettings.Parse(settings);
+    SetSharedSettings(settings);
     if (keepxsettings)
     {
         for (const auto& it : x)
         {
-            mSettings[it.first] = it.second;
+            Settings()[it.first] = it.second;
         }
     }
     IncrementChangeCount();
@@ -488,7 +699,7 @@ void Effect::PressButton(RenderableEffect* re, const std::string& id)
     bool changed = false;
     if (StartsWith(id, "E_"))
     {
-        changed = re->PressButton(id, mPaletteMap, mSettings);
+        changed = re->PressButton(id, PaletteMap(), Settings());
     }
     else
     {
@@ -504,49 +715,51 @@ void Effect::ApplySetting(const std::string& id, const std::string& value, Value
     wxString idd(id);
     if (idd.StartsWith("C_"))
     {
+        SettingsMap& paletteMap = PaletteMap();
         if (vc != nullptr && vc->IsActive())
         {
-            mPaletteMap[vcid] = vc->Serialise();
+            paletteMap[vcid] = vc->Serialise();
         }
         else
         {
-            mPaletteMap.erase(vcid);
-            mPaletteMap[id] = value;
+            paletteMap.erase(vcid);
+            paletteMap[id] = value;
         }
     }
     else
     {
+        SettingsMap& settings = Settings();
         if (vc != nullptr && vc->IsActive())
         {
-            mSettings[vcid] = vc->Serialise();
+            settings[vcid] = vc->Serialise();
         }
         else
         {
-            mSettings.erase(vcid);
+            settings.erase(vcid);
 
             wxString wid = id;
 
             if (wid.Contains("FILEPICKER")) {
                 wxString realid = wid.substr(0, wid.Length() - 3);
                 if (wid.EndsWith("_FN")) {
-                    mSettings[realid] = value;
+                    settings[realid] = value;
                 } else if (wid.EndsWith("_PN")) {
-                    if (mSettings.Contains(realid) && mSettings.Get(realid, "") != "") {
-                        wxString origName = mSettings[realid];
+                    if (settings.Contains(realid) && settings.Get(realid, "") != "") {
+                        wxString origName = settings[realid];
                         wxFileName fn(origName, origName[1] == ':' ? wxPATH_WIN : wxPATH_UNIX);
                         fn.SetPath(value);
                         wxString newName = fn.GetFullPath();
-                        mSettings[realid] = newName;
+                        settings[realid] = newName;
                     }
                 }
                 else if (wid.EndsWith("_SF")) {
-                    if (mSettings.Contains(realid) && mSettings.Get(realid, "") != "") {
+                    if (settings.Contains(realid) && settings.Get(realid, "") != "") {
 
                         // This moves through all possible options to locate the file relative to the provided show folder.
                         // This will be the deepest path possible ... so if the file exists in multiple locations it will find the 
                         // deepest valid path
                         // This only updates the path if we find the file ... if not found there will be no errors but it will log the issue
-                        wxString origName = mSettings[realid];
+                        wxString origName = settings[realid];
 
                         wxFileName fn(origName, origName[1] == ':' ? wxPATH_WIN : wxPATH_UNIX);
 
@@ -561,17 +774,17 @@ void Effect::ApplySetting(const std::string& id, const std::string& value, Value
                             pth += file;
                             if (wxFile::Exists(pth))                                 {
                                 // found it
-                                mSettings[realid] = pth;
+                                settings[realid] = pth;
                                 break;
                             }
                         }
-                        if (origName == mSettings[realid] && !wxFile::Exists(origName))                             {
+                        if (origName == settings[realid] && !wxFile::Exists(origName))                             {
                             logger_base.warn("Unable to correct show folder '%s' : '%s' to '%s'", (const char*)realid.c_str(), (const char*)origName.c_str(), (const char*)value.c_str());
                         }
                     }
                 }
             } else {
-                mSettings[id] = value;
+                settings[id] = value;
             }
         }
     }
@@ -582,7 +795,7 @@ void Effect::CopySettingsMap(SettingsMap &target, bool stripPfx) const
 {
     std::unique_lock<std::recursive_mutex> lock(settingsLock);
 
-    for (std::map<std::string,std::string>::const_iterator it=mSettings.begin(); it!=mSettings.end(); ++it)
+    for (std::map<std::string,std::string>::const_iterator it=mSettings->begin(); it!=mSettings->end(); ++it)
     {
         std::string name = it->first;
         if (stripPfx && name[1] == '_')
@@ -591,7 +804,7 @@ void Effect::CopySettingsMap(SettingsMap &target, bool stripPfx) const
         }
         target[name] = it->second;
     }
-    for (std::map<std::string,std::string>::const_iterator it=mPaletteMap.begin(); it!=mPaletteMap.end(); ++it)
+    for (std::map<std::string,std::string>::const_iterator it=mPaletteMap->begin(); it!=mPaletteMap->end(); ++it)
     {
         std::string name = it->first;
         if (stripPfx && name[1] == '_'  && (name[2] == 'S' || name[2] == 'C' || name[2] == 'V')) //only need the slider, checkbox and value curve entries
@@ -607,45 +820,51 @@ void Effect::FixBuffer(const Model* m)
 {
     if (m == nullptr) return;
 
+    std::unique_lock<std::recursive_mutex> lock(settingsLock);
     auto styles = m->GetBufferStyles();
-    auto style = mSettings.Get("B_CHOICE_BufferStyle", "Default");
+    auto style = mSettings->Get("B_CHOICE_BufferStyle", "Default");
 
     if (std::find(styles.begin(), styles.end(), style) == styles.end())
     {
+        // fixed in a copy which goes back to the pool so every effect needing the same fix shares it
+        SettingsMap fixed(*mSettings);
         if (style.substr(0, 9) == "Per Model")
         {
-            mSettings["B_CHOICE_BufferStyle"] = style.substr(10);
+            fixed["B_CHOICE_BufferStyle"] = style.substr(10);
         }
         else
         {
-            mSettings["B_CHOICE_BufferStyle"] = "Default";
+            fixed["B_CHOICE_BufferStyle"] = "Default";
         }
+        SetSharedSettings(fixed.AsString());
+        SettingsChanged();
     }
 }
 
 bool Effect::IsPersistent() const
 {
-    return mSettings.GetBool("B_CHECKBOX_OverlayBkg", false);
+    std::unique_lock<std::recursive_mutex> lock(settingsLock);
+    return mSettings->GetBool("B_CHECKBOX_OverlayBkg", false);
 }
 
 std::string Effect::GetPaletteAsString() const
 {
     std::unique_lock<std::recursive_mutex> lock(settingsLock);
-    return mPaletteMap.AsString();
+    return mPaletteMap->AsString();
 }
 
 void Effect::SetPalette(const std::string& i)
 {
     std::unique_lock<std::recursive_mutex> lock(settingsLock);
-    mPaletteMap.Parse(i);
+    SetSharedPaletteMap(i);
     mColors.clear();
     mCC.clear();
     IncrementChangeCount();
-    if (mPaletteMap.empty())
+    if (mPaletteMap->empty())
     {
         return;
     }
-    ParseColorMap(mPaletteMap, mColors, mCC);
+    ParseColorMap(*mPaletteMap, mColors, mCC);
 }
 
 // This only updates the colour palette ... preserving all the other colour settings
@@ -657,26 +876,26 @@ void Effect::SetColourOnlyPalette(const std::string& i)
     auto oldPalette = mPaletteMap;
 
     // parse in the new one
-    mPaletteMap.Parse(i);
+    SetSharedPaletteMap(i);
 
     // copy over all the non colour entries
-    for (auto it = oldPalette.begin(); it != oldPalette.end(); ++it)
+    for (auto it = oldPalette->begin(); it != oldPalette->end(); ++it)
     {
         wxString key(it->first);
         if (!key.StartsWith("C_BUTTON_Palette") && !key.StartsWith("C_CHECKBOX_Palette"))
         {
-            mPaletteMap[it->first] = it->second;
+            PaletteMap()[it->first] = it->second;
         }
     }
 
     mColors.clear();
     mCC.clear();
     IncrementChangeCount();
-    if (mPaletteMap.empty())
+    if (mPaletteMap->empty())
     {
         return;
     }
-    ParseColorMap(mPaletteMap, mColors, mCC);
+    ParseColorMap(*mPaletteMap, mColors, mCC);
 }
 
 void Effect::CopyPalette(xlColorVector &target, xlColorCurveVector& newcc) const
@@ -691,11 +910,11 @@ void Effect::PaletteMapUpdated() {
     mColors.clear();
     mCC.clear();
     IncrementChangeCount();
-    if (mPaletteMap.empty())
+    if (mPaletteMap->empty())
     {
         return;
     }
-    ParseColorMap(mPaletteMap, mColors, mCC);
+    ParseColorMap(*mPaletteMap, mColors, mCC);
 }
 
 bool operator<(const Effect &e1, const Effect &e2)
@@ -733,3 +952,68 @@ void Effect::PurgeCache(bool deleteCache) {
         mCache = nullptr;
     }
 }
+
+void Effect::SettingsChanged() {
+    std::unique_lock<std::recursive_mutex> lock(settingsLock);
+    if (!mCheckpoints.empty()) {
+        mCheckpoints.clear();
+        Checkpoints.Remove(this);
+    }
+    ++mCheckpointGeneration;
+}
+
+bool Effect::IsCheckpointingEnabled() {
+    return CheckpointPool::GetLimit() > 0;
+}
+
+int Effect::GetCheckpointGeneration() const {
+    std::unique_lock<std::recursive_mutex> lock(settingsLock);
+    return mCheckpointGeneration;
+}
+
+void Effect::AddCheckpoint(std::shared_ptr<const EffectCheckpoint> checkpoint) {
+    std::unique_lock<std::recursive_mutex> lock(settingsLock);
+    if (checkpoint->generation != mCheckpointGeneration) {
+        // rendered from settings the effect no longer has
+        return;
+    }
+    // forget any the pool has dropped
+    for (auto it = mCheckpoints.begin(); it != mCheckpoints.end(); ) {
+        if (it->second.expired()) {
+            it = mCheckpoints.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    mCheckpoints[checkpoint->frame] = checkpoint;
+    Checkpoints.Add(this, checkpoint);
+}
+
+std::shared_ptr<const EffectCheckpoint> Effect::GetCheckpoint(int beforeFrame, int generation) const {
+    std::unique_lock<std::recursive_mutex> lock(settingsLock);
+    if (generation != mCheckpointGeneration) {
+        return nullptr;
+    }
+    // the latest one the pool hasn't dropped
+    auto it = mCheckpoints.lower_bound(beforeFrame);
+    while (it != mCheckpoints.begin()) {
+        --it;
+        auto checkpoint = it->second.lock();
+        if (checkpoint != nullptr) {
+            if (checkpoint->generation != generation) {
+                return nullptr;
+            }
+            Checkpoints.Touch(checkpoint.get());
+            return checkpoint;
+        }
+    }
+    return nullptr;
+}
+
+void Effect::ClearCheckpoints(int generation) {
+    std::unique_lock<std::recursive_mutex> lock(settingsLock);
+    if (generation == mCheckpointGeneration && !mCheckpoints.empty()) {
+        mCheckpoints.clear();
+        Checkpoints.Remove(this);
+    }
+}
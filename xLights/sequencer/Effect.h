@@ -15,6 +15,8 @@
 #include <vector>
 #include <string>
 #include <mutex>
+#include <memory>
+#include <map>
 
 #include "../ColorCurve.h" // This needs to be here
 #include "../UtilClasses.h"
@@ -26,6 +28,7 @@ class ValueCurve;
 class RenderCacheItem;
 class RenderBuffer;
 class RenderCache;
+struct EffectCheckpoint;
 class Model;
 class RenderableEffect;
 
@@ -50,17 +53,31 @@ class Effect
     EffectLayer* mParentLayer = nullptr;
     xlColor mColorMask = xlBLACK;
     mutable std::recursive_mutex settingsLock;
-    SettingsMap mSettings;
-    SettingsMap mPaletteMap;
+    // settings and palette maps are shared with other effects with identical strings until this effect changes them
+    std::shared_ptr<SettingsMap> mSettings;
+    std::shared_ptr<SettingsMap> mPaletteMap;
+    bool mSettingsShared = false;
+    bool mPaletteMapShared = false;
     xlColorVector mColors;
     xlColorCurveVector mCC;
     DrawGLUtils::xlDisplayList background;
     RenderCacheItem *mCache = nullptr;
+    // the checkpoints are owned by a pool shared by all effects which drops the least recently used
+    // when they take too much memory so these can expire
+    std::map<int, std::weak_ptr<const EffectCheckpoint>> mCheckpoints;
+    int mCheckpointGeneration = 0;
     wxLongLong _timeToDelete = 0;
 
     Effect() {}  //don't allow default or copy constructor
     Effect(const Effect &e) {}
     static void ParseColorMap(const SettingsMap &mPaletteMap, xlColorVector &mColors, xlColorCurveVector& mCC);
+    void SetSharedSettings(const std::string& settings);
+    void SetSharedPaletteMap(const std::string& palette);
+    // these give this effect its own copy of a shared map before it is changed
+    SettingsMap& Settings();
+    SettingsMap& PaletteMap();
+    // drops the checkpoints as they were rendered from the old settings
+    void SettingsChanged();
 
 public:
     Effect(EffectLayer* parent, int id, const std::string & name, const std::string &settings, const std::string &palette,
@@ -115,23 +132,31 @@ public:
     void SetSettings(const std::string &settings, bool keepxsettings);
     void ApplySetting(const std::string& id, const std::string& value, ValueCurve* vc, const std::string& vcid);
     void PressButton(RenderableEffect* re, const std::string& id);
-    const SettingsMap &GetSettings() const { return mSettings; }
+    // the reference is only good until the settings next change ... off the main thread hold on to the
+    // map with GetSettingsPtr() or copy it with CopySettingsMap()
+    const SettingsMap &GetSettings() const { return *mSettings; }
+    std::shared_ptr<const SettingsMap> GetSettingsPtr() const;
+    std::shared_ptr<const SettingsMap> GetPaletteMapPtr() const;
     void CopySettingsMap(SettingsMap &target, bool stripPfx = false) const;
     void FixBuffer(const Model* m);
     bool IsPersistent() const;
+    // hands maps this effect has changed back to the pool so effects changed the same way share again
+    void ShareSettings();
 
     const xlColorVector &GetPalette() const { return mColors; }
     int GetPaletteSize() const { return mColors.size(); }
-    const SettingsMap &GetPaletteMap() const { return mPaletteMap; }
+    // same as GetSettings() ... off the main thread use GetPaletteMapPtr()
+    const SettingsMap &GetPaletteMap() const { return *mPaletteMap; }
     std::string GetPaletteAsString() const;
     void SetPalette(const std::string& i);
     void SetColourOnlyPalette(const std::string & i);
     void CopyPalette(xlColorVector &target, xlColorCurveVector& newcc) const;
 
     /* Do NOT call these on any thread other than the main thread */
-    SettingsMap &GetSettings() { return mSettings; }
+    /* The non const versions take a private copy of shared settings so only use them to make changes */
+    SettingsMap &GetSettings() { return Settings(); }
     xlColorVector &GetPalette() { return mColors; }
-    SettingsMap &GetPaletteMap() { return mPaletteMap; }
+    SettingsMap &GetPaletteMap() { return PaletteMap(); }
     void PaletteMapUpdated();
 
     DrawGLUtils::xlDisplayList &GetBackgroundDisplayList() { return background; }
@@ -154,6 +179,19 @@ public:
     bool GetFrame(RenderBuffer &buffer, RenderCache &renderCache);
     void AddFrame(RenderBuffer &buffer, RenderCache &renderCache);
     void PurgeCache(bool deleteCachefile = false);
+
+    // render state saved part way through the effect so a render can resume from the middle of it.
+    // The generation moves on whenever the effect changes so a render still running with the old
+    // settings can't add or use checkpoints ... read it before copying the settings to render with.
+    // All effects' checkpoints together are limited by the special option EffectCheckpointMB (0 turns them off)
+    static bool IsCheckpointingEnabled();
+    int GetCheckpointGeneration() const;
+    void AddCheckpoint(std::shared_ptr<const EffectCheckpoint> checkpoint);
+    std::shared_ptr<const EffectCheckpoint> GetCheckpoint(int beforeFrame, int generation) const; // the latest one before the frame
+    void ClearCheckpoints(int generation);
+
+    // number of distinct settings and palette strings currently shared between effects
+    static void GetSharedSettingsCounts(size_t& settings, size_t& palettes);
 };
 
 bool operator<(const Effect &e1, const Effect &e2);
@@ -1319,7 +1319,7 @@ std::list<std::string> EffectLayer::GetFileReferences(Model* model, EffectManage
 
     for (int k = 0; k < GetEffectCount(); k++)
     {
-        Effect* ef = GetEffect(k);
+        const Effect* ef = GetEffect(k);
 
         if (ef->GetEffectIndex() >= 0)
         {
@@ -1337,7 +1337,7 @@ std::list<std::string> EffectLayer::GetFacesUsed(EffectManager& em) const
 
     for (int k = 0; k < GetEffectCount(); k++)
     {
-        Effect* ef = GetEffect(k);
+        const Effect* ef = GetEffect(k);
 
         if (ef->GetEffectIndex() >= 0)
         {
@@ -12,11 +12,13 @@
 #include <wx/utils.h>
 #include <wx/tokenzr.h>
 #include <wx/filename.h>
+#include <wx/stopwatch.h>
 
 #include <algorithm>
 
 #include "SequenceElements.h"
 #include "TimeLine.h"
+#include "BinarySequenceFile.h"
 #include "../xLightsMain.h"
 #include "../LyricsDialog.h"
 #include "../xLightsXmlFile.h"
@@ -27,6 +29,7 @@
 #include "../SequenceViewManager.h"
 #include "../JukeboxPanel.h"
 #include "../TraceLog.h"
+#include "../Parallel.h"
 #include "../UtilFunctions.h"
 
 #include <log4cpp/Category.hh>
@@ -644,7 +647,8 @@ int SequenceElements::LoadEffects(EffectLayer *effectLayer,
     const std::string &type,
     wxXmlNode *effectLayerNode,
     const std::vector<std::string> & effectStrings,
-    const std::vector<std::string> & colorPalettes) {
+    const std::vector<std::string> & colorPalettes,
+    bool loadNodes) {
     static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
 
     int loaded = 0;
@@ -687,15 +691,16 @@ int SequenceElements::LoadEffects(EffectLayer *effectLayer,
                 }
                 else {
                     settings = ToStdString(effect->GetNodeContent());
-                }
 
-                if (settings.find("E_FILEPICKER_Pictures_Filename") != std::string::npos)
-                {
-                    settings = FixEffectFileParameter("E_FILEPICKER_Pictures_Filename", settings, "");
-                }
-                else if (settings.find("E_FILEPICKER_Glediator_Filename") != std::string::npos)
-                {
-                    settings = FixEffectFileParameter("E_FILEPICKER_Glediator_Filename", settings, "");
+                    // effect db strings have already had this applied when the db was loaded
+                    if (settings.find("E_FILEPICKER_Pictures_Filename") != std::string::npos)
+                    {
+                        settings = FixEffectFileParameter("E_FILEPICKER_Pictures_Filename", settings, "");
+                    }
+                    else if (settings.find("E_FILEPICKER_Glediator_Filename") != std::string::npos)
+                    {
+                        settings = FixEffectFileParameter("E_FILEPICKER_Glediator_Filename", settings, "");
+                    }
                 }
 
                 wxString tmp;
@@ -716,7 +721,7 @@ int SequenceElements::LoadEffects(EffectLayer *effectLayer,
             effectLayer->AddEffect(id, effectName, settings, pal,
                 startTime, endTime, EFFECT_NOT_SELECTED, bProtected);
         }
-        else if (effect->GetName() == STR_NODE && effectLayerNode->GetName() == STR_STRAND) {
+        else if (loadNodes && effect->GetName() == STR_NODE && effectLayerNode->GetName() == STR_STRAND) {
             StrandElement *se = (StrandElement*)effectLayer->GetParentElement();
             EffectLayer* neffectLayer = se->GetNodeLayer(wxAtoi(effect->GetAttribute(STR_INDEX)), true);
             if (effect->GetAttribute(STR_NAME, STR_EMPTY) != STR_EMPTY) {
@@ -746,10 +751,19 @@ bool SequenceElements::LoadSequencerFile(xLightsXmlFile& xml_file, const wxStrin
     Clear();
     TraceLog::AddTraceMessage("   Cleared");
     supportsModelBlending = xml_file.supportsModelBlending();
+
+    // if there is an up to date binary sidecar the effects come from it rather than the xml
+    BinarySequenceFile binary;
+    bool useBinary = xml_file.GetExt().Lower() == "xsq" && BinarySequenceFile::IsEnabled() && binary.Open(xml_file.GetFullPath().ToStdString(), ShowDir.ToStdString());
+    if (useBinary) {
+        logger_base.debug("Loading effects from binary sequence file.");
+    }
+
     for (wxXmlNode* e = root->GetChildren(); e != nullptr; e = e->GetNext())
     {
         TraceLog::PushTraceContext();
         TraceLog::AddTraceMessage("Processing " + e->GetName());;
+        wxStopWatch sectionTimer;
         if (e->GetName() == "DisplayElements")
         {
             std::list<wxXmlNode*> toremove;
@@ -812,7 +826,7 @@ bool SequenceElements::LoadSequencerFile(xLightsXmlFile& xml_file, const wxStrin
                 }
             }
         }
-        else if (e->GetName() == "EffectDB")
+        else if (e->GetName() == "EffectDB" && !useBinary)
         {
             effectStrings.clear();
             for (wxXmlNode* elementNode = e->GetChildren(); elementNode != nullptr; elementNode = elementNode->GetNext())
@@ -828,11 +842,21 @@ bool SequenceElements::LoadSequencerFile(xLightsXmlFile& xml_file, const wxStrin
                         elementNode->SetContent(FixEffectFileParameter("E_TEXTCTRL_Glediator_Filename", elementNode->GetNodeContent(), ShowDir));
                     }
 
-                    effectStrings.push_back(ToStdString(elementNode->GetNodeContent()));
+                    // the fix LoadEffects applies to each effect is done once here for each shared string
+                    std::string settings = ToStdString(elementNode->GetNodeContent());
+                    if (settings.find("E_FILEPICKER_Pictures_Filename") != std::string::npos)
+                    {
+                        settings = FixEffectFileParameter("E_FILEPICKER_Pictures_Filename", settings, "");
+                    }
+                    else if (settings.find("E_FILEPICKER_Glediator_Filename") != std::string::npos)
+                    {
+                        settings = FixEffectFileParameter("E_FILEPICKER_Glediator_Filename", settings, "");
+                    }
+                    effectStrings.push_back(settings);
                 }
             }
         }
-        else if (e->GetName() == "ColorPalettes")
+        else if (e->GetName() == "ColorPalettes" && !useBinary)
         {
             colorPalettes.clear();
             for (wxXmlNode* elementNode = e->GetChildren(); elementNode != nullptr; elementNode = elementNode->GetNext())
@@ -847,24 +871,25 @@ bool SequenceElements::LoadSequencerFile(xLightsXmlFile& xml_file, const wxStrin
         {
             xframe->LoadJukebox(e);
         }
+        else if (e->GetName() == "ElementEffects" && useBinary)
+        {
+            int loaded = binary.LoadEffects(*this, xml_file.GetSequenceDurationMS());
+            logger_base.debug("    %d effects loaded from binary sequence file.", loaded);
+        }
         else if (e->GetName() == "ElementEffects")
         {
-            int count = 0;
-            for (wxXmlNode* elementNode = e->GetChildren(); elementNode != NULL; elementNode = elementNode->GetNext())
+            // Effects are loaded in two phases. First, on this thread, every element's layers, strands,
+            // submodels and node layers are created. Then the effects are created with one job per element
+            // so everything a job touches (the element, its layers and their effects) is owned by that job.
+            wxStopWatch sw;
+            struct ElementLoadJob
             {
-                if (elementNode->GetName() == STR_ELEMENT)
-                {
-                    for (wxXmlNode* effectLayerNode = elementNode->GetChildren(); effectLayerNode != nullptr; effectLayerNode = effectLayerNode->GetNext())
-                    {
-                        for (wxXmlNode* effect = effectLayerNode->GetChildren(); effect != nullptr; effect = effect->GetNext())
-                        {
-                            count++;
-                        }
-                    }
-                }
-            }
+                Element* element = nullptr;
+                std::string type;
+                std::vector<std::pair<EffectLayer*, wxXmlNode*>> layers;
+            };
+            std::vector<ElementLoadJob> jobs;
 
-            int loaded = 0;
             for (wxXmlNode* elementNode = e->GetChildren(); elementNode != NULL; elementNode = elementNode->GetNext())
             {
                 if (elementNode->GetName() == STR_ELEMENT)
@@ -907,6 +932,10 @@ bool SequenceElements::LoadSequencerFile(xLightsXmlFile& xml_file, const wxStrin
                         }
                         else
                         {
+                            ElementLoadJob job;
+                            job.element = element;
+                            job.type = elementNode->GetAttribute(STR_TYPE).ToStdString();
+
                             for (wxXmlNode* effectLayerNode = elementNode->GetChildren(); effectLayerNode != nullptr; effectLayerNode = effectLayerNode->GetNext())
                             {
                                 EffectLayer* effectLayer = nullptr;
@@ -938,22 +967,31 @@ bool SequenceElements::LoadSequencerFile(xLightsXmlFile& xml_file, const wxStrin
                                         if (effectLayerNode->GetAttribute(STR_NAME, STR_EMPTY) != STR_EMPTY) {
                                             se->SetName(effectLayerNode->GetAttribute(STR_NAME).Trim(true).Trim(false).ToStdString());
                                         }
+
+                                        // node layers have to exist before the effects are loaded in parallel
+                                        for (wxXmlNode* nodeNode = effectLayerNode->GetChildren(); nodeNode != nullptr; nodeNode = nodeNode->GetNext()) {
+                                            if (nodeNode->GetName() == STR_NODE && effectLayerNode->GetName() == STR_STRAND) {
+                                                NodeLayer* nodeLayer = se->GetNodeLayer(wxAtoi(nodeNode->GetAttribute(STR_INDEX)), true);
+                                                if (nodeNode->GetAttribute(STR_NAME, STR_EMPTY) != STR_EMPTY) {
+                                                    nodeLayer->SetName(nodeNode->GetAttribute(STR_NAME).ToStdString());
+                                                }
+                                                job.layers.push_back({ nodeLayer, nodeNode });
+                                            }
+                                        }
                                     }
                                     else                                         {
                                         logger_base.error("Element %s was not a model element: %s. This typically happens when a timing track is created with the same name as a model.", (const char *)element->GetName().c_str());
                                     }
                                 }
                                 if (effectLayer != nullptr) {
-                                    loaded += LoadEffects(effectLayer, elementNode->GetAttribute(STR_TYPE).ToStdString(), effectLayerNode, effectStrings, colorPalettes);
-                                    if (count) {
-                                        GetXLightsFrame()->SetStatusText(wxString::Format("Effects Loaded: %i%%.", loaded * 100 / count));
-                                    }
+                                    job.layers.push_back({ effectLayer, effectLayerNode });
                                 }
                                 else
                                 {
                                     wxASSERT(false);
                                 }
                             }
+                            jobs.push_back(job);
                         }
                     }
                     else
@@ -962,7 +1000,21 @@ bool SequenceElements::LoadSequencerFile(xLightsXmlFile& xml_file, const wxStrin
                     }
                 }
             }
+            logger_base.debug("    Sequence layers created for %d elements in %ldms.", (int)jobs.size(), sw.Time());
+
+            sw.Start();
+            std::atomic_int loaded(0);
+            parallel_for(0, jobs.size(), [this, &jobs, &effectStrings, &colorPalettes, &loaded](int i) {
+                int count = 0;
+                for (const auto& it : jobs[i].layers) {
+                    count += LoadEffects(it.first, jobs[i].type, it.second, effectStrings, colorPalettes, false);
+                }
+                loaded += count;
+            });
+            GetXLightsFrame()->SetStatusText(wxString::Format("Effects Loaded: %i.", (int)loaded));
+            logger_base.debug("    %d effects loaded in %ldms.", (int)loaded, sw.Time());
         }
+        logger_base.debug("Sequencer file section %s processed in %ldms.", (const char*)e->GetName().c_str(), sectionTimer.Time());
         TraceLog::PopTraceContext();
     }
     for (size_t x = 0; x < GetElementCount(); x++) {
@@ -1853,6 +1905,79 @@ std::list<std::string> SequenceElements::GetAllUsedEffectTypes() const
     return res;
 }
 
+// approximate heap used by a settings map ... assumes a 32 byte tree node overhead and 15 character short strings
+static size_t EstimateMapBytes(const SettingsMap& map)
+{
+    size_t res = sizeof(SettingsMap);
+    for (const auto& it : map) {
+        res += sizeof(std::pair<const std::string, std::string>) + 32;
+        if (it.first.capacity() > 15) res += it.first.capacity() + 1;
+        if (it.second.capacity() > 15) res += it.second.capacity() + 1;
+    }
+    return res;
+}
+
+void SequenceElements::LogMemoryUsage() const
+{
+    static log4cpp::Category& logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    size_t effects = 0;
+    size_t settingsBytes = 0;
+    size_t settingsUnsharedBytes = 0;
+    size_t paletteBytes = 0;
+    size_t paletteUnsharedBytes = 0;
+    size_t colourBytes = 0;
+    std::set<const SettingsMap*> seenSettings;
+    std::set<const SettingsMap*> seenPalettes;
+
+    auto addLayer = [&](const EffectLayer* el) {
+        for (int k = 0; k < el->GetEffectCount(); k++) {
+            const Effect* eff = el->GetEffect(k);
+            effects++;
+            size_t sb = EstimateMapBytes(eff->GetSettings());
+            settingsUnsharedBytes += sb;
+            if (seenSettings.insert(&eff->GetSettings()).second) settingsBytes += sb;
+            size_t pb = EstimateMapBytes(eff->GetPaletteMap());
+            paletteUnsharedBytes += pb;
+            if (seenPalettes.insert(&eff->GetPaletteMap()).second) paletteBytes += pb;
+            colourBytes += eff->GetPalette().size() * (sizeof(xlColor) + sizeof(ColorCurve));
+        }
+    };
+
+    for (size_t i = 0; i < GetElementCount(); i++) {
+        Element* e = GetElement(i);
+        for (size_t j = 0; j < e->GetEffectLayerCount(); j++) {
+            addLayer(e->GetEffectLayer(j));
+        }
+        ModelElement* mel = dynamic_cast<ModelElement*>(e);
+        if (mel != nullptr) {
+            for (int x = 0; x < mel->GetSubModelAndStrandCount(); ++x) {
+                SubModelElement* sme = mel->GetSubModel(x);
+                for (size_t j = 0; j < sme->GetEffectLayerCount(); j++) {
+                    addLayer(sme->GetEffectLayer(j));
+                }
+                StrandElement* ste = dynamic_cast<StrandElement*>(sme);
+                if (ste != nullptr) {
+                    for (int n = 0; n < ste->GetNodeLayerCount(); n++) {
+                        addLayer(ste->GetNodeLayer(n));
+                    }
+                }
+            }
+        }
+    }
+
+    size_t sharedSettings;
+    size_t sharedPalettes;
+    Effect::GetSharedSettingsCounts(sharedSettings, sharedPalettes);
+
+    logger_base.debug("Sequence memory (approximate):");
+    logger_base.debug("    Effects: %d : %dKB", (int)effects, (int)(effects * sizeof(Effect) / 1024));
+    logger_base.debug("    Settings: %d distinct maps : %dKB (%dKB if not shared)", (int)seenSettings.size(), (int)(settingsBytes / 1024), (int)(settingsUnsharedBytes / 1024));
+    logger_base.debug("    Palettes: %d distinct maps : %dKB (%dKB if not shared)", (int)seenPalettes.size(), (int)(paletteBytes / 1024), (int)(paletteUnsharedBytes / 1024));
+    logger_base.debug("    Palette colours: %dKB", (int)(colourBytes / 1024));
+    logger_base.debug("    Shared settings pool: %d settings, %d palettes", (int)sharedSettings, (int)sharedPalettes);
+}
+
 std::list<std::string> SequenceElements::GetAllElementNamesWithEffects()
 {
     std::list<std::string> res;
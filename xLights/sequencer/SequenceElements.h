@@ -17,6 +17,7 @@
 #include <set>
 #include <string>
 #include <mutex>
+#include <atomic>
 #include "wx/xml/xml.h"
 #include "wx/filename.h"
 #include "UndoManager.h"
@@ -93,6 +94,7 @@ public:
     std::list<std::string> GetAllEffectDescriptions();
     std::list<std::string> GetAllReferencedFiles();
     std::list<std::string> GetAllUsedEffectTypes() const;
+    void LogMemoryUsage() const;
     std::list<std::string> GetAllElementNamesWithEffects();
     int GetElementLayerCount(std::string elementName, std::list<int>* layers = nullptr);
     std::list<Effect*> GetElementLayerEffects(std::string elementName, int layer);
@@ -207,7 +209,8 @@ private:
         const std::string &type,
         wxXmlNode *effectLayerNode,
         const std::vector<std::string> & effectStrings,
-        const std::vector<std::string> & colorPalettes);
+        const std::vector<std::string> & colorPalettes,
+        bool loadNodes = true);
     static bool SortElementsByIndex(const Element *element1, const Element *element2)
     {
         return (element1->GetIndex() < element2->GetIndex());
@@ -246,7 +249,7 @@ private:
 
     // mFirstVisibleModelRow=0 is first model row not the row in Row_Information struct.
     int mFirstVisibleModelRow;
-    unsigned int mChangeCount;
+    std::atomic<unsigned int> mChangeCount;
     unsigned int mMasterViewChangeCount;
     UndoManager undo_mgr;
 
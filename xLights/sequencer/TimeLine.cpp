@@ -326,6 +326,18 @@ bool TimeLine::SetPlayMarkerMS(int ms)
     return changed;
 }
 
+void TimeLine::SetRenderFrontierMS(int ms)
+{
+    if (mRenderFrontierMS == ms) return;
+
+    bool visible = mRenderFrontierMS >= mStartTimeMS && mRenderFrontierMS <= mEndTimeMS;
+    mRenderFrontierMS = ms;
+    if (visible || (ms >= mStartTimeMS && ms <= mEndTimeMS)) {
+        wxClientDC dc(this);
+        render(dc);
+    }
+}
+
 void TimeLine::SetZoomMarkerMS(int ms)
 {
     mZoomMarkerMS = ms;
@@ -905,6 +917,15 @@ void TimeLine::render( wxDC& dc ) {
         dc.DrawPoint(mCurrentPlayMarker, y_bottom);
     }
 
+    // draw where the render has reached ahead of the play marker
+    if (mRenderFrontierMS >= mStartTimeMS && mRenderFrontierMS <= mEndTimeMS)
+    {
+        int x = GetPositionFromTimeMS(mRenderFrontierMS);
+        dc.SetPen(*wxRED_PEN);
+        dc.DrawLine(x, h / 2, x, h - 1);
+        dc.DrawLine(x + 1, h / 2, x + 1, h - 1);
+    }
+
     // Draw the selection line if not a range
     if( mSelectedPlayMarkerStart != -1 && mSelectedPlayMarkerEnd == -1 ) {
         dc.SetPen(*pen_black);
@@ -47,6 +47,9 @@ public:
     bool SetPlayMarkerMS(int ms);
     int GetPlayMarker() const;
 
+    // how far the render has got ahead of the play marker ... -1 hides it
+    void SetRenderFrontierMS(int ms);
+
     void SetZoomMarkerMS(int ms);
 
     void SetSelectedPositionStart(int pos, bool reset_end = true);
@@ -157,6 +160,7 @@ private:
     int mSelectedPlayMarkerStartMS;
     int mSelectedPlayMarkerEndMS;
     int mCurrentPlayMarkerMS;
+    int mRenderFrontierMS = -1;
     int mSequenceEndMarker;
     int mSequenceEndMarkerMS;
     int mZoomMarkerMS;
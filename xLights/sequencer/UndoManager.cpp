@@ -11,8 +11,138 @@
 #include "UndoManager.h"
 #include "Element.h"
 #include "SequenceElements.h"
+#include "../SequenceData.h"
+#include "../SpecialOptions.h"
 #include <log4cpp/Category.hh>
 
+#include <algorithm>
+
+namespace
+{
+    void WriteCount(std::vector<uint8_t>& out, size_t value)
+    {
+        while (value >= 0x80) {
+            out.push_back((uint8_t)(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back((uint8_t)value);
+    }
+
+    size_t ReadCount(const std::vector<uint8_t>& in, size_t& pos)
+    {
+        size_t value = 0;
+        int shift = 0;
+        while (pos < in.size()) {
+            uint8_t b = in[pos++];
+            value |= (size_t)(b & 0x7F) << shift;
+            if ((b & 0x80) == 0) break;
+            shift += 7;
+        }
+        return value;
+    }
+
+    // a literal run ends when at least this many zero bytes follow
+    const size_t MIN_ZERO_RUN = 4;
+
+    size_t GetRenderedDataLimit()
+    {
+        int mb = wxAtoi(SpecialOptions::GetOption("UndoRenderSnapshotMB", "128"));
+        if (mb < 0) mb = 0;
+        return (size_t)mb * 1024 * 1024;
+    }
+}
+
+RenderedDataSnapshot::RenderedDataSnapshot(const SequenceData& data, const ChannelRanges& channelRanges, int startFrame, int endFrame)
+: _startFrame(std::max(startFrame, 0)), _endFrame(std::min(endFrame, (int)data.NumFrames() - 1)), _frameSize(0)
+{
+    for (const auto& it : channelRanges) {
+        if (it.first >= data.NumChannels() || it.second == 0) continue;
+        uint32_t count = std::min(it.second, data.NumChannels() - it.first);
+        _channelRanges.push_back({ it.first, count });
+        _frameSize += count;
+    }
+    if (_frameSize == 0) return;
+
+    std::vector<uint8_t> prev(_frameSize, 0);
+    std::vector<uint8_t> delta(_frameSize);
+    for (int frame = _startFrame; frame <= _endFrame; ++frame) {
+        const FrameData& fd = data[frame];
+        size_t pos = 0;
+        for (const auto& it : _channelRanges) {
+            const unsigned char* src = fd[it.first];
+            for (uint32_t c = 0; c < it.second; ++c, ++pos) {
+                delta[pos] = src[c] ^ prev[pos];
+                prev[pos] = src[c];
+            }
+        }
+
+        // each frame is a list of (zero run, literal run, literal bytes)
+        size_t i = 0;
+        while (i < _frameSize) {
+            size_t start = i;
+            while (i < _frameSize && delta[i] == 0) ++i;
+            WriteCount(_encoded, i - start);
+            start = i;
+            size_t zeros = 0;
+            while (i < _frameSize && zeros < MIN_ZERO_RUN) {
+                zeros = delta[i] == 0 ? zeros + 1 : 0;
+                ++i;
+            }
+            size_t literal = i - start - (zeros == MIN_ZERO_RUN ? zeros : 0);
+            WriteCount(_encoded, literal);
+            _encoded.insert(_encoded.end(), delta.begin() + start, delta.begin() + start + literal);
+            i = start + literal;
+        }
+    }
+    _encoded.shrink_to_fit();
+}
+
+bool RenderedDataSnapshot::Covers(const ChannelRanges& channelRanges, int startFrame, int endFrame) const
+{
+    if (startFrame < _startFrame || endFrame > _endFrame) return false;
+    for (const auto& it : channelRanges) {
+        bool found = false;
+        for (const auto& it2 : _channelRanges) {
+            if (it.first >= it2.first && it.first + it.second <= it2.first + it2.second) {
+                found = true;
+                break;
+            }
+        }
+        if (!found) return false;
+    }
+    return true;
+}
+
+bool RenderedDataSnapshot::Restore(SequenceData& data) const
+{
+    if (_frameSize == 0 || _endFrame >= (int)data.NumFrames()) return false;
+    for (const auto& it : _channelRanges) {
+        if (it.first + it.second > data.NumChannels()) return false;
+    }
+
+    std::vector<uint8_t> cur(_frameSize, 0);
+    size_t pos = 0;
+    for (int frame = _startFrame; frame <= _endFrame; ++frame) {
+        size_t i = 0;
+        while (i < _frameSize && pos < _encoded.size()) {
+            i += ReadCount(_encoded, pos);
+            size_t literal = ReadCount(_encoded, pos);
+            if (i + literal > _frameSize || pos + literal > _encoded.size()) return false;
+            for (size_t l = 0; l < literal; ++l) {
+                cur[i++] ^= _encoded[pos++];
+            }
+        }
+
+        FrameData& fd = data[frame];
+        size_t offset = 0;
+        for (const auto& it : _channelRanges) {
+            memcpy(&fd[it.first], &cur[offset], it.second);
+            offset += it.second;
+        }
+    }
+    return true;
+}
+
 DeletedEffectInfo::DeletedEffectInfo( const std::string &element_name_, int layer_index_, const std::string &name_, const std::string &settings_,
                                       const std::string &palette_, int startTimeMS_, int endTimeMS_, int Selected_, bool Protected_ )
 : element_name(element_name_), layer_index(layer_index_), name(name_), settings(settings_),
@@ -72,7 +202,7 @@ UndoStep::UndoStep( UNDO_ACTIONS action, ModifiedEffectInfo* effect_info )
 }
 
 UndoManager::UndoManager(SequenceElements* parent)
-: mParentSequence(parent), mCaptureUndo(false)
+: mParentSequence(parent), mCaptureUndo(false), mSequenceData(nullptr), mRenderedDataPending(nullptr)
 {
 }
 
@@ -97,6 +227,9 @@ void UndoManager::RemoveUnusedMarkers()
         // delete any marker stragglers
         if( last_action->undo_action == UNDO_MARKER )
         {
+            if (last_action == mRenderedDataPending) {
+                mRenderedDataPending = nullptr;
+            }
             mUndoSteps.pop_back();
         }
     }
@@ -122,6 +255,7 @@ void UndoManager::Clear() {
         delete mUndoSteps[i];
     }
     mUndoSteps.clear();
+    mRenderedDataPending = nullptr;
     ClearRedo();
 }
 
@@ -150,6 +284,7 @@ void UndoManager::CreateUndoStep()
     RemoveUnusedMarkers();
     UndoStep* action = new UndoStep(UNDO_MARKER);
     mUndoSteps.push_back(action);
+    mRenderedDataPending = action;
 }
 
 void UndoManager::CaptureEffectToBeDeleted( const std::string &element_name, int layer_index, const std::string &name, const std::string &settings,
@@ -188,21 +323,83 @@ void UndoManager::CaptureModifiedEffect( const std::string &element_name, int la
     mUndoSteps.push_back(action);
 }
 
+void UndoManager::CaptureRenderedData(const RenderedDataSnapshot::ChannelRanges& channelRanges, int startFrame, int endFrame)
+{
+    static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+    if (mSequenceData == nullptr || mRenderedDataPending == nullptr || !mSequenceData->IsValidData()) return;
+
+    // the pending marker must still be the start of the most recent group of changes
+    UndoStep* marker = nullptr;
+    for (auto it = mUndoSteps.rbegin(); it != mUndoSteps.rend(); ++it) {
+        if ((*it)->undo_action == UNDO_MARKER) {
+            marker = *it;
+            break;
+        }
+    }
+    if (marker != mRenderedDataPending || GetRenderedDataLimit() == 0) {
+        mRenderedDataPending = nullptr;
+        return;
+    }
+    if (!ChangeCaptured()) return;
+
+    if (marker->rendered_data == nullptr) {
+        marker->rendered_data = std::make_unique<RenderedDataSnapshot>(*mSequenceData, channelRanges, startFrame, endFrame);
+        logger_base.debug("Undo captured rendered data for frames %d-%d, %d channel ranges, %d bytes.",
+            startFrame, endFrame, (int)channelRanges.size(), (int)marker->rendered_data->GetSize());
+        TrimRenderedData();
+    }
+    else if (!marker->rendered_data->Covers(channelRanges, startFrame, endFrame)) {
+        // this step has now caused data outside the snapshot to render so restoring it would be incomplete
+        marker->rendered_data.reset();
+        mRenderedDataPending = nullptr;
+    }
+}
+
+void UndoManager::TrimRenderedData()
+{
+    size_t limit = GetRenderedDataLimit();
+    size_t total = 0;
+    for (const auto& it : mUndoSteps) {
+        if (it->rendered_data != nullptr) total += it->rendered_data->GetSize();
+    }
+    for (const auto& it : mRedoSteps) {
+        if (it->rendered_data != nullptr) total += it->rendered_data->GetSize();
+    }
+
+    // drop the oldest undo snapshots first then the furthest away redo
+    for (auto it = mUndoSteps.begin(); total > limit && it != mUndoSteps.end(); ++it) {
+        if ((*it)->rendered_data != nullptr) {
+            total -= (*it)->rendered_data->GetSize();
+            (*it)->rendered_data.reset();
+        }
+    }
+    for (auto it = mRedoSteps.begin(); total > limit && it != mRedoSteps.end(); ++it) {
+        if ((*it)->rendered_data != nullptr) {
+            total -= (*it)->rendered_data->GetSize();
+            (*it)->rendered_data.reset();
+        }
+    }
+}
+
 void UndoManager::UndoLastStep()
 {
+    mRenderedDataPending = nullptr;
     UndoStep* action = new UndoStep(UNDO_MARKER);
     mRedoSteps.push_back(action);
-    ProcessUndoStep(mUndoSteps, mRedoSteps);
+    ProcessUndoStep(mUndoSteps, mRedoSteps, action);
+    TrimRenderedData();
 }
 
 void UndoManager::RedoLastStep()
 {
+    mRenderedDataPending = nullptr;
     UndoStep* action = new UndoStep(UNDO_MARKER);
     mUndoSteps.push_back(action);
-    ProcessUndoStep(mRedoSteps, mUndoSteps);
+    ProcessUndoStep(mRedoSteps, mUndoSteps, action);
+    TrimRenderedData();
 }
 
-void UndoManager::ProcessUndoStep(std::vector<UndoStep*> &fromList, std::vector<UndoStep*> &toList)
+void UndoManager::ProcessUndoStep(std::vector<UndoStep*> &fromList, std::vector<UndoStep*> &toList, UndoStep* toMarker)
 {
     static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
     bool done = false;
@@ -212,6 +409,16 @@ void UndoManager::ProcessUndoStep(std::vector<UndoStep*> &fromList, std::vector<
         switch (next_action->undo_action)
         {
         case UNDO_MARKER:
+            if (next_action->rendered_data != nullptr && mSequenceData != nullptr) {
+                // put back the data as it was rendered before the step keeping what is there now for the reverse operation
+                const RenderedDataSnapshot* before = next_action->rendered_data.get();
+                toMarker->rendered_data = std::make_unique<RenderedDataSnapshot>(*mSequenceData, before->GetChannelRanges(), before->GetStartFrame(), before->GetEndFrame());
+                if (!before->Restore(*mSequenceData)) {
+                    logger_base.warn("UndoManager::ProcessUndoStep rendered data no longer fits the sequence data.");
+                    toMarker->rendered_data.reset();
+                }
+                next_action->rendered_data.reset();
+            }
             done = true;
             break;
         case UNDO_EFFECT_DELETED:
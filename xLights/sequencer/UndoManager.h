@@ -12,8 +12,11 @@
 
 #include "wx/wx.h"
 #include <vector>
+#include <memory>
+#include <cstdint>
 
 class SequenceElements;
+class SequenceData;
 class Effect;
 
 enum UNDO_ACTIONS
@@ -76,6 +79,35 @@ public:
     ModifiedEffectInfo( const std::string &element_name_, int layer_index_, Effect *ef);
 };
 
+// A copy of the rendered data for the channels and frames an undo step caused to be re-rendered
+// taken before the render overwrote them. Undoing the step puts the data straight back so the
+// preview and output are correct immediately while the re-render runs to confirm it.
+// Each frame is stored XORed against the previous frame with runs of zero bytes collapsed so
+// static and slow moving effects take very little memory.
+class RenderedDataSnapshot
+{
+public:
+    // channel ranges are 0 based start channel and channel count
+    typedef std::vector<std::pair<uint32_t, uint32_t>> ChannelRanges;
+
+    RenderedDataSnapshot(const SequenceData& data, const ChannelRanges& channelRanges, int startFrame, int endFrame);
+
+    bool Covers(const ChannelRanges& channelRanges, int startFrame, int endFrame) const;
+    bool Restore(SequenceData& data) const;
+
+    const ChannelRanges& GetChannelRanges() const { return _channelRanges; }
+    int GetStartFrame() const { return _startFrame; }
+    int GetEndFrame() const { return _endFrame; }
+    size_t GetSize() const { return _encoded.size(); }
+
+private:
+    ChannelRanges _channelRanges;
+    int _startFrame;
+    int _endFrame;
+    size_t _frameSize;
+    std::vector<uint8_t> _encoded;
+};
+
 class UndoStep
 {
 public:
@@ -90,6 +122,7 @@ public:
     std::vector<AddedEffectInfo*> added_effect_info;
     std::vector<MovedEffectInfo*> moved_effect_info;
     std::vector<ModifiedEffectInfo*> modified_effect_info;
+    std::unique_ptr<RenderedDataSnapshot> rendered_data; // only held by UNDO_MARKER steps
 };
 
 class UndoManager
@@ -120,13 +153,21 @@ class UndoManager
         void CaptureEffectToBeMoved( const std::string &element_name, int layer_index, int id, int startTimeMS, int endTimeMS );
         void CaptureModifiedEffect( const std::string &element_name, int layer_index, int id, const std::string &settings, const std::string &palette );
         void CaptureModifiedEffect( const std::string &element_name, int layer_index, Effect *ef);
+
+        // called before the effects changed by the current undo step are rendered so the rendered
+        // data they replace can be restored on undo. Size limited by the special option UndoRenderSnapshotMB
+        void SetSequenceData(SequenceData* data) { mSequenceData = data; }
+        void CaptureRenderedData(const RenderedDataSnapshot::ChannelRanges& channelRanges, int startFrame, int endFrame);
     protected:
-        void ProcessUndoStep(std::vector<UndoStep*> &fromList, std::vector<UndoStep*> &toList);
+        void ProcessUndoStep(std::vector<UndoStep*> &fromList, std::vector<UndoStep*> &toList, UndoStep* toMarker);
+        void TrimRenderedData();
 
     private:
         std::vector<UndoStep*> mUndoSteps;
         std::vector<UndoStep*> mRedoSteps;
         SequenceElements* mParentSequence;
         bool mCaptureUndo;
+        SequenceData* mSequenceData;
+        UndoStep* mRenderedDataPending; // the marker of the step whose render has not been captured yet
 
 };
@@ -480,7 +480,7 @@ void Waveform::DrawWaveView(const WaveView &wv)
             c = xLightsApp::GetFrame()->color_mgr.GetColor(ColorManager::COLOR_WAVEFORM);
         }
 
-        int max = std::min(mWindowWidth, wv.MinMaxs.size());
+        int max = std::min(mWindowWidth, wv.GetPixelCount());
         if (mStartPixelOffset != wv.lastRenderStart || max != wv.lastRenderSize) {
             wv.background.Reset();
             wv.outline.Reset();
@@ -490,14 +490,15 @@ void Waveform::DrawWaveView(const WaveView &wv)
             std::vector<double> vertexes;
             vertexes.resize((mWindowWidth + 2));
 
-            for (size_t x = 0; x < mWindowWidth && x < wv.MinMaxs.size(); x++)
+            for (size_t x = 0; x < mWindowWidth && x < wv.GetPixelCount(); x++)
             {
                 int index = x;
                 index += mStartPixelOffset;
-                if (index >= 0 && index < wv.MinMaxs.size())
+                if (index >= 0 && index < wv.GetPixelCount())
                 {
-                    double y1 = ((wv.MinMaxs[index].min * (float)(max_wave_ht / 2))+ (mWindowHeight / 2));
-                    double y2 = ((wv.MinMaxs[index].max * (float)(max_wave_ht / 2))+ (mWindowHeight / 2));
+                    MINMAX mm = wv.GetMinMax(_media, index);
+                    double y1 = ((mm.min * (float)(max_wave_ht / 2))+ (mWindowHeight / 2));
+                    double y2 = ((mm.max * (float)(max_wave_ht / 2))+ (mWindowHeight / 2));
 
                     wv.background.AddVertex(x, y1);
                     wv.background.AddVertex(x, y2);
@@ -509,7 +510,7 @@ void Waveform::DrawWaveView(const WaveView &wv)
             for (int x = mWindowWidth; x >= 0; x--) {
                 int index = x;
                 index += mStartPixelOffset;
-                if (index >= 0 && index < wv.MinMaxs.size()) {
+                if (index >= 0 && index < wv.GetPixelCount()) {
                     wv.outline.AddVertex(x, vertexes[x]);
                 }
             }
@@ -675,36 +676,38 @@ void Waveform::SetGLSize(int w, int h)
     Refresh(false);
 }
 
-void Waveform::WaveView::SetMinMaxSampleSet(float SamplesPerPixel, AudioManager* media, AUDIOSAMPLETYPE type, int lowNote, int highNote)
+void Waveform::WaveView::SetPixelCount(AudioManager* media)
 {
-	MinMaxs.clear();
+    _pixels = 0;
+    _trackSize = 0;
 
-	if (media != nullptr)
-	{
-		float minimum=1;
-		float maximum=-1;
-		long trackSize = media->GetTrackSize();
-		int totalMinMaxs = (int)((float)trackSize/SamplesPerPixel)+1;
-
-		for (int i = 0; i < totalMinMaxs; i++) {
-			// Use float calculation to minimize compounded rounding of position
-			long start = (long)((float)i*SamplesPerPixel);
-			if (start >= trackSize) {
-				return;
-			}
-			long end = start + SamplesPerPixel;
-			if (end >= trackSize) {
-				end = trackSize;
-			}
-			minimum = 1;
-			maximum = -1;
-            media->GetLeftDataMinMax(start, end, minimum, maximum, type, lowNote, highNote);
-			MINMAX mm;
-			mm.min = minimum;
-			mm.max = maximum;
-			MinMaxs.push_back(mm);
-		}
+    if (media != nullptr && mSamplesPerPixel > 0)
+    {
+        _trackSize = media->GetTrackSize();
+        long pixels = (long)((float)_trackSize / mSamplesPerPixel) + 1;
+        // Use float calculation to minimize compounded rounding of position
+        if ((long)((float)(pixels - 1) * mSamplesPerPixel) >= _trackSize) {
+            pixels--;
+        }
+        _pixels = pixels;
+    }
+}
+
+Waveform::MINMAX Waveform::WaveView::GetMinMax(AudioManager* media, int pixel) const
+{
+    MINMAX mm = { 0, 0 };
+
+    if (media != nullptr)
+    {
+        // Use float calculation to minimize compounded rounding of position
+        long start = (long)((float)pixel * mSamplesPerPixel);
+        long end = start + mSamplesPerPixel;
+        if (end >= _trackSize) {
+            end = _trackSize;
+        }
+        media->GetLeftDataMinMax(start, end, mm.min, mm.max, _type, _lowNote, _highNote);
     }
+    return mm;
 }
 
 void Waveform::mouseLeftWindow(wxMouseEvent& event)
@@ -115,6 +115,8 @@ class Waveform : public xlGLCanvas
             int _lowNote = 0;
             int _highNote = 127;
             AUDIOSAMPLETYPE _type = AUDIOSAMPLETYPE::RAW;
+            long _trackSize = 0;
+            size_t _pixels = 0;
 
         public:
 
@@ -122,18 +124,19 @@ class Waveform : public xlGLCanvas
             mutable DrawGLUtils::xlVertexAccumulator outline;
             mutable int lastRenderStart;
             mutable int lastRenderSize;
-            std::vector<MINMAX> MinMaxs;
 
+            // the samples are summarised as each pixel is drawn using the audio managers pyramid
+            // so creating a view for a new zoom level costs nothing however long the song is
             WaveView(int ZoomLevel, float SamplesPerPixel, AudioManager* media, AUDIOSAMPLETYPE type, int lowNote, int highNote)
             {
                 mZoomLevel = ZoomLevel;
                 mSamplesPerPixel = SamplesPerPixel;
-                SetMinMaxSampleSet(SamplesPerPixel, media, type, lowNote, highNote);
                 lastRenderStart = -1;
                 lastRenderSize = 0;
                 _type = type;
                 _lowNote = lowNote;
                 _highNote = highNote;
+                SetPixelCount(media);
             }
             WaveView(int ZoomLevel) { }
             virtual ~WaveView() { }
@@ -142,7 +145,9 @@ class Waveform : public xlGLCanvas
             AUDIOSAMPLETYPE GetType() const { return _type; }
             int GetLowNote() const { return _lowNote; }
             int GetHighNote() const { return _highNote; }
-            void SetMinMaxSampleSet(float SamplesPerPixel, AudioManager* media, AUDIOSAMPLETYPE type, int lowNote, int highNote);
+            size_t GetPixelCount() const { return _pixels; }
+            void SetPixelCount(AudioManager* media);
+            MINMAX GetMinMax(AudioManager* media, int pixel) const;
         };
 
         void DrawWaveView(const WaveView &wv);
@@ -17,6 +17,7 @@
 #include <wx/filepicker.h>
 #include <wx/fontpicker.h>
 #include <wx/config.h>
+#include <wx/stopwatch.h>
 
 #include "../xLightsMain.h"
 #include "SequenceElements.h"
@@ -55,6 +56,7 @@
 #include "../LayoutPanel.h"
 #include "../TraceLog.h"
 #include "../effects/EffectPanelUtils.h"
+#include "../SpecialOptions.h"
 #include "../UtilFunctions.h"
 
 #include <log4cpp/Category.hh>
@@ -777,10 +779,14 @@ void xLightsFrame::LoadSequencer(xLightsXmlFile& xml_file)
     _sequenceElements.SetEffectsNode(EffectsNode);
 
     AddTraceMessage("loading");
+    wxStopWatch sw;
     _sequenceElements.LoadSequencerFile(xml_file, GetShowDirectory());
+    logger_base.debug("Sequence elements and effects loaded in %ldms.", sw.Time());
 
     logger_base.debug("Upgrading sequence");
+    sw.Start();
     xml_file.AdjustEffectSettingsForVersion(_sequenceElements, this);
+    logger_base.debug("Sequence upgraded in %ldms.", sw.Time());
 
     Menu_Settings_Sequence->Enable(true);
 
@@ -788,7 +794,10 @@ void xLightsFrame::LoadSequencer(xLightsXmlFile& xml_file)
     mLastAutosaveCount = mSavedChangeCount;
 
     logger_base.debug("Checking for valid models");
+    sw.Start();
     CheckForValidModels();
+    logger_base.debug("Models checked in %ldms.", sw.Time());
+    _sequenceElements.LogMemoryUsage();
 
     logger_base.debug("Loading the audio data");
     LoadAudioData(xml_file);
@@ -854,22 +863,23 @@ void xLightsFrame::Scrub(wxCommandEvent& event)
     sequenceVideoPanel->UpdateVideo(ms);
 
     //have the frame, copy from SeqData
+    const FrameData& frameData(_seqData[frame]);
     if (playModel != nullptr) {
         int nn = playModel->GetNodeCount();
         for (int node = 0; node < nn; node++) {
             int start = playModel->NodeStartChannel(node);
-            playModel->SetNodeChannelValues(node, &_seqData[frame][start]);
+            playModel->SetNodeChannelValues(node, frameData[start]);
         }
     }
     TimerOutput(frame);
     if (playModel != nullptr) {
         playModel->DisplayEffectOnWindow(_modelPreviewPanel, mPointSize);
     }
-    _housePreviewPanel->GetModelPreview()->Render(&_seqData[frame][0]);
+    _housePreviewPanel->GetModelPreview()->Render(frameData[0]);
     for (auto it = PreviewWindows.begin(); it != PreviewWindows.end(); ++it) {
         ModelPreview* preview = *it;
         if (preview->GetActive()) {
-            preview->Render(&_seqData[frame][0]);
+            preview->Render(frameData[0]);
         }
     }
 }
@@ -1453,6 +1463,8 @@ void xLightsFrame::DoPlaySequence()
 		{
 			playType = PLAY_TYPE_MODEL;
 			playStartMS = -1;
+			_renderAhead = SpecialOptions::GetOption("RenderAhead", "false") == "true";
+			_renderAheadPlayMS = -1;
 			playStartTime = mainSequencer->PanelTimeLine->GetNewStartTimeMS();
 			playEndTime = mainSequencer->PanelTimeLine->GetNewEndTimeMS();
 			if (CurrentSeqXmlFile->GetSequenceType() == "Media") {
@@ -2252,12 +2264,15 @@ void xLightsFrame::TimerRgbSeq(long msec)
             }
         }
     }
+    DispatchRenderAhead();
 
     // Update play status so sequencer grid can allow dropping timings during playback
     mainSequencer->SetPlayStatus(playType);
 
     // return if play is stopped
     if (playType == PLAY_TYPE_STOPPED || CurrentSeqXmlFile == nullptr) {
+        _renderLeadMS = -1;
+        mainSequencer->PanelTimeLine->SetRenderFrontierMS(-1);
         return;
     }
 
@@ -2345,10 +2360,21 @@ void xLightsFrame::TimerRgbSeq(long msec)
             }
             if ((frame % 200) == 0) {
                 static log4cpp::Category &logger_opengl = log4cpp::Category::getInstance(std::string("log_opengl"));
-                logger_opengl.debug("Play fps  %f   (%d ms)", _fps, _seqData.FrameTime());
+                logger_opengl.debug("Play fps  %f   (%d ms) render lead %d ms", _fps, _seqData.FrameTime(), _renderLeadMS);
             }
         }
 
+        // work out how far ahead of the play marker the render has got
+        _renderAheadPlayMS = current_play_time;
+        int frontier = GetRenderFrontierFrame(current_play_time / _seqData.FrameTime());
+        if (frontier == -1) {
+            _renderLeadMS = -1;
+            mainSequencer->PanelTimeLine->SetRenderFrontierMS(-1);
+        } else {
+            _renderLeadMS = std::max(0, frontier * _seqData.FrameTime() - current_play_time);
+            mainSequencer->PanelTimeLine->SetRenderFrontierMS(frontier * _seqData.FrameTime());
+        }
+
         //static wxLongLong ms = wxGetUTCTimeMillis();
         mainSequencer->UpdateTimeDisplay(current_play_time, _fps);
         if (mainSequencer->PanelTimeLine->SetPlayMarkerMS(current_play_time)) {
@@ -2366,23 +2392,28 @@ void xLightsFrame::TimerRgbSeq(long msec)
     }
 
     int frame = curt / _seqData.FrameTime();
+    if (_renderAhead && playType == PLAY_TYPE_MODEL && !IsFrameRendered(frame)) {
+        // the render has not got to this frame yet so leave the last rendered frame showing
+        return;
+    }
     //have the frame, copy from SeqData
+    const FrameData& frameData(_seqData[frame]);
     if (playModel != nullptr) {
         int nn = playModel->GetNodeCount();
         for (int node = 0; node < nn; node++) {
             int start = playModel->NodeStartChannel(node);
-            playModel->SetNodeChannelValues(node, &_seqData[frame][start]);
+            playModel->SetNodeChannelValues(node, frameData[start]);
         }
     }
     TimerOutput(frame);
     if (playModel != nullptr) {
         playModel->DisplayEffectOnWindow(_modelPreviewPanel, mPointSize);
     }
-    _housePreviewPanel->GetModelPreview()->Render(&_seqData[frame][0]);
+    _housePreviewPanel->GetModelPreview()->Render(frameData[0]);
     for (auto it = PreviewWindows.begin(); it != PreviewWindows.end(); ++it) {
         ModelPreview* preview = *it;
         if( preview->GetActive() ) {
-            preview->Render(&_seqData[frame][0]);
+            preview->Render(frameData[0]);
         }
     }
 }
@@ -54,6 +54,7 @@
 #include "HousePreviewPanel.h"
 #include "BatchRenderDialog.h"
 #include "VideoExporter.h"
+#include "SoftwarePreviewRenderer.h"
 #include "JukeboxPanel.h"
 #include "EffectAssist.h"
 #include "EffectsPanel.h"
@@ -477,6 +478,7 @@ xLightsFrame::xLightsFrame(wxWindow* parent, wxWindowID id) : _sequenceElements(
 {
     static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
     logger_base.debug("xLightsFrame being constructed.");
+    _sequenceElements.get_undo_mgr().SetSequenceData(&_seqData);
 
     xLightsApp::__frame = this;
 
@@ -497,6 +499,7 @@ xLightsFrame::xLightsFrame(wxWindow* parent, wxWindowID id) : _sequenceElements(
 
     Bind(EVT_SELECTED_EFFECT_CHANGED, &xLightsFrame::SelectedEffectChanged, this);
     Bind(EVT_RENDER_RANGE, &xLightsFrame::RenderRange, this);
+    Bind(wxEVT_IDLE, &xLightsFrame::OnIdleCompactSeqData, this);
     wxHTTP::Initialize();
 
     //(*Initialize(xLightsFrame)
@@ -3035,45 +3038,86 @@ void xLightsFrame::OnMenuItem_File_Export_VideoSelected(wxCommandEvent& event)
     int audioFrameIndex = 0;
     bool exportStatus = false;
     std::string emsg;
-    try {
-        VideoExporter videoExporter(this, width, height, contentScaleFactor, _seqData.FrameTime(), _seqData.NumFrames(), audioChannelCount, audioSampleRate, path);
-
-        auto audioLambda = [audioMgr, &audioFrameIndex](float* leftCh, float* rightCh, int frameSize) {
-            int trackSize = audioMgr->GetTrackSize();
-            int clampedSize = std::min(frameSize, trackSize - audioFrameIndex);
-            if (clampedSize > 0) {
-                const float* leftptr = audioMgr->GetLeftDataPtr(audioFrameIndex);
-                const float* rightptr = audioMgr->GetRightDataPtr(audioFrameIndex);
-
-                if (leftptr != nullptr) {
-                    std::memcpy(leftCh, leftptr, clampedSize * sizeof(float));
-                    std::memcpy(rightCh, rightptr, clampedSize * sizeof(float));
-                    audioFrameIndex += frameSize;
+    if (SpecialOptions::GetOption("SoftwareVideoExport", "false") == "true") {
+        // draw the frames on the CPU rather than reading them back from the house preview so no OpenGL
+        // is needed ... SoftwareVideoExportViewpoints=true also exports every saved viewpoint at the same time
+        int w = width * contentScaleFactor;
+        int h = height * contentScaleFactor;
+        w += w % 2;
+        h += h % 2;
+        SoftwarePreviewScene scene(housePreview->GetModels());
+        std::list<std::unique_ptr<SoftwarePreviewRenderer>> renderers;
+        std::vector<std::pair<std::string, SoftwarePreviewRenderer*>> views;
+        auto addView = [&](const std::string& viewPath, const PreviewCamera& camera) {
+            renderers.emplace_back(std::make_unique<SoftwarePreviewRenderer>(scene, w, h));
+            SoftwarePreviewRenderer* renderer = renderers.back().get();
+            renderer->SetVirtualCanvasSize(housePreview->GetVirtualCanvasWidth(), housePreview->GetVirtualCanvasHeight(), housePreview->GetDisplay2DCenter0());
+            renderer->SetBackground(housePreview->GetBackgroundImage(), housePreview->GetScaleBackgroundImage(), housePreview->GetBackgroundBrightness(), housePreview->GetBackgroundAlpha());
+            renderer->Prepare(camera);
+            views.push_back({ viewPath, renderer });
+        };
+        addView(path.ToStdString(), housePreview->GetActiveCamera());
+        if (SpecialOptions::GetOption("SoftwareVideoExportViewpoints", "false") == "true") {
+            auto viewpointPath = [&path](const std::string& name) {
+                wxFileName fn(path);
+                wxString safe(name);
+                for (auto it = safe.begin(); it != safe.end(); ++it) {
+                    if (!wxIsalnum(*it)) *it = '_';
                 }
+                fn.SetName(fn.GetName() + "_" + safe);
+                return fn.GetFullPath().ToStdString();
+            };
+            for (int i = 0; i < viewpoint_mgr.GetNum2DCameras(); i++) {
+                addView(viewpointPath(viewpoint_mgr.GetCamera2D(i)->GetName()), *viewpoint_mgr.GetCamera2D(i));
+            }
+            for (int i = 0; i < viewpoint_mgr.GetNum3DCameras(); i++) {
+                addView(viewpointPath(viewpoint_mgr.GetCamera3D(i)->GetName()), *viewpoint_mgr.GetCamera3D(i));
             }
-            return true;
-        };
-
-        if (audioMgr != nullptr) {
-            videoExporter.setGetAudioCallback(audioLambda);
         }
+        logger_base.debug("Exporting %d views using the software renderer.", (int)views.size());
+        exportStatus = SoftwarePreviewRenderer::ExportVideos(this, views, _seqData, audioMgr, emsg);
+    }
+    else {
+        try {
+            VideoExporter videoExporter(this, width, height, contentScaleFactor, _seqData.FrameTime(), _seqData.NumFrames(), audioChannelCount, audioSampleRate, path);
+
+            auto audioLambda = [audioMgr, &audioFrameIndex](float* leftCh, float* rightCh, int frameSize) {
+                int trackSize = audioMgr->GetTrackSize();
+                int clampedSize = std::min(frameSize, trackSize - audioFrameIndex);
+                if (clampedSize > 0) {
+                    const float* leftptr = audioMgr->GetLeftDataPtr(audioFrameIndex);
+                    const float* rightptr = audioMgr->GetRightDataPtr(audioFrameIndex);
+
+                    if (leftptr != nullptr) {
+                        std::memcpy(leftCh, leftptr, clampedSize * sizeof(float));
+                        std::memcpy(rightCh, rightptr, clampedSize * sizeof(float));
+                        audioFrameIndex += frameSize;
+                    }
+                }
+                return true;
+            };
 
-        xlGLCanvas::CaptureHelper captureHelper(width, height, contentScaleFactor);
+            if (audioMgr != nullptr) {
+                videoExporter.setGetAudioCallback(audioLambda);
+            }
 
-        auto videoLambda = [this, housePreview, &captureHelper](uint8_t* buf, int bufSize, unsigned frameIndex) {
-            const FrameData& frameData(this->_seqData[frameIndex]);
-            const uint8_t* data = frameData[0];
-            housePreview->Render(data, false);
-            return captureHelper.ToRGB(buf, bufSize, true);
-        };
-        videoExporter.setGetVideoCallback(videoLambda);
+            xlGLCanvas::CaptureHelper captureHelper(width, height, contentScaleFactor);
 
-        exportStatus = videoExporter.Export();
-    }
-    catch (const std::runtime_error& re) {
-        emsg = (const char*)re.what();
-        logger_base.error("Error exporting video : %s", (const char*)re.what());
-        exportStatus = false;
+            auto videoLambda = [this, housePreview, &captureHelper](uint8_t* buf, int bufSize, unsigned frameIndex) {
+                const FrameData& frameData(this->_seqData[frameIndex]);
+                const uint8_t* data = frameData[0];
+                housePreview->Render(data, false);
+                return captureHelper.ToRGB(buf, bufSize, true);
+            };
+            videoExporter.setGetVideoCallback(videoLambda);
+
+            exportStatus = videoExporter.Export();
+        }
+        catch (const std::runtime_error& re) {
+            emsg = (const char*)re.what();
+            logger_base.error("Error exporting video : %s", (const char*)re.what());
+            exportStatus = false;
+        }
     }
 
     mainSequencer->SetPlayStatus( playStatus );
@@ -4110,10 +4154,23 @@ void xLightsFrame::SetRenderCacheFolder(bool useShow, const std::string& folder)
 
     SetXmlSetting("renderCacheDir", renderCacheDirectory);
     UnsavedRgbEffectsChanges = true;
+    UpdateAudioCacheFolder();
 
     logger_base.debug("Render Cache directory set to : %s.", (const char*)renderCacheDirectory.c_str());
 }
 
+// the decoded audio cache lives with the render cache and follows its settings
+std::string xLightsFrame::GetAudioCacheFolder() const
+{
+    if (renderCacheDirectory == "") return "";
+    return renderCacheDirectory + wxFileName::GetPathSeparator() + "AudioCache";
+}
+
+void xLightsFrame::UpdateAudioCacheFolder()
+{
+    AudioManager::SetCacheFolder(_enableRenderCache == "Disabled" ? "" : GetAudioCacheFolder());
+}
+
 void xLightsFrame::GetBackupFolder(bool& useShow, std::string& folder)
 {
     useShow = (showDirectory == _backupDirectory);
@@ -6277,7 +6334,10 @@ void xLightsFrame::ValidateEffectAssets()
 void xLightsFrame::CheckEffect(Effect* ef, wxFile& f, size_t& errcount, size_t& warncount, const std::string& name, const std::string& modelName, bool node, bool& videoCacheWarning, bool& disabledEffects, std::list<std::pair<std::string, std::string>>& faces, std::list<std::pair<std::string, std::string>>& states, std::list<std::string>& viewPoints)
 {
     EffectManager& em = _sequenceElements.GetEffectManager();
-    SettingsMap& sm = ef->GetSettings();
+    // read through the const effect so checking doesn't take every effect's shared settings for writing ...
+    // the map is held as the effect checks below are handed the effect and could change its settings
+    std::shared_ptr<const SettingsMap> settings = static_cast<const Effect*>(ef)->GetSettingsPtr();
+    const SettingsMap& sm = *settings;
 
     if (ef->GetEffectName() == "Video")
     {
@@ -6625,7 +6685,7 @@ int xLightsFrame::ExportNodes(wxFile& f, StrandElement* e, NodeLayer* nl, int n,
             effectTotalTime[ef->GetEffectName()] = duration;
         }
 
-        SettingsMap& sm = ef->GetSettings();
+        const SettingsMap& sm = static_cast<const Effect*>(ef)->GetSettings();
         f.Write(wxString::Format("\"%s\",%02d:%02d.%03d,%02d:%02d.%03d,%02d:%02d.%03d,\"%s\",\"%s\",%s,%s\n",
             ef->GetEffectName(),
             ef->GetStartTimeMS() / 60000,
@@ -6719,7 +6779,7 @@ int xLightsFrame::ExportElement(wxFile& f, Element* e, std::map<std::string, int
                     effectTotalTime[ef->GetEffectName()] = duration;
                 }
 
-                SettingsMap& sm = ef->GetSettings();
+                const SettingsMap& sm = static_cast<const Effect*>(ef)->GetSettings();
                 f.Write(wxString::Format("\"%s\",%02d:%02d.%03d,%02d:%02d.%03d,%02d:%02d.%03d,\"%s\",\"%s\",%s,%s\n",
                     ef->GetEffectName(),
                     ef->GetStartTimeMS() / 60000,
@@ -7625,7 +7685,9 @@ void xLightsFrame::TimerOutput(int period)
 {
     if (CheckBoxLightOutput->IsChecked())
     {
-        _outputManager.SetManyChannels(0, &_seqData[period][0], _seqData.NumChannels());
+        // read through the const frame so playing a sparse sequence does not allocate the frames
+        const FrameData& frame(_seqData[period]);
+        _outputManager.SetManyChannels(0, frame[0], _seqData.NumChannels());
     }
 }
 
@@ -9298,6 +9360,7 @@ void xLightsFrame::OnMenuItemUserDictSelected(wxCommandEvent& event)
 void xLightsFrame::OnMenuItem_PurgeRenderCacheSelected(wxCommandEvent& event)
 {
     _renderCache.Purge(&_sequenceElements, true);
+    AudioManager::PurgeCache(GetAudioCacheFolder());
 }
 
 void xLightsFrame::SetEnableRenderCache(const wxString &t)
@@ -9308,6 +9371,10 @@ void xLightsFrame::SetEnableRenderCache(const wxString &t)
     }
     _renderCache.Enable(_enableRenderCache);
     _renderCache.CleanupCache(&_sequenceElements); // purge anything the cache no longer needs
+    UpdateAudioCacheFolder();
+    if (_enableRenderCache == "Disabled") {
+        AudioManager::PurgeCache(GetAudioCacheFolder());
+    }
 
     if (_renderCache.IsEnabled() && CurrentSeqXmlFile != nullptr) {
         // this will force a reload of the cache
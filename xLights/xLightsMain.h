@@ -207,6 +207,7 @@ class BufferPanel;
 class LayoutPanel;
 class RenderProgressDialog;
 class RenderProgressInfo;
+class SharedRenderFrames;
 class wxLed;
 
 class xlAuiToolBar : public wxAuiToolBar {
@@ -410,13 +411,16 @@ public:
     bool ImportSuperStar(Element *el, wxXmlDocument &doc, int x_size, int y_size,
                          int x_offset, int y_offset,
                          int imageResizeType, const wxSize &modelSize, const wxString& layerBlend);
-    bool ImportLMS(wxXmlDocument &doc, const wxFileName &filename);
-    bool ImportLPE(wxXmlDocument &doc, const wxFileName &filename);
+    // effectsPending means doc only holds the channel list and the mapped channels effects are read from filename once mapped
+    bool ImportLMS(wxXmlDocument &doc, const wxFileName &filename, bool effectsPending = false);
+    bool ImportLPE(wxXmlDocument &doc, const wxFileName &filename, bool effectsPending = false);
     bool ImportVixen3(const wxFileName &filename);
-    bool ImportS5(wxXmlDocument &doc, const wxFileName &filename);
+    bool ImportS5(wxXmlDocument &doc, const wxFileName &filename, bool effectsPending = false);
 
     void SuspendRender(bool suspend) { _suspendRender = suspend; }
     bool IsRenderSuspended() const { return _suspendRender; }
+    // how far the render is ahead of the play marker ... -1 if nothing ahead of it is waiting to render
+    int GetRenderLeadMS() const { return _renderLeadMS; }
 
     //(*Handlers(xLightsFrame)
     void OnQuit(wxCommandEvent& event);
@@ -1010,6 +1014,8 @@ public:
     void SetFSEQFolder(bool useShow, const std::string& folder);
     void GetRenderCacheFolder(bool& useShow, std::string& folder);
     void SetRenderCacheFolder(bool useShow, const std::string& folder);
+    std::string GetAudioCacheFolder() const;
+    void UpdateAudioCacheFolder();
 
     void GetBackupFolder(bool& useShow, std::string& folder);
     void SetBackupFolder(bool useShow, const std::string& folder);
@@ -1192,9 +1198,27 @@ public:
     void DoPostStartupCommands();
     
     std::list<RenderProgressInfo *>renderProgressInfo;
+    // set when a render finishes on sparse sequence data ... the idle handler compacts it once it is safe
+    bool _compactSeqDataPending = false;
     std::queue<RenderEvent*> mainThreadRenderEvents;
     std::mutex renderEventLock;
 
+    // While playing with RenderAhead=true frames behind the play marker are held back here
+    // so the frames about to be shown render first
+    struct RenderAheadRange
+    {
+        std::string model;
+        int startFrame;
+        int endFrame;
+    };
+    std::list<RenderAheadRange> _renderAheadQueue;
+    // set while Render sets up a render which hands its frames on a window at a time
+    int _renderWindowFrames = 0;
+    std::function<void(int, int)> _renderWindowCallback;
+    bool _renderAhead = false;
+    int _renderAheadPlayMS = -1;
+    int _renderLeadMS = -1;
+
     std::string _permanentShowFolder;
     std::string mediaFilename;
     std::string showDirectory;
@@ -1265,9 +1289,17 @@ public:
     bool InitPixelBuffer(const std::string &modelName, PixelBufferClass &buffer, int layerCount, bool zeroBased = false);
     Model *GetModel(const std::string& name) const;
     void RenderGridToSeqData(std::function<void()>&& callback);
+    // renders the whole sequence handing each window of frames to windowDone, in order, as soon as it is complete
+    void RenderGridToSeqDataWindowed(int windowFrames, std::function<void(int, int)>&& windowDone, std::function<void()>&& callback);
+    bool IsWindowedRenderPossible();
+    bool RenderGridToFalconPiFile(const wxString& filename, std::function<void()>&& callback);
     bool AbortRender(int maxTimeMs = 60000);
     std::string GetSelectedLayoutPanelPreview() const;
     void UpdateRenderStatus();
+    void UpdateRenderWindow(RenderProgressInfo* rpi, bool done);
+    bool CanCompactSeqData() const;
+    void OnIdleCompactSeqData(wxIdleEvent& event);
+    void LogSharedFrames(SharedRenderFrames* sharedFrames);
     void LogRenderStatus();
     bool RenderEffectFromMap(bool suppress, Effect *effect, int layer, int period, SettingsMap& SettingsMap,
                              PixelBufferClass &buffer, bool &ResetEffectState,
@@ -1275,6 +1307,10 @@ public:
     void RenderMainThreadEffects();
     void RenderEffectOnMainThread(RenderEvent *evt);
     void RenderEffectForModel(const std::string &model, int startms, int endms, bool clear = false);
+    bool IsRenderingAhead() const;
+    void DispatchRenderAhead();
+    int GetRenderFrontierFrame(int frame) const;
+    bool IsFrameRendered(int frame) const { return GetRenderFrontierFrame(frame) != frame; }
     void RenderDirtyModels();
     void RenderTimeSlice(int startms, int endms, bool clear);
     void Render(SequenceElements& seqElements,
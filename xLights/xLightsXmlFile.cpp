@@ -10,6 +10,7 @@
 
 #include <wx/tokenzr.h>
 #include <wx/regex.h>
+#include <wx/stopwatch.h>
 #include <wx/numdlg.h>
 #include <wx/zipstrm.h>
 #include <wx/wfstream.h>
@@ -30,6 +31,7 @@
 #include "xLightsVersion.h"
 #include "UtilFunctions.h"
 #include "sequencer/TimeLine.h"
+#include "sequencer/BinarySequenceFile.h"
 #include "Vixen3.h"
 
 #include <log4cpp/Category.hh>
@@ -1120,11 +1122,13 @@ bool xLightsXmlFile::LoadSequence(const wxString& ShowDir, bool ignore_audio)
     static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
     logger_base.info("LoadSequence: Loading sequence " + GetFullPath());
 
+    wxStopWatch sw;
 	if (!seqDocument.Load(GetFullPath()))
 	{
 		logger_base.error("LoadSequence: XML file load failed.");
 		return false;
 	}
+    logger_base.debug("LoadSequence: XML parsed in %ldms.", sw.Time());
     is_open = true;
 
     wxXmlNode* root=seqDocument.GetRoot();
@@ -2967,6 +2971,16 @@ void xLightsXmlFile::Save( SequenceElements& seq_elements)
 #endif
     
     seqDocument.Save(GetFullPath());
+
+    if (GetExt().Lower() == "xsq") {
+        if (BinarySequenceFile::IsEnabled()) {
+            BinarySequenceFile::Write(GetFullPath().ToStdString(), seq_elements);
+        }
+        else if (wxFileExists(BinarySequenceFile::GetSidecarPath(GetFullPath().ToStdString()))) {
+            // dont leave a sidecar which no longer matches the xsq
+            wxRemoveFile(BinarySequenceFile::GetSidecarPath(GetFullPath().ToStdString()));
+        }
+    }
 }
 
 bool xLightsXmlFile::TimingAlreadyExists(const std::string & section, xLightsFrame* xLightsParent)
@@ -3100,6 +3114,8 @@ void xLightsXmlFile::AdjustEffectSettingsForVersion(SequenceElements& elements,
                         Effect* eff = layer->GetEffect(k);
                         if (eff != nullptr && eff->GetEffectIndex() >= 0 && effects[eff->GetEffectIndex()] != nullptr) {
                             effects[eff->GetEffectIndex()]->adjustSettings(ver, eff);
+                            // upgrading gave the effect its own settings ... share them again with effects upgraded the same way
+                            eff->ShareSettings();
                         }
                     }
                 }
@@ -3111,6 +3127,7 @@ void xLightsXmlFile::AdjustEffectSettingsForVersion(SequenceElements& elements,
                             Effect* eff = layer->GetEffect(k);
                             if (eff != nullptr && eff->GetEffectIndex() >= 0 && effects[eff->GetEffectIndex()] != nullptr) {
                                 effects[eff->GetEffectIndex()]->adjustSettings(ver, eff);
+                                eff->ShareSettings();
                             }
                         }
                     }
@@ -3122,6 +3139,7 @@ void xLightsXmlFile::AdjustEffectSettingsForVersion(SequenceElements& elements,
                                 Effect* eff = nlayer->GetEffect(l);
                                 if (eff != nullptr && eff->GetEffectIndex() >= 0 && effects[eff->GetEffectIndex()] != nullptr) {
                                     effects[eff->GetEffectIndex()]->adjustSettings(ver, eff);
+                                    eff->ShareSettings();
                                 }
                             }
                         }
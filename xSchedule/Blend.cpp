@@ -10,22 +10,7 @@
 
 
 #include "Blend.h"
-
-//#define SIMD
-
-#ifdef SIMD
-#include "emmintrin.h"
-#define ALIGNMENT (128 / 8)
-
-int GetMisalignedBytes(uint8_t* b1, uint8_t* b2)
-{
-    int m1 = (size_t)b1 % ALIGNMENT;
-    int m2 = (size_t)b2 % ALIGNMENT;
-
-    if (m1 == m2) return m1;
-    return -1;
-}
-#endif
+#include "BlendKernels.h"
 
 void PopulateBlendModes(wxChoice* choice)
 {
@@ -155,367 +140,61 @@ void Blend(uint8_t* buffer, size_t bufferSize, uint8_t* blendBuffer, size_t blen
 
 void Overwrite(uint8_t* buffer, uint8_t* blendBuffer, size_t channels)
 {
-    memcpy(buffer, blendBuffer, channels);
+    BlendKernels::Overwrite(buffer, blendBuffer, channels);
 }
 
 void OverwriteIfZero(uint8_t* buffer, uint8_t* blendBuffer, size_t channels)
 {
-#ifdef SIMD
-    int misaligned = GetMisalignedBytes(buffer, blendBuffer);
-    if (misaligned >= 0 && (channels - misaligned) >= ALIGNMENT) // we can only use SIMD if misalignment is the same for both buffers and we have the minimum number of bytes to do
-    {
-        // do the misaligned
-        for (size_t i = 0; i < misaligned; ++i)
-        {
-            if (*(buffer + i) == 0x00)
-            {
-                *(buffer + i) = *(blendBuffer + i);
-            }
-        }
-
-        __m128i zero = _mm_setr_epi32(0, 0, 0, 0);
-        int simd = channels / ALIGNMENT;
-        for (size_t i = 0; i < simd; ++i)
-        {
-            size_t offset = misaligned + i * ALIGNMENT;
-            __m128i b = _mm_load_si128((__m128i*)(buffer + offset));
-            __m128i bb = _mm_load_si128((__m128i*)(blendBuffer + offset));
-
-            __m128i mask = _mm_cmpeq_epi8(b, zero); // sets FF where B is zero
-            __m128i newv = _mm_and_si128(mask, bb); // grab bb where B has zero
-            __m128i r = _mm_or_si128(b, newv); // merge them
-
-            _mm_store_si128((__m128i*)(buffer + offset), r);
-        }
-
-        // do the residual
-        for (size_t i = 0; i < channels % ALIGNMENT; ++i)
-        {
-            size_t offset = misaligned + i + simd * ALIGNMENT;
-            if (*(buffer + offset) == 0)
-            {
-                *(buffer + offset) = *(blendBuffer + offset);
-            }
-        }
-    }
-    else
-#endif
-    {
-        for (size_t i = 0; i < channels; ++i)
-        {
-            if (*(buffer + i) == 0x00)
-            {
-                *(buffer + i) = *(blendBuffer + i);
-            }
-        }
-    }
+    BlendKernels::OverwriteIfZero(buffer, blendBuffer, channels);
 }
 
 void Mask(uint8_t* buffer, uint8_t* blendBuffer, size_t channels)
 {
-#ifdef SIMD
-    int misaligned = GetMisalignedBytes(buffer, blendBuffer);
-    if (misaligned >= 0 && (channels - misaligned) >= ALIGNMENT) // we can only use SIMD if misalignment is the same for both buffers and we have the minimum number of bytes to do
-    {
-        // do the misaligned
-        for (size_t i = 0; i < misaligned; ++i)
-        {
-            if (*(blendBuffer + i) > 0)
-            {
-                *(buffer + i) = 0x00;
-            }
-        }
-
-        __m128i zero = _mm_setr_epi32(0, 0, 0, 0);
-        int simd = channels / ALIGNMENT;
-
-        for (size_t i = 0; i < simd; ++i)
-        {
-            size_t offset = misaligned + i * ALIGNMENT;
-            __m128i b = _mm_load_si128((__m128i*)(buffer + offset));
-            __m128i bb = _mm_load_si128((__m128i*)(blendBuffer + offset));
-
-            __m128i mask = _mm_cmpeq_epi8(bb, zero); // sets FF where BB is zero
-            __m128i r = _mm_and_si128(mask, b); // and the mask
-
-            _mm_store_si128((__m128i*)(buffer + offset), r);
-        }
-
-        // do the residual
-        for (size_t i = 0; i < channels % ALIGNMENT; ++i)
-        {
-            size_t offset = misaligned + i + simd * ALIGNMENT;
-            if (*(blendBuffer + offset) > 0)
-            {
-                *(buffer + offset) = 0x00;
-            }
-        }
-    }
-    else
-#endif
-    {
-        for (size_t i = 0; i < channels; ++i)
-        {
-            if (*(blendBuffer + i) > 0)
-            {
-                *(buffer + i) = 0x00;
-            }
-        }
-    }
+    BlendKernels::Mask(buffer, blendBuffer, channels);
 }
 
 void MaskPixel(uint8_t* buffer, uint8_t* blendBuffer, size_t pixels)
 {
-    for (size_t i = 0; i < pixels; ++i)
-    {
-        uint8_t* p = blendBuffer + i * 3;
-        auto sum = *p + *(p + 1) + *(p + 2);
-        if (sum > 0)
-        {
-            uint8_t* pp = buffer + i * 3;
-            *pp = 0x00;
-            *(pp + 1) = 0x00;
-            *(pp + 2) = 0x00;
-        }
-    }
+    BlendKernels::MaskPixel(buffer, blendBuffer, pixels);
 }
 
 void Unmask(uint8_t* buffer, uint8_t* blendBuffer, size_t channels)
 {
-#ifdef SIMD
-    int misaligned = GetMisalignedBytes(buffer, blendBuffer);
-    if (misaligned >= 0 && (channels - misaligned) >= ALIGNMENT) // we can only use SIMD if misalignment is the same for both buffers and we have the minimum number of bytes to do
-    {
-        // do the misaligned
-        for (size_t i = 0; i < misaligned; ++i)
-        {
-            if (*(blendBuffer + i) == 0)
-            {
-                *(buffer + i) = 0x00;
-            }
-        }
-
-        __m128i zero = _mm_setr_epi32(0, 0, 0, 0);
-        int simd = channels / ALIGNMENT;
-        for (size_t i = 0; i < simd; ++i)
-        {
-            size_t offset = misaligned + i * ALIGNMENT;
-            __m128i b = _mm_load_si128((__m128i*)(buffer + offset));
-            __m128i bb = _mm_load_si128((__m128i*)(blendBuffer + offset));
-
-            __m128i mask = _mm_cmpeq_epi8(bb, zero); // sets FF where BB is zero
-            __m128i r = _mm_andnot_si128(mask, b); // invert the mask and then and it
-
-            _mm_store_si128((__m128i*)(buffer + offset), r);
-        }
-
-        // do the residual
-        for (size_t i = 0; i < channels % ALIGNMENT; ++i)
-        {
-            size_t offset = misaligned + i + simd * ALIGNMENT;
-            if (*(blendBuffer + offset) == 0)
-            {
-                *(buffer + offset) = 0x00;
-            }
-        }
-    }
-    else
-#endif
-    {
-        for (size_t i = 0; i < channels; ++i)
-        {
-            if (*(blendBuffer + i) == 0)
-            {
-                *(buffer + i) = 0x00;
-            }
-        }
-    }
+    BlendKernels::Unmask(buffer, blendBuffer, channels);
 }
 
 void UnmaskPixel(uint8_t* buffer, uint8_t* blendBuffer, size_t pixels)
 {
-    for (size_t i = 0; i < pixels; ++i)
-    {
-        uint8_t* p = blendBuffer + i * 3;
-        auto sum = *p + *(p + 1) + *(p + 2);
-        if (sum == 0)
-        {
-            uint8_t* pp = buffer + i * 3;
-            *pp = 0x00;
-            *(pp + 1) = 0x00;
-            *(pp + 2) = 0x00;
-        }
-    }
+    BlendKernels::UnmaskPixel(buffer, blendBuffer, pixels);
 }
 
 void Average(uint8_t* buffer, uint8_t* blendBuffer, size_t channels)
 {
-#ifdef SIMD
-    int misaligned = GetMisalignedBytes(buffer, blendBuffer);
-    if (misaligned >= 0 && (channels - misaligned) >= ALIGNMENT) // we can only use SIMD if misalignment is the same for both buffers and we have the minimum number of bytes to do
-    {
-        // do the misaligned
-        for (size_t i = 0; i < misaligned; ++i)
-        {
-            *(buffer + i) = (uint8_t)(((int)*(buffer + i) + (int)*(blendBuffer + i)) / 2);
-        }
-
-        int simd = channels / ALIGNMENT;
-        for (size_t i = 0; i < simd; ++i)
-        {
-            size_t offset = misaligned + i * ALIGNMENT;
-            __m128i b = _mm_load_si128((__m128i*)(buffer + offset));
-            __m128i bb = _mm_load_si128((__m128i*)(blendBuffer + offset));
-
-            __m128i r = _mm_avg_epu8(b, bb);
-
-            _mm_store_si128((__m128i*)(buffer + offset), r);
-        }
-
-        // do the residual
-        for (size_t i = 0; i < channels % ALIGNMENT; ++i)
-        {
-            size_t offset = i + misaligned + simd * ALIGNMENT;
-            *(buffer + offset) = (uint8_t)(((int)*(buffer + offset) + (int)*(blendBuffer + offset)) / 2);
-        }
-    }
-    else
-#endif
-    {
-        for (size_t i = 0; i < channels; ++i)
-        {
-            *(buffer + i) = (uint8_t)(((int)*(buffer + i) + (int)*(blendBuffer + i)) / 2);
-        }
-    }
+    BlendKernels::Average(buffer, blendBuffer, channels);
 }
 
 void Maximum(uint8_t* buffer, uint8_t* blendBuffer, size_t channels)
 {
-#ifdef SIMD
-    int misaligned = GetMisalignedBytes(buffer, blendBuffer);
-    if (misaligned >= 0 && (channels - misaligned) >= ALIGNMENT) // we can only use SIMD if misalignment is the same for both buffers and we have the minimum number of bytes to do
-    {
-        // do the misaligned
-        for (size_t i = 0; i < misaligned; ++i)
-        {
-            *(buffer + i) = std::max(*(buffer + i), *(blendBuffer + i));
-        }
-
-        // do the aligned pieces using SIMD instructions ... up to 16 times faster
-        int simd = (channels - misaligned) / ALIGNMENT;
-        for (size_t i = 0; i < simd; ++i)
-        {
-            size_t offset = misaligned + i * ALIGNMENT;
-            __m128i b = _mm_load_si128((__m128i*)(buffer + offset));
-            __m128i bb = _mm_load_si128((__m128i*)(blendBuffer + offset));
-
-            __m128i r = _mm_max_epu8(b, bb);
-
-            _mm_store_si128((__m128i*)(buffer + offset), r);
-                                }
-
-        // do the residual part at the end where we dont have enough bytes to process
-        for (size_t i = 0; i < channels % ALIGNMENT; ++i)
-        {
-            size_t offset = i + misaligned + simd * ALIGNMENT;
-            *(buffer + offset) = std::max(*(buffer + offset), *(blendBuffer + offset));
-        }
-    }
-    else
-#endif
-    {
-        for (size_t i = 0; i < channels; ++i)
-        {
-            *(buffer + i) = std::max(*(buffer + i), *(blendBuffer + i));
-        }
-    }
+    BlendKernels::Maximum(buffer, blendBuffer, channels);
 }
 
 void Minimum(uint8_t* buffer, uint8_t* blendBuffer, size_t channels)
 {
-#ifdef SIMD
-    int misaligned = GetMisalignedBytes(buffer, blendBuffer);
-
-    if (misaligned >= 0 && (channels - misaligned) >= ALIGNMENT) // we can only use SIMD if misalignment is the same for both buffers and we have the minimum number of bytes to do
-    {
-        // do the misaligned
-        for (size_t i = 0; i < misaligned; ++i)
-        {
-            *(buffer + i) = std::min(*(buffer + i), *(blendBuffer + i));
-        }
-
-        int simd = channels / ALIGNMENT;
-        for (size_t i = 0; i < simd; ++i)
-        {
-            size_t offset = misaligned + i * ALIGNMENT;
-            __m128i b = _mm_load_si128((__m128i*)(buffer + offset));
-            __m128i bb = _mm_load_si128((__m128i*)(blendBuffer + offset));
-
-            __m128i r = _mm_min_epu8(b, bb);
-
-            _mm_store_si128((__m128i*)(buffer + offset), r);
-        }
-
-        // do the residual
-        for (size_t i = 0; i < channels % ALIGNMENT; ++i)
-        {
-            size_t offset = i + misaligned + simd * ALIGNMENT;
-            *(buffer + offset) = std::min(*(buffer + offset), *(blendBuffer + offset));
-        }
-    }
-    else
-#endif
-    {
-        for (size_t i = 0; i < channels; ++i)
-        {
-            *(buffer + i) = std::min(*(buffer + i), *(blendBuffer + i));
-        }
-    }
+    BlendKernels::Minimum(buffer, blendBuffer, channels);
 }
 
 void OverwriteIfBlack(uint8_t* buffer, uint8_t* blendBuffer, size_t pixels)
 {
-    for (size_t i = 0; i < pixels; ++i)
-    {
-        uint8_t* p = buffer + i * 3;
-        auto sum = *p + *(p + 1) + *(p + 2);
-        if (sum == 0)
-        {
-            uint8_t* pp = blendBuffer + i * 3;
-            *p = *pp;
-            *(p + 1) = *(pp + 1);
-            *(p + 2) = *(pp + 2);
-        }
-    }
+    BlendKernels::OverwriteIfBlack(buffer, blendBuffer, pixels);
 }
 
 void OverwriteSkipBlack(uint8_t* buffer, uint8_t* blendBuffer, size_t pixels)
 {
-    for (size_t i = 0; i < pixels; ++i)
-    {
-        uint8_t* pp = blendBuffer + i * 3;
-        auto sum = *pp + *(pp + 1) + *(pp + 2);
-        if (sum > 0)
-        {
-            uint8_t* p = buffer + i * 3;
-            *p = *pp;
-            *(p + 1) = *(pp + 1);
-            *(p + 2) = *(pp + 2);
-        }
-    }
+    BlendKernels::OverwriteSkipBlack(buffer, blendBuffer, pixels);
 }
 
 // apply the input data as if it was (inputvalue / 255) * currentvalue ... ie a brightness
 void Brightness(uint8_t* buffer, uint8_t* blendBuffer, size_t pixels)
 {
-    uint8_t* p = buffer;
-    uint8_t* pp = blendBuffer;
-    for (size_t i = 0; i < pixels * 3; ++i)         {
-        if (*pp == 0)             {
-            *p = 0;
-        }
-        else if (*pp != 255)             {
-            *p = ((int)*p * (int)*pp) / 255;
-        }
-    }
-}
\ No newline at end of file
+    BlendKernels::Brightness(buffer, blendBuffer, pixels);
+}
@@ -0,0 +1,587 @@
+/***************************************************************
+ * This source files comes from the xLights project
+ * https://www.xlights.org
+ * https://github.com/smeighan/xLights
+ * See the github commit history for a record of contributing
+ * developers.
+ * Copyright claimed based on commit dates recorded in Github
+ * License: https://github.com/smeighan/xLights/blob/master/License.txt
+ **************************************************************/
+
+#include "BlendKernels.h"
+
+#include <algorithm>
+#include <cstring>
+
+// BLENDKERNELS_SCALAR forces the plain C++ code ... used by BlendKernelsTest to check the vector code against it
+#if defined(BLENDKERNELS_SCALAR)
+#elif defined(__AVX2__)
+#define BLEND_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BLEND_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define BLEND_NEON
+#include <arm_neon.h>
+#endif
+
+#if defined(BLEND_AVX2) || defined(BLEND_SSE2) || defined(BLEND_NEON)
+#define BLEND_SIMD
+#endif
+
+#pragma region ChannelMask
+
+ChannelMask ChannelMask::FromOneBasedList(const std::list<int>& channels, size_t size)
+{
+    ChannelMask res(size);
+    for (const auto& it : channels) {
+        if (it >= 1 && (size_t)it <= size) {
+            res.Set(it - 1);
+        }
+    }
+    return res;
+}
+
+void ChannelMask::Resize(size_t channels)
+{
+    size_t padded = (channels + 63) & ~(size_t)63;
+    _bits.resize(padded / 64, 0);
+    _lanes.resize(padded, 0);
+}
+
+void ChannelMask::Set(size_t channel)
+{
+    if (channel >= _lanes.size()) Resize(channel + 1);
+    if (!IsSet(channel)) {
+        _bits[channel >> 6] |= (1ULL << (channel & 63));
+        _lanes[channel] = 0xFF;
+        ++_count;
+    }
+}
+
+void ChannelMask::Clear()
+{
+    std::fill(_bits.begin(), _bits.end(), 0);
+    std::fill(_lanes.begin(), _lanes.end(), 0);
+    _count = 0;
+}
+
+#pragma endregion
+
+#pragma region Vector primitives
+
+namespace
+{
+    // The primitives below are the only place the instruction set matters. The kernels further
+    // down are written once against them and finish each buffer with the scalar reference code.
+
+#if defined(BLEND_AVX2)
+    typedef __m256i vu8;
+    constexpr size_t VW = 32;
+    inline vu8 Load(const uint8_t* p) { return _mm256_loadu_si256((const __m256i*)p); }
+    inline void Store(uint8_t* p, vu8 v) { _mm256_storeu_si256((__m256i*)p, v); }
+    inline vu8 Zero() { return _mm256_setzero_si256(); }
+    inline vu8 Max(vu8 a, vu8 b) { return _mm256_max_epu8(a, b); }
+    inline vu8 Min(vu8 a, vu8 b) { return _mm256_min_epu8(a, b); }
+    inline vu8 And(vu8 a, vu8 b) { return _mm256_and_si256(a, b); }
+    inline vu8 Or(vu8 a, vu8 b) { return _mm256_or_si256(a, b); }
+    inline vu8 AndNot(vu8 mask, vu8 v) { return _mm256_andnot_si256(mask, v); }
+    inline vu8 IsZero(vu8 a) { return _mm256_cmpeq_epi8(a, Zero()); }
+    inline bool AllSet(vu8 mask) { return (uint32_t)_mm256_movemask_epi8(mask) == 0xFFFFFFFF; }
+    inline bool AnySet(vu8 mask) { return _mm256_movemask_epi8(mask) != 0; }
+    // _mm256_avg_epu8 rounds up, the scalar code rounds down
+    inline vu8 AverageDown(vu8 a, vu8 b) { return _mm256_sub_epi8(_mm256_avg_epu8(a, b), _mm256_and_si256(_mm256_xor_si256(a, b), _mm256_set1_epi8(1))); }
+
+    // exact (a * b) / 255 for 16 bit products using (t + 1 + (t >> 8)) >> 8
+    inline __m256i Div255(__m256i t) { return _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(t, _mm256_set1_epi16(1)), _mm256_srli_epi16(t, 8)), 8); }
+    inline vu8 MulDiv255(vu8 a, vu8 b)
+    {
+        // unpack and pack both work within 128 bit lanes so the byte order is preserved
+        __m256i lo = Div255(_mm256_mullo_epi16(_mm256_unpacklo_epi8(a, Zero()), _mm256_unpacklo_epi8(b, Zero())));
+        __m256i hi = Div255(_mm256_mullo_epi16(_mm256_unpackhi_epi8(a, Zero()), _mm256_unpackhi_epi8(b, Zero())));
+        return _mm256_packus_epi16(lo, hi);
+    }
+
+    // exact t / 100 for t <= 25500 using (t * 41944) >> 22
+    inline __m256i Div100(__m256i t) { return _mm256_srli_epi16(_mm256_mulhi_epu16(t, _mm256_set1_epi16((short)41944)), 6); }
+    inline vu8 MulPercent(vu8 a, int percent)
+    {
+        __m256i p = _mm256_set1_epi16((short)percent);
+        __m256i lo = Div100(_mm256_mullo_epi16(_mm256_unpacklo_epi8(a, Zero()), p));
+        __m256i hi = Div100(_mm256_mullo_epi16(_mm256_unpackhi_epi8(a, Zero()), p));
+        return _mm256_packus_epi16(lo, hi);
+    }
+
+    inline __m256i Fade32(__m256i a, __m256i b, __m256 inv, __m256 pos)
+    {
+        return _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(a), inv), _mm256_mul_ps(_mm256_cvtepi32_ps(b), pos)));
+    }
+    inline __m256i Fade16(__m256i a, __m256i b, __m256 inv, __m256 pos)
+    {
+        __m256i lo = Fade32(_mm256_unpacklo_epi16(a, Zero()), _mm256_unpacklo_epi16(b, Zero()), inv, pos);
+        __m256i hi = Fade32(_mm256_unpackhi_epi16(a, Zero()), _mm256_unpackhi_epi16(b, Zero()), inv, pos);
+        return _mm256_packs_epi32(lo, hi);
+    }
+    inline vu8 Fade(vu8 a, vu8 b, float inv, float pos)
+    {
+        __m256 vinv = _mm256_set1_ps(inv);
+        __m256 vpos = _mm256_set1_ps(pos);
+        __m256i lo = Fade16(_mm256_unpacklo_epi8(a, Zero()), _mm256_unpacklo_epi8(b, Zero()), vinv, vpos);
+        __m256i hi = Fade16(_mm256_unpackhi_epi8(a, Zero()), _mm256_unpackhi_epi8(b, Zero()), vinv, vpos);
+        return _mm256_packus_epi16(lo, hi);
+    }
+#elif defined(BLEND_SSE2)
+    typedef __m128i vu8;
+    constexpr size_t VW = 16;
+    inline vu8 Load(const uint8_t* p) { return _mm_loadu_si128((const __m128i*)p); }
+    inline void Store(uint8_t* p, vu8 v) { _mm_storeu_si128((__m128i*)p, v); }
+    inline vu8 Zero() { return _mm_setzero_si128(); }
+    inline vu8 Max(vu8 a, vu8 b) { return _mm_max_epu8(a, b); }
+    inline vu8 Min(vu8 a, vu8 b) { return _mm_min_epu8(a, b); }
+    inline vu8 And(vu8 a, vu8 b) { return _mm_and_si128(a, b); }
+    inline vu8 Or(vu8 a, vu8 b) { return _mm_or_si128(a, b); }
+    inline vu8 AndNot(vu8 mask, vu8 v) { return _mm_andnot_si128(mask, v); }
+    inline vu8 IsZero(vu8 a) { return _mm_cmpeq_epi8(a, Zero()); }
+    inline bool AllSet(vu8 mask) { return _mm_movemask_epi8(mask) == 0xFFFF; }
+    inline bool AnySet(vu8 mask) { return _mm_movemask_epi8(mask) != 0; }
+    // _mm_avg_epu8 rounds up, the scalar code rounds down
+    inline vu8 AverageDown(vu8 a, vu8 b) { return _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), _mm_set1_epi8(1))); }
+
+    // exact (a * b) / 255 for 16 bit products using (t + 1 + (t >> 8)) >> 8
+    inline __m128i Div255(__m128i t) { return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(t, _mm_set1_epi16(1)), _mm_srli_epi16(t, 8)), 8); }
+    inline vu8 MulDiv255(vu8 a, vu8 b)
+    {
+        __m128i lo = Div255(_mm_mullo_epi16(_mm_unpacklo_epi8(a, Zero()), _mm_unpacklo_epi8(b, Zero())));
+        __m128i hi = Div255(_mm_mullo_epi16(_mm_unpackhi_epi8(a, Zero()), _mm_unpackhi_epi8(b, Zero())));
+        return _mm_packus_epi16(lo, hi);
+    }
+
+    // exact t / 100 for t <= 25500 using (t * 41944) >> 22
+    inline __m128i Div100(__m128i t) { return _mm_srli_epi16(_mm_mulhi_epu16(t, _mm_set1_epi16((short)41944)), 6); }
+    inline vu8 MulPercent(vu8 a, int percent)
+    {
+        __m128i p = _mm_set1_epi16((short)percent);
+        __m128i lo = Div100(_mm_mullo_epi16(_mm_unpacklo_epi8(a, Zero()), p));
+        __m128i hi = Div100(_mm_mullo_epi16(_mm_unpackhi_epi8(a, Zero()), p));
+        return _mm_packus_epi16(lo, hi);
+    }
+
+    inline __m128i Fade32(__m128i a, __m128i b, __m128 inv, __m128 pos)
+    {
+        return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(a), inv), _mm_mul_ps(_mm_cvtepi32_ps(b), pos)));
+    }
+    inline __m128i Fade16(__m128i a, __m128i b, __m128 inv, __m128 pos)
+    {
+        __m128i lo = Fade32(_mm_unpacklo_epi16(a, Zero()), _mm_unpacklo_epi16(b, Zero()), inv, pos);
+        __m128i hi = Fade32(_mm_unpackhi_epi16(a, Zero()), _mm_unpackhi_epi16(b, Zero()), inv, pos);
+        return _mm_packs_epi32(lo, hi);
+    }
+    inline vu8 Fade(vu8 a, vu8 b, float inv, float pos)
+    {
+        __m128 vinv = _mm_set1_ps(inv);
+        __m128 vpos = _mm_set1_ps(pos);
+        __m128i lo = Fade16(_mm_unpacklo_epi8(a, Zero()), _mm_unpacklo_epi8(b, Zero()), vinv, vpos);
+        __m128i hi = Fade16(_mm_unpackhi_epi8(a, Zero()), _mm_unpackhi_epi8(b, Zero()), vinv, vpos);
+        return _mm_packus_epi16(lo, hi);
+    }
+#elif defined(BLEND_NEON)
+    typedef uint8x16_t vu8;
+    constexpr size_t VW = 16;
+    inline vu8 Load(const uint8_t* p) { return vld1q_u8(p); }
+    inline void Store(uint8_t* p, vu8 v) { vst1q_u8(p, v); }
+    inline vu8 Zero() { return vdupq_n_u8(0); }
+    inline vu8 Max(vu8 a, vu8 b) { return vmaxq_u8(a, b); }
+    inline vu8 Min(vu8 a, vu8 b) { return vminq_u8(a, b); }
+    inline vu8 And(vu8 a, vu8 b) { return vandq_u8(a, b); }
+    inline vu8 Or(vu8 a, vu8 b) { return vorrq_u8(a, b); }
+    inline vu8 AndNot(vu8 mask, vu8 v) { return vbicq_u8(v, mask); }
+    inline vu8 IsZero(vu8 a) { return vceqq_u8(a, Zero()); }
+    inline bool AllSet(vu8 mask) { return vminvq_u8(mask) == 0xFF; }
+    inline bool AnySet(vu8 mask) { return vmaxvq_u8(mask) != 0; }
+    // halving add truncates just like the scalar code
+    inline vu8 AverageDown(vu8 a, vu8 b) { return vhaddq_u8(a, b); }
+
+    // exact (a * b) / 255 for 16 bit products using (t + 1 + (t >> 8)) >> 8
+    inline uint8x8_t Div255(uint16x8_t t) { return vshrn_n_u16(vaddq_u16(vaddq_u16(t, vdupq_n_u16(1)), vshrq_n_u16(t, 8)), 8); }
+    inline vu8 MulDiv255(vu8 a, vu8 b)
+    {
+        return vcombine_u8(Div255(vmull_u8(vget_low_u8(a), vget_low_u8(b))), Div255(vmull_u8(vget_high_u8(a), vget_high_u8(b))));
+    }
+
+    // exact t / 100 for t <= 25500 using (t * 41944) >> 22
+    inline uint8x8_t Div100(uint16x8_t t)
+    {
+        uint16x4_t lo = vshrn_n_u32(vmull_u16(vget_low_u16(t), vdup_n_u16(41944)), 16);
+        uint16x4_t hi = vshrn_n_u32(vmull_u16(vget_high_u16(t), vdup_n_u16(41944)), 16);
+        return vmovn_u16(vshrq_n_u16(vcombine_u16(lo, hi), 6));
+    }
+    inline vu8 MulPercent(vu8 a, int percent)
+    {
+        uint8x8_t p = vdup_n_u8((uint8_t)percent);
+        return vcombine_u8(Div100(vmull_u8(vget_low_u8(a), p)), Div100(vmull_u8(vget_high_u8(a), p)));
+    }
+
+    inline uint16x4_t Fade32(uint16x4_t a, uint16x4_t b, float32x4_t inv, float32x4_t pos)
+    {
+        float32x4_t r = vaddq_f32(vmulq_f32(vcvtq_f32_u32(vmovl_u16(a)), inv), vmulq_f32(vcvtq_f32_u32(vmovl_u16(b)), pos));
+        return vmovn_u32(vcvtq_u32_f32(r));
+    }
+    inline uint8x8_t Fade16(uint8x8_t a, uint8x8_t b, float32x4_t inv, float32x4_t pos)
+    {
+        uint16x8_t a16 = vmovl_u8(a);
+        uint16x8_t b16 = vmovl_u8(b);
+        return vmovn_u16(vcombine_u16(Fade32(vget_low_u16(a16), vget_low_u16(b16), inv, pos), Fade32(vget_high_u16(a16), vget_high_u16(b16), inv, pos)));
+    }
+    inline vu8 Fade(vu8 a, vu8 b, float inv, float pos)
+    {
+        float32x4_t vinv = vdupq_n_f32(inv);
+        float32x4_t vpos = vdupq_n_f32(pos);
+        return vcombine_u8(Fade16(vget_low_u8(a), vget_low_u8(b), vinv, vpos), Fade16(vget_high_u8(a), vget_high_u8(b), vinv, vpos));
+    }
+#endif
+
+#ifdef BLEND_SIMD
+    inline vu8 Select(vu8 mask, vu8 ifSet, vu8 ifClear) { return Or(And(mask, ifSet), AndNot(mask, ifClear)); }
+
+    typedef enum {
+        PIXELS_BLACK, // every pixel in the block is 0,0,0
+        PIXELS_LIT,   // no channel in the block is zero so no pixel is black
+        PIXELS_MIXED  // needs to be looked at pixel by pixel
+    } PIXELBLOCK;
+
+    // a block is VW pixels which is exactly 3 vectors of RGB data
+    inline PIXELBLOCK ClassifyPixels(const uint8_t* p)
+    {
+        vu8 z0 = IsZero(Load(p));
+        vu8 z1 = IsZero(Load(p + VW));
+        vu8 z2 = IsZero(Load(p + 2 * VW));
+        if (AllSet(And(And(z0, z1), z2))) return PIXELS_BLACK;
+        if (!AnySet(Or(Or(z0, z1), z2))) return PIXELS_LIT;
+        return PIXELS_MIXED;
+    }
+#endif
+
+    inline bool IsBlack(const uint8_t* p)
+    {
+        return *p == 0 && *(p + 1) == 0 && *(p + 2) == 0;
+    }
+
+    inline void CopyPixel(uint8_t* p, const uint8_t* pp)
+    {
+        *p = *pp;
+        *(p + 1) = *(pp + 1);
+        *(p + 2) = *(pp + 2);
+    }
+
+    inline void ZeroPixel(uint8_t* p)
+    {
+        *p = 0x00;
+        *(p + 1) = 0x00;
+        *(p + 2) = 0x00;
+    }
+}
+
+#pragma endregion
+
+const char* BlendKernels::GetImplementation()
+{
+#if defined(BLEND_AVX2)
+    return "AVX2";
+#elif defined(BLEND_SSE2)
+    return "SSE2";
+#elif defined(BLEND_NEON)
+    return "NEON";
+#else
+    return "Scalar";
+#endif
+}
+
+#pragma region Per channel
+
+void BlendKernels::Overwrite(uint8_t* buffer, const uint8_t* blendBuffer, size_t channels)
+{
+    memcpy(buffer, blendBuffer, channels);
+}
+
+void BlendKernels::OverwriteIfZero(uint8_t* buffer, const uint8_t* blendBuffer, size_t channels)
+{
+    size_t i = 0;
+#ifdef BLEND_SIMD
+    for (; i + VW <= channels; i += VW) {
+        vu8 b = Load(buffer + i);
+        Store(buffer + i, Or(b, And(IsZero(b), Load(blendBuffer + i))));
+    }
+#endif
+    for (; i < channels; ++i) {
+        if (*(buffer + i) == 0x00) {
+            *(buffer + i) = *(blendBuffer + i);
+        }
+    }
+}
+
+void BlendKernels::Mask(uint8_t* buffer, const uint8_t* blendBuffer, size_t channels)
+{
+    size_t i = 0;
+#ifdef BLEND_SIMD
+    for (; i + VW <= channels; i += VW) {
+        Store(buffer + i, And(IsZero(Load(blendBuffer + i)), Load(buffer + i)));
+    }
+#endif
+    for (; i < channels; ++i) {
+        if (*(blendBuffer + i) > 0) {
+            *(buffer + i) = 0x00;
+        }
+    }
+}
+
+void BlendKernels::Unmask(uint8_t* buffer, const uint8_t* blendBuffer, size_t channels)
+{
+    size_t i = 0;
+#ifdef BLEND_SIMD
+    for (; i + VW <= channels; i += VW) {
+        Store(buffer + i, AndNot(IsZero(Load(blendBuffer + i)), Load(buffer + i)));
+    }
+#endif
+    for (; i < channels; ++i) {
+        if (*(blendBuffer + i) == 0) {
+            *(buffer + i) = 0x00;
+        }
+    }
+}
+
+void BlendKernels::Average(uint8_t* buffer, const uint8_t* blendBuffer, size_t channels)
+{
+    size_t i = 0;
+#ifdef BLEND_SIMD
+    for (; i + VW <= channels; i += VW) {
+        Store(buffer + i, AverageDown(Load(buffer + i), Load(blendBuffer + i)));
+    }
+#endif
+    for (; i < channels; ++i) {
+        *(buffer + i) = (uint8_t)(((int)*(buffer + i) + (int)*(blendBuffer + i)) / 2);
+    }
+}
+
+void BlendKernels::Maximum(uint8_t* buffer, const uint8_t* blendBuffer, size_t channels)
+{
+    size_t i = 0;
+#ifdef BLEND_SIMD
+    for (; i + VW <= channels; i += VW) {
+        Store(buffer + i, Max(Load(buffer + i), Load(blendBuffer + i)));
+    }
+#endif
+    for (; i < channels; ++i) {
+        *(buffer + i) = std::max(*(buffer + i), *(blendBuffer + i));
+    }
+}
+
+void BlendKernels::Minimum(uint8_t* buffer, const uint8_t* blendBuffer, size_t channels)
+{
+    size_t i = 0;
+#ifdef BLEND_SIMD
+    for (; i + VW <= channels; i += VW) {
+        Store(buffer + i, Min(Load(buffer + i), Load(blendBuffer + i)));
+    }
+#endif
+    for (; i < channels; ++i) {
+        *(buffer + i) = std::min(*(buffer + i), *(blendBuffer + i));
+    }
+}
+
+void BlendKernels::Crossfade(uint8_t* buffer, const uint8_t* blendBuffer, size_t channels, float pos, const ChannelMask* excluded)
+{
+    if (excluded != nullptr && excluded->Empty()) excluded = nullptr;
+    float inv = 1.0 - pos;
+    bool snapToBlend = pos >= 0.5;
+
+    size_t i = 0;
+#ifdef BLEND_SIMD
+    const uint8_t* lanes = excluded == nullptr ? nullptr : excluded->GetLanes();
+    size_t maskSize = excluded == nullptr ? 0 : excluded->Size();
+    for (; i + VW <= channels; i += VW) {
+        vu8 a = Load(buffer + i);
+        vu8 b = Load(blendBuffer + i);
+        vu8 r = Fade(a, b, inv, pos);
+        if (i < maskSize) {
+            r = Select(Load(lanes + i), snapToBlend ? b : a, r);
+        }
+        Store(buffer + i, r);
+    }
+#endif
+    for (; i < channels; ++i) {
+        if (excluded != nullptr && excluded->IsSet(i)) {
+            if (snapToBlend) {
+                *(buffer + i) = *(blendBuffer + i);
+            }
+        }
+        else {
+            *(buffer + i) = (uint8_t)((float)*(buffer + i) * inv + (float)*(blendBuffer + i) * pos);
+        }
+    }
+}
+
+void BlendKernels::Scale(uint8_t* buffer, size_t channels, int percent, const ChannelMask* excluded)
+{
+    if (percent == 100) return;
+    if (excluded != nullptr && excluded->Empty()) excluded = nullptr;
+
+    if (percent == 0 && excluded == nullptr) {
+        memset(buffer, 0x00, channels);
+        return;
+    }
+
+    size_t i = 0;
+#ifdef BLEND_SIMD
+    // the exact divide by 100 only holds for products that fit in 16 bits
+    if (percent > 0 && percent < 100) {
+        const uint8_t* lanes = excluded == nullptr ? nullptr : excluded->GetLanes();
+        size_t maskSize = excluded == nullptr ? 0 : excluded->Size();
+        for (; i + VW <= channels; i += VW) {
+            vu8 a = Load(buffer + i);
+            vu8 r = MulPercent(a, percent);
+            if (i < maskSize) {
+                r = Select(Load(lanes + i), a, r);
+            }
+            Store(buffer + i, r);
+        }
+    }
+#endif
+    for (; i < channels; ++i) {
+        if (excluded == nullptr || !excluded->IsSet(i)) {
+            *(buffer + i) = (uint8_t)((int)*(buffer + i) * percent / 100);
+        }
+    }
+}
+
+#pragma endregion
+
+#pragma region Per pixel
+
+// apply the input data as if it was (inputvalue / 255) * currentvalue ... ie a brightness
+void BlendKernels::Brightness(uint8_t* buffer, const uint8_t* blendBuffer, size_t pixels)
+{
+    size_t channels = pixels * 3;
+    size_t i = 0;
+#ifdef BLEND_SIMD
+    for (; i + VW <= channels; i += VW) {
+        Store(buffer + i, MulDiv255(Load(buffer + i), Load(blendBuffer + i)));
+    }
+#endif
+    for (; i < channels; ++i) {
+        uint8_t* p = buffer + i;
+        uint8_t pp = *(blendBuffer + i);
+        if (pp == 0) {
+            *p = 0;
+        }
+        else if (pp != 255) {
+            *p = ((int)*p * (int)pp) / 255;
+        }
+    }
+}
+
+void BlendKernels::OverwriteIfBlack(uint8_t* buffer, const uint8_t* blendBuffer, size_t pixels)
+{
+    size_t i = 0;
+#ifdef BLEND_SIMD
+    for (; i + VW <= pixels; i += VW) {
+        uint8_t* p = buffer + i * 3;
+        const uint8_t* pp = blendBuffer + i * 3;
+        switch (ClassifyPixels(p)) {
+        case PIXELS_BLACK:
+            memcpy(p, pp, VW * 3);
+            break;
+        case PIXELS_LIT:
+            break;
+        case PIXELS_MIXED:
+            for (size_t j = 0; j < VW; ++j) {
+                if (IsBlack(p + j * 3)) CopyPixel(p + j * 3, pp + j * 3);
+            }
+            break;
+        }
+    }
+#endif
+    for (; i < pixels; ++i) {
+        if (IsBlack(buffer + i * 3)) CopyPixel(buffer + i * 3, blendBuffer + i * 3);
+    }
+}
+
+void BlendKernels::OverwriteSkipBlack(uint8_t* buffer, const uint8_t* blendBuffer, size_t pixels)
+{
+    size_t i = 0;
+#ifdef BLEND_SIMD
+    for (; i + VW <= pixels; i += VW) {
+        uint8_t* p = buffer + i * 3;
+        const uint8_t* pp = blendBuffer + i * 3;
+        switch (ClassifyPixels(pp)) {
+        case PIXELS_BLACK:
+            break;
+        case PIXELS_LIT:
+            memcpy(p, pp, VW * 3);
+            break;
+        case PIXELS_MIXED:
+            for (size_t j = 0; j < VW; ++j) {
+                if (!IsBlack(pp + j * 3)) CopyPixel(p + j * 3, pp + j * 3);
+            }
+            break;
+        }
+    }
+#endif
+    for (; i < pixels; ++i) {
+        if (!IsBlack(blendBuffer + i * 3)) CopyPixel(buffer + i * 3, blendBuffer + i * 3);
+    }
+}
+
+void BlendKernels::MaskPixel(uint8_t* buffer, const uint8_t* blendBuffer, size_t pixels)
+{
+    size_t i = 0;
+#ifdef BLEND_SIMD
+    for (; i + VW <= pixels; i += VW) {
+        uint8_t* p = buffer + i * 3;
+        const uint8_t* pp = blendBuffer + i * 3;
+        switch (ClassifyPixels(pp)) {
+        case PIXELS_BLACK:
+            break;
+        case PIXELS_LIT:
+            memset(p, 0x00, VW * 3);
+            break;
+        case PIXELS_MIXED:
+            for (size_t j = 0; j < VW; ++j) {
+                if (!IsBlack(pp + j * 3)) ZeroPixel(p + j * 3);
+            }
+            break;
+        }
+    }
+#endif
+    for (; i < pixels; ++i) {
+        if (!IsBlack(blendBuffer + i * 3)) ZeroPixel(buffer + i * 3);
+    }
+}
+
+void BlendKernels::UnmaskPixel(uint8_t* buffer, const uint8_t* blendBuffer, size_t pixels)
+{
+    size_t i = 0;
+#ifdef BLEND_SIMD
+    for (; i + VW <= pixels; i += VW) {
+        uint8_t* p = buffer + i * 3;
+        const uint8_t* pp = blendBuffer + i * 3;
+        switch (ClassifyPixels(pp)) {
+        case PIXELS_BLACK:
+            memset(p, 0x00, VW * 3);
+            break;
+        case PIXELS_LIT:
+            break;
+        case PIXELS_MIXED:
+            for (size_t j = 0; j < VW; ++j) {
+                if (IsBlack(pp + j * 3)) ZeroPixel(p + j * 3);
+            }
+            break;
+        }
+    }
+#endif
+    for (; i < pixels; ++i) {
+        if (IsBlack(blendBuffer + i * 3)) ZeroPixel(buffer + i * 3);
+    }
+}
+
+#pragma endregion
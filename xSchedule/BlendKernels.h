@@ -0,0 +1,79 @@
+#pragma once
+
+/***************************************************************
+ * This source files comes from the xLights project
+ * https://www.xlights.org
+ * https://github.com/smeighan/xLights
+ * See the github commit history for a record of contributing
+ * developers.
+ * Copyright claimed based on commit dates recorded in Github
+ * License: https://github.com/smeighan/xLights/blob/master/License.txt
+ **************************************************************/
+
+// Channel blending kernels shared by xSchedule (Blend.cpp) and xFade (UniverseData).
+// This file must not depend on wxWidgets so it can be used by any of the tools.
+//
+// The kernels pick the widest instruction set the compiler is targeting: AVX2 when
+// built with AVX2 enabled, otherwise SSE2 on x86/x64 and NEON on arm64. Every kernel
+// produces exactly the same bytes as the scalar code it replaced.
+
+#include <cstdint>
+#include <cstddef>
+#include <list>
+#include <vector>
+
+// A precomputed set of channels (0 based) to be treated specially by a kernel.
+// Built once when the configuration changes so the per frame work is a straight
+// bitwise select rather than a list search per channel.
+class ChannelMask
+{
+    std::vector<uint64_t> _bits;  // one bit per channel
+    std::vector<uint8_t> _lanes;  // 0xFF per set channel ... used by the SIMD selects
+    size_t _count = 0;
+
+public:
+    ChannelMask() {}
+    ChannelMask(size_t channels) { Resize(channels); }
+
+    // builds the mask from a list of 1 based channel numbers ... the format used by the xFade settings
+    static ChannelMask FromOneBasedList(const std::list<int>& channels, size_t size);
+
+    void Resize(size_t channels);
+    void Set(size_t channel);
+    void Clear();
+    bool IsSet(size_t channel) const { return channel < _lanes.size() && (_bits[channel >> 6] & (1ULL << (channel & 63))) != 0; }
+    bool Empty() const { return _count == 0; }
+    size_t Count() const { return _count; }
+    size_t Size() const { return _lanes.size(); }
+    // the lanes are padded to a multiple of 64 channels so vector blocks never straddle the end of the mask
+    const uint8_t* GetLanes() const { return _lanes.data(); }
+};
+
+namespace BlendKernels
+{
+    // name of the instruction set the kernels were compiled for ... for logging
+    const char* GetImplementation();
+
+    // per channel kernels
+    void Overwrite(uint8_t* buffer, const uint8_t* blendBuffer, size_t channels);
+    void OverwriteIfZero(uint8_t* buffer, const uint8_t* blendBuffer, size_t channels);
+    void Mask(uint8_t* buffer, const uint8_t* blendBuffer, size_t channels);
+    void Unmask(uint8_t* buffer, const uint8_t* blendBuffer, size_t channels);
+    void Average(uint8_t* buffer, const uint8_t* blendBuffer, size_t channels);
+    void Maximum(uint8_t* buffer, const uint8_t* blendBuffer, size_t channels);
+    void Minimum(uint8_t* buffer, const uint8_t* blendBuffer, size_t channels);
+
+    // per pixel (RGB triplet) kernels
+    void Brightness(uint8_t* buffer, const uint8_t* blendBuffer, size_t pixels);
+    void OverwriteIfBlack(uint8_t* buffer, const uint8_t* blendBuffer, size_t pixels);
+    void OverwriteSkipBlack(uint8_t* buffer, const uint8_t* blendBuffer, size_t pixels);
+    void MaskPixel(uint8_t* buffer, const uint8_t* blendBuffer, size_t pixels);
+    void UnmaskPixel(uint8_t* buffer, const uint8_t* blendBuffer, size_t pixels);
+
+    // buffer = buffer * (1 - pos) + blendBuffer * pos
+    // excluded channels are not faded ... they snap from buffer to blendBuffer at pos 0.5
+    void Crossfade(uint8_t* buffer, const uint8_t* blendBuffer, size_t channels, float pos, const ChannelMask* excluded = nullptr);
+
+    // buffer = buffer * percent / 100 leaving any excluded channels untouched
+    void Scale(uint8_t* buffer, size_t channels, int percent, const ChannelMask* excluded = nullptr);
+}
@@ -0,0 +1,432 @@
+/***************************************************************
+ * This source files comes from the xLights project
+ * https://www.xlights.org
+ * https://github.com/smeighan/xLights
+ * See the github commit history for a record of contributing
+ * developers.
+ * Copyright claimed based on commit dates recorded in Github
+ * License: https://github.com/smeighan/xLights/blob/master/License.txt
+ **************************************************************/
+
+// Checks every blend kernel against the scalar code it replaced and measures its throughput.
+// This does not depend on wxWidgets ... see the Makefile alongside for how to build it for each instruction set.
+//
+//    BlendKernelsTest          check the kernels
+//    BlendKernelsTest bench    check the kernels then time them
+
+#include "../BlendKernels.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#pragma region Scalar reference
+
+// These are the loops from Blend.cpp and UniverseData.cpp before the kernels existed
+
+namespace Reference
+{
+    void Overwrite(uint8_t* buffer, const uint8_t* blendBuffer, size_t channels)
+    {
+        memcpy(buffer, blendBuffer, channels);
+    }
+
+    void OverwriteIfZero(uint8_t* buffer, const uint8_t* blendBuffer, size_t channels)
+    {
+        for (size_t i = 0; i < channels; ++i) {
+            if (*(buffer + i) == 0) *(buffer + i) = *(blendBuffer + i);
+        }
+    }
+
+    void Mask(uint8_t* buffer, const uint8_t* blendBuffer, size_t channels)
+    {
+        for (size_t i = 0; i < channels; ++i) {
+            if (*(blendBuffer + i) > 0) *(buffer + i) = 0x00;
+        }
+    }
+
+    void Unmask(uint8_t* buffer, const uint8_t* blendBuffer, size_t channels)
+    {
+        for (size_t i = 0; i < channels; ++i) {
+            if (*(blendBuffer + i) == 0) *(buffer + i) = 0x00;
+        }
+    }
+
+    void Average(uint8_t* buffer, const uint8_t* blendBuffer, size_t channels)
+    {
+        for (size_t i = 0; i < channels; ++i) {
+            *(buffer + i) = ((int)*(buffer + i) + (int)*(blendBuffer + i)) / 2;
+        }
+    }
+
+    void Maximum(uint8_t* buffer, const uint8_t* blendBuffer, size_t channels)
+    {
+        for (size_t i = 0; i < channels; ++i) {
+            *(buffer + i) = std::max(*(buffer + i), *(blendBuffer + i));
+        }
+    }
+
+    void Minimum(uint8_t* buffer, const uint8_t* blendBuffer, size_t channels)
+    {
+        for (size_t i = 0; i < channels; ++i) {
+            *(buffer + i) = std::min(*(buffer + i), *(blendBuffer + i));
+        }
+    }
+
+    void Brightness(uint8_t* buffer, const uint8_t* blendBuffer, size_t pixels)
+    {
+        for (size_t i = 0; i < pixels * 3; ++i) {
+            if (*(blendBuffer + i) == 0) {
+                *(buffer + i) = 0;
+            }
+            else if (*(blendBuffer + i) != 255) {
+                *(buffer + i) = ((int)*(buffer + i) * (int)*(blendBuffer + i)) / 255;
+            }
+        }
+    }
+
+    bool IsBlack(const uint8_t* p)
+    {
+        return *p + *(p + 1) + *(p + 2) == 0;
+    }
+
+    void OverwriteIfBlack(uint8_t* buffer, const uint8_t* blendBuffer, size_t pixels)
+    {
+        for (size_t i = 0; i < pixels; ++i) {
+            if (IsBlack(buffer + i * 3)) memcpy(buffer + i * 3, blendBuffer + i * 3, 3);
+        }
+    }
+
+    void OverwriteSkipBlack(uint8_t* buffer, const uint8_t* blendBuffer, size_t pixels)
+    {
+        for (size_t i = 0; i < pixels; ++i) {
+            if (!IsBlack(blendBuffer + i * 3)) memcpy(buffer + i * 3, blendBuffer + i * 3, 3);
+        }
+    }
+
+    void MaskPixel(uint8_t* buffer, const uint8_t* blendBuffer, size_t pixels)
+    {
+        for (size_t i = 0; i < pixels; ++i) {
+            if (!IsBlack(blendBuffer + i * 3)) memset(buffer + i * 3, 0x00, 3);
+        }
+    }
+
+    void UnmaskPixel(uint8_t* buffer, const uint8_t* blendBuffer, size_t pixels)
+    {
+        for (size_t i = 0; i < pixels; ++i) {
+            if (IsBlack(blendBuffer + i * 3)) memset(buffer + i * 3, 0x00, 3);
+        }
+    }
+
+    void Crossfade(uint8_t* buffer, const uint8_t* blendBuffer, size_t channels, float pos, const std::list<int>& excludeChannels)
+    {
+        float inv = 1.0 - pos;
+        for (size_t i = 0; i < channels; ++i) {
+            if (std::find(excludeChannels.begin(), excludeChannels.end(), i + 1) != excludeChannels.end()) {
+                if (pos >= 0.5) {
+                    *(buffer + i) = *(blendBuffer + i);
+                }
+            }
+            else {
+                *(buffer + i) = (uint8_t)((float)*(buffer + i) * inv + (float)*(blendBuffer + i) * pos);
+            }
+        }
+    }
+
+    void Scale(uint8_t* buffer, size_t channels, int brightness, const std::list<int>& excludeChannels)
+    {
+        for (size_t i = 0; i < channels; ++i) {
+            if (std::find(excludeChannels.begin(), excludeChannels.end(), i + 1) == excludeChannels.end()) {
+                *(buffer + i) = (uint8_t)((int)*(buffer + i) * brightness / 100);
+            }
+        }
+    }
+}
+
+#pragma endregion
+
+#pragma region Kernel table
+
+typedef void (*BlendFunction)(uint8_t* buffer, const uint8_t* blendBuffer, size_t count);
+
+struct BlendMethod
+{
+    const char* name;    // the APPLYMETHOD it implements
+    bool perPixel;       // count is pixels rather than channels
+    BlendFunction kernel;
+    BlendFunction reference;
+};
+
+static const BlendMethod BLEND_METHODS[] = {
+    { "OVERWRITE", false, BlendKernels::Overwrite, Reference::Overwrite },
+    { "OVERWRITEIFZERO", false, BlendKernels::OverwriteIfZero, Reference::OverwriteIfZero },
+    { "MASK", false, BlendKernels::Mask, Reference::Mask },
+    { "UNMASK", false, BlendKernels::Unmask, Reference::Unmask },
+    { "AVERAGE", false, BlendKernels::Average, Reference::Average },
+    { "MAX", false, BlendKernels::Maximum, Reference::Maximum },
+    { "OVERWRITEIFBLACK", true, BlendKernels::OverwriteIfBlack, Reference::OverwriteIfBlack },
+    { "MASKPIXEL", true, BlendKernels::MaskPixel, Reference::MaskPixel },
+    { "UNMASKPIXEL", true, BlendKernels::UnmaskPixel, Reference::UnmaskPixel },
+    { "MIN", false, BlendKernels::Minimum, Reference::Minimum },
+    { "OVERWRITESKIPBLACK", true, BlendKernels::OverwriteSkipBlack, Reference::OverwriteSkipBlack },
+    { "BRIGHTNESS", true, BlendKernels::Brightness, Reference::Brightness }
+};
+
+#pragma endregion
+
+#pragma region Checks
+
+static std::mt19937 __rng(20210301);
+static int __failures = 0;
+
+// fills a buffer with data that exercises the zero, black pixel and full value special cases
+static void Fill(std::vector<uint8_t>& data, int style)
+{
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::uniform_int_distribution<int> percent(0, 99);
+    for (size_t i = 0; i < data.size(); ++i) {
+        switch (style) {
+        case 0: // anything
+            data[i] = byte(__rng);
+            break;
+        case 1: // mostly zero
+            data[i] = percent(__rng) < 70 ? 0 : byte(__rng);
+            break;
+        case 2: // mostly 0 or 255
+            data[i] = percent(__rng) < 50 ? 0 : (percent(__rng) < 50 ? 255 : byte(__rng));
+            break;
+        case 4: // runs of lit and black pixels like a show where models are either on or off
+            if (i % (3 * 64) == 0) {
+                bool black = percent(__rng) < 50;
+                for (size_t j = i; j < std::min(i + 3 * 64, data.size()); ++j) {
+                    data[j] = black ? 0 : 1 + byte(__rng) % 255;
+                }
+            }
+            break;
+        default: // whole black pixels
+            if (i % 3 == 0) {
+                bool black = percent(__rng) < 50;
+                for (size_t j = i; j < std::min(i + 3, data.size()); ++j) {
+                    data[j] = black ? 0 : byte(__rng);
+                }
+            }
+            break;
+        }
+    }
+}
+
+static bool Compare(const std::string& what, size_t size, size_t offset, const uint8_t* expected, const uint8_t* actual, size_t length)
+{
+    for (size_t i = 0; i < length; ++i) {
+        if (expected[i] != actual[i]) {
+            printf("FAIL %s size %d offset %d: byte %d expected %d got %d\n", what.c_str(), (int)size, (int)offset, (int)i, (int)expected[i], (int)actual[i]);
+            ++__failures;
+            return false;
+        }
+    }
+    return true;
+}
+
+// sizes either side of the 16 and 32 byte vector widths and the 48/96 byte pixel blocks
+static std::vector<size_t> GetSizes()
+{
+    std::vector<size_t> sizes;
+    for (size_t i = 0; i <= 200; ++i) {
+        sizes.push_back(i);
+    }
+    for (size_t s : { 255, 256, 257, 510, 511, 512, 513, 1023, 1024, 1025, 3 * 170, 3 * 680 + 1, 65536 + 7 }) {
+        sizes.push_back(s);
+    }
+    return sizes;
+}
+
+// the buffers are offset within a larger allocation so the kernels see misaligned pointers
+// and guard bytes either side catch any writes past the end
+static const size_t GUARD = 64;
+
+static void CheckBlendMethods()
+{
+    for (const auto& m : BLEND_METHODS) {
+        int count = 0;
+        for (size_t size : GetSizes()) {
+            for (size_t offset = 0; offset < 4; ++offset) {
+                for (int style = 0; style < 5; ++style) {
+                    std::vector<uint8_t> buffer(size + 2 * GUARD);
+                    std::vector<uint8_t> blend(size + 2 * GUARD);
+                    Fill(buffer, style);
+                    Fill(blend, (style + offset) % 5);
+                    std::vector<uint8_t> expected = buffer;
+
+                    size_t n = m.perPixel ? size / 3 : size;
+                    m.reference(expected.data() + GUARD + offset, blend.data() + GUARD + offset, n);
+                    m.kernel(buffer.data() + GUARD + offset, blend.data() + GUARD + offset, n);
+
+                    if (!Compare(m.name, size, offset, expected.data(), buffer.data(), buffer.size())) break;
+                    ++count;
+                }
+            }
+        }
+        printf("%-20s %d cases\n", m.name, count);
+    }
+}
+
+// a random set of 1 based channels in the style of the xFade exclusion list
+static std::list<int> RandomExclusions(size_t size, int density)
+{
+    std::list<int> res;
+    std::uniform_int_distribution<int> percent(0, 99);
+    for (size_t i = 0; i < size; ++i) {
+        if (percent(__rng) < density) res.push_back((int)i + 1);
+    }
+    // channels past the end of the buffer must be ignored
+    if (density > 0) res.push_back((int)size + 5);
+    return res;
+}
+
+static void CheckCrossfade()
+{
+    static const float positions[] = { 0.0f, 0.1f, 0.25f, 0.4999f, 0.5f, 0.5001f, 0.75f, 0.9f, 1.0f };
+    int count = 0;
+    for (size_t size : GetSizes()) {
+        // the reference searches the exclusion list for every channel
+        if (size > 2048) continue;
+        for (int density : { 0, 5, 50, 100 }) {
+            std::list<int> excluded = RandomExclusions(size, density);
+            ChannelMask mask = ChannelMask::FromOneBasedList(excluded, size);
+            for (float pos : positions) {
+                size_t offset = count % 4;
+                std::vector<uint8_t> buffer(size + 2 * GUARD);
+                std::vector<uint8_t> blend(size + 2 * GUARD);
+                Fill(buffer, 0);
+                Fill(blend, count % 3);
+                std::vector<uint8_t> expected = buffer;
+
+                Reference::Crossfade(expected.data() + GUARD + offset, blend.data() + GUARD + offset, size, pos, excluded);
+                BlendKernels::Crossfade(buffer.data() + GUARD + offset, blend.data() + GUARD + offset, size, pos, density == 0 && count % 2 == 0 ? nullptr : &mask);
+
+                if (!Compare("Crossfade " + std::to_string(pos) + " excluded " + std::to_string(excluded.size()), size, offset, expected.data(), buffer.data(), buffer.size())) return;
+                ++count;
+            }
+        }
+    }
+    printf("%-20s %d cases\n", "Crossfade", count);
+}
+
+static void CheckScale()
+{
+    static const int percents[] = { 0, 1, 33, 50, 99, 100, 101, 150, 255 };
+    int count = 0;
+    for (size_t size : GetSizes()) {
+        // the reference searches the exclusion list for every channel
+        if (size > 2048) continue;
+        for (int density : { 0, 5, 50, 100 }) {
+            std::list<int> excluded = RandomExclusions(size, density);
+            ChannelMask mask = ChannelMask::FromOneBasedList(excluded, size);
+            for (int pct : percents) {
+                size_t offset = count % 4;
+                std::vector<uint8_t> buffer(size + 2 * GUARD);
+                Fill(buffer, count % 3);
+                std::vector<uint8_t> expected = buffer;
+
+                Reference::Scale(expected.data() + GUARD + offset, size, pct, excluded);
+                BlendKernels::Scale(buffer.data() + GUARD + offset, size, pct, density == 0 && count % 2 == 0 ? nullptr : &mask);
+
+                if (!Compare("Scale " + std::to_string(pct) + "% excluded " + std::to_string(excluded.size()), size, offset, expected.data(), buffer.data(), buffer.size())) return;
+                ++count;
+            }
+        }
+    }
+    printf("%-20s %d cases\n", "Scale", count);
+}
+
+#pragma endregion
+
+#pragma region Benchmark
+
+// runs fn until it has been going for a while and returns MB/s of channel data processed
+template<typename F>
+static double Time(size_t bytes, F fn)
+{
+    auto start = std::chrono::steady_clock::now();
+    size_t runs = 0;
+    double elapsed = 0;
+    do {
+        for (int i = 0; i < 16; ++i) fn();
+        runs += 16;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } while (elapsed < 0.25);
+    return (double)bytes * runs / elapsed / (1024.0 * 1024.0);
+}
+
+static void Benchmark()
+{
+    // roughly a large show ... 1000 universes of 510 channels
+    const size_t size = 510 * 1000;
+    std::vector<uint8_t> original(size);
+    std::vector<uint8_t> buffer(size);
+    std::vector<uint8_t> blend(size);
+    // the per pixel kernels skip whole blocks of black or lit pixels so they are timed on runs rather than
+    // on pixels that are individually random which is their worst case
+    Fill(original, 4);
+    Fill(blend, 4);
+
+    std::list<int> excluded = RandomExclusions(size, 5);
+    ChannelMask mask = ChannelMask::FromOneBasedList(excluded, size);
+
+    printf("\n%-20s %12s %12s %8s\n", "Method", "Scalar MB/s", "Kernel MB/s", "Speedup");
+    auto report = [](const char* name, double reference, double kernel) {
+        printf("%-20s %12.0f %12.0f %7.2fx\n", name, reference, kernel, kernel / reference);
+    };
+
+    // the buffer is reset each run so methods like MASK do not degenerate to all zeros
+    for (const auto& m : BLEND_METHODS) {
+        size_t n = m.perPixel ? size / 3 : size;
+        double r = Time(size, [&]() { memcpy(buffer.data(), original.data(), size); m.reference(buffer.data(), blend.data(), n); });
+        double k = Time(size, [&]() { memcpy(buffer.data(), original.data(), size); m.kernel(buffer.data(), blend.data(), n); });
+        report(m.name, r, k);
+    }
+
+    // the reference crossfade and scale search the exclusion list per channel so time them without one
+    // as well as timing the kernels with the mask to show what the mask costs
+    std::list<int> none;
+    double r = Time(size, [&]() { memcpy(buffer.data(), original.data(), size); Reference::Crossfade(buffer.data(), blend.data(), size, 0.3f, none); });
+    double k = Time(size, [&]() { memcpy(buffer.data(), original.data(), size); BlendKernels::Crossfade(buffer.data(), blend.data(), size, 0.3f); });
+    report("Crossfade", r, k);
+    k = Time(size, [&]() { memcpy(buffer.data(), original.data(), size); BlendKernels::Crossfade(buffer.data(), blend.data(), size, 0.3f, &mask); });
+    report("Crossfade masked", r, k);
+
+    r = Time(size, [&]() { memcpy(buffer.data(), original.data(), size); Reference::Scale(buffer.data(), size, 60, none); });
+    k = Time(size, [&]() { memcpy(buffer.data(), original.data(), size); BlendKernels::Scale(buffer.data(), size, 60); });
+    report("Scale", r, k);
+    k = Time(size, [&]() { memcpy(buffer.data(), original.data(), size); BlendKernels::Scale(buffer.data(), size, 60, &mask); });
+    report("Scale masked", r, k);
+
+    r = Time(size, [&]() { memcpy(buffer.data(), original.data(), size); });
+    printf("%-20s %12.0f    (reset copy included in every figure above)\n", "memcpy", r);
+}
+
+#pragma endregion
+
+int main(int argc, char** argv)
+{
+    printf("Blend kernels: %s\n\n", BlendKernels::GetImplementation());
+
+    CheckBlendMethods();
+    CheckCrossfade();
+    CheckScale();
+
+    if (__failures != 0) {
+        printf("\n%d failures\n", __failures);
+        return 1;
+    }
+    printf("\nAll kernels match the scalar code\n");
+
+    if (argc > 1 && std::string(argv[1]) == "bench") {
+        Benchmark();
+    }
+    return 0;
+}
@@ -83,8 +83,84 @@ size_t MatrixMapper::Map(int x, int y) const
     wxASSERT(x >= 0 && x < GetWidth());
     wxASSERT(y >= 0 && y < GetHeight());
 
-    long startChannel = GetStartChannelAsNumber();
-    size_t loc = startChannel;
+    std::unique_lock<std::mutex> lock(_channelMapLock);
+    return GetStartChannelAsNumber() + GetChannelMap()[y * GetWidth() + x];
+}
+
+const std::vector<uint32_t>& MatrixMapper::GetChannelMap() const
+{
+    // only rebuilt when the matrix is changed ... the start channel is added when it is used so
+    // changes to the network layout don't affect it
+    if (_channelMapChangeCount != _changeCount || _channelMap.size() != (size_t)GetWidth() * GetHeight())
+    {
+        int width = GetWidth();
+        int height = GetHeight();
+        _channelMap.resize((size_t)width * height);
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                _channelMap[(size_t)y * width + x] = CalculateOffset(x, y);
+            }
+        }
+        _channelMapChangeCount = _changeCount;
+    }
+    return _channelMap;
+}
+
+void MatrixMapper::Blit(const uint8_t* image, int width, int height, uint8_t* buffer, size_t size, APPLYMETHOD blendMode) const
+{
+    if (width != GetWidth() || height != GetHeight())
+    {
+        wxASSERT(false);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(_channelMapLock);
+    const std::vector<uint32_t>& channelMap = GetChannelMap();
+    size_t start = GetStartChannelAsNumber() - 1;
+    size_t channels = GetChannels();
+    if (start >= size) return;
+
+    if ((size_t)width * height * 3 == channels)
+    {
+        // every channel of the matrix is a pixel so put the image in channel order and blend it in one go
+        _blitBuffer.resize(channels);
+        for (int y = 0; y < height; ++y)
+        {
+            const uint8_t* src = image + (size_t)y * width * 3;
+            const uint32_t* row = &channelMap[(size_t)(height - y - 1) * width];
+            for (int x = 0; x < width; ++x)
+            {
+                uint8_t* dst = &_blitBuffer[row[x]];
+                dst[0] = src[0];
+                dst[1] = src[1];
+                dst[2] = src[2];
+                src += 3;
+            }
+        }
+        Blend(buffer, size, _blitBuffer.data(), channels, blendMode, start);
+    }
+    else
+    {
+        // the strings have nodes left over which aren't part of the matrix so these must be left alone
+        for (int y = 0; y < height; ++y)
+        {
+            const uint8_t* src = image + (size_t)y * width * 3;
+            const uint32_t* row = &channelMap[(size_t)(height - y - 1) * width];
+            for (int x = 0; x < width; ++x)
+            {
+                uint8_t rgb[3] = { src[0], src[1], src[2] };
+                Blend(buffer, size, rgb, 3, blendMode, start + row[x]);
+                src += 3;
+            }
+        }
+    }
+}
+
+size_t MatrixMapper::CalculateOffset(int x, int y) const
+{
+    size_t loc = 0;
 
     if (_orientation == MMORIENTATION::VERTICAL)
     {
@@ -300,11 +376,11 @@ size_t MatrixMapper::Map(int x, int y) const
     }
 
     // make sure the value is within the range expected ... until i know my code is right
-    if (loc < startChannel || loc >= startChannel + GetChannels())
+    if (loc >= GetChannels())
     {
         // location out of range ... this can happen if the user tampers with the matrix while it is in use
         // force it to a valid value
-        loc = startChannel;
+        loc = 0;
         wxASSERT(false);
     }
 
@@ -11,6 +11,11 @@
  **************************************************************/
 
 #include <string>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+
+#include "Blend.h"
 
 class wxXmlNode;
 class OutputManager;
@@ -31,6 +36,15 @@ class MatrixMapper
 	MMSTARTLOCATION _startLocation;
     std::string _startChannel;
 
+    // the channel offset of every pixel from the first channel of the matrix, rows bottom to top
+    mutable std::mutex _channelMapLock;
+    mutable std::vector<uint32_t> _channelMap;
+    mutable int _channelMapChangeCount = -1;
+    mutable std::vector<uint8_t> _blitBuffer;
+
+    size_t CalculateOffset(int x, int y) const;
+    const std::vector<uint32_t>& GetChannelMap() const;
+
 public:
 
 		static MMORIENTATION EncodeOrientation(const std::string orientation);
@@ -44,6 +58,8 @@ public:
         MatrixMapper(OutputManager* outputManager);
         virtual ~MatrixMapper() {}
 		size_t Map(int x, int y) const;
+        // blends an RGB image (rows top to bottom as wxImage stores them) the size of the matrix into the channel buffer
+        void Blit(const uint8_t* image, int width, int height, uint8_t* buffer, size_t size, APPLYMETHOD blendMode) const;
 		size_t GetChannels() const;
 		int GetWidth() const;
 		int GetHeight() const;
@@ -46,7 +46,6 @@ protected:
 
     wxString GetText(size_t ms);
     wxPoint GetLocation(size_t ms, wxSize size);
-    void SetPixel(uint8_t* p, uint8_t r, uint8_t g, uint8_t b, APPLYMETHOD blendMode);
 
 public:
 
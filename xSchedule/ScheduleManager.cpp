@@ -247,6 +247,22 @@ int ScheduleManager::GetPPS() const
     return 0;
 }
 
+// percentage of packets in the last frame output not sent because their data had not changed
+int ScheduleManager::GetSuppressedPacketPercent() const
+{
+    if (_outputManager != nullptr)
+    {
+        int sent = _outputManager->GetLastFrameSentPackets();
+        int suppressed = _outputManager->GetLastFrameSuppressedPackets();
+        if (sent + suppressed > 0)
+        {
+            return suppressed * 100 / (sent + suppressed);
+        }
+    }
+
+    return 0;
+}
+
 void ScheduleManager::StartListeners()
 {
     _listenerManager->StartListeners();
@@ -577,6 +593,7 @@ bool ScheduleManager::IsDirty()
 void ScheduleManager::SetDirty()
 {
     _changeCount++;
+    _stateVersion++;
 }
 
 void ScheduleManager::Save()
@@ -1602,6 +1619,9 @@ bool ScheduleManager::Action(const wxString& command, const wxString& parameters
     bool result = true;
     bool scheduleChanged = false;
 
+    // any command can change what the cached queries would show
+    _stateVersion++;
+
     Command* cmd = _commandManager.GetCommand(command);
 
     if (cmd == nullptr)
@@ -3489,52 +3509,91 @@ void ScheduleManager::GetNextScheduledPlayList(PlayList** p, Schedule** s)
 // 127.0.0.1/xScheduleStash?Command=Store&Key=<key> ... this must be posted with the data in the body of the request ... key must be filename legal
 // 127.0.0.1/xScheduleStash?Command=Retrieve&Key=<key> ... this returs a text response with the data if successful
 
-// 127.0.0.1/xScheduleQuery?Query=GetPlayLists&Parameters=
-// 127.0.0.1/xScheduleQuery?Query=GetPlayListSteps&Parameters=<playlistname>
-// 127.0.0.1/xScheduleQuery?Query=GetPlayingStatus&Parameters=
-// 127.0.0.1/xScheduleQuery?Query=GetButtons&Parameters=
+// the status shows the position in the current step so it cannot be allowed to get very old but this
+// still limits how often it is built no matter how many clients are polling
+#define STATUS_CACHE_MAXAGEMS 100
+// playlists only change when edited but include when they are next scheduled
+#define QUERY_CACHE_MAXAGEMS 1000
 
-bool ScheduleManager::Query(const wxString& command, const wxString& parameters, wxString& data, wxString& msg, const wxString& ip, const wxString& reference)
+bool ScheduleManager::IsCachedQuery(const std::string& command) const
 {
-    wxASSERT(IsQuery(command));
+    return command == "getplayingstatus" || command == "getplaylists" || command == "getplayliststeps";
+}
 
-    bool result = true;
-    data = "";
-    std::string c = command.Lower();
-    if (c == "getplaylists")
+CachedQuery ScheduleManager::GetCachedQuery(const std::string& command, const wxString& parameters)
+{
+    wxASSERT(IsCachedQuery(command));
+
+    long long now = wxGetLocalTimeMillis().GetValue();
+    CachedQuery& cq = _queryCache[command + "|" + parameters.ToStdString()];
+
+    long long maxAge = command == "getplayingstatus" ? STATUS_CACHE_MAXAGEMS : QUERY_CACHE_MAXAGEMS;
+    if (cq._version != 0 && cq._stateVersion == _stateVersion && now - cq._builtMS < maxAge)
     {
-        bool first = true;
-        data = "{\"playlists\":[";
+        return cq;
+    }
+
+    CachedQuery built;
+    BuildCachedQuery(command, parameters, built);
+
+    cq._stateVersion = _stateVersion;
+    cq._builtMS = now;
+    cq._result = built._result;
+    cq._msg = built._msg;
+    if (cq._version == 0 || built._body != cq._body)
+    {
+        cq._body = built._body;
+        cq._fields = std::move(built._fields);
+        cq._version = ++_lastQueryVersion;
+    }
+
+    // dont let clients asking for playlists that dont exist grow the cache
+    if (!cq._result)
+    {
+        CachedQuery failed = cq;
+        _queryCache.erase(command + "|" + parameters.ToStdString());
+        return failed;
+    }
+
+    return cq;
+}
+
+void ScheduleManager::BuildCachedQuery(const std::string& command, const wxString& parameters, CachedQuery& cq)
+{
+    auto& fields = cq._fields;
+    auto quote = [](const wxString& value) { return "\"" + value.ToStdString() + "\""; };
+
+    if (command == "getplaylists")
+    {
+        std::string playlists = "[";
         for (const auto& it : _playLists)
         {
-            if (first) {
-                first = false;
-            }
-            else
+            if (playlists.size() > 1)
             {
-                data += ",";
+                playlists += ",";
             }
-            data += "{\"name\":\"" + it->GetNameNoTime() +
+            playlists += "{\"name\":\"" + it->GetNameNoTime() +
                     "\",\"id\":\"" + wxString::Format(wxT("%i"), it->GetId()).ToStdString() +
                 "\",\"nextscheduled\":\"" + it->GetNextScheduledTime() +
                 "\",\"length\":\""+ FormatTime(it->GetLengthMS()) +
                 "\",\"lengthms\":\"" + wxString::Format("%ld", (long)it->GetLengthMS()) + "\"}";
         }
-        data += "],\"reference\":\""+reference+"\"}";
+        playlists += "]";
+        fields.push_back({ "playlists", playlists });
     }
-    else if (c == "getplayliststeps")
+    else if (command == "getplayliststeps")
     {
         PlayList* p = GetPlayList(DecodePlayList(parameters));
 
+        std::string stepsJSON = "[";
         if (p != nullptr)
         {
-            data = "{\"steps\":[";
             auto steps = p->GetSteps();
             for (auto it =  steps.begin(); it != steps.end(); ++it)
             {
                 if (it != steps.begin())
                 {
-                    data += ",";
+                    stepsJSON += ",";
                 }
 
                 std::string first;
@@ -3557,21 +3616,145 @@ bool ScheduleManager::Query(const wxString& command, const wxString& parameters,
                     last = "\",\"endonly\":\"false";
                 }
 
-                data += "{\"name\":\"" + (*it)->GetNameNoTime() +
+                stepsJSON += "{\"name\":\"" + (*it)->GetNameNoTime() +
                     "\",\"id\":\"" + wxString::Format(wxT("%i"), (*it)->GetId()).ToStdString() +
                     first + last +
-                    "\",\"everystep\":\"" + ((*it)->GetEveryStep() ? _("true") : _("false")) +
+                    "\",\"everystep\":\"" + ((*it)->GetEveryStep() ? "true" : "false") +
                     "\",\"offset\":\"" + (*it)->GetStartTime(p) +
                     "\",\"length\":\"" + FormatTime((*it)->GetLengthMS()) +
                     "\",\"lengthms\":\"" + wxString::Format("%ld", (long)(*it)->GetLengthMS()) + "\"}";
             }
-            data += "],\"reference\":\""+reference+"\"}";
         }
         else
         {
-            data = "{\"steps\":[],\"reference\":\""+reference+"\"}";
-            result = false;
-            msg = "Playlist '" + parameters + "' not found.";
+            cq._result = false;
+            cq._msg = "Playlist '" + parameters.ToStdString() + "' not found.";
+        }
+        stepsJSON += "]";
+        fields.push_back({ "steps", stepsJSON });
+    }
+    else if (command == "getplayingstatus")
+    {
+        PlayList* p = GetRunningPlayList();
+        if (p == nullptr || p->GetRunningStep() == nullptr)
+        {
+            fields.push_back({ "status", quote("idle") });
+            fields.push_back({ "outputtolights", quote(_outputManager->IsOutputting() ? "true" : "false") });
+            fields.push_back({ "volume", quote(wxString::Format(wxT("%i"), GetVolume())) });
+            fields.push_back({ "brightness", quote(wxString::Format(wxT("%i"), GetBrightness())) });
+            fields.push_back({ "version", quote(xlights_version_string) });
+            fields.push_back({ "passwordset", quote(_scheduleOptions->GetPassword() == "" ? "false" : "true") });
+            fields.push_back({ "time", quote(wxDateTime::Now().Format("%Y-%m-%d %H:%M:%S")) });
+        }
+        else
+        {
+            std::string nextsong;
+            std::string nextsongid;
+            bool didloop;
+
+            if (p->IsRandom())
+            {
+                nextsong = "God knows";
+                nextsongid = "";
+            }
+            else
+            {
+                auto next = p->GetNextStep(didloop);
+                if (next == nullptr)
+                {
+                    nextsong = "";
+                    nextsongid = "";
+                }
+                else
+                {
+                    nextsong = next->GetNameNoTime();
+                    nextsongid = wxString::Format(wxT("%i"), next->GetId());
+                }
+            }
+
+            RunningSchedule* rs = GetRunningSchedule();
+            PlayListStep* step = p->GetRunningStep();
+            bool scheduled = IsCurrentPlayListScheduled() && rs != nullptr;
+
+            fields.push_back({ "status", quote(p->IsPaused() ? "paused" : "playing") });
+            fields.push_back({ "playlist", quote(p->GetNameNoTime()) });
+            fields.push_back({ "playlistid", quote(wxString::Format(wxT("%i"), p->GetId())) });
+            fields.push_back({ "playlistlooping", quote(p->IsLooping() || p->GetLoopsLeft() > 0 ? "true" : "false") });
+            fields.push_back({ "playlistloopsleft", quote(wxString::Format(wxT("%i"), p->GetLoopsLeft())) });
+            fields.push_back({ "random", quote(p->IsRandom() ? "true" : "false") });
+            fields.push_back({ "step", quote(step->GetNameNoTime()) });
+            fields.push_back({ "stepid", quote(wxString::Format(wxT("%i"), step->GetId())) });
+            fields.push_back({ "steplooping", quote(p->IsStepLooping() || step->GetLoopsLeft() > 0 ? "true" : "false") });
+            fields.push_back({ "steploopsleft", quote(wxString::Format(wxT("%i"), step->GetLoopsLeft())) });
+            fields.push_back({ "length", quote(FormatTime(step->GetLengthMS())) });
+            fields.push_back({ "lengthms", quote(wxString::Format("%ld", (long)step->GetLengthMS())) });
+            fields.push_back({ "position", quote(FormatTime(step->GetPosition())) });
+            fields.push_back({ "positionms", quote(wxString::Format("%ld", (long)step->GetPosition())) });
+            fields.push_back({ "left", quote(FormatTime(step->GetLengthMS() - step->GetPosition())) });
+            fields.push_back({ "leftms", quote(wxString::Format("%ld", (long)(step->GetLengthMS() - step->GetPosition()))) });
+            fields.push_back({ "playlistposition", quote(FormatTime(p->GetPosition())) });
+            fields.push_back({ "playlistpositionms", quote(wxString::Format("%ld", (long)p->GetPosition())) });
+            fields.push_back({ "playlistleft", quote(FormatTime(p->GetLengthMS() - p->GetPosition())) });
+            fields.push_back({ "playlistleftms", quote(wxString::Format("%ld", (long)(p->GetLengthMS() - p->GetPosition()))) });
+            fields.push_back({ "trigger", quote(IsCurrentPlayListScheduled() ? "scheduled" : (_immediatePlay != nullptr) ? "manual" : "queued") });
+            fields.push_back({ "schedulename", quote(scheduled ? rs->GetSchedule()->GetName() : "N/A") });
+            fields.push_back({ "scheduleend", quote(scheduled ? rs->GetSchedule()->GetNextEndTime() : "N/A") });
+            fields.push_back({ "scheduleid", quote(scheduled ? wxString::Format(wxT("%i"), rs->GetSchedule()->GetId()) : "N/A") });
+            fields.push_back({ "nextstep", quote(nextsong) });
+            fields.push_back({ "nextstepid", quote(nextsongid) });
+            fields.push_back({ "version", quote(xlights_version_string) });
+            fields.push_back({ "queuelength", quote(wxString::Format(wxT("%i"), (int)_queuedSongs->GetSteps().size())) });
+            fields.push_back({ "volume", quote(wxString::Format(wxT("%i"), GetVolume())) });
+            fields.push_back({ "brightness", quote(wxString::Format(wxT("%i"), GetBrightness())) });
+            fields.push_back({ "time", quote(wxDateTime::Now().Format("%Y-%m-%d %H:%M:%S")) });
+            fields.push_back({ "autooutputtolights", quote(_manualOTL ? "false" : "true") });
+            fields.push_back({ "passwordset", quote(_scheduleOptions->GetPassword() == "" ? "false" : "true") });
+            fields.push_back({ "outputtolights", quote(_outputManager->IsOutputting() ? "true" : "false") });
+        }
+
+        std::string ping = GetPingStatus();
+        fields.push_back({ "pingstatus", ping.substr(ping.find(':') + 1) });
+    }
+
+    cq._body = "{";
+    for (const auto& it : fields)
+    {
+        if (cq._body.size() > 1)
+        {
+            cq._body += ",";
+        }
+        cq._body += "\"" + it.first + "\":" + it.second;
+    }
+}
+
+// 127.0.0.1/xScheduleQuery?Query=GetPlayLists&Parameters=
+// 127.0.0.1/xScheduleQuery?Query=GetPlayListSteps&Parameters=<playlistname>
+// 127.0.0.1/xScheduleQuery?Query=GetPlayingStatus&Parameters=
+// 127.0.0.1/xScheduleQuery?Query=GetButtons&Parameters=
+
+bool ScheduleManager::Query(const wxString& command, const wxString& parameters, wxString& data, wxString& msg, const wxString& ip, const wxString& reference, std::string* etag)
+{
+    wxASSERT(IsQuery(command));
+
+    bool result = true;
+    data = "";
+    std::string c = command.Lower();
+    if (IsCachedQuery(c))
+    {
+        CachedQuery cq = GetCachedQuery(c, parameters);
+        data = cq._body;
+        if (c == "getplayingstatus")
+        {
+            data += ",\"ip\":\"" + ip + "\"";
+        }
+        data += ",\"reference\":\"" + reference + "\"}";
+        result = cq._result;
+        msg = cq._msg;
+
+        if (etag != nullptr)
+        {
+            // the body is identified by its version ... the rest of the response only varies with the ip and reference
+            *etag = wxString::Format("\"%llx-%zx\"", (unsigned long long)cq._version, std::hash<std::string>()((ip + "|" + reference).ToStdString())).ToStdString();
         }
     }
     else if (c == "getmatrices")
@@ -3785,90 +3968,6 @@ bool ScheduleManager::Query(const wxString& command, const wxString& parameters,
             msg = "Incorrect parameters. Playlist and schedule expected: " + parameters;
         }
     }
-    else if (c == "getplayingstatus")
-    {
-        PlayList* p = GetRunningPlayList();
-        if (p == nullptr || p->GetRunningStep() == nullptr)
-        {
-            data = "{\"status\":\"idle\",\"outputtolights\":\"" + std::string(_outputManager->IsOutputting() ? "true" : "false") +
-                "\",\"volume\":\"" + wxString::Format(wxT("%i"), GetVolume()) +
-				"\",\"brightness\":\"" + wxString::Format(wxT("%i"), GetBrightness()) +
-				"\",\"ip\":\"" + ip +
-                "\",\"version\":\"" + xlights_version_string +
-                "\",\"reference\":\"" + reference +
-                "\",\"passwordset\":\"" + (_scheduleOptions->GetPassword() == ""? "false" : "true") +
-                "\",\"time\":\""+ wxDateTime::Now().Format("%Y-%m-%d %H:%M:%S") +
-                "\"," + GetPingStatus() +"}";
-        }
-        else
-        {
-            std::string nextsong;
-            std::string nextsongid;
-            bool didloop;
-
-            if (p->IsRandom())
-            {
-                nextsong = "God knows";
-                nextsongid = "";
-            }
-            else
-            {
-                auto next = p->GetNextStep(didloop);
-                if (next == nullptr)
-                {
-                    nextsong = "";
-                    nextsongid = "";
-                }
-                else
-                {
-                    nextsong = next->GetNameNoTime();
-                    nextsongid = wxString::Format(wxT("%i"), next->GetId());
-                }
-            }
-
-            RunningSchedule* rs = GetRunningSchedule();
-
-            data = "{\"status\":\"" + std::string(p->IsPaused() ? "paused" : "playing") +
-                "\",\"playlist\":\"" + p->GetNameNoTime() +
-                "\",\"playlistid\":\"" + wxString::Format(wxT("%i"), p->GetId()).ToStdString() +
-                "\",\"playlistlooping\":\"" + (p->IsLooping() || p->GetLoopsLeft() > 0 ? "true" : "false") +
-                "\",\"playlistloopsleft\":\"" + wxString::Format(wxT("%i"),p->GetLoopsLeft()).ToStdString() +
-                "\",\"random\":\"" + (p->IsRandom() ? "true" : "false") +
-                "\",\"step\":\"" + p->GetRunningStep()->GetNameNoTime() +
-                "\",\"stepid\":\"" + wxString::Format(wxT("%i"), p->GetRunningStep()->GetId()).ToStdString() +
-                "\",\"steplooping\":\"" + (p->IsStepLooping() || p->GetRunningStep()->GetLoopsLeft() > 0 ? "true" : "false") +
-                "\",\"steploopsleft\":\"" + wxString::Format(wxT("%i"), p->GetRunningStep()->GetLoopsLeft()).ToStdString() +
-                "\",\"length\":\"" + FormatTime(p->GetRunningStep()->GetLengthMS()) +
-                "\",\"lengthms\":\"" + wxString::Format("%ld", (long)(p->GetRunningStep()->GetLengthMS())) +
-                "\",\"position\":\"" + FormatTime(p->GetRunningStep()->GetPosition()) +
-                "\",\"positionms\":\"" + wxString::Format("%ld", (long)(p->GetRunningStep()->GetPosition())) +
-                "\",\"left\":\"" + FormatTime(p->GetRunningStep()->GetLengthMS() - p->GetRunningStep()->GetPosition()) +
-                "\",\"leftms\":\"" + wxString::Format("%ld", (long)(p->GetRunningStep()->GetLengthMS() - p->GetRunningStep()->GetPosition())) +
-                "\",\"playlistposition\":\"" + FormatTime(p->GetPosition()) +
-                "\",\"playlistpositionms\":\"" + wxString::Format("%ld", (long)(p->GetPosition())) +
-                "\",\"playlistleft\":\"" + FormatTime(p->GetLengthMS() - p->GetPosition()) +
-                "\",\"playlistleftms\":\"" + wxString::Format("%ld", (long)(p->GetLengthMS() - p->GetPosition())) +
-                "\",\"trigger\":\"" + std::string(IsCurrentPlayListScheduled() ? "scheduled": (_immediatePlay != nullptr) ? "manual" : "queued") +
-                "\",\"schedulename\":\"" + std::string((IsCurrentPlayListScheduled() && rs != nullptr) ? rs->GetSchedule()->GetName() : "N/A") +
-                "\",\"scheduleend\":\"" + std::string((IsCurrentPlayListScheduled() && rs != nullptr) ? rs->GetSchedule()->GetNextEndTime() : "N/A") +
-                "\",\"scheduleid\":\"" + std::string((IsCurrentPlayListScheduled() && rs != nullptr) ? wxString::Format(wxT("%i"), rs->GetSchedule()->GetId()).ToStdString()  : "N/A") +
-                "\",\"nextstep\":\"" + nextsong +
-                "\",\"nextstepid\":\"" + nextsongid +
-                "\",\"version\":\"" + xlights_version_string +
-                "\",\"queuelength\":\"" + wxString::Format(wxT("%i"), (long)_queuedSongs->GetSteps().size()) +
-                "\",\"volume\":\"" + wxString::Format(wxT("%i"), GetVolume()) +
-                "\",\"brightness\":\"" + wxString::Format(wxT("%i"), GetBrightness()) +
-				"\",\"time\":\"" + wxDateTime::Now().Format("%Y-%m-%d %H:%M:%S") +
-                "\",\"ip\":\"" + ip +
-                "\",\"reference\":\"" + reference +
-                "\",\"autooutputtolights\":\"" + (_manualOTL ? "false" : "true") +
-                "\",\"passwordset\":\"" + (_scheduleOptions->GetPassword() == "" ? "false" : "true") +
-                "\",\"outputtolights\":\"" + std::string(_outputManager->IsOutputting() ? "true" : "false") + 
-                "\"," + GetPingStatus() + "}";
-            //static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
-            //logger_base.info("%s", (const char*)data.c_str());
-        }
-    }
     else if (c == "getbuttons")
     {
         data = _scheduleOptions->GetButtonsJSON(_commandManager, reference);
@@ -11,7 +11,9 @@
  **************************************************************/
 
 #include <list>
+#include <map>
 #include <string>
+#include <vector>
 #include <wx/wx.h>
 #include "Schedule.h"
 #include "CommandManager.h"
@@ -54,6 +56,19 @@ public:
     size_t GetStartChannel() const { return _startChannel; }
 };
 
+// A pre-serialised answer to one of the queries web clients and plugins poll continuously.
+// It is rebuilt when the schedule changes or it gets too old and is otherwise served as is.
+struct CachedQuery
+{
+    uint64_t _version = 0;      // unique across all cached queries ... changes only when the body does
+    uint64_t _stateVersion = 0; // the schedule state it was built from
+    long long _builtMS = 0;
+    bool _result = true;
+    std::string _msg;
+    std::string _body;          // the JSON without the per client fields or the closing brace
+    std::vector<std::pair<std::string, std::string>> _fields; // name and JSON value of every field in the body
+};
+
 class ActionMessageData
 {
 public:
@@ -106,8 +121,13 @@ class ScheduleManager
     bool _webRequestToggle = false;
     Pinger* _pinger = nullptr;
     std::unique_ptr<SyncManager> _syncManager = nullptr;
+    std::map<std::string, CachedQuery> _queryCache;
+    uint64_t _stateVersion = 1;
+    uint64_t _lastQueryVersion = 0;
 
     void DisableRemoteOutputs();
+    bool IsCachedQuery(const std::string& command) const;
+    void BuildCachedQuery(const std::string& command, const wxString& parameters, CachedQuery& cq);
     std::string GetPingStatus();
     std::string FormatTime(size_t timems);
     void CreateBrightnessArray();
@@ -183,11 +203,12 @@ class ScheduleManager
         std::string GetShowDir() const { return _showDir; }
         bool PlayPlayList(PlayList* playlist, size_t& rate, bool loop = false, const std::string& step = "", bool forcelast = false, int loops = -1, bool random = false, int steploops = -1);
         bool IsSomethingPlaying() const { return GetRunningPlayList() != nullptr; }
-        void OptionsChanged() { _changeCount++; };
-        void OutputProcessingChanged() { _changeCount++; };
+        void OptionsChanged() { _changeCount++; _stateVersion++; };
+        void OutputProcessingChanged() { _changeCount++; _stateVersion++; };
         bool Action(const wxString& label, PlayList* selplaylist, PlayListStep* selplayliststep, Schedule* selschedule, size_t& rate, wxString& msg);
         bool Action(const wxString& command, const wxString& parameters, const wxString& data, PlayList* selplaylist, PlayListStep* selplayliststep, Schedule* selschedule, size_t& rate, wxString& msg);
-        bool Query(const wxString& command, const wxString& parameters, wxString& data, wxString& msg, const wxString& ip, const wxString& reference);
+        bool Query(const wxString& command, const wxString& parameters, wxString& data, wxString& msg, const wxString& ip, const wxString& reference, std::string* etag = nullptr);
+        CachedQuery GetCachedQuery(const std::string& command, const wxString& parameters);
         bool IsQuery(const wxString& command);
         PlayList * GetPlayList(const std::string& playlist) const;
         void StopPlayList(PlayList* playlist, bool atendofcurrentstep, bool sustain = false);
@@ -216,6 +237,7 @@ class ScheduleManager
         static std::string xScheduleShowDir();
         bool ShowDirectoriesMatch() const;
         int GetPPS() const;
+        int GetSuppressedPacketPercent() const;
         void StartListeners();
         int Sync(const std::string& filename, long ms);
         int DoSync(const std::string& filename, long ms);
@@ -22,6 +22,10 @@
 #include "../xLights/UtilFunctions.h"
 #include "md5.h"
 
+#include <list>
+#include <map>
+#include <vector>
+
 #include <log4cpp/Category.hh>
 
 #undef WXUSINGDLL
@@ -35,6 +39,9 @@ std::list<std::string> __Loggedin;
 int __loginTimeout = 30;
 std::string __validPass = "";
 std::string __defaultPage = "index.html";
+std::map<long, bool> __statusSubscribers; // websocket connections wanting status deltas ... true once they have had a full status
+std::vector<std::pair<std::string, std::string>> __lastStatusFields;
+uint64_t __lastStatusVersion = 0;
 
 void WebServer::GeneratePass()
 {
@@ -258,7 +265,7 @@ wxString ProcessPluginRequest(HttpConnection& connection, const wxString& plugin
     return ((xScheduleFrame*)wxTheApp->GetTopWindow())->ProcessPluginRequest(plugin, command, parameters, data, reference);
 }
 
-wxString ProcessQuery(HttpConnection &connection, const wxString& query, const wxString& parameters, const wxString& reference, const std::string& pass)
+wxString ProcessQuery(HttpConnection &connection, const wxString& query, const wxString& parameters, const wxString& reference, const std::string& pass, std::string* etag = nullptr)
 {
     wxStopWatch sw;
     static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
@@ -279,7 +286,7 @@ wxString ProcessQuery(HttpConnection &connection, const wxString& query, const w
 
     wxString result = "";
     wxString msg;
-    if (xScheduleFrame::GetScheduleManager()->Query(query, parameters, result, msg, connection.Address().IPAddress(), reference))
+    if (xScheduleFrame::GetScheduleManager()->Query(query, parameters, result, msg, connection.Address().IPAddress(), reference, etag))
     {
 #ifndef DETAILED_LOGGING
         if (query != "GetPlayingStatus")
@@ -576,11 +583,23 @@ bool MyRequestHandler(HttpConnection& connection, HttpRequest& request)
         wxString parameters = parms["Parameters"];
         wxString reference = parms["Reference"];
 
-        wxString result = ProcessQuery(connection, query, parameters, reference, "");
+        std::string etag;
+        wxString result = ProcessQuery(connection, query, parameters, reference, "", &etag);
 
-        HttpResponse response(connection, request, HttpStatus::OK);
-        response.MakeFromText(result, "application/json");
-        connection.SendResponse(response);
+        if (etag != "" && request["If-None-Match"].Contains(etag)) {
+            // the client already has this exact status
+            HttpResponse response(connection, request, HttpStatus::NotModified);
+            response.AddHeader("ETag", etag);
+            connection.SendResponse(response);
+        }
+        else {
+            HttpResponse response(connection, request, HttpStatus::OK);
+            response.MakeFromText(result, "application/json");
+            if (etag != "") {
+                response.AddHeader("ETag", etag);
+            }
+            connection.SendResponse(response);
+        }
 
         res = true;
     }
@@ -767,6 +786,20 @@ void MyMessageHandler(HttpConnection& connection, WebSocketMessage& message)
                 wxString r = root.Get("r", defaultValue).AsString();
                 result = ProcessXyzzy(connection, c, p, r, "");
             }
+            else if (type == "subscribe")
+            {
+                wxString d = root.Get("Deltas", defaultValue).AsString().Lower();
+                wxString r = root.Get("Reference", defaultValue).AsString();
+                if (d == "true")
+                {
+                    __statusSubscribers[connection.Id()] = false;
+                }
+                else
+                {
+                    __statusSubscribers.erase(connection.Id());
+                }
+                result = "{\"result\":\"ok\",\"reference\":\"" + r + "\"}";
+            }
             else if (type == "login")
             {
                 wxString c = root.Get("Credential", defaultValue).AsString();
@@ -832,12 +865,15 @@ void WebServer::SendMessageToAllWebSockets(const wxString& message)
     }
     reentry = true;
 
+    // the message is framed once and the same bytes queued to every client
+    WebSocketMessage wsm(message);
+    BroadcastMessage(wsm);
+
     for (auto it = _connections.begin(); it != _connections.end(); ++it)
     {
         if ((*it).second->IsWebSocket())
         {
-            WebSocketMessage wsm(message);
-            if (it->second->SendMessage(wsm))
+            if (it->second->IsOpen())
             {
                 UpdateValid(*it->second);
             }
@@ -851,6 +887,82 @@ void WebServer::SendMessageToAllWebSockets(const wxString& message)
     reentry = false;
 }
 
+void WebServer::SendStatusToAllWebSockets(const wxString& status, const CachedQuery& cq)
+{
+    // clients that have subscribed to deltas only get the fields that changed since the last status
+    bool sameFields = cq._fields.size() == __lastStatusFields.size();
+    std::string delta = "{\"delta\":\"true\",\"statusversion\":\"" + wxString::Format("%llu", (unsigned long long)cq._version).ToStdString() + "\"";
+    for (size_t i = 0; sameFields && i < cq._fields.size(); i++)
+    {
+        if (cq._fields[i].first != __lastStatusFields[i].first)
+        {
+            sameFields = false;
+        }
+        else if (cq._fields[i].second != __lastStatusFields[i].second)
+        {
+            delta += ",\"" + cq._fields[i].first + "\":" + cq._fields[i].second;
+        }
+    }
+    delta += "}";
+
+    std::list<long> full;
+    std::list<long> deltas;
+    std::map<long, bool> subscribers;
+    for (auto it = _connections.begin(); it != _connections.end(); ++it)
+    {
+        if (!it->second->IsWebSocket() || !it->second->IsOpen()) continue;
+
+        auto sub = __statusSubscribers.find(it->first);
+        if (sub == __statusSubscribers.end())
+        {
+            full.push_back(it->first);
+        }
+        else
+        {
+            if (!sub->second || !sameFields)
+            {
+                full.push_back(it->first);
+            }
+            else if (cq._version != __lastStatusVersion)
+            {
+                deltas.push_back(it->first);
+            }
+            subscribers[it->first] = true;
+        }
+    }
+    // this also forgets connections which have closed
+    __statusSubscribers = subscribers;
+    __lastStatusFields = cq._fields;
+    __lastStatusVersion = cq._version;
+
+    // each message is framed once and the same bytes queued to every client
+    if (full.size() > 0)
+    {
+        WebSocketMessage wsm(status);
+        SendMessageTo(full, wsm);
+    }
+    if (deltas.size() > 0)
+    {
+        WebSocketMessage wsm(delta);
+        SendMessageTo(deltas, wsm);
+    }
+
+    for (auto it = _connections.begin(); it != _connections.end(); ++it)
+    {
+        if ((*it).second->IsWebSocket())
+        {
+            if (it->second->IsOpen())
+            {
+                UpdateValid(*it->second);
+            }
+            else
+            {
+                RemoveFromValid(*it->second);
+            }
+        }
+    }
+}
+
 bool WebServer::IsSomeoneListening() const
 {
     for (auto it : _connections)
@@ -12,6 +12,8 @@
 
 #include "wxHTTPServer/wxhttpserver.h"
 
+struct CachedQuery;
+
 class WebServer : HttpServer
 {
 
@@ -24,6 +26,7 @@ public:
         void SetPassword(const wxString& password);
         void GeneratePass();
         void SendMessageToAllWebSockets(const wxString& message);
+        void SendStatusToAllWebSockets(const wxString& status, const CachedQuery& cq);
         bool IsSomeoneListening() const;
         void SetAllowUnauthenticatedPagesToBypassLogin(bool allowUnauthPages);
         void SetDefaultPage(const std::string& defaultPage);
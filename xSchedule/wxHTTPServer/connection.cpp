@@ -19,285 +19,220 @@
 #include <wx/base64.h>
 #include <wx/filename.h>
 
-HttpConnection::HttpConnection(HttpServer *server, wxSocketBase *socket) :
+HttpConnection::HttpConnection(HttpServer *server, long id, const wxString &ip, unsigned short port) :
 	_server(server),
-	_socket(socket),
+	_id(id),
 	_isWebSocket(false),
-	_message(NULL)
+	_open(true)
 {
-	if (!_socket->GetPeer(_address))
-		wxLogMessage(_("accepted a new connection from <unknown> (socket %d)"), socket->GetSocket());
-	else
-		wxLogMessage(_("accepted a new connection from %s:%u (socket %d)"), _address.IPAddress(), _address.Service(), socket->GetSocket());
+	_address.Hostname(ip);
+	_address.Service(port);
+	wxLogMessage(_("accepted a new connection from %s:%u (connection %ld)"), ip, port, id);
 }
 
 HttpConnection::~HttpConnection()
 {
-	wxLogMessage(_("connection closed (socket %d)"), _socket->GetSocket());
+	wxLogMessage(_("connection closed (connection %ld)"), _id);
 }
 
-bool HttpConnection::HandleRequest()
+bool HttpConnection::HandleRequest(const std::string &input)
 {
-	_socket->SetFlags(wxSOCKET_NOWAIT);
-
-	wxMemoryBuffer input;
-	char           buffer[1024];
+	HttpRequest request(*this, wxString(input.c_str(), input.size()));
 
-	do
-	{
-		_socket->Read(buffer, sizeof(buffer));
-		input.AppendData(buffer, _socket->LastReadCount());
-	} while (_socket->LastReadCount() > 0);
-
-	if (_isWebSocket)
-	{
-		return ParseFrame(input);
-	}
-	else
+	if (request.Method() == "GET")
 	{
-		HttpRequest request(*this, wxString((char *)input.GetData(), input.GetDataLen()));
-
-		if (request.Method() == "GET")
+		if (request["Upgrade"].CmpNoCase("websocket") == 0)
 		{
-			if (request["Upgrade"].CmpNoCase("websocket") == 0)
+			if (!request["Host"].IsEmpty() && !request["Connection"].IsEmpty() &&
+				!request["Sec-WebSocket-Key"].IsEmpty() && !request["Sec-WebSocket-Version"].IsEmpty())
+				return WebSocketHandshake(request);
+			else
 			{
-				if (!request["Host"].IsEmpty() && !request["Connection"].IsEmpty() &&
-					!request["Sec-WebSocket-Key"].IsEmpty() && !request["Sec-WebSocket-Version"].IsEmpty())
-					return WebSocketHandshake(request);
-				else
-                {
-                    HttpResponse hr(*this, request, HttpStatus::BadRequest);
-					return SendResponse(hr);
-                }
+				HttpResponse hr(*this, request, HttpStatus::BadRequest);
+				return SendResponse(hr);
 			}
-			else
+		}
+		else
+		{
+			if (_server->_context.RequestHandler)
 			{
-				if (_server->_context.RequestHandler)
-				{
-					if (_server->_context.RequestHandler(*this, request))
-						return true;
-				}
+				if (_server->_context.RequestHandler(*this, request))
+					return true;
+			}
 
-				wxString fileName(_server->_context.DefaultDirectory);
-				fileName += wxFILE_SEP_PATH;
+			wxString fileName(_server->_context.DefaultDirectory);
+			fileName += wxFILE_SEP_PATH;
 
-				if (request.URI() == "/")
+			if (request.URI() == "/")
+			{
+				for (size_t i = 0; i < _server->_context.DefaultDocuments.Count(); i++)
 				{
-					for (size_t i = 0; i < _server->_context.DefaultDocuments.Count(); i++)
+					if (wxFileName::FileExists(fileName + _server->_context.DefaultDocuments[i]))
 					{
-						if (wxFileName::FileExists(fileName + _server->_context.DefaultDocuments[i]))
-						{
-							fileName += _server->_context.DefaultDocuments[i];
-							break;
-						}
+						fileName += _server->_context.DefaultDocuments[i];
+						break;
 					}
 				}
-				else
-					fileName += request.URI().Mid(1);
+			}
+			else
+				fileName += request.URI().Mid(1);
 
-				HttpResponse response(*this, request, fileName);
+			HttpResponse response(*this, request, fileName);
 
-				return SendResponse(response);
-			}
+			return SendResponse(response);
 		}
-		else
+	}
+	else
+	{
+		// all others requests are routed to custom implementations
+		if (_server->_context.RequestHandler)
 		{
-			// all others requests are routed to custom implementations
-			if (_server->_context.RequestHandler)
-			{
-				if (_server->_context.RequestHandler(*this, request))
-					return true;
-			}
+			if (_server->_context.RequestHandler(*this, request))
+				return true;
 		}
+
+		// the connection is kept open so the client must get an answer or any requests
+		// it has pipelined behind this one will never be answered
+		HttpResponse hr(*this, request, HttpStatus::NotFound);
+		SendResponse(hr);
 	}
 
 	return false;
 }
 
+bool HttpConnection::HandleMessage(int opcode, const std::string &content)
+{
+	WebSocketMessage message((WebSocketMessage::Opcode)opcode);
+	message._content.AppendData(content.c_str(), content.size());
+
+	if (message._type == WebSocketMessage::Ping)
+		wxLogMessage("received a PING message");
+
+	if (message._type == WebSocketMessage::Pong)
+		wxLogMessage("received a PONG message");
+
+	if (_server->_context.MessageHandler)
+		_server->_context.MessageHandler(*this, message);
+
+	switch (message._type)
+	{
+	case WebSocketMessage::Ping:
+		{
+			WebSocketMessage wsm(WebSocketMessage::Pong);
+			wsm._content.AppendData(content.c_str(), content.size());
+			SendMessage(wsm);
+		}
+		break;
+	case WebSocketMessage::Close:
+		{
+			WebSocketMessage wsm(WebSocketMessage::Close);
+			SendMessage(wsm);
+			Close();
+		}
+		break;
+	default:
+		break;
+	}
+
+	return true;
+}
+
 bool HttpConnection::SendResponse(HttpResponse &response)
 {
-    _socket->SetFlags(wxSOCKET_WAITALL);
-	wxString row = wxString::Format("%s %d %s\r\n", response.Version(), response.Status().Code(), response.Status().Description());
-	_socket->Write(row.ToAscii(), row.Length());
-    if (_socket->Error()) {
-        _socket->SetFlags(wxSOCKET_NOWAIT);
-        return false;
-    }
+	if (!_open) return false;
 
+	bool upgrade = response.Status().Code() == HttpStatus::SwitchingProtocols;
+
+	// keep the connection open unless the client does not want it or the websocket upgrade failed
+	bool close = false;
+	if (!upgrade)
+	{
+		wxString connection = response._request["Connection"].Lower();
+		if (connection.Contains("close") ||
+			(response._request.Version() == "HTTP/1.0" && !connection.Contains("keep-alive")) ||
+			response._request["Upgrade"].CmpNoCase("websocket") == 0)
+		{
+			close = true;
+		}
+	}
+
+	wxString head = wxString::Format("%s %d %s\r\n", response.Version(), response.Status().Code(), response.Status().Description());
+
+	bool hasLength = false;
 	for (size_t i = 0; i < response.Headers().Count(); i++)
 	{
-		wxString header = response[i];
-		_socket->Write(header.ToAscii(), header.Length());
-        if (_socket->Error()) {
-            _socket->SetFlags(wxSOCKET_NOWAIT);
-            return false;
-        }
+		HttpHeader &header = response.Headers().Item(i);
+
+		if (!upgrade && header._key.CmpNoCase("Connection") == 0) continue;
+		if (header._key.CmpNoCase("Content-Length") == 0) hasLength = true;
+
+		head += response[i];
 	}
 
-	_socket->Write("\r\n", 2);
-    if (_socket->Error()) {
-        _socket->SetFlags(wxSOCKET_NOWAIT);
-        return false;
-    }
-    
-	if (!response._content.IsEmpty())
+	if (!upgrade)
 	{
-		_socket->Write(response._content.GetData(), response._content.GetDataLen());
-        if (_socket->Error()) {
-            _socket->SetFlags(wxSOCKET_NOWAIT);
-            return false;
-        }
+		// without a length a kept alive client cannot tell where the response ends
+		if (!hasLength && response.Status().Code() != HttpStatus::NotModified && response.Status().Code() != HttpStatus::NoContent)
+			head += wxString::Format("Content-Length: %zu\r\n", response._content.GetDataLen());
+		head += close ? "Connection: close\r\n" : "Connection: keep-alive\r\n";
 	}
+	head += "\r\n";
+
+	auto data = std::make_shared<std::string>(head.ToStdString());
+	if (!response._content.IsEmpty())
+		data->append((const char *)response._content.GetData(), response._content.GetDataLen());
+
+	_server->_io->Send(_id, data, close);
+	if (close) _open = false;
 
-    _socket->SetFlags(wxSOCKET_NOWAIT);
 	return true;
 }
 
-bool HttpConnection::SendMessage(WebSocketMessage &message)
+std::shared_ptr<const std::string> HttpConnection::FrameMessage(const WebSocketMessage &message)
 {
-    // As we are just writing dont set it to wait
-    //_socket->SetFlags(wxSOCKET_WAITALL);
-	wxMemoryBuffer header;
+	auto frame = std::make_shared<std::string>();
+	size_t len = message._content.GetDataLen();
+	frame->reserve(len + 10);
 
-	header.AppendByte((wxUint8)0x80 | message._type); // final + type
+	frame->push_back((char)(0x80 | message._type)); // final + type
 
-	if (message._content.GetDataLen() > 0xFFFF)
+	if (len > 0xFFFF)
 	{
-		wxUint64 tmp = message._content.GetDataLen();
-		header.AppendByte(127);
+		frame->push_back((char)127);
 		for (int i = 7; i >= 0; i--)
-		{
-			header.AppendByte((wxUint8)(tmp & 0x0FF));
-			tmp = tmp / 0x100;
-		}
+			frame->push_back((char)(((wxUint64)len >> (8 * i)) & 0xFF));
 	}
-	else if (message._content.GetDataLen() > 125)
+	else if (len > 125)
 	{
-		header.AppendByte(126);
-		header.AppendByte((wxUint8)((message._content.GetDataLen() & 0xFF00) / 0x100));
-		header.AppendByte((wxUint8)(message._content.GetDataLen() & 0xFF));
+		frame->push_back((char)126);
+		frame->push_back((char)((len >> 8) & 0xFF));
+		frame->push_back((char)(len & 0xFF));
 	}
 	else
 	{
-		header.AppendByte((wxUint8) message._content.GetDataLen());
+		frame->push_back((char)len);
 	}
 
-	_socket->Write(header.GetData(), header.GetDataLen());
-    if (_socket->Error())
-    {
-        _socket->SetFlags(wxSOCKET_NOWAIT);
-        return false;
-    }
+	if (len > 0)
+		frame->append((const char *)message._content.GetData(), len);
 
-	if (!message._content.IsEmpty())
-		_socket->Write(message._content.GetData(), message._content.GetDataLen());
-
-    _socket->SetFlags(wxSOCKET_NOWAIT);
-    return !_socket->Error();
+	return frame;
 }
 
-bool HttpConnection::Close()
+bool HttpConnection::SendMessage(WebSocketMessage &message)
 {
-	wxASSERT(_socket);
+	if (!_open) return false;
 
-	bool result = _socket->Close();
-	_socket = NULL;
-
-	return result;
+	_server->_io->Send(_id, FrameMessage(message), false);
+	return true;
 }
 
-bool HttpConnection::ParseFrame(wxMemoryBuffer &buffer)
+bool HttpConnection::Close()
 {
-	if (buffer.GetDataLen() < 2)
-		return false;
-
-    bool done = false;
-    int pos = 0;
+	if (!_open) return false;
 
-    while (!done)
-    {
-        bool final = buffer[pos + 0] & 0x80 ? true : false;
-
-        if (((buffer[pos + 0] & 0x40) != 0) || ((buffer[pos + 0] & 0x20) != 0) || ((buffer[pos + 0] & 0x10) != 0))
-        {
-            wxLogWarning("reserved bits must be 0");
-            return false; // Invalid ws message
-        }
-
-        WebSocketMessage::Opcode type = (WebSocketMessage::Opcode)(buffer[pos + 0] & 0x0F);
-
-        if (!_message)
-            _message = new WebSocketMessage(type);
-
-        //ws_conn->close  = ((buffer[0] & 0x0F) == 0x08);
-        //ws_conn->ping   = ((buffer[0] & 0x0F) == 0x09);
-        //ws_conn->pong   = ((buffer[0] & 0x0F) == 0x0A);
-
-        if (type == WebSocketMessage::Ping)
-            wxLogMessage("received a PING message");
-
-        if (type == WebSocketMessage::Pong)
-            wxLogMessage("received a PONG message");
-
-        int length = buffer[pos + 1] & 0x7F;
-        int     start = 2;
-        wxUint8 mask[4] = { 0 };
-
-        if (length == 126)
-        {
-            length = ((((int)buffer[pos + 2]) << 8) + buffer[pos + 3]);
-            start = 4;
-        }
-        else if (length == 127)
-        {
-            length = 0;
-            for (int i = 0; i < 8; i++)
-                length = (wxUint64)length * 0x100 + buffer[pos + 2 + i];
-            start = 10;
-        }
-
-        if (buffer[pos + 1] & 128)
-        {
-            memcpy(mask, &(buffer[pos + start]), 4);
-            start += 4;
-        }
-
-        for (int i = 0; i < length; i++)
-            _message->_content.AppendByte(buffer[pos + start + i] ^ mask[i % 4]);
-
-        if (final && _server->_context.MessageHandler)
-        {
-            _server->_context.MessageHandler(*this, *_message);
-
-            switch (_message->_type)
-            {
-            case WebSocketMessage::Ping:
-            {
-                WebSocketMessage wsm(WebSocketMessage::Pong);
-                SendMessage(wsm);
-            }
-            break;
-            case WebSocketMessage::Close:
-            {
-                WebSocketMessage wsm(WebSocketMessage::Close);
-                SendMessage(wsm);
-            }
-            break;
-            default:
-            break;
-            }
-
-            delete _message;
-            _message = nullptr;
-        }
-
-        pos += start + length;
-
-        if (pos >= buffer.GetDataLen())
-        {
-            done = true;
-        }
-    }
+	_open = false;
+	_server->_io->Close(_id);
 
 	return true;
 }
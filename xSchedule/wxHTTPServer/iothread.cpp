@@ -0,0 +1,779 @@
+/***************************************************************
+ * This source files comes from the xLights project
+ * https://www.xlights.org
+ * https://github.com/smeighan/xLights
+ * See the github commit history for a record of contributing
+ * developers.
+ * Copyright claimed based on commit dates recorded in Github
+ * License: https://github.com/smeighan/xLights/blob/master/License.txt
+ **************************************************************/
+
+#ifdef __WXMSW__
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#endif
+
+#include "wxhttpserver.h"
+
+#include <log4cpp/Category.hh>
+
+#include <chrono>
+#include <cstring>
+#include <set>
+#include <vector>
+
+#ifdef __WXMSW__
+#ifdef _MSC_VER
+#pragma comment(lib, "ws2_32.lib")
+#endif
+typedef SOCKET NativeSocket;
+#define INVALID_NATIVE_SOCKET INVALID_SOCKET
+#define SEND_FLAGS 0
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#ifdef __LINUX__
+#include <sys/epoll.h>
+#endif
+typedef int NativeSocket;
+#define INVALID_NATIVE_SOCKET -1
+#ifdef MSG_NOSIGNAL
+#define SEND_FLAGS MSG_NOSIGNAL
+#else
+#define SEND_FLAGS 0
+#endif
+#endif
+
+//#define DETAILED_LOGGING
+
+// limits on what a client can make us buffer before we give up on it
+#define HTTPIO_MAXHEADER (64 * 1024)
+#define HTTPIO_MAXBODY (16 * 1024 * 1024)
+#define HTTPIO_READSIZE 16384
+// plain HTTP connections idle for this long are closed ... websockets are left alone
+#define HTTPIO_IDLETIMEOUTMS 60000
+#define HTTPIO_LISTENID -1
+#define HTTPIO_WAKEID -2
+
+struct HttpIOSocket
+{
+	long         id;
+	NativeSocket socket;
+	bool         webSocket = false;
+	bool         closeAfterWrite = false;
+	bool         continueSent = false;
+	bool         watchingWrite = false;
+	std::string  input;
+	std::list<std::shared_ptr<const std::string>> output;
+	size_t       outputOffset = 0;
+	int          messageOpcode = -1; // opcode of a fragmented websocket message being assembled
+	std::string  message;
+	std::chrono::steady_clock::time_point lastActivity;
+
+	HttpIOSocket(long i, NativeSocket s) : id(i), socket(s), lastActivity(std::chrono::steady_clock::now()) {}
+};
+
+static void CloseNativeSocket(NativeSocket s)
+{
+#ifdef __WXMSW__
+	closesocket(s);
+#else
+	close(s);
+#endif
+}
+
+static bool SetNonBlocking(NativeSocket s)
+{
+#ifdef __WXMSW__
+	u_long mode = 1;
+	return ioctlsocket(s, FIONBIO, &mode) == 0;
+#else
+	int flags = fcntl(s, F_GETFL, 0);
+	return flags != -1 && fcntl(s, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+// true if the last socket call failed only because it would have had to wait
+static bool WouldBlock()
+{
+#ifdef __WXMSW__
+	int e = WSAGetLastError();
+	return e == WSAEWOULDBLOCK || e == WSAEINTR;
+#else
+	return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+static std::string LowerTrim(const std::string &s)
+{
+	size_t start = s.find_first_not_of(" \t\r");
+	if (start == std::string::npos) return "";
+	size_t end = s.find_last_not_of(" \t\r");
+
+	std::string res = s.substr(start, end - start + 1);
+	for (auto &c : res)
+	{
+		c = (char)tolower((unsigned char)c);
+	}
+	return res;
+}
+
+HttpIOThread::HttpIOThread(HttpServer *server) :
+	wxThread(wxTHREAD_JOINABLE),
+	_server(server),
+	_stop(false)
+{
+#ifdef __WXMSW__
+	WSADATA wsaData;
+	WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif
+}
+
+HttpIOThread::~HttpIOThread()
+{
+	for (auto &it : _sockets)
+	{
+		CloseNativeSocket(it.second->socket);
+		delete it.second;
+	}
+	_sockets.clear();
+
+	if (_listen != nullptr)
+	{
+		CloseNativeSocket(_listen->socket);
+		delete _listen;
+		_listen = nullptr;
+	}
+
+	if (_wake != nullptr)
+	{
+		CloseNativeSocket(_wake->socket);
+		delete _wake;
+		_wake = nullptr;
+	}
+
+#ifdef __LINUX__
+	if (_poll != -1)
+	{
+		close(_poll);
+		_poll = -1;
+	}
+#endif
+
+#ifdef __WXMSW__
+	WSACleanup();
+#endif
+}
+
+bool HttpIOThread::Listen(unsigned short port)
+{
+	static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+	NativeSocket s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (s == INVALID_NATIVE_SOCKET)
+	{
+		logger_base.error("Web server unable to create listening socket.");
+		return false;
+	}
+
+#ifndef __WXMSW__
+	// on windows this would let another program steal the port
+	int reuse = 1;
+	setsockopt(s, SOL_SOCKET, SO_REUSEADDR, (const char *)&reuse, sizeof(reuse));
+#endif
+
+	sockaddr_in addr;
+	memset(&addr, 0x00, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_ANY);
+	addr.sin_port = htons(port);
+
+	if (bind(s, (sockaddr *)&addr, sizeof(addr)) != 0 || listen(s, SOMAXCONN) != 0 || !SetNonBlocking(s))
+	{
+		logger_base.error("Web server unable to listen on port %u.", port);
+		CloseNativeSocket(s);
+		return false;
+	}
+	_listen = new HttpIOSocket(HTTPIO_LISTENID, s);
+
+	// other threads wake us up by sending a byte to this socket which is connected to itself
+	NativeSocket w = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	sockaddr_in wakeAddr;
+	memset(&wakeAddr, 0x00, sizeof(wakeAddr));
+	wakeAddr.sin_family = AF_INET;
+	wakeAddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	wakeAddr.sin_port = 0;
+	socklen_t wakeAddrLen = sizeof(wakeAddr);
+	if (w == INVALID_NATIVE_SOCKET ||
+		bind(w, (sockaddr *)&wakeAddr, sizeof(wakeAddr)) != 0 ||
+		getsockname(w, (sockaddr *)&wakeAddr, &wakeAddrLen) != 0 ||
+		connect(w, (sockaddr *)&wakeAddr, wakeAddrLen) != 0 ||
+		!SetNonBlocking(w))
+	{
+		logger_base.error("Web server unable to create wake socket.");
+		if (w != INVALID_NATIVE_SOCKET) CloseNativeSocket(w);
+		return false;
+	}
+	_wake = new HttpIOSocket(HTTPIO_WAKEID, w);
+
+#ifdef __LINUX__
+	_poll = epoll_create1(EPOLL_CLOEXEC);
+	if (_poll == -1)
+	{
+		logger_base.error("Web server unable to create epoll.");
+		return false;
+	}
+	Watch(_listen, true);
+	Watch(_wake, true);
+#endif
+
+	return true;
+}
+
+void HttpIOThread::Stop()
+{
+	if (_stop) return;
+
+	_stop = true;
+	Wake();
+	Wait();
+}
+
+void HttpIOThread::Wake()
+{
+	if (_wake == nullptr) return;
+
+	char c = 0;
+	send(_wake->socket, &c, 1, 0);
+}
+
+void HttpIOThread::Send(long id, const std::shared_ptr<const std::string> &data, bool closeAfter)
+{
+	{
+		std::unique_lock<std::mutex> lock(_outboundLock);
+		_outbound.push_back({ id, data, closeAfter });
+	}
+	Wake();
+}
+
+void HttpIOThread::Send(const std::list<long> &ids, const std::shared_ptr<const std::string> &data)
+{
+	{
+		std::unique_lock<std::mutex> lock(_outboundLock);
+		for (const auto &it : ids)
+		{
+			_outbound.push_back({ it, data, false });
+		}
+	}
+	Wake();
+}
+
+void HttpIOThread::Close(long id)
+{
+	Send(id, nullptr, true);
+}
+
+bool HttpIOThread::TakeEvents(std::list<HttpIOEvent> &events, size_t max)
+{
+	std::unique_lock<std::mutex> lock(_eventLock);
+
+	while (!_events.empty() && events.size() < max)
+	{
+		events.push_back(std::move(_events.front()));
+		_events.pop_front();
+	}
+
+	if (_events.empty())
+	{
+		_eventsPosted = false;
+		return false;
+	}
+	return true;
+}
+
+void HttpIOThread::PostEvent(HttpIOEvent &&event)
+{
+	std::unique_lock<std::mutex> lock(_eventLock);
+	_events.push_back(std::move(event));
+
+	// only ask for one call at a time ... it takes everything queued by then
+	if (!_eventsPosted)
+	{
+		_eventsPosted = true;
+		_server->CallAfter(&HttpServer::OnIOEvents);
+	}
+}
+
+void HttpIOThread::Watch(HttpIOSocket *socket, bool add)
+{
+#ifdef __LINUX__
+	bool wantWrite = !socket->output.empty();
+	if (!add && wantWrite == socket->watchingWrite) return;
+
+	epoll_event ev;
+	memset(&ev, 0x00, sizeof(ev));
+	ev.events = EPOLLIN | (wantWrite ? EPOLLOUT : 0);
+	ev.data.u64 = (uint64_t)(int64_t)socket->id;
+	epoll_ctl(_poll, add ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, socket->socket, &ev);
+	socket->watchingWrite = wantWrite;
+#endif
+}
+
+void HttpIOThread::Accept()
+{
+	static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+	while (true)
+	{
+		sockaddr_in addr;
+		socklen_t addrLen = sizeof(addr);
+		NativeSocket s = accept(_listen->socket, (sockaddr *)&addr, &addrLen);
+		if (s == INVALID_NATIVE_SOCKET) return;
+
+		if (!SetNonBlocking(s))
+		{
+			CloseNativeSocket(s);
+			continue;
+		}
+
+		// responses are written in one go so dont hold them back waiting for more
+		int noDelay = 1;
+		setsockopt(s, IPPROTO_TCP, TCP_NODELAY, (const char *)&noDelay, sizeof(noDelay));
+#ifdef SO_NOSIGPIPE
+		int noSigPipe = 1;
+		setsockopt(s, SOL_SOCKET, SO_NOSIGPIPE, (const char *)&noSigPipe, sizeof(noSigPipe));
+#endif
+
+		HttpIOSocket *socket = new HttpIOSocket(_nextId++, s);
+		_sockets[socket->id] = socket;
+		Watch(socket, true);
+
+		char ip[INET_ADDRSTRLEN] = "";
+		inet_ntop(AF_INET, &addr.sin_addr, ip, sizeof(ip));
+
+#ifdef DETAILED_LOGGING
+		logger_base.debug("Web server accepted connection %ld from %s.", socket->id, ip);
+#endif
+
+		HttpIOEvent event;
+		event.type = HttpIOEvent::Connected;
+		event.id = socket->id;
+		event.ip = ip;
+		event.port = ntohs(addr.sin_port);
+		PostEvent(std::move(event));
+	}
+}
+
+bool HttpIOThread::Read(HttpIOSocket *socket)
+{
+	char buffer[HTTPIO_READSIZE];
+
+	while (true)
+	{
+		int read = (int)recv(socket->socket, buffer, sizeof(buffer), 0);
+		if (read == 0) return false; // client closed the connection
+		if (read < 0)
+		{
+			if (WouldBlock()) break;
+			return false;
+		}
+		socket->input.append(buffer, read);
+	}
+	socket->lastActivity = std::chrono::steady_clock::now();
+
+	if (socket->webSocket)
+	{
+		return ParseWebSocket(socket);
+	}
+	return ParseHttp(socket);
+}
+
+// Splits complete requests out of the input. Only enough of the headers is looked at to find where
+// the request ends ... the request itself is parsed on the handler thread.
+bool HttpIOThread::ParseHttp(HttpIOSocket *socket)
+{
+	while (!socket->webSocket)
+	{
+		size_t end = socket->input.find("\r\n\r\n");
+		if (end == std::string::npos)
+		{
+			return socket->input.size() <= HTTPIO_MAXHEADER;
+		}
+		size_t headerLength = end + 4;
+
+		size_t contentLength = 0;
+		bool upgrade = false;
+		bool expectContinue = false;
+
+		size_t line = socket->input.find("\r\n") + 2;
+		while (line < end)
+		{
+			size_t lineEnd = socket->input.find("\r\n", line);
+			size_t colon = socket->input.find(':', line);
+			if (colon != std::string::npos && colon < lineEnd)
+			{
+				std::string key = LowerTrim(socket->input.substr(line, colon - line));
+				std::string value = LowerTrim(socket->input.substr(colon + 1, lineEnd - colon - 1));
+
+				if (key == "content-length")
+				{
+					contentLength = strtoul(value.c_str(), nullptr, 10);
+				}
+				else if (key == "upgrade")
+				{
+					upgrade = value.find("websocket") != std::string::npos;
+				}
+				else if (key == "expect")
+				{
+					expectContinue = value == "100-continue";
+				}
+			}
+			line = lineEnd + 2;
+		}
+
+		if (contentLength > HTTPIO_MAXBODY) return false;
+
+		if (socket->input.size() < headerLength + contentLength)
+		{
+			if (expectContinue && !socket->continueSent)
+			{
+				socket->output.push_back(std::make_shared<const std::string>("HTTP/1.1 100 Continue\r\n\r\n"));
+				socket->continueSent = true;
+			}
+			return true;
+		}
+
+		HttpIOEvent event;
+		event.type = HttpIOEvent::Request;
+		event.id = socket->id;
+		event.data = socket->input.substr(0, headerLength + contentLength);
+		socket->input.erase(0, headerLength + contentLength);
+		socket->continueSent = false;
+		PostEvent(std::move(event));
+
+		// anything after an upgrade request is websocket frames
+		if (upgrade) socket->webSocket = true;
+	}
+
+	return ParseWebSocket(socket);
+}
+
+bool HttpIOThread::ParseWebSocket(HttpIOSocket *socket)
+{
+	static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+	while (true)
+	{
+		size_t available = socket->input.size();
+		if (available < 2) return true;
+
+		const uint8_t *buffer = (const uint8_t *)socket->input.data();
+
+		if ((buffer[0] & 0x70) != 0)
+		{
+			logger_base.warn("Web socket reserved bits must be 0.");
+			return false;
+		}
+
+		bool final = (buffer[0] & 0x80) != 0;
+		int opcode = buffer[0] & 0x0F;
+		bool masked = (buffer[1] & 0x80) != 0;
+		uint64_t length = buffer[1] & 0x7F;
+		size_t start = 2;
+
+		if (length == 126)
+		{
+			if (available < 4) return true;
+			length = ((uint64_t)buffer[2] << 8) + buffer[3];
+			start = 4;
+		}
+		else if (length == 127)
+		{
+			if (available < 10) return true;
+			length = 0;
+			for (int i = 0; i < 8; i++)
+				length = (length << 8) + buffer[2 + i];
+			start = 10;
+		}
+
+		if (length > HTTPIO_MAXBODY) return false;
+
+		uint8_t mask[4] = { 0 };
+		if (masked)
+		{
+			if (available < start + 4) return true;
+			memcpy(mask, &buffer[start], 4);
+			start += 4;
+		}
+
+		if (available < start + length) return true;
+
+		std::string payload = socket->input.substr(start, (size_t)length);
+		for (size_t i = 0; i < payload.size(); i++)
+		{
+			payload[i] ^= mask[i % 4];
+		}
+		socket->input.erase(0, start + (size_t)length);
+
+		if (opcode >= WebSocketMessage::Close)
+		{
+			// control frames are never fragmented but can arrive in the middle of a fragmented message
+			HttpIOEvent event;
+			event.type = HttpIOEvent::Message;
+			event.id = socket->id;
+			event.opcode = opcode;
+			event.data = std::move(payload);
+			PostEvent(std::move(event));
+			continue;
+		}
+
+		if (opcode == WebSocketMessage::Continuation)
+		{
+			if (socket->messageOpcode == -1) return false;
+			socket->message += payload;
+			if (socket->message.size() > HTTPIO_MAXBODY) return false;
+		}
+		else
+		{
+			socket->messageOpcode = opcode;
+			socket->message = std::move(payload);
+		}
+
+		if (final)
+		{
+			HttpIOEvent event;
+			event.type = HttpIOEvent::Message;
+			event.id = socket->id;
+			event.opcode = socket->messageOpcode;
+			event.data = std::move(socket->message);
+			PostEvent(std::move(event));
+
+			socket->messageOpcode = -1;
+			socket->message.clear();
+		}
+	}
+}
+
+bool HttpIOThread::Write(HttpIOSocket *socket)
+{
+	while (!socket->output.empty())
+	{
+		const std::string &data = *socket->output.front();
+
+		if (socket->outputOffset < data.size())
+		{
+			int sent = (int)send(socket->socket, data.data() + socket->outputOffset, (int)(data.size() - socket->outputOffset), SEND_FLAGS);
+			if (sent < 0)
+			{
+				if (WouldBlock()) break;
+				return false;
+			}
+			socket->outputOffset += sent;
+			socket->lastActivity = std::chrono::steady_clock::now();
+		}
+
+		if (socket->outputOffset >= data.size())
+		{
+			socket->output.pop_front();
+			socket->outputOffset = 0;
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	if (socket->output.empty() && socket->closeAfterWrite) return false;
+
+	Watch(socket, false);
+	return true;
+}
+
+void HttpIOThread::TakeOutbound()
+{
+	std::list<Outbound> outbound;
+	{
+		std::unique_lock<std::mutex> lock(_outboundLock);
+		outbound.swap(_outbound);
+	}
+	if (outbound.empty()) return;
+
+	std::set<long> touched;
+	for (auto &it : outbound)
+	{
+		auto s = _sockets.find(it.id);
+		if (s == _sockets.end() || s->second->closeAfterWrite) continue;
+
+		if (it.data != nullptr)
+		{
+			s->second->output.push_back(it.data);
+		}
+		if (it.closeAfter)
+		{
+			s->second->closeAfterWrite = true;
+		}
+		touched.insert(it.id);
+	}
+
+	// most of the time the whole response fits in the socket buffer so there is no need to wait
+	for (const auto &it : touched)
+	{
+		auto s = _sockets.find(it);
+		if (s != _sockets.end() && !Write(s->second))
+		{
+			Remove(s->second);
+		}
+	}
+}
+
+void HttpIOThread::Remove(HttpIOSocket *socket)
+{
+#ifdef __LINUX__
+	epoll_ctl(_poll, EPOLL_CTL_DEL, socket->socket, nullptr);
+#endif
+	CloseNativeSocket(socket->socket);
+	_sockets.erase(socket->id);
+
+	HttpIOEvent event;
+	event.type = HttpIOEvent::Closed;
+	event.id = socket->id;
+	PostEvent(std::move(event));
+
+	delete socket;
+}
+
+void HttpIOThread::Handle(long id, bool readable, bool writable)
+{
+	if (id == HTTPIO_LISTENID)
+	{
+		Accept();
+		return;
+	}
+
+	if (id == HTTPIO_WAKEID)
+	{
+		char buffer[64];
+		while (recv(_wake->socket, buffer, sizeof(buffer), 0) > 0) {}
+		return;
+	}
+
+	auto it = _sockets.find(id);
+	if (it == _sockets.end()) return;
+	HttpIOSocket *socket = it->second;
+
+	if (readable && !Read(socket))
+	{
+		Remove(socket);
+		return;
+	}
+
+	// reading can queue a reply of its own (100 Continue, websocket pong or close) so whenever there
+	// is output try to send it ... Write watches for the socket becoming writable if it can't all go now
+	if ((writable || !socket->output.empty()) && !Write(socket))
+	{
+		Remove(socket);
+	}
+}
+
+void HttpIOThread::CloseIdle()
+{
+	auto now = std::chrono::steady_clock::now();
+
+	std::list<HttpIOSocket *> idle;
+	for (const auto &it : _sockets)
+	{
+		if (!it.second->webSocket && it.second->output.empty() &&
+			std::chrono::duration_cast<std::chrono::milliseconds>(now - it.second->lastActivity).count() > HTTPIO_IDLETIMEOUTMS)
+		{
+			idle.push_back(it.second);
+		}
+	}
+
+	for (const auto &it : idle)
+	{
+		Remove(it);
+	}
+}
+
+void *HttpIOThread::Entry()
+{
+	static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+	logger_base.debug("Web server I/O thread started.");
+
+	auto lastIdleCheck = std::chrono::steady_clock::now();
+
+	while (!_stop)
+	{
+#ifdef __LINUX__
+		epoll_event events[64];
+		int n = epoll_wait(_poll, events, 64, 1000);
+		for (int i = 0; i < n && !_stop; i++)
+		{
+			Handle((long)(int64_t)events[i].data.u64,
+				(events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) != 0,
+				(events[i].events & EPOLLOUT) != 0);
+		}
+#else
+		std::vector<pollfd> fds;
+		std::vector<long> ids;
+		fds.reserve(_sockets.size() + 2);
+		ids.reserve(_sockets.size() + 2);
+
+		pollfd pfd;
+		memset(&pfd, 0x00, sizeof(pfd));
+		pfd.events = POLLIN;
+		pfd.fd = _listen->socket;
+		fds.push_back(pfd);
+		ids.push_back(HTTPIO_LISTENID);
+		pfd.fd = _wake->socket;
+		fds.push_back(pfd);
+		ids.push_back(HTTPIO_WAKEID);
+		for (const auto &it : _sockets)
+		{
+			pfd.fd = it.second->socket;
+			pfd.events = POLLIN | (it.second->output.empty() ? 0 : POLLOUT);
+			fds.push_back(pfd);
+			ids.push_back(it.first);
+		}
+
+#ifdef __WXMSW__
+		int n = WSAPoll(fds.data(), (ULONG)fds.size(), 1000);
+#else
+		int n = poll(fds.data(), (nfds_t)fds.size(), 1000);
+#endif
+		for (size_t i = 0; n > 0 && i < fds.size() && !_stop; i++)
+		{
+			if (fds[i].revents == 0) continue;
+			Handle(ids[i],
+				(fds[i].revents & (POLLIN | POLLHUP | POLLERR | POLLNVAL)) != 0,
+				(fds[i].revents & POLLOUT) != 0);
+		}
+#endif
+
+		TakeOutbound();
+
+		auto now = std::chrono::steady_clock::now();
+		if (std::chrono::duration_cast<std::chrono::milliseconds>(now - lastIdleCheck).count() > 1000)
+		{
+			CloseIdle();
+			lastIdleCheck = now;
+		}
+	}
+
+	// the server deletes all its connections when it stops so no one needs telling
+	for (auto &it : _sockets)
+	{
+		CloseNativeSocket(it.second->socket);
+		delete it.second;
+	}
+	_sockets.clear();
+
+	logger_base.debug("Web server I/O thread exiting.");
+	return nullptr;
+}
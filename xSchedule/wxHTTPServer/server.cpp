@@ -17,20 +17,16 @@
 
 //#define DETAILED_LOGGING
 
-#define SERVER_ID	100
-#define SOCKET_ID	101
+// most work items handled each time the handler thread is called so a burst of requests
+// cannot starve everything else on that thread
+#define MAX_EVENTS_PER_CALL 16
 
 #include <wx/arrimpl.cpp>
 //WX_DEFINE_EXPORTED_OBJARRAY(HeadersCollection);
 WX_DEFINE_OBJARRAY(HeadersCollection)
 
-BEGIN_EVENT_TABLE(HttpServer, wxEvtHandler)
-	EVT_SOCKET(SERVER_ID, HttpServer::OnServerEvent)
-	EVT_SOCKET(SOCKET_ID, HttpServer::OnSocketEvent)
-END_EVENT_TABLE()
-
 HttpServer::HttpServer() :
-	_server(NULL)
+	_io(nullptr)
 {
 }
 
@@ -42,195 +38,146 @@ HttpServer::~HttpServer()
 bool HttpServer::Start(const HttpContext &context)
 {
     static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
-    wxASSERT(!_server || (_server && _server->IsClosed()));
 
-	if (_server && _server->IsConnected())
+	if (_io != nullptr)
 		Stop();
 
 	_context = context;
 
-	// Create the address - defaults to localhost:0 initially
-	_address.Service(_context.Port);
-
-	wxLogMessage(_("starting server on %s:%u..."), _address.IPAddress(), _address.Service());
-    logger_base.info("starting server on %s:%u...", (const char *)_address.IPAddress().c_str(), _address.Service());
+	wxLogMessage(_("starting server on port %u..."), _context.Port);
+    logger_base.info("starting server on port %u...", _context.Port);
 
-	// Create the socket
-	_server = new wxSocketServer(_address, wxSOCKET_REUSEADDR);
-
-	// We use IsOk() here to see if the server is really listening
-    if (!_server->IsOk())
-    {
+	_io = new HttpIOThread(this);
+	if (!_io->Listen(_context.Port))
+	{
         wxLogError(_("unable to start the server on the specified port"));
         logger_base.error(_("unable to start the server on the specified port"));
-    }
-	else
-	{
-		IPaddress address;
-        if (!_server->GetLocal(address))
-        {
-            wxLogError(_("unable to retrieve the address to which you are connected"));
-            logger_base.error(_("unable to retrieve the address to which you are connected"));
-        }
-        else
-        {
-            wxLogMessage(_("server running on %s:%u"), address.IPAddress(), address.Service());
-            logger_base.info("server running on %s:%u", (const char *)address.IPAddress().c_str(), address.Service());
-        }
+		delete _io;
+		_io = nullptr;
+		return false;
+	}
 
-		// Setup the event handler and subscribe to connection events
-		_server->SetEventHandler(*this, SERVER_ID);
-		_server->SetNotify(wxSOCKET_CONNECTION_FLAG);
-		_server->Notify(true);
+	if (_io->Create() != wxTHREAD_NO_ERROR || _io->Run() != wxTHREAD_NO_ERROR)
+	{
+        logger_base.error("unable to start the web server I/O thread");
+		delete _io;
+		_io = nullptr;
+		return false;
 	}
 
-	return _server->IsOk();
+	wxLogMessage(_("server running on port %u"), _context.Port);
+    logger_base.info("server running on port %u", _context.Port);
+
+	return true;
 }
 
 bool HttpServer::Stop()
 {
     static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
-    
-    if (!_server) return false;
 
-    // close all open connections
+    if (_io == nullptr) return false;
+
+    // this closes all the sockets
+    _io->Stop();
+    delete _io;
+    _io = nullptr;
+
     for (auto it = _connections.begin(); it != _connections.end(); ++it)
     {
-        it->second->Close();
+        delete it->second;
     }
+    _connections.clear();
 
-    _server->Notify(false);
-	_server->Close();
-	delete _server;
-    _server = nullptr;
-
-	wxLogMessage(_("closed server on %s:%u"), _address.IPAddress(), _address.Service());
-    logger_base.debug("closed server on %s:%u", (const char*)_address.IPAddress().c_str(), _address.Service());
+	wxLogMessage(_("closed server on port %u"), _context.Port);
+    logger_base.debug("closed server on port %u", _context.Port);
 
 	return true;
 }
 
-void HttpServer::OnServerEvent(wxSocketEvent& event)
+void HttpServer::BroadcastMessage(WebSocketMessage &message)
 {
-    static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
-    wxStopWatch sw;
+    if (_io == nullptr) return;
 
-    switch (event.GetSocketEvent())
-    {
-    case wxSOCKET_CONNECTION:
-#ifdef DETAILED_LOGGING
-        logger_base.info("OnServerEvent: wxSOCKET_CONNECTION");
-#endif
-        break;
-    default:
-#ifdef DETAILED_LOGGING
-        logger_base.info("OnServerEvent: unexpected event %d", event.GetSocketEvent());
-#endif
-        break;
-    }
-
-    // Accept new connection if there is one in the pending connections queue, else exit. We use Accept(false) for
-    // non-blocking accept (although if we got here, there should ALWAYS be a pending connection).
-    wxSocketBase *socket = _server->Accept(false);
-
-    if (socket)
+    std::list<long> ids;
+    for (auto it = _connections.begin(); it != _connections.end(); ++it)
     {
-#ifdef DETAILED_LOGGING
-        logger_base.info("created socket client (socket %d)", socket->GetSocket());
-#endif
-
-        HttpConnection *connection = nullptr;
-
-        if (event.GetSocketEvent() == wxSOCKET_CONNECTION)
+        if (it->second->IsWebSocket() && it->second->IsOpen())
         {
-            connection = new HttpConnection(this, socket);
-            _connections[socket] = connection;
+            ids.push_back(it->first);
         }
-        else
-            connection = _connections[socket];
+    }
 
-        wxASSERT(connection != nullptr);
+    SendMessageTo(ids, message);
+}
 
-        socket->SetEventHandler(*this, SOCKET_ID);
-        socket->SetNotify(wxSOCKET_INPUT_FLAG | wxSOCKET_LOST_FLAG);
-        socket->Notify(true);
-    }
-    else
-    {
-#ifdef DETAILED_LOGGING
-        logger_base.info("error, impossible to accept a new connection");
-#endif
-    }
+void HttpServer::SendMessageTo(const std::list<long> &ids, WebSocketMessage &message)
+{
+    if (_io == nullptr || ids.empty()) return;
 
-#ifdef DETAILED_LOGGING
-    logger_base.info("OnServerEvent Time %ld.", sw.Time());
-#endif
+    _io->Send(ids, HttpConnection::FrameMessage(message));
 }
 
-void HttpServer::OnSocketEvent(wxSocketEvent& event)
+void HttpServer::OnIOEvents()
 {
     static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    if (_io == nullptr) return;
+
     wxStopWatch sw;
+    std::list<HttpIOEvent> events;
+    bool more = _io->TakeEvents(events, MAX_EVENTS_PER_CALL);
 
-	switch(event.GetSocketEvent())
-	{
-	case wxSOCKET_INPUT:
-#ifdef DETAILED_LOGGING
-        logger_base.info("OnSocketEvent: wxSOCKET_INPUT");
-#endif
-		break;
-	case wxSOCKET_LOST:
+    for (auto& it : events)
+    {
+        switch (it.type)
+        {
+        case HttpIOEvent::Connected:
+            {
 #ifdef DETAILED_LOGGING
-        logger_base.info("OnSocketEvent: wxSOCKET_LOST");
+                logger_base.info("created socket client (connection %ld)", it.id);
 #endif
-		break;
-	default:
+                _connections[it.id] = new HttpConnection(this, it.id, it.ip, it.port);
+            }
+            break;
+        case HttpIOEvent::Request:
+        case HttpIOEvent::Message:
+            {
+                auto c = _connections.find(it.id);
+                if (c == _connections.end()) break;
+
+                if (it.type == HttpIOEvent::Request)
+                {
+                    c->second->HandleRequest(it.data);
+                }
+                else
+                {
+                    c->second->HandleMessage(it.opcode, it.data);
+                }
+            }
+            break;
+        case HttpIOEvent::Closed:
+            {
+                auto c = _connections.find(it.id);
+                if (c == _connections.end()) break;
+                delete c->second;
+                _connections.erase(c);
 #ifdef DETAILED_LOGGING
-        logger_base.info("OnServerEvent: unexpected event %d", event.GetSocketEvent());
+                logger_base.info("deleted socket client (connection %ld)", it.id);
 #endif
-		break;
-	}
-
-	wxSocketBase *socket = event.GetSocket();
+            }
+            break;
+        }
 
-	HttpConnection *connection = _connections[socket];
-	wxASSERT(connection != NULL);
+        // a handler may have stopped the server
+        if (_io == nullptr) return;
+    }
 
-	// Now we process the event
-	switch(event.GetSocketEvent())
-	{
-	case wxSOCKET_INPUT:
-		{
-			// We disable input events, so that the test doesn't trigger wxSocketEvent again.
-			socket->SetNotify(wxSOCKET_LOST_FLAG);
-			socket->SetFlags(wxSOCKET_NOWAIT);
-
-			connection->HandleRequest();
-
-			// Enable input events again.
-			socket->SetNotify(wxSOCKET_LOST_FLAG | wxSOCKET_INPUT_FLAG);
-			break;
-		}
-	case wxSOCKET_LOST:
-		{
-			_connections.erase(_connections.find(socket));
-			delete connection;
-
-			// Destroy() should be used instead of delete wherever possible, due to the fact that wxSocket uses 'delayed events'
-			// (see the documentation for wxPostEvent) and we don't want an event to arrive to the event handler (the frame,
-			// here) after the socket has been deleted. Also, we might be doing some other thing with the socket at the same
-			// time; for example, we might be in the middle of a test or something. Destroy() takes care of all this for us.
-#ifdef DETAILED_LOGGING
-            logger_base.info("deleted socket client (socket %d)", socket->GetSocket());
-#endif
-			socket->Destroy();
-			break;
-		}
-    default:
-        break;
-	}
+    if (more)
+    {
+        CallAfter(&HttpServer::OnIOEvents);
+    }
 
 #ifdef DETAILED_LOGGING
-    logger_base.info("OnSocketEvent Time %ld.", sw.Time());
+    logger_base.info("OnIOEvents %d events Time %ld.", (int)events.size(), sw.Time());
 #endif
 }
@@ -23,6 +23,14 @@
 #include <wx/socket.h>
 #include <wx/dynarray.h>
 #include <wx/hash.h>
+#include <wx/thread.h>
+
+#include <atomic>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
 
 #define SERVER_NAME    "xLights Web Server"
 #define SERVER_VERSION "1.0"
@@ -45,6 +53,8 @@ class HttpConnection;
 class HttpRequest;
 class HttpResponse;
 class WebSocketMessage;
+class HttpIOThread;
+struct HttpIOSocket;
 
 typedef bool (*RequestHandlerPtr)(HttpConnection &connection, HttpRequest &request);
 typedef void (*MessageHandlerPtr)(HttpConnection &connection, WebSocketMessage &message);
@@ -161,6 +171,7 @@ protected:
 	wxString _value;
 
 	friend class HttpHeaders;
+	friend class HttpConnection;
 };
 
 //WX_DECLARE_EXPORTED_OBJARRAY(HttpHeader, HeadersCollection);
@@ -193,39 +204,43 @@ public:
 };
 
 // Connection class
+// Connections live on the thread running the handlers. The socket itself belongs to the
+// server I/O thread so sending only queues the bytes and never blocks the caller.
 class /* WXDLLIMPEXP_BASE */ HttpConnection
 {
 public:
-	HttpConnection(HttpServer *server, wxSocketBase *socket);
+	HttpConnection(HttpServer *server, long id, const wxString &ip, unsigned short port);
 	virtual ~HttpConnection();
 
-	virtual bool HandleRequest();
+	virtual bool HandleRequest(const std::string &input);
+	virtual bool HandleMessage(int opcode, const std::string &content);
 	virtual bool SendResponse(HttpResponse &response);
 	virtual bool SendMessage(WebSocketMessage &message);
 	virtual bool Close();
 
+	// frame a message ready to be sent to any number of websocket connections
+	static std::shared_ptr<const std::string> FrameMessage(const WebSocketMessage &message);
+
 	// properties
-	inline bool IsOpen() { return (_socket && _socket->IsOk()); }
+	inline bool IsOpen() { return _open; }
 	inline const HttpServer *Server() const { return _server; }
-	inline const wxSocketBase *Socket() const { return _socket; }
+	inline long Id() const { return _id; }
 	inline const IPaddress &Address() { return _address; }
 	inline bool IsWebSocket() { return _isWebSocket; }
 
 protected:
-	void ParseRequest(const wxString &content);
-	bool ParseFrame(wxMemoryBuffer &buffer);
 	bool WebSocketHandshake(HttpRequest &request);
 
 protected:
 	HttpServer       *_server;
-	wxSocketBase     *_socket;
+	long              _id;
 	IPaddress         _address;
 	bool              _isWebSocket;
-	WebSocketMessage *_message;
+	bool              _open;
 };
 
-//WX_DECLARE_EXPORTED_HASH_MAP(wxSocketBase *, HttpConnection *, wxPointerHash, wxPointerEqual, ConnectionMap);
-WX_DECLARE_HASH_MAP(wxSocketBase *, HttpConnection *, wxPointerHash, wxPointerEqual, ConnectionMap);
+//WX_DECLARE_EXPORTED_HASH_MAP(long, HttpConnection *, wxIntegerHash, wxIntegerEqual, ConnectionMap);
+WX_DECLARE_HASH_MAP(long, HttpConnection *, wxIntegerHash, wxIntegerEqual, ConnectionMap);
 
 // HTTP request
 class /* WXDLLIMPEXP_BASE */ HttpRequest
@@ -321,24 +336,104 @@ public:
 	bool Start(const HttpContext &context);
 	bool Stop();
 
+	// queue the same pre-framed message to every open websocket connection
+	void BroadcastMessage(WebSocketMessage &message);
+	// queue the same pre-framed message to the listed connections
+	void SendMessageTo(const std::list<long> &ids, WebSocketMessage &message);
+
 	// properties
 
 	inline const HttpContext &Context() const { return _context; }
 
 protected:
-	// event handlers (these functions should _not_ be virtual)
-	void OnServerEvent(wxSocketEvent &event);
-	void OnSocketEvent(wxSocketEvent &event);
+	// runs on the handler thread whenever the I/O thread has queued work
+	void OnIOEvents();
     ConnectionMap   _connections;
 
 private:
-	wxSocketServer *_server;
+	HttpIOThread   *_io;
 	HttpContext     _context;
-	IPaddress       _address;
-
-	DECLARE_EVENT_TABLE()
 
 	friend class HttpConnection;
+	friend class HttpIOThread;
+};
+
+// Something the I/O thread needs the handler thread to deal with
+struct HttpIOEvent
+{
+	enum Type
+	{
+		Connected,
+		Request,    // a complete HTTP request including any body
+		Message,    // a complete websocket message
+		Closed
+	};
+
+	Type           type;
+	long           id;
+	std::string    ip;
+	unsigned short port = 0;
+	int            opcode = 0;
+	std::string    data;
+};
+
+// Owns the listening socket and every connection socket. All socket reads and writes happen
+// here using non-blocking sockets and epoll (poll elsewhere) so a slow or busy client never
+// holds up the thread running the scheduler. Requests are split out of the byte stream here
+// (so keep-alive and pipelined requests work) and then queued to the handler thread in order.
+class HttpIOThread : public wxThread
+{
+public:
+	HttpIOThread(HttpServer *server);
+	virtual ~HttpIOThread();
+
+	// call before Run
+	bool Listen(unsigned short port);
+	void Stop();
+
+	// these can be called from any thread
+	void Send(long id, const std::shared_ptr<const std::string> &data, bool closeAfter);
+	void Send(const std::list<long> &ids, const std::shared_ptr<const std::string> &data);
+	void Close(long id);
+	bool TakeEvents(std::list<HttpIOEvent> &events, size_t max);
+
+	virtual void *Entry() override;
+
+private:
+	struct Outbound
+	{
+		long id;
+		std::shared_ptr<const std::string> data; // null to just close
+		bool closeAfter;
+	};
+
+	void Wake();
+	void Handle(long id, bool readable, bool writable);
+	void CloseIdle();
+	void Accept();
+	bool Read(HttpIOSocket *socket);
+	bool Write(HttpIOSocket *socket);
+	bool ParseHttp(HttpIOSocket *socket);
+	bool ParseWebSocket(HttpIOSocket *socket);
+	void TakeOutbound();
+	void Remove(HttpIOSocket *socket);
+	void Watch(HttpIOSocket *socket, bool add);
+	void PostEvent(HttpIOEvent &&event);
+
+	HttpServer                     *_server;
+	std::atomic<bool>               _stop;
+	HttpIOSocket                   *_listen = nullptr;
+	HttpIOSocket                   *_wake = nullptr;
+	long                            _nextId = 1;
+	std::map<long, HttpIOSocket *>  _sockets; // only touched by the I/O thread
+	int                             _poll = -1; // epoll handle on linux
+
+	std::mutex                      _outboundLock;
+	std::list<Outbound>             _outbound;
+
+	std::mutex                      _eventLock;
+	std::list<HttpIOEvent>          _events;
+	bool                            _eventsPosted = false;
 };
 
 // Complete WebSocket message (framing is managed by server)
@@ -364,7 +459,7 @@ public:
 	// properties
 
 	// messagge type
-	inline Opcode Type() { return _type; }
+	inline Opcode Type() const { return _type; }
 	// messagge content
 	inline const wxMemoryBuffer &Content() const { return _content; }
 
@@ -3271,7 +3271,7 @@ void xScheduleFrame::UpdateUI(bool force)
 
     if (!minimiseUIUpdates) {
 
-        StaticText_PacketsPerSec->SetLabel(wxString::Format("Packets/Sec: %d", __schedule->GetPPS()));
+        StaticText_PacketsPerSec->SetLabel(wxString::Format("Packets/Sec: %d Suppressed: %d%%", __schedule->GetPPS(), __schedule->GetSuppressedPacketPercent()));
 
         if (__schedule->GetWebRequestToggle()) {
             if (!_webIconDisplayed) {
@@ -3612,9 +3612,13 @@ void xScheduleFrame::SendStatus()
                 if (__schedule->IsXyzzy())
                 {
                     __schedule->DoXyzzy("q", "", result, "");
+                    _webServer->SendMessageToAllWebSockets(result);
+                }
+                else
+                {
+                    // the query above has just refreshed the cached status
+                    _webServer->SendStatusToAllWebSockets(result, __schedule->GetCachedQuery("getplayingstatus", ""));
                 }
-
-                _webServer->SendMessageToAllWebSockets(result);
             }
         }
 